@@ -56,7 +56,7 @@ void Bitmap::clear_bit(int index) {
 int Bitmap::next_unsetted_bit(int start) {
   int ret = -1;
   int start_in_byte = start % 8;
-  for (int iter = start / 8, end = (size_ % 8 == 0 ? size_ / 8 : size_ / 8 + 1); iter <= end; iter++) {
+  for (int iter = start / 8, end = (size_ % 8 == 0 ? size_ / 8 : size_ / 8 + 1); iter < end; iter++) {
     char byte = bitmap_[iter];
     if (byte != -1) {
       int index_in_byte = find_first_zero(byte, start_in_byte);
@@ -64,9 +64,8 @@ int Bitmap::next_unsetted_bit(int start) {
         ret = iter * 8 + index_in_byte;
         break;
       }
-
-      start_in_byte = 0;
     }
+    start_in_byte = 0;
   }
 
   if (ret >= size_) {
@@ -78,7 +77,7 @@ int Bitmap::next_unsetted_bit(int start) {
 int Bitmap::next_setted_bit(int start) {
   int ret = -1;
   int start_in_byte = start % 8;
-  for (int iter = start / 8, end = (size_ % 8 == 0 ? size_ / 8 : size_ / 8 + 1); iter <= end; iter++) {
+  for (int iter = start / 8, end = (size_ % 8 == 0 ? size_ / 8 : size_ / 8 + 1); iter < end; iter++) {
     char byte = bitmap_[iter];
     if (byte != 0x00) {
       int index_in_byte = find_first_setted(byte, start_in_byte);
@@ -86,9 +85,8 @@ int Bitmap::next_setted_bit(int start) {
         ret = iter * 8 + index_in_byte;
         break;
       }
-
-      start_in_byte = 0;
     }
+    start_in_byte = 0;
   }
 
   if (ret >= size_) {
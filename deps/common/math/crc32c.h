@@ -0,0 +1,27 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifndef __COMMON_MATH_CRC32C_H_
+#define __COMMON_MATH_CRC32C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace common {
+
+/**
+ * CRC32C(Castagnoli)。CPU支持SSE4.2时使用crc32指令，否则查表计算
+ * @param crc 上一段数据的结果，第一段数据传0
+ */
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+}  // namespace common
+
+#endif  // __COMMON_MATH_CRC32C_H_
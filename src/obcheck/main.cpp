@@ -0,0 +1,51 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// 离线校验数据文件和索引文件的页面校验和，需要在observer停止之后运行。
+// 用法: obcheck file...
+// 所有页面都通过校验时返回0，否则输出校验失败的页号并返回1
+//
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "rc.h"
+#include "storage/default/disk_buffer_pool.h"
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s file...\n", argv[0]);
+    return 2;
+  }
+
+  int result = 0;
+  std::vector<PageNum> corrupted_pages;
+  for (int i = 1; i < argc; i++) {
+    RC rc = DiskBufferPool::verify_file(argv[i], corrupted_pages);
+    if (rc != RC::SUCCESS) {
+      printf("%s: failed to verify, rc=%d:%s\n", argv[i], rc, strrc(rc));
+      result = 1;
+    }
+    if (!corrupted_pages.empty()) {
+      printf("%s: %d corrupted pages:", argv[i], (int)corrupted_pages.size());
+      for (PageNum page_num : corrupted_pages) {
+        printf(" %d", page_num);
+      }
+      printf("\n");
+      result = 1;
+    } else if (rc == RC::SUCCESS) {
+      printf("%s: OK\n", argv[i]);
+    }
+  }
+  return result;
+}
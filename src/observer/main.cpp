@@ -24,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 #include "init.h"
 #include "net/server.h"
 #include "net/server_param.h"
+#include "storage/default/disk_buffer_pool.h"
 
 using namespace common;
 
@@ -146,6 +147,8 @@ void* quit_thread_func(void* _signum)
 {
     intptr_t signum = (intptr_t)_signum;
     LOG_INFO("Receive signal: %ld", signum);
+    // 保存缓冲池中的页面列表，下次启动时预热
+    cleanup_global_disk_buffer_pool();
     if (g_server)
     {
         g_server->shutdown();
@@ -314,10 +314,25 @@ void drop_table_destroy(DropTable *drop_table) {
 }
 
 void create_index_init(CreateIndex *create_index, const char *index_name,
-                       const char *relation_name, const char *attr_name) {
+                       const char *relation_name) {
     create_index->index_name = strdup(index_name);
     create_index->relation_name = strdup(relation_name);
-    create_index->attribute_name = strdup(attr_name);
+}
+int create_index_append_attribute(CreateIndex *create_index,
+                                  const char *attr_name) {
+    if (create_index->attribute_num >=
+        sizeof(create_index->attribute_names) /
+            sizeof(create_index->attribute_names[0])) {
+        return -1;
+    }
+    for (size_t i = 0; i < create_index->attribute_num; i++) {
+        if (0 == strcmp(create_index->attribute_names[i], attr_name)) {
+            return -1;
+        }
+    }
+    create_index->attribute_names[create_index->attribute_num++] =
+        strdup(attr_name);
+    return 0;
 }
 void set_index_unique(CreateIndex *create_index, int flag) {
     create_index->is_unique = flag;
@@ -325,11 +340,14 @@ void set_index_unique(CreateIndex *create_index, int flag) {
 void create_index_destroy(CreateIndex *create_index) {
     free(create_index->index_name);
     free(create_index->relation_name);
-    free(create_index->attribute_name);
+    for (size_t i = 0; i < create_index->attribute_num; i++) {
+        free(create_index->attribute_names[i]);
+        create_index->attribute_names[i] = nullptr;
+    }
+    create_index->attribute_num = 0;
 
     create_index->index_name = nullptr;
     create_index->relation_name = nullptr;
-    create_index->attribute_name = nullptr;
 }
 
 void drop_index_init(DropIndex *drop_index, const char *index_name) {
@@ -134,9 +134,10 @@ typedef struct {
 
 // struct of create_index
 typedef struct {
-    char *index_name;      // Index name
-    char *relation_name;   // Relation name
-    char *attribute_name;  // Attribute name
+    char *index_name;                // Index name
+    char *relation_name;             // Relation name
+    size_t attribute_num;            // Length of attribute names
+    char *attribute_names[MAX_NUM];  // Attribute names, 多列索引按顺序排列
     int is_unique;
 } CreateIndex;
 
@@ -249,7 +250,10 @@ void drop_table_init(DropTable *drop_table, const char *relation_name);
 void drop_table_destroy(DropTable *drop_table);
 
 void create_index_init(CreateIndex *create_index, const char *index_name,
-                       const char *relation_name, const char *attr_name);
+                       const char *relation_name);
+// 索引的列超过MAX_NUM个或者重复时返回-1，不追加
+int create_index_append_attribute(CreateIndex *create_index,
+                                  const char *attr_name);
 void create_index_destroy(CreateIndex *create_index);
 
 void drop_index_init(DropIndex *drop_index, const char *index_name);
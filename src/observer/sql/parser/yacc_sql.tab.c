@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.5.1.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -34,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -41,14 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
-
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.5.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -123,7 +124,7 @@ ParserContext *get_context(yyscan_t scanner)
 #define CONTEXT get_context(scanner)
 
 
-#line 127 "yacc_sql.tab.c"
+#line 128 "yacc_sql.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -146,184 +147,130 @@ ParserContext *get_context(yyscan_t scanner)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Use api.header.include to #include this header
-   instead of duplicating it here.  */
-#ifndef YY_YY_YACC_SQL_TAB_H_INCLUDED
-# define YY_YY_YACC_SQL_TAB_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    SEMICOLON = 258,
-    CREATE = 259,
-    DROP = 260,
-    TABLE = 261,
-    TABLES = 262,
-    UNIQUE = 263,
-    INDEX = 264,
-    SELECT = 265,
-    DESC = 266,
-    SHOW = 267,
-    SYNC = 268,
-    INSERT = 269,
-    DELETE = 270,
-    UPDATE = 271,
-    LBRACE = 272,
-    RBRACE = 273,
-    COMMA = 274,
-    TRX_BEGIN = 275,
-    TRX_COMMIT = 276,
-    TRX_ROLLBACK = 277,
-    INT_T = 278,
-    STRING_T = 279,
-    FLOAT_T = 280,
-    DATE_T = 281,
-    HELP = 282,
-    EXIT = 283,
-    DOT = 284,
-    INTO = 285,
-    VALUES = 286,
-    FROM = 287,
-    WHERE = 288,
-    ORDER = 289,
-    ASC = 290,
-    BY = 291,
-    NULLABLE = 292,
-    IS = 293,
-    NOT = 294,
-    NULL_ = 295,
-    INNER = 296,
-    JOIN = 297,
-    AND = 298,
-    SET = 299,
-    ON = 300,
-    LOAD = 301,
-    DATA = 302,
-    INFILE = 303,
-    EQ = 304,
-    LT = 305,
-    GT = 306,
-    LE = 307,
-    GE = 308,
-    NE = 309,
-    NUMBER = 310,
-    FLOAT = 311,
-    DATE = 312,
-    ID = 313,
-    PATH = 314,
-    SSS = 315,
-    STAR = 316,
-    STRING_V = 317
-  };
-#endif
-/* Tokens.  */
-#define SEMICOLON 258
-#define CREATE 259
-#define DROP 260
-#define TABLE 261
-#define TABLES 262
-#define UNIQUE 263
-#define INDEX 264
-#define SELECT 265
-#define DESC 266
-#define SHOW 267
-#define SYNC 268
-#define INSERT 269
-#define DELETE 270
-#define UPDATE 271
-#define LBRACE 272
-#define RBRACE 273
-#define COMMA 274
-#define TRX_BEGIN 275
-#define TRX_COMMIT 276
-#define TRX_ROLLBACK 277
-#define INT_T 278
-#define STRING_T 279
-#define FLOAT_T 280
-#define DATE_T 281
-#define HELP 282
-#define EXIT 283
-#define DOT 284
-#define INTO 285
-#define VALUES 286
-#define FROM 287
-#define WHERE 288
-#define ORDER 289
-#define ASC 290
-#define BY 291
-#define NULLABLE 292
-#define IS 293
-#define NOT 294
-#define NULL_ 295
-#define INNER 296
-#define JOIN 297
-#define AND 298
-#define SET 299
-#define ON 300
-#define LOAD 301
-#define DATA 302
-#define INFILE 303
-#define EQ 304
-#define LT 305
-#define GT 306
-#define LE 307
-#define GE 308
-#define NE 309
-#define NUMBER 310
-#define FLOAT 311
-#define DATE 312
-#define ID 313
-#define PATH 314
-#define SSS 315
-#define STAR 316
-#define STRING_V 317
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-union YYSTYPE
+#include "yacc_sql.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-#line 117 "yacc_sql.y"
-
-  struct _Attr *attr;
-  struct _Condition *condition1;
-  struct _Value *value1;
-  char *string;
-  int number;
-  float floats;
-	char *position;
-
-#line 313 "yacc_sql.tab.c"
-
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_SEMICOLON = 3,                  /* SEMICOLON  */
+  YYSYMBOL_CREATE = 4,                     /* CREATE  */
+  YYSYMBOL_DROP = 5,                       /* DROP  */
+  YYSYMBOL_TABLE = 6,                      /* TABLE  */
+  YYSYMBOL_TABLES = 7,                     /* TABLES  */
+  YYSYMBOL_UNIQUE = 8,                     /* UNIQUE  */
+  YYSYMBOL_INDEX = 9,                      /* INDEX  */
+  YYSYMBOL_SELECT = 10,                    /* SELECT  */
+  YYSYMBOL_DESC = 11,                      /* DESC  */
+  YYSYMBOL_SHOW = 12,                      /* SHOW  */
+  YYSYMBOL_SYNC = 13,                      /* SYNC  */
+  YYSYMBOL_INSERT = 14,                    /* INSERT  */
+  YYSYMBOL_DELETE = 15,                    /* DELETE  */
+  YYSYMBOL_UPDATE = 16,                    /* UPDATE  */
+  YYSYMBOL_LBRACE = 17,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 18,                    /* RBRACE  */
+  YYSYMBOL_COMMA = 19,                     /* COMMA  */
+  YYSYMBOL_TRX_BEGIN = 20,                 /* TRX_BEGIN  */
+  YYSYMBOL_TRX_COMMIT = 21,                /* TRX_COMMIT  */
+  YYSYMBOL_TRX_ROLLBACK = 22,              /* TRX_ROLLBACK  */
+  YYSYMBOL_INT_T = 23,                     /* INT_T  */
+  YYSYMBOL_STRING_T = 24,                  /* STRING_T  */
+  YYSYMBOL_FLOAT_T = 25,                   /* FLOAT_T  */
+  YYSYMBOL_DATE_T = 26,                    /* DATE_T  */
+  YYSYMBOL_HELP = 27,                      /* HELP  */
+  YYSYMBOL_EXIT = 28,                      /* EXIT  */
+  YYSYMBOL_DOT = 29,                       /* DOT  */
+  YYSYMBOL_INTO = 30,                      /* INTO  */
+  YYSYMBOL_VALUES = 31,                    /* VALUES  */
+  YYSYMBOL_FROM = 32,                      /* FROM  */
+  YYSYMBOL_WHERE = 33,                     /* WHERE  */
+  YYSYMBOL_ORDER = 34,                     /* ORDER  */
+  YYSYMBOL_ASC = 35,                       /* ASC  */
+  YYSYMBOL_BY = 36,                        /* BY  */
+  YYSYMBOL_NULLABLE = 37,                  /* NULLABLE  */
+  YYSYMBOL_IS = 38,                        /* IS  */
+  YYSYMBOL_NOT = 39,                       /* NOT  */
+  YYSYMBOL_NULL_ = 40,                     /* NULL_  */
+  YYSYMBOL_INNER = 41,                     /* INNER  */
+  YYSYMBOL_JOIN = 42,                      /* JOIN  */
+  YYSYMBOL_AND = 43,                       /* AND  */
+  YYSYMBOL_SET = 44,                       /* SET  */
+  YYSYMBOL_ON = 45,                        /* ON  */
+  YYSYMBOL_LOAD = 46,                      /* LOAD  */
+  YYSYMBOL_DATA = 47,                      /* DATA  */
+  YYSYMBOL_INFILE = 48,                    /* INFILE  */
+  YYSYMBOL_EQ = 49,                        /* EQ  */
+  YYSYMBOL_LT = 50,                        /* LT  */
+  YYSYMBOL_GT = 51,                        /* GT  */
+  YYSYMBOL_LE = 52,                        /* LE  */
+  YYSYMBOL_GE = 53,                        /* GE  */
+  YYSYMBOL_NE = 54,                        /* NE  */
+  YYSYMBOL_NUMBER = 55,                    /* NUMBER  */
+  YYSYMBOL_FLOAT = 56,                     /* FLOAT  */
+  YYSYMBOL_DATE = 57,                      /* DATE  */
+  YYSYMBOL_ID = 58,                        /* ID  */
+  YYSYMBOL_PATH = 59,                      /* PATH  */
+  YYSYMBOL_SSS = 60,                       /* SSS  */
+  YYSYMBOL_STAR = 61,                      /* STAR  */
+  YYSYMBOL_STRING_V = 62,                  /* STRING_V  */
+  YYSYMBOL_YYACCEPT = 63,                  /* $accept  */
+  YYSYMBOL_commands = 64,                  /* commands  */
+  YYSYMBOL_command = 65,                   /* command  */
+  YYSYMBOL_exit = 66,                      /* exit  */
+  YYSYMBOL_help = 67,                      /* help  */
+  YYSYMBOL_sync = 68,                      /* sync  */
+  YYSYMBOL_begin = 69,                     /* begin  */
+  YYSYMBOL_commit = 70,                    /* commit  */
+  YYSYMBOL_rollback = 71,                  /* rollback  */
+  YYSYMBOL_drop_table = 72,                /* drop_table  */
+  YYSYMBOL_show_tables = 73,               /* show_tables  */
+  YYSYMBOL_desc_table = 74,                /* desc_table  */
+  YYSYMBOL_create_index = 75,              /* create_index  */
+  YYSYMBOL_index_attr = 76,                /* index_attr  */
+  YYSYMBOL_index_list = 77,                /* index_list  */
+  YYSYMBOL_index = 78,                     /* index  */
+  YYSYMBOL_drop_index = 79,                /* drop_index  */
+  YYSYMBOL_create_table = 80,              /* create_table  */
+  YYSYMBOL_attr_def_list = 81,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 82,                  /* attr_def  */
+  YYSYMBOL_number = 83,                    /* number  */
+  YYSYMBOL_type = 84,                      /* type  */
+  YYSYMBOL_ID_get = 85,                    /* ID_get  */
+  YYSYMBOL_nullable = 86,                  /* nullable  */
+  YYSYMBOL_not_null = 87,                  /* not_null  */
+  YYSYMBOL_insert = 88,                    /* insert  */
+  YYSYMBOL_record_list = 89,               /* record_list  */
+  YYSYMBOL_record = 90,                    /* record  */
+  YYSYMBOL_value_list = 91,                /* value_list  */
+  YYSYMBOL_value = 92,                     /* value  */
+  YYSYMBOL_delete = 93,                    /* delete  */
+  YYSYMBOL_update = 94,                    /* update  */
+  YYSYMBOL_select = 95,                    /* select  */
+  YYSYMBOL_select_param = 96,              /* select_param  */
+  YYSYMBOL_aggregate_list = 97,            /* aggregate_list  */
+  YYSYMBOL_aggregate = 98,                 /* aggregate  */
+  YYSYMBOL_aggregate_attr = 99,            /* aggregate_attr  */
+  YYSYMBOL_select_attr = 100,              /* select_attr  */
+  YYSYMBOL_attr_list = 101,                /* attr_list  */
+  YYSYMBOL_rel_list = 102,                 /* rel_list  */
+  YYSYMBOL_join_list = 103,                /* join_list  */
+  YYSYMBOL_where = 104,                    /* where  */
+  YYSYMBOL_condition_list = 105,           /* condition_list  */
+  YYSYMBOL_condition = 106,                /* condition  */
+  YYSYMBOL_comOp = 107,                    /* comOp  */
+  YYSYMBOL_load_data = 108,                /* load_data  */
+  YYSYMBOL_order_by = 109,                 /* order_by  */
+  YYSYMBOL_order_param_list = 110,         /* order_param_list  */
+  YYSYMBOL_order_param = 111,              /* order_param  */
+  YYSYMBOL_is_desc = 112,                  /* is_desc  */
+  YYSYMBOL_is_asc = 113                    /* is_asc  */
 };
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
-int yyparse (void *scanner);
-
-#endif /* !YY_YY_YACC_SQL_TAB_H_INCLUDED  */
-
-
 
 #ifdef short
 # undef short
@@ -362,6 +309,18 @@ typedef int_least16_t yytype_int16;
 typedef short yytype_int16;
 #endif
 
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
 #elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
@@ -421,6 +380,7 @@ typedef int yytype_uint16;
 
 #define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
 
+
 /* Stored state numbers (used for stacks). */
 typedef yytype_uint8 yy_state_t;
 
@@ -439,6 +399,7 @@ typedef int yy_state_fast_t;
 # endif
 #endif
 
+
 #ifndef YY_ATTRIBUTE_PURE
 # if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
 #  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
@@ -457,17 +418,23 @@ typedef int yy_state_fast_t;
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -496,7 +463,7 @@ typedef int yy_state_fast_t;
 
 #define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -561,8 +528,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -627,25 +593,27 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   216
+#define YYLAST   219
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  63
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  50
+#define YYNNTS  51
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  114
+#define YYNRULES  115
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  226
+#define YYNSTATES  227
 
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   317
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                \
-  (0 <= (YYX) && (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
@@ -686,66 +654,64 @@ static const yytype_int8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
        0,   146,   146,   148,   152,   153,   154,   155,   156,   157,
      158,   159,   160,   161,   162,   163,   164,   165,   166,   167,
      168,   172,   177,   182,   188,   194,   200,   206,   212,   218,
-     225,   232,   233,   239,   242,   249,   256,   265,   267,   271,
-     278,   287,   290,   291,   292,   293,   296,   303,   306,   310,
-     311,   315,   324,   326,   330,   333,   335,   340,   343,   346,
-     349,   353,   360,   370,   380,   399,   400,   402,   403,   406,
-     412,   417,   422,   427,   434,   444,   449,   454,   461,   463,
-     468,   476,   478,   483,   484,   489,   491,   493,   495,   498,
-     509,   518,   529,   539,   549,   561,   575,   576,   577,   578,
-     579,   580,   581,   582,   586,   593,   595,   598,   600,   604,
-     607,   612,   615,   619,   620
+     225,   233,   243,   244,   248,   251,   258,   265,   274,   276,
+     280,   287,   296,   299,   300,   301,   302,   305,   312,   315,
+     319,   320,   324,   333,   335,   339,   342,   344,   349,   352,
+     355,   358,   362,   369,   379,   389,   408,   409,   411,   412,
+     415,   421,   426,   431,   436,   443,   453,   458,   463,   470,
+     472,   477,   485,   487,   492,   493,   498,   500,   502,   504,
+     507,   518,   527,   538,   548,   558,   570,   584,   585,   586,
+     587,   588,   589,   590,   591,   595,   602,   604,   607,   609,
+     613,   616,   621,   624,   628,   629
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "SEMICOLON", "CREATE", "DROP", "TABLE",
-  "TABLES", "UNIQUE", "INDEX", "SELECT", "DESC", "SHOW", "SYNC", "INSERT",
-  "DELETE", "UPDATE", "LBRACE", "RBRACE", "COMMA", "TRX_BEGIN",
-  "TRX_COMMIT", "TRX_ROLLBACK", "INT_T", "STRING_T", "FLOAT_T", "DATE_T",
-  "HELP", "EXIT", "DOT", "INTO", "VALUES", "FROM", "WHERE", "ORDER", "ASC",
-  "BY", "NULLABLE", "IS", "NOT", "NULL_", "INNER", "JOIN", "AND", "SET",
-  "ON", "LOAD", "DATA", "INFILE", "EQ", "LT", "GT", "LE", "GE", "NE",
-  "NUMBER", "FLOAT", "DATE", "ID", "PATH", "SSS", "STAR", "STRING_V",
-  "$accept", "commands", "command", "exit", "help", "sync", "begin",
-  "commit", "rollback", "drop_table", "show_tables", "desc_table",
-  "create_index", "index_list", "index", "drop_index", "create_table",
-  "attr_def_list", "attr_def", "number", "type", "ID_get", "nullable",
-  "not_null", "insert", "record_list", "record", "value_list", "value",
-  "delete", "update", "select", "select_param", "aggregate_list",
+  "\"end of file\"", "error", "\"invalid token\"", "SEMICOLON", "CREATE",
+  "DROP", "TABLE", "TABLES", "UNIQUE", "INDEX", "SELECT", "DESC", "SHOW",
+  "SYNC", "INSERT", "DELETE", "UPDATE", "LBRACE", "RBRACE", "COMMA",
+  "TRX_BEGIN", "TRX_COMMIT", "TRX_ROLLBACK", "INT_T", "STRING_T",
+  "FLOAT_T", "DATE_T", "HELP", "EXIT", "DOT", "INTO", "VALUES", "FROM",
+  "WHERE", "ORDER", "ASC", "BY", "NULLABLE", "IS", "NOT", "NULL_", "INNER",
+  "JOIN", "AND", "SET", "ON", "LOAD", "DATA", "INFILE", "EQ", "LT", "GT",
+  "LE", "GE", "NE", "NUMBER", "FLOAT", "DATE", "ID", "PATH", "SSS", "STAR",
+  "STRING_V", "$accept", "commands", "command", "exit", "help", "sync",
+  "begin", "commit", "rollback", "drop_table", "show_tables", "desc_table",
+  "create_index", "index_attr", "index_list", "index", "drop_index",
+  "create_table", "attr_def_list", "attr_def", "number", "type", "ID_get",
+  "nullable", "not_null", "insert", "record_list", "record", "value_list",
+  "value", "delete", "update", "select", "select_param", "aggregate_list",
   "aggregate", "aggregate_attr", "select_attr", "attr_list", "rel_list",
   "join_list", "where", "condition_list", "condition", "comOp",
   "load_data", "order_by", "order_param_list", "order_param", "is_desc",
   "is_asc", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313,   314,
-     315,   316,   317
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF (-165)
+#define YYPACT_NINF (-166)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -755,212 +721,215 @@ static const yytype_int16 yytoknum[] =
 #define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-    -165,     3,  -165,   108,   113,    -7,   -19,    40,    63,    37,
-      53,    18,    74,    83,    88,    90,   100,    64,  -165,  -165,
-    -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,
-    -165,  -165,  -165,  -165,  -165,  -165,    62,   112,  -165,    65,
-      66,    67,    45,  -165,    94,   109,  -165,   124,   126,  -165,
-      73,    75,    86,  -165,  -165,  -165,  -165,  -165,    84,   117,
-    -165,    91,   132,   134,    57,    80,    81,  -165,    82,    85,
-    -165,  -165,  -165,   110,   111,    87,    89,    92,    93,  -165,
-    -165,  -165,  -165,   118,  -165,   128,    46,   123,   107,   135,
-     109,   136,    13,   151,   106,   127,  -165,   137,    72,   141,
-     101,  -165,   102,  -165,  -165,   119,   143,  -165,   -28,   144,
-    -165,  -165,  -165,  -165,     7,  -165,    56,   121,  -165,   -28,
-     159,    92,   148,  -165,  -165,  -165,  -165,     4,   114,  -165,
-     123,   115,   116,   111,   149,   136,   164,   120,   130,  -165,
-    -165,  -165,  -165,  -165,  -165,    23,    32,    13,  -165,   111,
-     122,   137,   167,   129,  -165,   131,  -165,  -165,   156,  -165,
-     138,   107,   142,   -28,   161,   144,  -165,    56,  -165,  -165,
-    -165,   152,  -165,   121,   174,   179,  -165,  -165,  -165,   168,
-    -165,   133,   169,    13,   143,   153,   182,   149,  -165,  -165,
-      44,   139,  -165,  -165,  -165,    -4,   156,   185,   121,  -165,
-     140,  -165,  -165,   163,  -165,  -165,  -165,  -165,  -165,   107,
-      11,   171,   145,  -165,  -165,   146,  -165,  -165,  -165,   140,
-    -165,  -165,     9,   171,  -165,  -165
+    -166,     3,  -166,    38,   100,    60,   -31,    21,    26,     5,
+       8,   -25,    52,    56,    58,    68,    76,    -6,  -166,  -166,
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,
+    -166,  -166,  -166,  -166,  -166,  -166,    22,    72,  -166,    32,
+      37,    53,    41,  -166,    75,    91,  -166,   120,   121,  -166,
+      73,    74,    86,  -166,  -166,  -166,  -166,  -166,    85,   117,
+    -166,    90,   133,   134,    64,    80,    81,  -166,    82,    83,
+    -166,  -166,  -166,   111,   110,    87,    84,    88,    89,  -166,
+    -166,  -166,  -166,   119,  -166,   131,    49,   132,   109,   135,
+      91,   136,    17,   151,   106,   126,  -166,   138,   103,   141,
+     101,  -166,   102,  -166,  -166,   122,   142,  -166,    48,   143,
+    -166,  -166,  -166,  -166,    13,  -166,    63,   123,  -166,    48,
+     157,    88,   147,  -166,  -166,  -166,  -166,    15,   112,  -166,
+     132,   113,   114,   110,   148,   136,   165,   115,   130,  -166,
+    -166,  -166,  -166,  -166,  -166,    29,    36,    17,  -166,   110,
+     116,   138,   172,   124,  -166,   137,  -166,  -166,  -166,   159,
+    -166,   139,   109,   146,    48,   158,   143,  -166,    63,  -166,
+    -166,  -166,   152,  -166,   123,   179,   180,  -166,  -166,  -166,
+     167,  -166,   112,   168,    17,   142,   153,   184,   148,  -166,
+    -166,    42,   140,  -166,  -166,  -166,   -17,   159,   185,   123,
+    -166,   144,  -166,  -166,   161,  -166,  -166,  -166,  -166,  -166,
+     109,    10,   173,   145,  -166,  -166,   149,  -166,  -166,  -166,
+     144,  -166,  -166,     1,   173,  -166,  -166
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
        2,     0,     1,     0,     0,     0,     0,     0,     0,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     3,    20,
       19,    14,    15,    16,    17,     9,    10,    11,    12,    13,
-       8,     5,     7,     6,     4,    18,     0,     0,    33,     0,
-       0,     0,    78,    75,     0,    67,    65,     0,     0,    23,
+       8,     5,     7,     6,     4,    18,     0,     0,    34,     0,
+       0,     0,    79,    76,     0,    68,    66,     0,     0,    23,
        0,     0,     0,    24,    25,    26,    22,    21,     0,     0,
-      34,     0,     0,     0,     0,     0,     0,    76,     0,     0,
-      66,    29,    28,     0,    85,     0,     0,     0,     0,    27,
-      35,    73,    74,    71,    70,     0,    78,    78,    83,     0,
-      67,     0,     0,     0,     0,     0,    46,    37,     0,     0,
-       0,    69,     0,    79,    77,     0,    81,    68,     0,    52,
-      57,    58,    59,    60,     0,    61,     0,    87,    62,     0,
-       0,     0,     0,    42,    43,    44,    45,    49,     0,    72,
-      78,     0,     0,    85,    55,     0,     0,     0,   102,    96,
-      97,    98,    99,   100,   101,     0,     0,     0,    86,    85,
-       0,    37,     0,     0,    47,     0,    40,    48,    31,    80,
-       0,    83,   105,     0,     0,    52,    51,     0,   103,    91,
-      89,    92,    90,    87,     0,     0,    38,    36,    41,     0,
-      50,     0,     0,     0,    81,     0,     0,    55,    54,    53,
-       0,     0,    88,    63,   104,    49,    31,     0,    87,    82,
-       0,    64,    56,     0,    93,    94,    39,    32,    30,    83,
-     113,   107,     0,    84,   111,     0,   114,   109,   112,     0,
-     106,    95,   113,   107,   110,   108
+      35,     0,     0,     0,     0,     0,     0,    77,     0,     0,
+      67,    29,    28,     0,    86,     0,     0,     0,     0,    27,
+      36,    74,    75,    72,    71,     0,    79,    79,    84,     0,
+      68,     0,     0,     0,     0,     0,    47,    38,     0,     0,
+       0,    70,     0,    80,    78,     0,    82,    69,     0,    53,
+      58,    59,    60,    61,     0,    62,     0,    88,    63,     0,
+       0,     0,     0,    43,    44,    45,    46,    50,     0,    73,
+      79,     0,     0,    86,    56,     0,     0,     0,   103,    97,
+      98,    99,   100,   101,   102,     0,     0,     0,    87,    86,
+       0,    38,     0,     0,    48,     0,    41,    49,    31,    32,
+      81,     0,    84,   106,     0,     0,    53,    52,     0,   104,
+      92,    90,    93,    91,    88,     0,     0,    39,    37,    42,
+       0,    51,     0,     0,     0,    82,     0,     0,    56,    55,
+      54,     0,     0,    89,    64,   105,    50,    32,     0,    88,
+      83,     0,    65,    57,     0,    94,    95,    40,    33,    30,
+      84,   114,   108,     0,    85,   112,     0,   115,   110,   113,
+       0,   107,    96,   114,   108,   111,   109
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,  -165,
-    -165,  -165,  -165,    -3,  -165,  -165,  -165,    43,    78,  -165,
-    -165,  -165,     0,  -165,  -165,    31,    70,    14,  -108,  -165,
-    -165,  -165,  -165,   125,   147,  -165,  -165,   -82,    16,  -159,
-    -123,  -164,  -141,  -115,  -165,  -165,   -21,   -13,   -15,  -165
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,
+    -166,  -166,  -166,     9,    -4,  -166,  -166,  -166,    43,    78,
+    -166,  -166,  -166,    -1,  -166,  -166,    30,    62,    12,  -108,
+    -166,  -166,  -166,  -166,   118,   150,  -166,  -166,   -82,    16,
+    -160,  -123,  -165,  -141,  -115,  -166,  -166,   -20,   -15,   -14,
+    -166
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,     1,    18,    19,    20,    21,    22,    23,    24,    25,
-      26,    27,    28,   182,    39,    29,    30,   122,    97,   179,
-     127,    98,   156,   157,    31,   136,   109,   164,   116,    32,
-      33,    34,    44,    70,    45,    85,    46,    67,   133,   106,
-      93,   148,   117,   145,    35,   186,   220,   211,   217,   218
+       0,     1,    18,    19,    20,    21,    22,    23,    24,    25,
+      26,    27,    28,   159,   183,    39,    29,    30,   122,    97,
+     180,   127,    98,   156,   157,    31,   136,   109,   165,   116,
+      32,    33,    34,    44,    70,    45,    85,    46,    67,   133,
+     106,    93,   148,   117,   145,    35,   187,   221,   212,   218,
+     219
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-     134,   146,   184,     2,   103,   104,   173,     3,     4,   192,
-     162,   149,   110,     5,     6,     7,     8,     9,    10,    11,
-     214,   153,   214,    12,    13,    14,   174,   111,   112,   113,
-      15,    16,   115,   154,   209,   155,   137,   170,   172,    47,
-     215,   154,   198,   155,   216,   138,   216,    48,   159,    17,
-     213,    42,   190,   110,    43,   187,   139,   140,   141,   142,
-     143,   144,    64,   110,    65,    65,    49,    50,   111,   112,
-     113,   114,   110,   115,    66,   102,    52,    53,   111,   112,
-     113,   169,   204,   115,   110,    51,    54,   111,   112,   113,
-     171,    55,   115,    56,   138,   123,   124,   125,   126,   111,
-     112,   113,   203,    57,   115,   139,   140,   141,   142,   143,
-     144,    58,    81,    82,    36,    83,    37,    38,    84,    40,
-      59,    60,    41,    61,    62,    63,    68,    71,    69,    72,
-      75,    73,    76,    74,    77,    79,    78,    80,    86,    87,
-      88,    91,    65,    89,    92,    94,   101,   100,   105,    95,
-      96,    99,    64,   108,   118,   119,   121,   120,   128,   129,
-     130,   131,   132,   135,   147,   150,   152,   166,   163,   168,
-     177,   180,   158,   160,   161,   181,   185,   193,   167,   188,
-     175,   191,   194,   183,   178,   201,   195,   197,   208,   200,
-     219,   196,   212,   207,   176,   206,   189,   205,   210,   151,
-     199,   202,   225,   221,   222,   165,   223,   224,     0,     0,
-       0,     0,     0,     0,     0,   107,    90
+     134,   146,   185,     2,   103,   104,   174,     3,     4,   193,
+     163,   149,   215,     5,     6,     7,     8,     9,    10,    11,
+     154,   215,   155,    12,    13,    14,   175,    47,    48,    49,
+      15,    16,   153,    52,   210,    50,   217,   171,   173,   216,
+      51,    58,   137,   199,    36,   217,    37,    38,   160,    17,
+     214,   138,   154,   191,   155,    53,   188,   110,    64,    54,
+      65,    55,   139,   140,   141,   142,   143,   144,    65,   110,
+      66,    56,   111,   112,   113,   114,   110,   115,   102,    57,
+      59,    60,   110,   205,   111,   112,   113,   170,   110,   115,
+      61,   111,   112,   113,   172,    62,   115,   111,   112,   113,
+     204,   138,   115,   111,   112,   113,    40,    68,   115,    41,
+      69,    63,   139,   140,   141,   142,   143,   144,    42,    81,
+      82,    43,    83,    71,    72,    84,   123,   124,   125,   126,
+      75,    73,    74,    76,    77,    78,    79,    80,    86,    87,
+      88,    89,    91,    92,    95,    94,    96,    99,   100,   101,
+     105,    65,    64,   108,   118,   119,   120,   121,   128,   129,
+     130,   132,   135,   150,   131,   152,   147,   164,   167,   169,
+     158,   161,   162,   168,   176,   178,   189,   181,   182,   179,
+     186,   192,   194,   195,   184,   196,   198,   202,   209,   201,
+     213,   197,   220,   208,   177,   207,   190,   166,   206,   151,
+     203,   200,   211,   222,   226,   224,     0,   223,   107,   225,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    90
 };
 
 static const yytype_int16 yycheck[] =
 {
-     108,   116,   161,     0,    86,    87,   147,     4,     5,   173,
-     133,   119,    40,    10,    11,    12,    13,    14,    15,    16,
-      11,    17,    11,    20,    21,    22,   149,    55,    56,    57,
-      27,    28,    60,    37,   198,    39,    29,   145,   146,    58,
-      29,    37,   183,    39,    35,    38,    35,     7,   130,    46,
-     209,    58,   167,    40,    61,   163,    49,    50,    51,    52,
-      53,    54,    17,    40,    19,    19,     3,    30,    55,    56,
-      57,    58,    40,    60,    29,    29,    58,     3,    55,    56,
-      57,    58,   190,    60,    40,    32,     3,    55,    56,    57,
-      58,     3,    60,     3,    38,    23,    24,    25,    26,    55,
-      56,    57,    58,     3,    60,    49,    50,    51,    52,    53,
-      54,    47,    55,    56,     6,    58,     8,     9,    61,     6,
-      58,     9,     9,    58,    58,    58,    32,     3,    19,     3,
-      44,    58,    48,    58,    17,     3,    45,     3,    58,    58,
-      58,    31,    19,    58,    33,    58,    18,    29,    41,    60,
-      58,    58,    17,    17,     3,    49,    19,    30,    17,    58,
-      58,    42,    19,    19,    43,     6,    18,     3,    19,    39,
-       3,    40,    58,    58,    58,    19,    34,     3,    58,    18,
-      58,    29,     3,    45,    55,     3,    18,    18,     3,    36,
-      19,    58,    29,   196,   151,   195,   165,    58,    58,   121,
-     184,   187,   223,    58,    58,   135,   219,   222,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    90,    69
+     108,   116,   162,     0,    86,    87,   147,     4,     5,   174,
+     133,   119,    11,    10,    11,    12,    13,    14,    15,    16,
+      37,    11,    39,    20,    21,    22,   149,    58,     7,     3,
+      27,    28,    17,    58,   199,    30,    35,   145,   146,    29,
+      32,    47,    29,   184,     6,    35,     8,     9,   130,    46,
+     210,    38,    37,   168,    39,     3,   164,    40,    17,     3,
+      19,     3,    49,    50,    51,    52,    53,    54,    19,    40,
+      29,     3,    55,    56,    57,    58,    40,    60,    29,     3,
+      58,     9,    40,   191,    55,    56,    57,    58,    40,    60,
+      58,    55,    56,    57,    58,    58,    60,    55,    56,    57,
+      58,    38,    60,    55,    56,    57,     6,    32,    60,     9,
+      19,    58,    49,    50,    51,    52,    53,    54,    58,    55,
+      56,    61,    58,     3,     3,    61,    23,    24,    25,    26,
+      44,    58,    58,    48,    17,    45,     3,     3,    58,    58,
+      58,    58,    31,    33,    60,    58,    58,    58,    29,    18,
+      41,    19,    17,    17,     3,    49,    30,    19,    17,    58,
+      58,    19,    19,     6,    42,    18,    43,    19,     3,    39,
+      58,    58,    58,    58,    58,     3,    18,    40,    19,    55,
+      34,    29,     3,     3,    45,    18,    18,     3,     3,    36,
+      29,   182,    19,   197,   151,   196,   166,   135,    58,   121,
+     188,   185,    58,    58,   224,   220,    -1,    58,    90,   223,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    69
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
        0,    64,     0,     4,     5,    10,    11,    12,    13,    14,
       15,    16,    20,    21,    22,    27,    28,    46,    65,    66,
-      67,    68,    69,    70,    71,    72,    73,    74,    75,    78,
-      79,    87,    92,    93,    94,   107,     6,     8,     9,    77,
-       6,     9,    58,    61,    95,    97,    99,    58,     7,     3,
+      67,    68,    69,    70,    71,    72,    73,    74,    75,    79,
+      80,    88,    93,    94,    95,   108,     6,     8,     9,    78,
+       6,     9,    58,    61,    96,    98,   100,    58,     7,     3,
       30,    32,    58,     3,     3,     3,     3,     3,    47,    58,
-       9,    58,    58,    58,    17,    19,    29,   100,    32,    19,
-      96,     3,     3,    58,    58,    44,    48,    17,    45,     3,
-       3,    55,    56,    58,    61,    98,    58,    58,    58,    58,
-      97,    31,    33,   103,    58,    60,    58,    81,    84,    58,
-      29,    18,    29,   100,   100,    41,   102,    96,    17,    89,
-      40,    55,    56,    57,    58,    60,    91,   105,     3,    49,
-      30,    19,    80,    23,    24,    25,    26,    83,    17,    58,
-      58,    42,    19,   101,    91,    19,    88,    29,    38,    49,
-      50,    51,    52,    53,    54,   106,   106,    43,   104,    91,
-       6,    81,    18,    17,    37,    39,    85,    86,    58,   100,
-      58,    58,   103,    19,    90,    89,     3,    58,    39,    58,
-      91,    58,    91,   105,   103,    58,    80,     3,    55,    82,
-      40,    19,    76,    45,   102,    34,   108,    91,    18,    88,
-     106,    29,   104,     3,     3,    18,    58,    18,   105,   101,
-      36,     3,    90,    58,    91,    58,    85,    76,     3,   104,
-      58,   110,    29,   102,    11,    29,    35,   111,   112,    19,
-     109,    58,    58,   110,   111,   109
+       9,    58,    58,    58,    17,    19,    29,   101,    32,    19,
+      97,     3,     3,    58,    58,    44,    48,    17,    45,     3,
+       3,    55,    56,    58,    61,    99,    58,    58,    58,    58,
+      98,    31,    33,   104,    58,    60,    58,    82,    85,    58,
+      29,    18,    29,   101,   101,    41,   103,    97,    17,    90,
+      40,    55,    56,    57,    58,    60,    92,   106,     3,    49,
+      30,    19,    81,    23,    24,    25,    26,    84,    17,    58,
+      58,    42,    19,   102,    92,    19,    89,    29,    38,    49,
+      50,    51,    52,    53,    54,   107,   107,    43,   105,    92,
+       6,    82,    18,    17,    37,    39,    86,    87,    58,    76,
+     101,    58,    58,   104,    19,    91,    90,     3,    58,    39,
+      58,    92,    58,    92,   106,   104,    58,    81,     3,    55,
+      83,    40,    19,    77,    45,   103,    34,   109,    92,    18,
+      89,   107,    29,   105,     3,     3,    18,    76,    18,   106,
+     102,    36,     3,    91,    58,    92,    58,    86,    77,     3,
+     105,    58,   111,    29,   103,    11,    29,    35,   112,   113,
+      19,   110,    58,    58,   111,   112,   110
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    63,    64,    64,    65,    65,    65,    65,    65,    65,
       65,    65,    65,    65,    65,    65,    65,    65,    65,    65,
       65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
-      75,    76,    76,    77,    77,    78,    79,    80,    80,    81,
-      81,    82,    83,    83,    83,    83,    84,    85,    85,    86,
-      86,    87,    88,    88,    89,    90,    90,    91,    91,    91,
-      91,    91,    92,    93,    94,    95,    95,    96,    96,    97,
-      98,    98,    98,    98,    98,    99,    99,    99,   100,   100,
-     100,   101,   101,   102,   102,   103,   103,   104,   104,   105,
-     105,   105,   105,   105,   105,   105,   106,   106,   106,   106,
-     106,   106,   106,   106,   107,   108,   108,   109,   109,   110,
-     110,   111,   111,   112,   112
+      75,    76,    77,    77,    78,    78,    79,    80,    81,    81,
+      82,    82,    83,    84,    84,    84,    84,    85,    86,    86,
+      87,    87,    88,    89,    89,    90,    91,    91,    92,    92,
+      92,    92,    92,    93,    94,    95,    96,    96,    97,    97,
+      98,    99,    99,    99,    99,    99,   100,   100,   100,   101,
+     101,   101,   102,   102,   103,   103,   104,   104,   105,   105,
+     106,   106,   106,   106,   106,   106,   106,   107,   107,   107,
+     107,   107,   107,   107,   107,   108,   109,   109,   110,   110,
+     111,   111,   112,   112,   113,   113
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     0,     2,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
        1,     2,     2,     2,     2,     2,     2,     4,     3,     3,
-      10,     0,     3,     1,     2,     4,     8,     0,     3,     6,
-       3,     1,     1,     1,     1,     1,     1,     1,     1,     0,
-       2,     7,     0,     3,     4,     0,     3,     1,     1,     1,
-       1,     1,     5,     8,     9,     1,     2,     0,     3,     4,
-       1,     1,     3,     1,     1,     1,     2,     4,     0,     3,
-       5,     0,     4,     0,     7,     0,     3,     0,     3,     3,
-       3,     3,     3,     5,     5,     7,     1,     1,     1,     1,
-       1,     1,     1,     2,     8,     0,     4,     0,     3,     2,
-       4,     1,     1,     0,     1
+      10,     1,     0,     3,     1,     2,     4,     8,     0,     3,
+       6,     3,     1,     1,     1,     1,     1,     1,     1,     1,
+       0,     2,     7,     0,     3,     4,     0,     3,     1,     1,
+       1,     1,     1,     5,     8,     9,     1,     2,     0,     3,
+       4,     1,     1,     3,     1,     1,     1,     2,     4,     0,
+       3,     5,     0,     4,     0,     7,     0,     3,     0,     3,
+       3,     3,     3,     3,     5,     5,     7,     1,     1,     1,
+       1,     1,     1,     1,     2,     8,     0,     4,     0,     3,
+       2,     4,     1,     1,     0,     1
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -982,10 +951,9 @@ static const yytype_int8 yyr2[] =
       }                                                           \
   while (0)
 
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -1002,19 +970,16 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, scanner); \
+                  Kind, Value, scanner); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -1025,19 +990,16 @@ do {                                                                      \
 `-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, void *scanner)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (scanner);
+  YY_USE (yyoutput);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yytype], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1047,12 +1009,13 @@ yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, vo
 `---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, void *scanner)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner)
 {
   YYFPRINTF (yyo, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yytype, yyvaluep, scanner);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1085,7 +1048,8 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, int yyrule, void *scanner)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, void *scanner)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -1097,9 +1061,8 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, int yyrule, void *scanner)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[+yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                                              , scanner);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1114,8 +1077,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1138,259 +1101,34 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
-#  else
-/* Return the length of YYSTR.  */
-static YYPTRDIFF_T
-yystrlen (const char *yystr)
-{
-  YYPTRDIFF_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYPTRDIFF_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYPTRDIFF_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            else
-              goto append;
-
-          append:
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
-
-  if (yyres)
-    return yystpcpy (yyres, yystr) - yyres;
-  else
-    return yystrlen (yystr);
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
-                yy_state_t *yyssp, int yytoken)
-{
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat: reported tokens (one for the "unexpected",
-     one per "expected"). */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Actual size of YYARG. */
-  int yycount = 0;
-  /* Cumulated lengths of YYARG.  */
-  YYPTRDIFF_T yysize = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[+*yyssp];
-      YYPTRDIFF_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-      yysize = yysize0;
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYPTRDIFF_T yysize1
-                    = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-                    yysize = yysize1;
-                  else
-                    return 2;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-    default: /* Avoid compiler warnings. */
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    /* Don't count the "%s"s in the final size, but reserve room for
-       the terminator.  */
-    YYPTRDIFF_T yysize1 = yysize + (yystrlen (yyformat) - 2 * yycount) + 1;
-    if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-      yysize = yysize1;
-    else
-      return 2;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          ++yyp;
-          ++yyformat;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, void *scanner)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, void *scanner)
 {
-  YYUSE (yyvaluep);
-  YYUSE (scanner);
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1398,7 +1136,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, void *scanner)
 int
 yyparse (void *scanner)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1409,45 +1147,38 @@ YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
 YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    yy_state_fast_t yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+    int yyerrstatus = 0;
 
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
     yy_state_t yyssa[YYINITDEPTH];
-    yy_state_t *yyss;
-    yy_state_t *yyssp;
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
-
-    YYPTRDIFF_T yystacksize;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1455,16 +1186,10 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
 
@@ -1486,10 +1211,11 @@ yysetstate:
   YY_IGNORE_USELESS_CAST_BEGIN
   *yyssp = YY_CAST (yy_state_t, yystate);
   YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1517,7 +1243,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1528,10 +1254,10 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
-# undef YYSTACK_RELOCATE
+#  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
       }
@@ -1550,6 +1276,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1570,18 +1297,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, scanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1650,124 +1388,135 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 21:
+  case 21: /* exit: EXIT SEMICOLON  */
 #line 172 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_EXIT;//"exit";
     }
-#line 1659 "yacc_sql.tab.c"
+#line 1397 "yacc_sql.tab.c"
     break;
 
-  case 22:
+  case 22: /* help: HELP SEMICOLON  */
 #line 177 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_HELP;//"help";
     }
-#line 1667 "yacc_sql.tab.c"
+#line 1405 "yacc_sql.tab.c"
     break;
 
-  case 23:
+  case 23: /* sync: SYNC SEMICOLON  */
 #line 182 "yacc_sql.y"
                    {
       CONTEXT->ssql->flag = SCF_SYNC;
     }
-#line 1675 "yacc_sql.tab.c"
+#line 1413 "yacc_sql.tab.c"
     break;
 
-  case 24:
+  case 24: /* begin: TRX_BEGIN SEMICOLON  */
 #line 188 "yacc_sql.y"
                         {
       CONTEXT->ssql->flag = SCF_BEGIN;
     }
-#line 1683 "yacc_sql.tab.c"
+#line 1421 "yacc_sql.tab.c"
     break;
 
-  case 25:
+  case 25: /* commit: TRX_COMMIT SEMICOLON  */
 #line 194 "yacc_sql.y"
                          {
       CONTEXT->ssql->flag = SCF_COMMIT;
     }
-#line 1691 "yacc_sql.tab.c"
+#line 1429 "yacc_sql.tab.c"
     break;
 
-  case 26:
+  case 26: /* rollback: TRX_ROLLBACK SEMICOLON  */
 #line 200 "yacc_sql.y"
                            {
       CONTEXT->ssql->flag = SCF_ROLLBACK;
     }
-#line 1699 "yacc_sql.tab.c"
+#line 1437 "yacc_sql.tab.c"
     break;
 
-  case 27:
+  case 27: /* drop_table: DROP TABLE ID SEMICOLON  */
 #line 206 "yacc_sql.y"
                             {
         CONTEXT->ssql->flag = SCF_DROP_TABLE;//"drop_table";
         drop_table_init(&CONTEXT->ssql->sstr.drop_table, (yyvsp[-1].string));
     }
-#line 1708 "yacc_sql.tab.c"
+#line 1446 "yacc_sql.tab.c"
     break;
 
-  case 28:
+  case 28: /* show_tables: SHOW TABLES SEMICOLON  */
 #line 212 "yacc_sql.y"
                           {
       CONTEXT->ssql->flag = SCF_SHOW_TABLES;
     }
-#line 1716 "yacc_sql.tab.c"
+#line 1454 "yacc_sql.tab.c"
     break;
 
-  case 29:
+  case 29: /* desc_table: DESC ID SEMICOLON  */
 #line 218 "yacc_sql.y"
                       {
       CONTEXT->ssql->flag = SCF_DESC_TABLE;
       desc_table_init(&CONTEXT->ssql->sstr.desc_table, (yyvsp[-1].string));
     }
-#line 1725 "yacc_sql.tab.c"
+#line 1463 "yacc_sql.tab.c"
     break;
 
-  case 30:
+  case 30: /* create_index: CREATE index ID ON ID LBRACE index_attr index_list RBRACE SEMICOLON  */
 #line 226 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";
-			create_index_init(&CONTEXT->ssql->sstr.create_index, (yyvsp[-7].string), (yyvsp[-5].string), (yyvsp[-3].string));
+			create_index_init(&CONTEXT->ssql->sstr.create_index, (yyvsp[-7].string), (yyvsp[-5].string));
 		}
-#line 1734 "yacc_sql.tab.c"
+#line 1472 "yacc_sql.tab.c"
     break;
 
-  case 32:
+  case 31: /* index_attr: ID  */
 #line 233 "yacc_sql.y"
-                              {
-			// todo
+           {
+			// 每个属性名读完就追加，保持多列索引中列的顺序
+			if (create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, (yyvsp[0].string)) != 0) {
+				CONTEXT->ssql->flag = SCF_CREATE_INDEX;  // 让yyerror释放已经追加的属性名
+				yyerror(scanner, "too many or duplicate index columns");
+				YYABORT;
+			}
 		}
-#line 1742 "yacc_sql.tab.c"
+#line 1485 "yacc_sql.tab.c"
     break;
 
-  case 33:
-#line 239 "yacc_sql.y"
+  case 33: /* index_list: COMMA index_attr index_list  */
+#line 244 "yacc_sql.y"
+                                      { }
+#line 1491 "yacc_sql.tab.c"
+    break;
+
+  case 34: /* index: INDEX  */
+#line 248 "yacc_sql.y"
               {
 			set_index_unique(&CONTEXT->ssql->sstr.create_index, 0);
 		}
-#line 1750 "yacc_sql.tab.c"
+#line 1499 "yacc_sql.tab.c"
     break;
 
-  case 34:
-#line 242 "yacc_sql.y"
+  case 35: /* index: UNIQUE INDEX  */
+#line 251 "yacc_sql.y"
                        {
 			set_index_unique(&CONTEXT->ssql->sstr.create_index, 1);
 		}
-#line 1758 "yacc_sql.tab.c"
+#line 1507 "yacc_sql.tab.c"
     break;
 
-  case 35:
-#line 250 "yacc_sql.y"
+  case 36: /* drop_index: DROP INDEX ID SEMICOLON  */
+#line 259 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_DROP_INDEX;//"drop_index";
 			drop_index_init(&CONTEXT->ssql->sstr.drop_index, (yyvsp[-1].string));
 		}
-#line 1767 "yacc_sql.tab.c"
+#line 1516 "yacc_sql.tab.c"
     break;
 
-  case 36:
-#line 257 "yacc_sql.y"
+  case 37: /* create_table: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE SEMICOLON  */
+#line 266 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_CREATE_TABLE;//"create_table";
 			// CONTEXT->ssql->sstr.create_table.attribute_count = CONTEXT->value_length;
@@ -1775,167 +1524,167 @@ yyreduce:
 			//临时变量清零	
 			CONTEXT->value_length = 0;
 		}
-#line 1779 "yacc_sql.tab.c"
+#line 1528 "yacc_sql.tab.c"
     break;
 
-  case 38:
-#line 267 "yacc_sql.y"
+  case 39: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 276 "yacc_sql.y"
                                    {    }
-#line 1785 "yacc_sql.tab.c"
+#line 1534 "yacc_sql.tab.c"
     break;
 
-  case 39:
-#line 272 "yacc_sql.y"
+  case 40: /* attr_def: ID_get type LBRACE number RBRACE nullable  */
+#line 281 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-4].number), (yyvsp[-2].number), (yyvsp[0].number));
 			create_table_append_attribute(&CONTEXT->ssql->sstr.create_table, &attribute);
 			CONTEXT->value_length++;
 		}
-#line 1796 "yacc_sql.tab.c"
+#line 1545 "yacc_sql.tab.c"
     break;
 
-  case 40:
-#line 279 "yacc_sql.y"
+  case 41: /* attr_def: ID_get type nullable  */
+#line 288 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-1].number), 4, (yyvsp[0].number));
 			create_table_append_attribute(&CONTEXT->ssql->sstr.create_table, &attribute);
 			CONTEXT->value_length++;
 		}
-#line 1807 "yacc_sql.tab.c"
+#line 1556 "yacc_sql.tab.c"
     break;
 
-  case 41:
-#line 287 "yacc_sql.y"
+  case 42: /* number: NUMBER  */
+#line 296 "yacc_sql.y"
                        {(yyval.number) = (yyvsp[0].number);}
-#line 1813 "yacc_sql.tab.c"
+#line 1562 "yacc_sql.tab.c"
     break;
 
-  case 42:
-#line 290 "yacc_sql.y"
+  case 43: /* type: INT_T  */
+#line 299 "yacc_sql.y"
               { (yyval.number)=INTS; }
-#line 1819 "yacc_sql.tab.c"
+#line 1568 "yacc_sql.tab.c"
     break;
 
-  case 43:
-#line 291 "yacc_sql.y"
+  case 44: /* type: STRING_T  */
+#line 300 "yacc_sql.y"
                   { (yyval.number)=CHARS; }
-#line 1825 "yacc_sql.tab.c"
+#line 1574 "yacc_sql.tab.c"
     break;
 
-  case 44:
-#line 292 "yacc_sql.y"
+  case 45: /* type: FLOAT_T  */
+#line 301 "yacc_sql.y"
                  { (yyval.number)=FLOATS; }
-#line 1831 "yacc_sql.tab.c"
+#line 1580 "yacc_sql.tab.c"
     break;
 
-  case 45:
-#line 293 "yacc_sql.y"
+  case 46: /* type: DATE_T  */
+#line 302 "yacc_sql.y"
                     { (yyval.number)=DATES; }
-#line 1837 "yacc_sql.tab.c"
+#line 1586 "yacc_sql.tab.c"
     break;
 
-  case 46:
-#line 297 "yacc_sql.y"
+  case 47: /* ID_get: ID  */
+#line 306 "yacc_sql.y"
         {
 		char *temp=(yyvsp[0].string); 
 		snprintf(CONTEXT->id, sizeof(CONTEXT->id), "%s", temp);
 	}
-#line 1846 "yacc_sql.tab.c"
+#line 1595 "yacc_sql.tab.c"
     break;
 
-  case 47:
-#line 303 "yacc_sql.y"
+  case 48: /* nullable: NULLABLE  */
+#line 312 "yacc_sql.y"
                  {
 			(yyval.number)=1;
 		}
-#line 1854 "yacc_sql.tab.c"
+#line 1603 "yacc_sql.tab.c"
     break;
 
-  case 48:
-#line 306 "yacc_sql.y"
+  case 49: /* nullable: not_null  */
+#line 315 "yacc_sql.y"
                    {
 			(yyval.number)=0;
 		}
-#line 1862 "yacc_sql.tab.c"
+#line 1611 "yacc_sql.tab.c"
     break;
 
-  case 51:
-#line 316 "yacc_sql.y"
+  case 52: /* insert: INSERT INTO ID VALUES record record_list SEMICOLON  */
+#line 325 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_INSERT;
 			inserts_init(&CONTEXT->ssql->sstr.insertion, (yyvsp[-4].string), CONTEXT->values, CONTEXT->value_length);
 			//临时变量清零
       		CONTEXT->value_length=0;
 		}
-#line 1873 "yacc_sql.tab.c"
+#line 1622 "yacc_sql.tab.c"
     break;
 
-  case 53:
-#line 326 "yacc_sql.y"
+  case 54: /* record_list: COMMA record record_list  */
+#line 335 "yacc_sql.y"
                                    { }
-#line 1879 "yacc_sql.tab.c"
+#line 1628 "yacc_sql.tab.c"
     break;
 
-  case 54:
-#line 330 "yacc_sql.y"
+  case 55: /* record: LBRACE value value_list RBRACE  */
+#line 339 "yacc_sql.y"
                                        { }
-#line 1885 "yacc_sql.tab.c"
+#line 1634 "yacc_sql.tab.c"
     break;
 
-  case 56:
-#line 335 "yacc_sql.y"
+  case 57: /* value_list: COMMA value value_list  */
+#line 344 "yacc_sql.y"
                               { 
   		// CONTEXT->values[CONTEXT->value_length++] = *$2;
 	  }
-#line 1893 "yacc_sql.tab.c"
+#line 1642 "yacc_sql.tab.c"
     break;
 
-  case 57:
-#line 340 "yacc_sql.y"
+  case 58: /* value: NULL_  */
+#line 349 "yacc_sql.y"
               {
 			value_init_null(&CONTEXT->values[CONTEXT->value_length++]);
 		}
-#line 1901 "yacc_sql.tab.c"
+#line 1650 "yacc_sql.tab.c"
     break;
 
-  case 58:
-#line 343 "yacc_sql.y"
+  case 59: /* value: NUMBER  */
+#line 352 "yacc_sql.y"
              {	
   			value_init_integer(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].number));
 		}
-#line 1909 "yacc_sql.tab.c"
+#line 1658 "yacc_sql.tab.c"
     break;
 
-  case 59:
-#line 346 "yacc_sql.y"
+  case 60: /* value: FLOAT  */
+#line 355 "yacc_sql.y"
             {
   			value_init_float(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].floats));
 		}
-#line 1917 "yacc_sql.tab.c"
+#line 1666 "yacc_sql.tab.c"
     break;
 
-  case 60:
-#line 349 "yacc_sql.y"
+  case 61: /* value: DATE  */
+#line 358 "yacc_sql.y"
                {
 			(yyvsp[0].string) = substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
   			value_init_date(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].string));
 		}
-#line 1926 "yacc_sql.tab.c"
+#line 1675 "yacc_sql.tab.c"
     break;
 
-  case 61:
-#line 353 "yacc_sql.y"
+  case 62: /* value: SSS  */
+#line 362 "yacc_sql.y"
           {
 			(yyvsp[0].string) = substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
   			value_init_string(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].string));
 		}
-#line 1935 "yacc_sql.tab.c"
+#line 1684 "yacc_sql.tab.c"
     break;
 
-  case 62:
-#line 361 "yacc_sql.y"
+  case 63: /* delete: DELETE FROM ID where SEMICOLON  */
+#line 370 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_DELETE;//"delete";
 			deletes_init_relation(&CONTEXT->ssql->sstr.deletion, (yyvsp[-2].string));
@@ -1943,11 +1692,11 @@ yyreduce:
 					CONTEXT->conditions, CONTEXT->condition_length);
 			CONTEXT->condition_length = 0;	
     }
-#line 1947 "yacc_sql.tab.c"
+#line 1696 "yacc_sql.tab.c"
     break;
 
-  case 63:
-#line 371 "yacc_sql.y"
+  case 64: /* update: UPDATE ID SET ID EQ value where SEMICOLON  */
+#line 380 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_UPDATE;//"update";
 			Value *value = &CONTEXT->values[0];
@@ -1955,11 +1704,11 @@ yyreduce:
 					CONTEXT->conditions, CONTEXT->condition_length);
 			CONTEXT->condition_length = 0;
 		}
-#line 1959 "yacc_sql.tab.c"
+#line 1708 "yacc_sql.tab.c"
     break;
 
-  case 64:
-#line 381 "yacc_sql.y"
+  case 65: /* select: SELECT select_param FROM ID join_list rel_list where order_by SEMICOLON  */
+#line 390 "yacc_sql.y"
                 {
 			// CONTEXT->ssql->sstr.selection.relations[CONTEXT->from_length++]=$4;
 			selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-5].string));
@@ -1975,67 +1724,67 @@ yyreduce:
 			CONTEXT->select_length=0;
 			CONTEXT->value_length = 0;
 	}
-#line 1979 "yacc_sql.tab.c"
+#line 1728 "yacc_sql.tab.c"
     break;
 
-  case 65:
-#line 399 "yacc_sql.y"
+  case 66: /* select_param: select_attr  */
+#line 408 "yacc_sql.y"
                     { }
-#line 1985 "yacc_sql.tab.c"
+#line 1734 "yacc_sql.tab.c"
     break;
 
-  case 66:
-#line 400 "yacc_sql.y"
+  case 67: /* select_param: aggregate aggregate_list  */
+#line 409 "yacc_sql.y"
                                     { }
-#line 1991 "yacc_sql.tab.c"
+#line 1740 "yacc_sql.tab.c"
     break;
 
-  case 68:
-#line 403 "yacc_sql.y"
+  case 69: /* aggregate_list: COMMA aggregate aggregate_list  */
+#line 412 "yacc_sql.y"
                                          { }
-#line 1997 "yacc_sql.tab.c"
+#line 1746 "yacc_sql.tab.c"
     break;
 
-  case 69:
-#line 407 "yacc_sql.y"
+  case 70: /* aggregate: ID LBRACE aggregate_attr RBRACE  */
+#line 416 "yacc_sql.y"
                 {
 			selects_append_aggregate(&CONTEXT->ssql->sstr.selection, (yyvsp[-3].string));
 		}
-#line 2005 "yacc_sql.tab.c"
+#line 1754 "yacc_sql.tab.c"
     break;
 
-  case 70:
-#line 412 "yacc_sql.y"
+  case 71: /* aggregate_attr: STAR  */
+#line 421 "yacc_sql.y"
          {  
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, "*");
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2015 "yacc_sql.tab.c"
+#line 1764 "yacc_sql.tab.c"
     break;
 
-  case 71:
-#line 417 "yacc_sql.y"
+  case 72: /* aggregate_attr: ID  */
+#line 426 "yacc_sql.y"
          {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, (yyvsp[0].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2025 "yacc_sql.tab.c"
+#line 1774 "yacc_sql.tab.c"
     break;
 
-  case 72:
-#line 422 "yacc_sql.y"
+  case 73: /* aggregate_attr: ID DOT ID  */
+#line 431 "yacc_sql.y"
                     {
 			RelAttr attr;
 			relation_attr_init(&attr, (yyvsp[-2].string), (yyvsp[0].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2035 "yacc_sql.tab.c"
+#line 1784 "yacc_sql.tab.c"
     break;
 
-  case 73:
-#line 427 "yacc_sql.y"
+  case 74: /* aggregate_attr: NUMBER  */
+#line 436 "yacc_sql.y"
                  {
 			char number_str[16];
 			sprintf(number_str, "%d", (yyvsp[0].number));
@@ -2043,11 +1792,11 @@ yyreduce:
 			relation_attr_init(&attr, NULL, number_str);
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2047 "yacc_sql.tab.c"
+#line 1796 "yacc_sql.tab.c"
     break;
 
-  case 74:
-#line 434 "yacc_sql.y"
+  case 75: /* aggregate_attr: FLOAT  */
+#line 443 "yacc_sql.y"
             {
 			char float_str[16];
 			sprintf(float_str, "%f", (yyvsp[0].floats));
@@ -2055,77 +1804,77 @@ yyreduce:
 			relation_attr_init(&attr, NULL, float_str);
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2059 "yacc_sql.tab.c"
+#line 1808 "yacc_sql.tab.c"
     break;
 
-  case 75:
-#line 444 "yacc_sql.y"
+  case 76: /* select_attr: STAR  */
+#line 453 "yacc_sql.y"
          {  
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, "*");
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2069 "yacc_sql.tab.c"
+#line 1818 "yacc_sql.tab.c"
     break;
 
-  case 76:
-#line 449 "yacc_sql.y"
+  case 77: /* select_attr: ID attr_list  */
+#line 458 "yacc_sql.y"
                    {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2079 "yacc_sql.tab.c"
+#line 1828 "yacc_sql.tab.c"
     break;
 
-  case 77:
-#line 454 "yacc_sql.y"
+  case 78: /* select_attr: ID DOT ID attr_list  */
+#line 463 "yacc_sql.y"
                               {
 			RelAttr attr;
 			relation_attr_init(&attr, (yyvsp[-3].string), (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 2089 "yacc_sql.tab.c"
+#line 1838 "yacc_sql.tab.c"
     break;
 
-  case 79:
-#line 463 "yacc_sql.y"
+  case 80: /* attr_list: COMMA ID attr_list  */
+#line 472 "yacc_sql.y"
                          {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
       }
-#line 2099 "yacc_sql.tab.c"
+#line 1848 "yacc_sql.tab.c"
     break;
 
-  case 80:
-#line 468 "yacc_sql.y"
+  case 81: /* attr_list: COMMA ID DOT ID attr_list  */
+#line 477 "yacc_sql.y"
                                 {
 			RelAttr attr;
 			relation_attr_init(&attr, (yyvsp[-3].string), (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
   	  }
-#line 2109 "yacc_sql.tab.c"
+#line 1858 "yacc_sql.tab.c"
     break;
 
-  case 82:
-#line 478 "yacc_sql.y"
+  case 83: /* rel_list: COMMA ID join_list rel_list  */
+#line 487 "yacc_sql.y"
                                   {	
 			selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-2].string));
 		}
-#line 2117 "yacc_sql.tab.c"
+#line 1866 "yacc_sql.tab.c"
     break;
 
-  case 84:
-#line 484 "yacc_sql.y"
+  case 85: /* join_list: INNER JOIN ID ON condition condition_list join_list  */
+#line 493 "yacc_sql.y"
                                                               {
 			selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-4].string));
 		}
-#line 2125 "yacc_sql.tab.c"
+#line 1874 "yacc_sql.tab.c"
     break;
 
-  case 89:
-#line 499 "yacc_sql.y"
+  case 90: /* condition: ID comOp value  */
+#line 508 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, NULL, (yyvsp[-2].string));
@@ -2136,11 +1885,11 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 1, &left_attr, NULL, 0, NULL, right_value);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
 		}
-#line 2140 "yacc_sql.tab.c"
+#line 1889 "yacc_sql.tab.c"
     break;
 
-  case 90:
-#line 510 "yacc_sql.y"
+  case 91: /* condition: value comOp value  */
+#line 519 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 2];
 			Value *right_value = &CONTEXT->values[CONTEXT->value_length - 1];
@@ -2149,11 +1898,11 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 0, NULL, left_value, 0, NULL, right_value);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
 		}
-#line 2153 "yacc_sql.tab.c"
+#line 1902 "yacc_sql.tab.c"
     break;
 
-  case 91:
-#line 519 "yacc_sql.y"
+  case 92: /* condition: ID comOp ID  */
+#line 528 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, NULL, (yyvsp[-2].string));
@@ -2164,11 +1913,11 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 1, &left_attr, NULL, 1, &right_attr, NULL);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
 		}
-#line 2168 "yacc_sql.tab.c"
+#line 1917 "yacc_sql.tab.c"
     break;
 
-  case 92:
-#line 530 "yacc_sql.y"
+  case 93: /* condition: value comOp ID  */
+#line 539 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 1];
 			RelAttr right_attr;
@@ -2178,11 +1927,11 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 0, NULL, left_value, 1, &right_attr, NULL);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
 		}
-#line 2182 "yacc_sql.tab.c"
+#line 1931 "yacc_sql.tab.c"
     break;
 
-  case 93:
-#line 540 "yacc_sql.y"
+  case 94: /* condition: ID DOT ID comOp value  */
+#line 549 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, (yyvsp[-4].string), (yyvsp[-2].string));
@@ -2192,11 +1941,11 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 1, &left_attr, NULL, 0, NULL, right_value);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;	
     	}
-#line 2196 "yacc_sql.tab.c"
+#line 1945 "yacc_sql.tab.c"
     break;
 
-  case 94:
-#line 550 "yacc_sql.y"
+  case 95: /* condition: value comOp ID DOT ID  */
+#line 559 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 1];
 
@@ -2208,11 +1957,11 @@ yyreduce:
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
 									
     	}
-#line 2212 "yacc_sql.tab.c"
+#line 1961 "yacc_sql.tab.c"
     break;
 
-  case 95:
-#line 562 "yacc_sql.y"
+  case 96: /* condition: ID DOT ID comOp ID DOT ID  */
+#line 571 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, (yyvsp[-6].string), (yyvsp[-4].string));
@@ -2223,112 +1972,112 @@ yyreduce:
 			condition_init(&condition, CONTEXT->comp, 1, &left_attr, NULL, 1, &right_attr, NULL);
 			CONTEXT->conditions[CONTEXT->condition_length++] = condition;
     	}
-#line 2227 "yacc_sql.tab.c"
+#line 1976 "yacc_sql.tab.c"
     break;
 
-  case 96:
-#line 575 "yacc_sql.y"
+  case 97: /* comOp: EQ  */
+#line 584 "yacc_sql.y"
              { CONTEXT->comp = EQUAL_TO; }
-#line 2233 "yacc_sql.tab.c"
+#line 1982 "yacc_sql.tab.c"
     break;
 
-  case 97:
-#line 576 "yacc_sql.y"
+  case 98: /* comOp: LT  */
+#line 585 "yacc_sql.y"
          { CONTEXT->comp = LESS_THAN; }
-#line 2239 "yacc_sql.tab.c"
+#line 1988 "yacc_sql.tab.c"
     break;
 
-  case 98:
-#line 577 "yacc_sql.y"
+  case 99: /* comOp: GT  */
+#line 586 "yacc_sql.y"
          { CONTEXT->comp = GREAT_THAN; }
-#line 2245 "yacc_sql.tab.c"
+#line 1994 "yacc_sql.tab.c"
     break;
 
-  case 99:
-#line 578 "yacc_sql.y"
+  case 100: /* comOp: LE  */
+#line 587 "yacc_sql.y"
          { CONTEXT->comp = LESS_EQUAL; }
-#line 2251 "yacc_sql.tab.c"
+#line 2000 "yacc_sql.tab.c"
     break;
 
-  case 100:
-#line 579 "yacc_sql.y"
+  case 101: /* comOp: GE  */
+#line 588 "yacc_sql.y"
          { CONTEXT->comp = GREAT_EQUAL; }
-#line 2257 "yacc_sql.tab.c"
+#line 2006 "yacc_sql.tab.c"
     break;
 
-  case 101:
-#line 580 "yacc_sql.y"
+  case 102: /* comOp: NE  */
+#line 589 "yacc_sql.y"
          { CONTEXT->comp = NOT_EQUAL; }
-#line 2263 "yacc_sql.tab.c"
+#line 2012 "yacc_sql.tab.c"
     break;
 
-  case 102:
-#line 581 "yacc_sql.y"
+  case 103: /* comOp: IS  */
+#line 590 "yacc_sql.y"
              { CONTEXT->comp = IS_NULL; }
-#line 2269 "yacc_sql.tab.c"
+#line 2018 "yacc_sql.tab.c"
     break;
 
-  case 103:
-#line 582 "yacc_sql.y"
+  case 104: /* comOp: IS NOT  */
+#line 591 "yacc_sql.y"
                  { CONTEXT->comp = NOT_NULL; }
-#line 2275 "yacc_sql.tab.c"
+#line 2024 "yacc_sql.tab.c"
     break;
 
-  case 104:
-#line 587 "yacc_sql.y"
+  case 105: /* load_data: LOAD DATA INFILE SSS INTO TABLE ID SEMICOLON  */
+#line 596 "yacc_sql.y"
                 {
 		  CONTEXT->ssql->flag = SCF_LOAD_DATA;
 			load_data_init(&CONTEXT->ssql->sstr.load_data, (yyvsp[-1].string), (yyvsp[-4].string));
 		}
-#line 2284 "yacc_sql.tab.c"
+#line 2033 "yacc_sql.tab.c"
     break;
 
-  case 106:
-#line 595 "yacc_sql.y"
+  case 107: /* order_by: ORDER BY order_param order_param_list  */
+#line 604 "yacc_sql.y"
                                                 {}
-#line 2290 "yacc_sql.tab.c"
+#line 2039 "yacc_sql.tab.c"
     break;
 
-  case 108:
-#line 600 "yacc_sql.y"
+  case 109: /* order_param_list: COMMA order_param order_param_list  */
+#line 609 "yacc_sql.y"
                                              {}
-#line 2296 "yacc_sql.tab.c"
+#line 2045 "yacc_sql.tab.c"
     break;
 
-  case 109:
-#line 604 "yacc_sql.y"
+  case 110: /* order_param: ID is_desc  */
+#line 613 "yacc_sql.y"
                    {
 			selects_append_order(&CONTEXT->ssql->sstr.selection, NULL, (yyvsp[-1].string), (yyvsp[0].number));
 		}
-#line 2304 "yacc_sql.tab.c"
+#line 2053 "yacc_sql.tab.c"
     break;
 
-  case 110:
-#line 607 "yacc_sql.y"
+  case 111: /* order_param: ID DOT ID is_desc  */
+#line 616 "yacc_sql.y"
                             {
 			selects_append_order(&CONTEXT->ssql->sstr.selection, (yyvsp[-3].string), (yyvsp[-1].string), (yyvsp[0].number));
 		}
-#line 2312 "yacc_sql.tab.c"
+#line 2061 "yacc_sql.tab.c"
     break;
 
-  case 111:
-#line 612 "yacc_sql.y"
+  case 112: /* is_desc: DESC  */
+#line 621 "yacc_sql.y"
              {
 		(yyval.number) = 1;
 	}
-#line 2320 "yacc_sql.tab.c"
+#line 2069 "yacc_sql.tab.c"
     break;
 
-  case 112:
-#line 615 "yacc_sql.y"
+  case 113: /* is_desc: is_asc  */
+#line 624 "yacc_sql.y"
                  {
 		(yyval.number) = 0;
 	}
-#line 2328 "yacc_sql.tab.c"
+#line 2077 "yacc_sql.tab.c"
     break;
 
 
-#line 2332 "yacc_sql.tab.c"
+#line 2081 "yacc_sql.tab.c"
 
       default: break;
     }
@@ -2343,11 +2092,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
@@ -2371,50 +2119,14 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (scanner, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = YY_CAST (char *, YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (scanner, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2447,6 +2159,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2463,13 +2176,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2483,7 +2197,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, scanner);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2495,7 +2209,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2506,7 +2220,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -2514,24 +2228,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (scanner, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
 
-/*-----------------------------------------------------.
-| yyreturn -- parsing is finished, return the result.  |
-`-----------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2547,20 +2259,18 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[+*yyssp], yyvsp, scanner);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 624 "yacc_sql.y"
+
+#line 633 "yacc_sql.y"
 
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
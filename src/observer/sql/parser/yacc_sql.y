@@ -222,19 +222,28 @@ desc_table:
     ;
 
 create_index:		/*create index 语句的语法解析树*/
-    CREATE index ID ON ID LBRACE ID index_list RBRACE SEMICOLON 
+    CREATE index ID ON ID LBRACE index_attr index_list RBRACE SEMICOLON 
 		{
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";
-			create_index_init(&CONTEXT->ssql->sstr.create_index, $3, $5, $7);
+			create_index_init(&CONTEXT->ssql->sstr.create_index, $3, $5);
 		}
     ;
 
-index_list:
-	| COMMA ID index_list {
-			// todo
+index_attr:
+	ID {
+			// 每个属性名读完就追加，保持多列索引中列的顺序
+			if (create_index_append_attribute(&CONTEXT->ssql->sstr.create_index, $1) != 0) {
+				CONTEXT->ssql->flag = SCF_CREATE_INDEX;  // 让yyerror释放已经追加的属性名
+				yyerror(scanner, "too many or duplicate index columns");
+				YYABORT;
+			}
 		}
 	;
 
+index_list:
+	| COMMA index_attr index_list { }
+	;
+
 index:
 	INDEX {
 			set_index_unique(&CONTEXT->ssql->sstr.create_index, 0);
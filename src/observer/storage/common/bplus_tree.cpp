@@ -25,30 +25,48 @@ static inline int float_compare(float f1, float f2) {
     return result > 0 ? 1 : -1;
 }
 
+// 按列的类型比较一列的值，类型在编译期确定，节点内查找时不用每次比较都判断类型
+template <AttrType T>
+static inline int compare_value(const char *pdata, const char *pkey,
+                                int attr_length);
+
+template <>
+inline int compare_value<INTS>(const char *pdata, const char *pkey,
+                               int attr_length) {
+    int i1 = *(int *)pdata;
+    int i2 = *(int *)pkey;
+    return i1 > i2 ? 1 : (i1 < i2 ? -1 : 0);
+}
+
+template <>
+inline int compare_value<FLOATS>(const char *pdata, const char *pkey,
+                                 int attr_length) {
+    return float_compare(*(float *)pdata, *(float *)pkey);
+}
+
+template <>
+inline int compare_value<CHARS>(const char *pdata, const char *pkey,
+                                int attr_length) {
+    return strncmp(pdata, pkey, attr_length);
+}
+
+template <>
+inline int compare_value<DATES>(const char *pdata, const char *pkey,
+                                int attr_length) {
+    return strncmp(pdata, pkey, attr_length);
+}
+
 static int CompareKey(const char *pdata, const char *pkey, AttrType attr_type,
                       int attr_length) {  // 简化
-    int i1, i2;
-    float f1, f2;
-    const char *s1, *s2;
     switch (attr_type) {
-        case INTS: {
-            i1 = *(int *)pdata;
-            i2 = *(int *)pkey;
-            if (i1 > i2) return 1;
-            if (i1 < i2) return -1;
-            if (i1 == i2) return 0;
-        } break;
-        case FLOATS: {
-            f1 = *(float *)pdata;
-            f2 = *(float *)pkey;
-            return float_compare(f1, f2);
-        } break;
+        case INTS:
+            return compare_value<INTS>(pdata, pkey, attr_length);
+        case FLOATS:
+            return compare_value<FLOATS>(pdata, pkey, attr_length);
         case DATES:
-        case CHARS: {
-            s1 = pdata;
-            s2 = pkey;
-            return strncmp(s1, s2, attr_length);
-        } break;
+            return compare_value<DATES>(pdata, pkey, attr_length);
+        case CHARS:
+            return compare_value<CHARS>(pdata, pkey, attr_length);
         default: {
             LOG_PANIC("Unknown attr type: %d", attr_type);
         }
@@ -64,31 +82,143 @@ static inline int CmpRid(const RID *rid1, const RID *rid2) {
     return 0;
 }
 
-static inline int cmp_key_unique(AttrType attr_type, int attr_length,
+// 依次比较key的前attr_num列
+static int compare_attrs(const IndexFileHeader &header, const char *pdata,
+                         const char *pkey, int attr_num) {
+    int offset = 0;
+    for (int i = 0; i < attr_num; i++) {
+        int result = CompareKey(pdata + offset, pkey + offset,
+                                header.attr_types[i], header.attr_lengths[i]);
+        if (0 != result) {
+            return result;
+        }
+        offset += header.attr_lengths[i];
+    }
+    return 0;
+}
+
+// 前attr_num列的总长度
+static int prefix_length(const IndexFileHeader &header, int attr_num) {
+    int length = 0;
+    for (int i = 0; i < attr_num; i++) {
+        length += header.attr_lengths[i];
+    }
+    return length;
+}
+
+static inline int cmp_key_unique(const IndexFileHeader &header,
                                  const char *pdata, const char *pkey) {
-    int result = CompareKey(pdata, pkey, attr_type, attr_length);
-    return result;
+    return compare_attrs(header, pdata, pkey, header.attr_num);
 }
 
-static inline int CmpKey(AttrType attr_type, int attr_length, const char *pdata,
+static inline int CmpKey(const IndexFileHeader &header, const char *pdata,
                          const char *pkey) {
-    int result = CompareKey(pdata, pkey, attr_type, attr_length);
+    int result = compare_attrs(header, pdata, pkey, header.attr_num);
     if (0 != result) {
         return result;
     }
-    RID *rid1 = (RID *)(pdata + attr_length);
-    RID *rid2 = (RID *)(pkey + attr_length);
+    RID *rid1 = (RID *)(pdata + header.attr_length);
+    RID *rid2 = (RID *)(pkey + header.attr_length);
     return CmpRid(rid1, rid2);
 }
 
-BplusTreeHandler::BplusTreeHandler(bool is_unique) : is_unique_(is_unique) {}
+// 第一列的类型作为模板参数，后面的列和RID只有第一列相等时才需要比较
+template <AttrType T>
+struct KeyComparator {
+    const IndexFileHeader &header;
+    int attr_num;  // 为0时比较所有列和RID
+
+    int operator()(const char *pdata, const char *pkey) const {
+        int result = compare_value<T>(pdata, pkey, header.attr_lengths[0]);
+        if (0 != result) {
+            return result;
+        }
+        const int num = attr_num > 0 ? attr_num : header.attr_num;
+        int offset = header.attr_lengths[0];
+        for (int i = 1; i < num; i++) {
+            result = CompareKey(pdata + offset, pkey + offset,
+                                header.attr_types[i], header.attr_lengths[i]);
+            if (0 != result) {
+                return result;
+            }
+            offset += header.attr_lengths[i];
+        }
+        if (attr_num > 0) {
+            return 0;
+        }
+        return CmpRid((RID *)(pdata + header.attr_length),
+                      (RID *)(pkey + header.attr_length));
+    }
+};
+
+template <AttrType T>
+static int binary_search(const IndexFileHeader &header, const IndexNode *node,
+                         const char *pkey, int attr_num, bool upper) {
+    KeyComparator<T> compare{header, attr_num};
+    int left = 0;
+    int right = node->key_num;
+    while (left < right) {
+        int mid = left + (right - left) / 2;
+        int result = compare(node->keys() + mid * header.key_length, pkey);
+        if (result < 0 || (upper && result == 0)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+/**
+ * 节点内的key是有序的，二分查找第一个不小于pkey的位置，upper为true时找第一个大于pkey的位置。
+ * 只比较前attr_num列，attr_num为0时比较所有列和RID。没有这样的key时返回key_num
+ */
+static int search_node(const IndexFileHeader &header, const IndexNode *node,
+                       const char *pkey, int attr_num, bool upper) {
+    switch (header.attr_types[0]) {
+        case INTS:
+            return binary_search<INTS>(header, node, pkey, attr_num, upper);
+        case FLOATS:
+            return binary_search<FLOATS>(header, node, pkey, attr_num, upper);
+        case DATES:
+            return binary_search<DATES>(header, node, pkey, attr_num, upper);
+        case CHARS:
+            return binary_search<CHARS>(header, node, pkey, attr_num, upper);
+        default: {
+            LOG_PANIC("Unknown attr type: %d", header.attr_types[0]);
+        }
+    }
+    return node->key_num;
+}
+
+/**
+ * 加了写latch的页面句柄在出错提前返回时解锁并unpin。
+ * 正常路径上自己解锁并unpin之后句柄不再是open状态，析构时什么也不做
+ */
+class PageWriteGuard {
+public:
+    PageWriteGuard(DiskBufferPool *disk_buffer_pool, BPPageHandle &page_handle)
+        : disk_buffer_pool_(disk_buffer_pool), page_handle_(page_handle) {}
+    ~PageWriteGuard() {
+        if (page_handle_.open) {
+            page_handle_.wunlatch();
+            disk_buffer_pool_->unpin_page(&page_handle_);
+        }
+    }
+
+private:
+    DiskBufferPool *disk_buffer_pool_;
+    BPPageHandle &page_handle_;
+};
+
+BplusTreeHandler::BplusTreeHandler(bool is_unique) : is_unique_(is_unique) {
+    pthread_rwlock_init(&tree_latch_, nullptr);
+}
+
+BplusTreeHandler::~BplusTreeHandler() { pthread_rwlock_destroy(&tree_latch_); }
 
 IndexNode *BplusTreeHandler::get_index_node(char *page_data) const {
-    IndexNode *node = (IndexNode *)(page_data + sizeof(IndexFileHeader));
-    node->keys = (char *)node + sizeof(IndexNode);
-    node->rids =
-        (RID *)(node->keys + file_header_.order * file_header_.key_length);
-    return node;
+    return (IndexNode *)(page_data + sizeof(IndexFileHeader));
 }
 
 RC BplusTreeHandler::sync() {
@@ -96,12 +226,30 @@ RC BplusTreeHandler::sync() {
 }
 
 RC BplusTreeHandler::create(const char *file_name, AttrType attr_type,
-                            int attr_length) {
+                            int attr_length, DiskBufferPool *buffer_pool) {
+    return create(file_name, 1, &attr_type, &attr_length, buffer_pool);
+}
+
+RC BplusTreeHandler::create(const char *file_name, int attr_num,
+                            const AttrType attr_types[],
+                            const int attr_lengths[],
+                            DiskBufferPool *buffer_pool) {
+    if (attr_num <= 0 || attr_num > MAX_NUM) {
+        LOG_ERROR("Invalid attr num of index. file name=%s, attr num=%d",
+                  file_name, attr_num);
+        return RC::INVALID_ARGUMENT;
+    }
+    int attr_length = 0;
+    for (int i = 0; i < attr_num; i++) {
+        attr_length += attr_lengths[i];
+    }
+
     BPPageHandle page_handle;
     IndexNode *root;
     char *pdata;
     RC rc;
-    DiskBufferPool *disk_buffer_pool = theGlobalDiskBufferPool();
+    DiskBufferPool *disk_buffer_pool =
+        buffer_pool != nullptr ? buffer_pool : theGlobalDiskBufferPool();
     rc = disk_buffer_pool->create_file(file_name);
     if (rc != SUCCESS) {
         return rc;
@@ -134,13 +282,22 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type,
                   rc, strrc(rc));
         return rc;
     }
+    int page_data_size = 0;
+    rc = disk_buffer_pool->get_page_data_size(file_id, &page_data_size);
+    if (rc != SUCCESS) {
+        return rc;
+    }
+
     IndexFileHeader *file_header = (IndexFileHeader *)pdata;
     file_header->attr_length = attr_length;
     file_header->key_length = attr_length + sizeof(RID);
-    file_header->attr_type = attr_type;
+    file_header->attr_type = attr_types[0];
+    file_header->attr_num = attr_num;
+    memcpy(file_header->attr_types, attr_types, attr_num * sizeof(AttrType));
+    memcpy(file_header->attr_lengths, attr_lengths, attr_num * sizeof(int));
     file_header->node_num = 1;
     file_header->order =
-        ((int)BP_PAGE_DATA_SIZE - sizeof(IndexFileHeader) - sizeof(IndexNode)) /
+        (page_data_size - sizeof(IndexFileHeader) - sizeof(IndexNode)) /
         (attr_length + 2 * sizeof(RID));
     file_header->root_page = page_num;
 
@@ -148,8 +305,8 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type,
     root->is_leaf = 1;
     root->key_num = 0;
     root->parent = -1;
-    root->keys = nullptr;
-    root->rids = nullptr;
+    root->unused_keys = nullptr;
+    root->unused_rids = nullptr;
 
     rc = disk_buffer_pool->mark_dirty(&page_handle);
     if (rc != SUCCESS) {
@@ -170,7 +327,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type,
     return SUCCESS;
 }
 
-RC BplusTreeHandler::open(const char *file_name) {
+RC BplusTreeHandler::open(const char *file_name, DiskBufferPool *buffer_pool) {
     RC rc;
     BPPageHandle page_handle;
     char *pdata;
@@ -178,7 +335,8 @@ RC BplusTreeHandler::open(const char *file_name) {
         return RC::RECORD_OPENNED;
     }
 
-    DiskBufferPool *disk_buffer_pool = theGlobalDiskBufferPool();
+    DiskBufferPool *disk_buffer_pool =
+        buffer_pool != nullptr ? buffer_pool : theGlobalDiskBufferPool();
     int file_id;
     rc = disk_buffer_pool->open_file(file_name, &file_id);
     if (rc != SUCCESS) {
@@ -212,12 +370,60 @@ RC BplusTreeHandler::close() {
     return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::crab_to_leaf(const char *pkey, bool exclusive,
+                                  BPPageHandle *leaf_handle, int attr_num) {
+    BPPageHandle page_handle;
+    char *pdata;
+    RC rc = disk_buffer_pool_->get_this_page(file_id_, file_header_.root_page,
+                                             &page_handle);
+    if (rc != SUCCESS) {
+        return rc;
+    }
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    // 持有树的读锁时节点不会在叶子节点和内部节点之间变化，可以在加latch之前判断
+    IndexNode *node = (IndexNode *)(pdata + sizeof(IndexFileHeader));
+    if (exclusive && node->is_leaf) {
+        page_handle.wlatch();
+    } else {
+        page_handle.rlatch();
+    }
+    node = get_index_node(pdata);
+    while (0 == node->is_leaf) {
+        // 只有前缀时当作比前缀相同的项都小
+        const int i =
+            pkey == nullptr
+                ? 0
+                : search_node(file_header_, node, pkey, attr_num, attr_num == 0);
+        BPPageHandle child_handle;
+        rc = disk_buffer_pool_->get_this_page(file_id_, node->rids(file_header_)[i].page_num,
+                                              &child_handle);
+        if (rc != SUCCESS) {
+            page_handle.runlatch();
+            disk_buffer_pool_->unpin_page(&page_handle);
+            return rc;
+        }
+        disk_buffer_pool_->get_data(&child_handle, &pdata);
+        node = (IndexNode *)(pdata + sizeof(IndexFileHeader));
+        if (exclusive && node->is_leaf) {
+            child_handle.wlatch();
+        } else {
+            child_handle.rlatch();
+        }
+        page_handle.runlatch();
+        disk_buffer_pool_->unpin_page(&page_handle);
+        page_handle = child_handle;
+        node = get_index_node(pdata);
+    }
+    *leaf_handle = page_handle;
+    return SUCCESS;
+}
+
 RC BplusTreeHandler::find_leaf(const char *pkey, PageNum *leaf_page) {
     RC rc;
     BPPageHandle page_handle;
     IndexNode *node;
     char *pdata;
-    int i, tmp;
+    int i;
     rc = disk_buffer_pool_->get_this_page(file_id_, file_header_.root_page,
                                           &page_handle);
     if (rc != SUCCESS) {
@@ -230,16 +436,12 @@ RC BplusTreeHandler::find_leaf(const char *pkey, PageNum *leaf_page) {
     }
     node = get_index_node(pdata);
     while (0 == node->is_leaf) {
-        for (i = 0; i < node->key_num; i++) {
-            tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey,
-                         node->keys + i * file_header_.key_length);
-            if (tmp < 0) break;
-        }
+        i = search_node(file_header_, node, pkey, 0, true);
         rc = disk_buffer_pool_->unpin_page(&page_handle);
         if (rc != SUCCESS) {
             return rc;
         }
-        rc = disk_buffer_pool_->get_this_page(file_id_, node->rids[i].page_num,
+        rc = disk_buffer_pool_->get_this_page(file_id_, node->rids(file_header_)[i].page_num,
                                               &page_handle);
         if (rc != SUCCESS) {
             return rc;
@@ -261,58 +463,55 @@ RC BplusTreeHandler::find_leaf(const char *pkey, PageNum *leaf_page) {
     return SUCCESS;
 }
 
-RC BplusTreeHandler::insert_into_leaf(PageNum leaf_page, const char *pkey,
+RC BplusTreeHandler::insert_into_node(IndexNode *node, const char *pkey,
                                       const RID *rid) {
-    int i, insert_pos, tmp;
-    BPPageHandle page_handle;
-    char *pdata;
+    int i, insert_pos;
     char *from, *to;
-    IndexNode *node;
-    RC rc;
 
-    rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-    node = get_index_node(pdata);
-
-    for (insert_pos = 0; insert_pos < node->key_num; insert_pos++) {
-        if (is_unique_) {
-            tmp = cmp_key_unique(
-                file_header_.attr_type, file_header_.attr_length, pkey,
-                node->keys + insert_pos * file_header_.key_length);
-        } else {
-            tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey,
-                         node->keys + insert_pos * file_header_.key_length);
-        }
-        if (tmp == 0) {
-            return RC::RECORD_DUPLICATE_KEY;
-        }
-        if (tmp < 0) break;
+    // 唯一索引只比较列的值
+    const int attr_num = is_unique_ ? file_header_.attr_num : 0;
+    insert_pos = search_node(file_header_, node, pkey, attr_num, false);
+    if (insert_pos < node->key_num &&
+        (is_unique_
+             ? cmp_key_unique(file_header_, pkey,
+                              node->keys() + insert_pos * file_header_.key_length)
+             : CmpKey(file_header_, pkey,
+                      node->keys() + insert_pos * file_header_.key_length)) ==
+            0) {
+        return RC::RECORD_DUPLICATE_KEY;
     }
     for (i = node->key_num; i > insert_pos; i--) {
-        from = node->keys + (i - 1) * file_header_.key_length;
-        to = node->keys + i * file_header_.key_length;
+        from = node->keys() + (i - 1) * file_header_.key_length;
+        to = node->keys() + i * file_header_.key_length;
         memcpy(to, from, file_header_.key_length);
-        memcpy(node->rids + i, node->rids + i - 1, sizeof(RID));
+        memcpy(node->rids(file_header_) + i, node->rids(file_header_) + i - 1, sizeof(RID));
     }
-    memcpy(node->keys + insert_pos * file_header_.key_length, pkey,
+    memcpy(node->keys() + insert_pos * file_header_.key_length, pkey,
            file_header_.key_length);
-    memcpy(node->rids + insert_pos, rid, sizeof(RID));
+    memcpy(node->rids(file_header_) + insert_pos, rid, sizeof(RID));
     node->key_num++;  //叶子结点增加一条记录
-    rc = disk_buffer_pool_->mark_dirty(&page_handle);
+    return SUCCESS;
+}
+
+RC BplusTreeHandler::insert_into_leaf(PageNum leaf_page, const char *pkey,
+                                      const RID *rid) {
+    BPPageHandle page_handle;
+    char *pdata;
+    RC rc;
+
+    rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
     if (rc != SUCCESS) {
         return rc;
     }
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if (rc != SUCCESS) {
-        return rc;
+    page_handle.wlatch();
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    rc = insert_into_node(get_index_node(pdata), pkey, rid);
+    if (rc == SUCCESS) {
+        disk_buffer_pool_->mark_dirty(&page_handle);
     }
-    return SUCCESS;
+    page_handle.wunlatch();
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
 }
 
 RC BplusTreeHandler::print() {
@@ -340,7 +539,7 @@ RC BplusTreeHandler::print() {
         printf("page_num :%d %d\n", i, node->is_leaf);
         for (j = 0; j < node->key_num && j < 6; j++) {
             printf("keynum :%d rids:page_num :%d,slotnum :%d\n", node->key_num,
-                   node->rids[j].page_num, node->rids[j].slot_num);
+                   node->rids(file_header_)[j].page_num, node->rids(file_header_)[j].slot_num);
         }
         printf("\n");
         rc = disk_buffer_pool_->unpin_page(&page_handle);
@@ -361,12 +560,14 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
     RID *temp_pointers, tmprid;
     char *temp_keys, *new_key;
     char *pdata;
-    int insert_pos, split, i, j, tmp;
+    int insert_pos, split, i, j;
 
     rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle1);
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle1.wlatch();
+    PageWriteGuard guard1(disk_buffer_pool_, page_handle1);
     rc = disk_buffer_pool_->get_data(&page_handle1, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -378,6 +579,8 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle2.wlatch();
+    PageWriteGuard guard2(disk_buffer_pool_, page_handle2);
 
     rc = disk_buffer_pool_->get_data(&page_handle2, &pdata);
     if (rc != SUCCESS) {
@@ -411,17 +614,13 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
         return RC::NOMEM;
     }
 
-    for (insert_pos = 0; insert_pos < leaf->key_num; insert_pos++) {
-        tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey,
-                     leaf->keys + insert_pos * file_header_.key_length);
-        if (tmp < 0) break;
-    }
+    insert_pos = search_node(file_header_, leaf, pkey, 0, true);
     for (i = 0, j = 0; i < leaf->key_num; i++, j++) {
         if (j == insert_pos) j++;
         memcpy(temp_keys + j * file_header_.key_length,
-               leaf->keys + i * file_header_.key_length,
+               leaf->keys() + i * file_header_.key_length,
                file_header_.key_length);
-        memcpy(temp_pointers + j, leaf->rids + i, sizeof(RID));
+        memcpy(temp_pointers + j, leaf->rids(file_header_) + i, sizeof(RID));
     }
     memcpy(temp_keys + insert_pos * file_header_.key_length, pkey,
            file_header_.key_length);
@@ -430,29 +629,29 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
     split = file_header_.order / 2;
 
     for (i = 0; i < split; i++) {
-        memcpy(leaf->keys + i * file_header_.key_length,
+        memcpy(leaf->keys() + i * file_header_.key_length,
                temp_keys + i * file_header_.key_length,
                file_header_.key_length);
-        memcpy(leaf->rids + i, temp_pointers + i, sizeof(RID));
+        memcpy(leaf->rids(file_header_) + i, temp_pointers + i, sizeof(RID));
     }
     leaf->key_num = split;
 
     for (i = split, j = 0; i < file_header_.order; i++, j++) {
-        memcpy(new_node->keys + j * file_header_.key_length,
+        memcpy(new_node->keys() + j * file_header_.key_length,
                temp_keys + i * file_header_.key_length,
                file_header_.key_length);
-        memcpy(new_node->rids + j, temp_pointers + i, sizeof(RID));
+        memcpy(new_node->rids(file_header_) + j, temp_pointers + i, sizeof(RID));
         new_node->key_num++;
     }
 
     free(temp_pointers);
     free(temp_keys);
 
-    memcpy(new_node->rids + file_header_.order - 1,
-           leaf->rids + file_header_.order - 1, sizeof(RID));
+    memcpy(new_node->rids(file_header_) + file_header_.order - 1,
+           leaf->rids(file_header_) + file_header_.order - 1, sizeof(RID));
     tmprid.page_num = new_page;
     tmprid.slot_num = -1;
-    memcpy(leaf->rids + file_header_.order - 1, &tmprid, sizeof(RID));
+    memcpy(leaf->rids(file_header_) + file_header_.order - 1, &tmprid, sizeof(RID));
 
     new_key = (char *)malloc(file_header_.key_length);
     if (new_key == nullptr) {
@@ -460,7 +659,7 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
                   file_header_.key_length);
         return RC::NOMEM;
     }
-    memcpy(new_key, new_node->keys, file_header_.key_length);
+    memcpy(new_key, new_node->keys(), file_header_.key_length);
 
     rc = disk_buffer_pool_->mark_dirty(&page_handle1);
     if (rc != SUCCESS) {
@@ -468,6 +667,7 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
         return rc;
     }
 
+    page_handle1.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle1);
     if (rc != SUCCESS) {
         free(new_key);
@@ -479,6 +679,7 @@ RC BplusTreeHandler::insert_into_leaf_after_split(PageNum leaf_page,
         free(new_key);
         return rc;
     }
+    page_handle2.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle2);
     if (rc != SUCCESS) {
         free(new_key);
@@ -508,6 +709,7 @@ RC BplusTreeHandler::insert_intern_node(PageNum parent_page, PageNum left_page,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -517,24 +719,25 @@ RC BplusTreeHandler::insert_intern_node(PageNum parent_page, PageNum left_page,
 
     insert_pos = 0;
     while ((insert_pos <= node->key_num) &&
-           (node->rids[insert_pos].page_num != left_page))
+           (node->rids(file_header_)[insert_pos].page_num != left_page))
         insert_pos++;
     for (i = node->key_num; i > insert_pos; i--) {
-        memcpy(node->rids + i + 1, node->rids + i, sizeof(RID));
-        memcpy(node->keys + i * file_header_.key_length,
-               node->keys + (i - 1) * file_header_.key_length,
+        memcpy(node->rids(file_header_) + i + 1, node->rids(file_header_) + i, sizeof(RID));
+        memcpy(node->keys() + i * file_header_.key_length,
+               node->keys() + (i - 1) * file_header_.key_length,
                file_header_.key_length);
     }
     rid.page_num = right_page;
     rid.slot_num = BP_INVALID_PAGE_NUM;  // change to invalid page num
-    memcpy(node->rids + insert_pos + 1, &rid, sizeof(RID));
-    memcpy(node->keys + insert_pos * file_header_.key_length, pkey,
+    memcpy(node->rids(file_header_) + insert_pos + 1, &rid, sizeof(RID));
+    memcpy(node->keys() + insert_pos * file_header_.key_length, pkey,
            file_header_.key_length);
     node->key_num++;
     rc = disk_buffer_pool_->mark_dirty(&page_handle);
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -558,6 +761,8 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle1.wlatch();
+    PageWriteGuard guard1(disk_buffer_pool_, page_handle1);
     rc = disk_buffer_pool_->get_data(&page_handle1, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -570,6 +775,8 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle2.wlatch();
+    PageWriteGuard guard2(disk_buffer_pool_, page_handle2);
     rc = disk_buffer_pool_->get_data(&page_handle2, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -614,16 +821,16 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
 
     insert_pos = 0;
     while ((insert_pos <= inter_node->key_num) &&
-           (inter_node->rids[insert_pos].page_num != left_page))
+           (inter_node->rids(file_header_)[insert_pos].page_num != left_page))
         insert_pos++;
     for (i = 0, j = 0; i < inter_node->key_num + 1; i++, j++) {
         if (j == insert_pos + 1) j++;
-        memcpy(temp_pointers + j, inter_node->rids + i, sizeof(RID));
+        memcpy(temp_pointers + j, inter_node->rids(file_header_) + i, sizeof(RID));
     }
     for (i = 0, j = 0; i < inter_node->key_num; i++, j++) {
         if (j == insert_pos) j++;
         memcpy(temp_keys + j * file_header_.key_length,
-               inter_node->keys + i * file_header_.key_length,
+               inter_node->keys() + i * file_header_.key_length,
                file_header_.key_length);
     }
     tmprid.page_num = right_page;
@@ -635,36 +842,38 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
     split = (file_header_.order + 1) / 2;
 
     for (i = 0; i < split - 1; i++) {
-        memcpy(inter_node->keys + i * file_header_.key_length,
+        memcpy(inter_node->keys() + i * file_header_.key_length,
                temp_keys + i * file_header_.key_length,
                file_header_.key_length);
-        memcpy(inter_node->rids + i, temp_pointers + i, sizeof(RID));
+        memcpy(inter_node->rids(file_header_) + i, temp_pointers + i, sizeof(RID));
     }
     inter_node->key_num = split - 1;
-    memcpy(inter_node->rids + i, temp_pointers + i, sizeof(RID));
+    memcpy(inter_node->rids(file_header_) + i, temp_pointers + i, sizeof(RID));
     memcpy(new_key, temp_keys + i * file_header_.key_length,
            file_header_.key_length);
 
     for (++i, j = 0; i < file_header_.order; i++, j++) {
-        memcpy(new_node->keys + j * file_header_.key_length,
+        memcpy(new_node->keys() + j * file_header_.key_length,
                temp_keys + i * file_header_.key_length,
                file_header_.key_length);
-        memcpy(new_node->rids + j, temp_pointers + i, sizeof(RID));
+        memcpy(new_node->rids(file_header_) + j, temp_pointers + i, sizeof(RID));
         new_node->key_num++;
     }
-    memcpy(new_node->rids + j, temp_pointers + i, sizeof(RID));
+    memcpy(new_node->rids(file_header_) + j, temp_pointers + i, sizeof(RID));
 
     free(temp_keys);
     free(temp_pointers);
 
     for (i = 0; i <= new_node->key_num; i++) {
-        child_page = new_node->rids[i].page_num;
+        child_page = new_node->rids(file_header_)[i].page_num;
         rc = disk_buffer_pool_->get_this_page(file_id_, child_page,
                                               &child_page_handle);
         if (rc != SUCCESS) {
             free(new_key);
             return rc;
         }
+        child_page_handle.wlatch();
+        PageWriteGuard child_guard(disk_buffer_pool_, child_page_handle);
         rc = disk_buffer_pool_->get_data(&child_page_handle, &pdata);
         if (rc != SUCCESS) {
             free(new_key);
@@ -677,6 +886,7 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
             free(new_key);
             return rc;
         }
+        child_page_handle.wunlatch();
         rc = disk_buffer_pool_->unpin_page(&child_page_handle);
         if (rc != SUCCESS) {
             free(new_key);
@@ -689,6 +899,7 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
         free(new_key);
         return rc;
     }
+    page_handle1.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle1);
     if (rc != SUCCESS) {
         free(new_key);
@@ -699,6 +910,7 @@ RC BplusTreeHandler::insert_intern_node_after_split(PageNum inter_page,
         free(new_key);
         return rc;
     }
+    page_handle2.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle2);
     if (rc != SUCCESS) {
         free(new_key);
@@ -764,6 +976,7 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -777,18 +990,19 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     root->is_leaf = false;
     root->key_num = 1;
     root->parent = -1;
-    memcpy(root->keys, pkey, file_header_.key_length);
+    memcpy(root->keys(), pkey, file_header_.key_length);
     rid.page_num = left_page;
     rid.slot_num = -1;
-    memcpy(root->rids, &rid, sizeof(RID));
+    memcpy(root->rids(file_header_), &rid, sizeof(RID));
     rid.page_num = right_page;
     rid.slot_num = -1;
-    memcpy(root->rids + 1, &rid, sizeof(RID));
+    memcpy(root->rids(file_header_) + 1, &rid, sizeof(RID));
 
     rc = disk_buffer_pool_->mark_dirty(&page_handle);
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -798,6 +1012,7 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -809,6 +1024,7 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -818,6 +1034,7 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -829,6 +1046,7 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&page_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -840,10 +1058,8 @@ RC BplusTreeHandler::insert_into_new_root(PageNum left_page, const char *pkey,
 
 RC BplusTreeHandler::insert_entry(const char *pkey, const RID *rid) {
     RC rc;
-    PageNum leaf_page;
     BPPageHandle page_handle;
     char *pdata, *key;
-    IndexNode *leaf;
     if (nullptr == disk_buffer_pool_) {
         return RC::RECORD_CLOSED;
     }
@@ -856,56 +1072,71 @@ RC BplusTreeHandler::insert_entry(const char *pkey, const RID *rid) {
     memcpy(key, pkey, file_header_.attr_length);
     memcpy(key + file_header_.attr_length, rid, sizeof(*rid));
     LOG_DEBUG("ZD: key=%s", key);
+
+    // 叶子节点放得下时只加树的读锁，直接插入到叶子节点中
+    pthread_rwlock_rdlock(&tree_latch_);
+    rc = crab_to_leaf(key, true, &page_handle);
+    bool done = rc != SUCCESS;
+    if (rc == SUCCESS) {
+        disk_buffer_pool_->get_data(&page_handle, &pdata);
+        IndexNode *leaf = get_index_node(pdata);
+        if (leaf->key_num < file_header_.order - 1) {
+            rc = insert_into_node(leaf, key, rid);
+            if (rc == SUCCESS) {
+                disk_buffer_pool_->mark_dirty(&page_handle);
+            }
+            done = true;
+        }
+        page_handle.wunlatch();
+        disk_buffer_pool_->unpin_page(&page_handle);
+    }
+    pthread_rwlock_unlock(&tree_latch_);
+
+    if (!done) {
+        // 叶子节点要分裂，加树的写锁之后重新查找
+        pthread_rwlock_wrlock(&tree_latch_);
+        rc = insert_entry_exclusive(key, rid);
+        pthread_rwlock_unlock(&tree_latch_);
+    }
+    free(key);
+    return rc;
+}
+
+RC BplusTreeHandler::insert_entry_exclusive(const char *key, const RID *rid) {
+    RC rc;
+    PageNum leaf_page;
+    BPPageHandle page_handle;
+    char *pdata;
+    IndexNode *leaf;
     rc = find_leaf(key, &leaf_page);
     if (rc != SUCCESS) {
-        free(key);
         return rc;
     }
 
     rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
     if (rc != SUCCESS) {
-        free(key);
         return rc;
     }
 
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
-        free(key);
         return rc;
     }
     leaf = (IndexNode *)(pdata + sizeof(IndexFileHeader));
-
-    if (leaf->key_num < file_header_.order - 1) {
-        rc = disk_buffer_pool_->unpin_page(&page_handle);
-        if (rc != SUCCESS) {
-            free(key);
-            return rc;
-        }
-        rc = insert_into_leaf(leaf_page, key, rid);
-        if (rc != SUCCESS) {
-            free(key);
-            return rc;
-        }
-        free(key);
-        return SUCCESS;
-    } else {
-        rc = disk_buffer_pool_->unpin_page(&page_handle);
-        if (rc != SUCCESS) {
-            free(key);
-            return rc;
-        }
-
-        // print();
-
-        rc = insert_into_leaf_after_split(leaf_page, key, rid);
-        free(key);
-        return SUCCESS;
+    const bool full = leaf->key_num >= file_header_.order - 1;
+    rc = disk_buffer_pool_->unpin_page(&page_handle);
+    if (rc != SUCCESS) {
+        return rc;
     }
+    // 其它线程可能已经分裂了这个叶子节点
+    if (!full) {
+        return insert_into_leaf(leaf_page, key, rid);
+    }
+    return insert_into_leaf_after_split(leaf_page, key, rid);
 }
 
 RC BplusTreeHandler::get_entry(const char *pkey, RID *rid) {
     RC rc;
-    PageNum leaf_page;
     BPPageHandle page_handle;
     int i;
     char *pdata, *key;
@@ -920,90 +1151,76 @@ RC BplusTreeHandler::get_entry(const char *pkey, RID *rid) {
     memcpy(key, pkey, file_header_.attr_length);
     memcpy(key + file_header_.attr_length, rid, sizeof(RID));
 
-    rc = find_leaf(key, &leaf_page);
-    if (rc != SUCCESS) {
-        free(key);
-        return rc;
-    }
-
-    rc = disk_buffer_pool_->get_this_page(file_id_, leaf_page, &page_handle);
-    if (rc != SUCCESS) {
-        free(key);
-        return rc;
-    }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+    pthread_rwlock_rdlock(&tree_latch_);
+    rc = crab_to_leaf(key, false, &page_handle);
     if (rc != SUCCESS) {
+        pthread_rwlock_unlock(&tree_latch_);
         free(key);
         return rc;
     }
 
+    rc = RC::RECORD_INVALID_KEY;
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
     leaf = get_index_node(pdata);
-    for (i = 0; i < leaf->key_num; i++) {
-        if (CmpKey(file_header_.attr_type, file_header_.attr_length, key,
-                   leaf->keys + (i * file_header_.key_length)) == 0) {
-            memcpy(rid, leaf->rids + i, sizeof(RID));
-            free(key);
-            return SUCCESS;
-        }
-    }
+    i = search_node(file_header_, leaf, key, 0, false);
+    if (i < leaf->key_num &&
+        CmpKey(file_header_, key, leaf->keys() + (i * file_header_.key_length)) ==
+            0) {
+        memcpy(rid, leaf->rids(file_header_) + i, sizeof(RID));
+        rc = SUCCESS;
+    }
+    page_handle.runlatch();
+    disk_buffer_pool_->unpin_page(&page_handle);
+    pthread_rwlock_unlock(&tree_latch_);
     free(key);
-    return RC::RECORD_INVALID_KEY;
+    return rc;
 }
 
-RC BplusTreeHandler::delete_entry_from_node(PageNum node_page,
-                                            const char *pkey) {
-    BPPageHandle page_handle;
-    IndexNode *node;
-    char *pdata;
-    int delete_index, i, tmp;
-    RC rc;
-
-    rc = disk_buffer_pool_->get_this_page(file_id_, node_page, &page_handle);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-
-    node = get_index_node(pdata);
-
-    for (delete_index = 0; delete_index < node->key_num; delete_index++) {
-        tmp = CmpKey(file_header_.attr_type, file_header_.attr_length, pkey,
-                     node->keys + delete_index * file_header_.key_length);
-        if (tmp == 0) break;
-    }
-    if (delete_index >= node->key_num) {
+RC BplusTreeHandler::delete_from_node(IndexNode *node, const char *pkey) {
+    int delete_index, i;
+    delete_index = search_node(file_header_, node, pkey, 0, false);
+    if (delete_index >= node->key_num ||
+        CmpKey(file_header_, pkey,
+               node->keys() + delete_index * file_header_.key_length) != 0) {
         return RC::RECORD_INVALID_KEY;
     }
     i = delete_index;
     while (i < (node->key_num - 1)) {
-        memcpy(node->keys + i * file_header_.key_length,
-               node->keys + (i + 1) * file_header_.key_length,
+        memcpy(node->keys() + i * file_header_.key_length,
+               node->keys() + (i + 1) * file_header_.key_length,
                file_header_.key_length);
         i++;
     }
 
     if (node->is_leaf)
         for (i = delete_index; i < (node->key_num - 1); i++)
-            memcpy(node->rids + i, node->rids + i + 1, sizeof(RID));
+            memcpy(node->rids(file_header_) + i, node->rids(file_header_) + i + 1, sizeof(RID));
     else
         for (i = delete_index + 1; i < node->key_num; i++)
-            memcpy(node->rids + i, node->rids + i + 1, sizeof(RID));
+            memcpy(node->rids(file_header_) + i, node->rids(file_header_) + i + 1, sizeof(RID));
     node->key_num--;
+    return SUCCESS;
+}
 
-    rc = disk_buffer_pool_->mark_dirty(&page_handle);
+RC BplusTreeHandler::delete_entry_from_node(PageNum node_page,
+                                            const char *pkey) {
+    BPPageHandle page_handle;
+    char *pdata;
+    RC rc;
+
+    rc = disk_buffer_pool_->get_this_page(file_id_, node_page, &page_handle);
     if (rc != SUCCESS) {
         return rc;
     }
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if (rc != SUCCESS) {
-        return rc;
+    page_handle.wlatch();
+    disk_buffer_pool_->get_data(&page_handle, &pdata);
+    rc = delete_from_node(get_index_node(pdata), pkey);
+    if (rc == SUCCESS) {
+        disk_buffer_pool_->mark_dirty(&page_handle);
     }
-
-    return SUCCESS;
+    page_handle.wunlatch();
+    disk_buffer_pool_->unpin_page(&page_handle);
+    return rc;
 }
 
 RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
@@ -1018,6 +1235,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    left_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&left_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1029,6 +1247,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    right_handle.wlatch();
 
     rc = disk_buffer_pool_->get_data(&right_handle, &pdata);
     if (rc != SUCCESS) {
@@ -1043,6 +1262,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    parent_handle.wlatch();
 
     rc = disk_buffer_pool_->get_data(&parent_handle, &pdata);
     if (rc != SUCCESS) {
@@ -1052,36 +1272,37 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
     parent = get_index_node(pdata);
 
     for (k = 0; k < parent->key_num; k++)
-        if ((parent->rids[k].page_num) == leaf_page) break;
+        if ((parent->rids(file_header_)[k].page_num) == leaf_page) break;
 
     start = left->key_num;
     if (left->is_leaf == false) {
-        memcpy(left->keys + start * file_header_.key_length,
-               parent->keys + k * file_header_.key_length,
+        memcpy(left->keys() + start * file_header_.key_length,
+               parent->keys() + k * file_header_.key_length,
                file_header_.key_length);
         start++;
         left->key_num++;
     }
     for (i = start, j = 0; j < right->key_num; i++, j++) {
-        memcpy(left->keys + i * file_header_.key_length,
-               right->keys + j * file_header_.key_length,
+        memcpy(left->keys() + i * file_header_.key_length,
+               right->keys() + j * file_header_.key_length,
                file_header_.key_length);
-        memcpy(left->rids + i, right->rids + j, sizeof(RID));
+        memcpy(left->rids(file_header_) + i, right->rids(file_header_) + j, sizeof(RID));
         left->key_num++;
     }
 
     if (left->is_leaf)
-        memcpy(left->rids + file_header_.order - 1,
-               right->rids + file_header_.order - 1, sizeof(RID));
+        memcpy(left->rids(file_header_) + file_header_.order - 1,
+               right->rids(file_header_) + file_header_.order - 1, sizeof(RID));
     else {
-        memcpy(left->rids + i, right->rids + j, sizeof(RID));
+        memcpy(left->rids(file_header_) + i, right->rids(file_header_) + j, sizeof(RID));
 
         for (i = start; i <= left->key_num; i++) {
             rc = disk_buffer_pool_->get_this_page(
-                file_id_, left->rids[i].page_num, &tmphandle);
+                file_id_, left->rids(file_header_)[i].page_num, &tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wlatch();
             rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
             if (rc != SUCCESS) {
                 return rc;
@@ -1093,6 +1314,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&tmphandle);
             if (rc != SUCCESS) {
                 return rc;
@@ -1106,7 +1328,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
                   file_header_.key_length);
         return RC::NOMEM;
     }
-    memcpy(tmp_key, parent->keys + k * file_header_.key_length,
+    memcpy(tmp_key, parent->keys() + k * file_header_.key_length,
            file_header_.key_length);
 
     rc = disk_buffer_pool_->mark_dirty(&left_handle);
@@ -1114,11 +1336,13 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
         free(tmp_key);
         return rc;
     }
+    left_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&left_handle);
     if (rc != SUCCESS) {
         free(tmp_key);
         return rc;
     }
+    right_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&right_handle);
     if (rc != SUCCESS) {
         free(tmp_key);
@@ -1130,6 +1354,7 @@ RC BplusTreeHandler::coalesce_node(PageNum leaf_page, PageNum right_page) {
         return rc;
     }
 
+    parent_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&parent_handle);
     if (rc != SUCCESS) {
         free(tmp_key);
@@ -1157,6 +1382,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    left_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&left_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1168,6 +1394,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    right_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&right_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1181,6 +1408,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    parent_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&parent_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1189,64 +1417,68 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     parent = get_index_node(pdata);
 
     for (k = 0; k < parent->key_num; k++)
-        if (parent->rids[k].page_num == leaf_page) break;
+        if (parent->rids(file_header_)[k].page_num == leaf_page) break;
     if (left->is_leaf) {
         min_key = file_header_.order / 2;
         if (left->key_num < min_key) {
-            memcpy(left->keys + left->key_num * file_header_.key_length,
-                   right->keys, file_header_.key_length);
-            memcpy(left->rids + left->key_num, right->rids, sizeof(RID));
+            memcpy(left->keys() + left->key_num * file_header_.key_length,
+                   right->keys(), file_header_.key_length);
+            memcpy(left->rids(file_header_) + left->key_num, right->rids(file_header_), sizeof(RID));
             left->key_num++;
 
             for (i = 0; i < right->key_num - 1; i++) {
-                memcpy(right->keys + i * file_header_.key_length,
-                       right->keys + (i + 1) * file_header_.key_length,
+                memcpy(right->keys() + i * file_header_.key_length,
+                       right->keys() + (i + 1) * file_header_.key_length,
                        file_header_.key_length);
-                memcpy(right->rids + i, right->rids + i + 1, sizeof(RID));
+                memcpy(right->rids(file_header_) + i, right->rids(file_header_) + i + 1, sizeof(RID));
             }
             right->key_num--;
-            memcpy(parent->keys + k * file_header_.key_length, right->keys,
+            memcpy(parent->keys() + k * file_header_.key_length, right->keys(),
                    file_header_.key_length);
         } else {
             for (i = right->key_num; i > 0; i--) {
-                memcpy(right->keys + i * file_header_.key_length,
-                       right->keys + (i - 1) * file_header_.key_length,
+                memcpy(right->keys() + i * file_header_.key_length,
+                       right->keys() + (i - 1) * file_header_.key_length,
                        file_header_.key_length);
-                memcpy(right->rids + i, right->rids + i - 1, sizeof(RID));
+                memcpy(right->rids(file_header_) + i, right->rids(file_header_) + i - 1, sizeof(RID));
             }
-            memcpy(right->keys,
-                   left->keys + (left->key_num - 1) * file_header_.key_length,
+            memcpy(right->keys(),
+                   left->keys() + (left->key_num - 1) * file_header_.key_length,
                    file_header_.key_length);
+            memcpy(right->rids(file_header_), left->rids(file_header_) + left->key_num - 1, sizeof(RID));
 
             left->key_num--;
             right->key_num++;
-            memcpy(parent->keys + k * file_header_.key_length, right->keys,
+            memcpy(parent->keys() + k * file_header_.key_length, right->keys(),
                    file_header_.key_length);
         }
     } else {
         min_key = (file_header_.order + 1) / 2 - 1;
         if (left->key_num < min_key) {
-            memcpy(left->keys + left->key_num * file_header_.key_length,
-                   parent->keys + k * file_header_.key_length,
+            memcpy(left->keys() + left->key_num * file_header_.key_length,
+                   parent->keys() + k * file_header_.key_length,
                    file_header_.key_length);
-            memcpy(left->rids + left->key_num + 1, right->rids, sizeof(RID));
+            memcpy(left->rids(file_header_) + left->key_num + 1, right->rids(file_header_), sizeof(RID));
             left->key_num++;
 
-            memcpy(parent->keys + k * file_header_.key_length, right->keys,
+            memcpy(parent->keys() + k * file_header_.key_length, right->keys(),
                    file_header_.key_length);
             for (i = 0; i < right->key_num - 1; i++) {
-                memcpy(right->keys + i * file_header_.key_length,
-                       right->keys + (i + 1) * file_header_.key_length,
+                memcpy(right->keys() + i * file_header_.key_length,
+                       right->keys() + (i + 1) * file_header_.key_length,
                        file_header_.key_length);
-                memcpy(right->rids + i, right->rids + i + 1, sizeof(RID));
+                memcpy(right->rids(file_header_) + i, right->rids(file_header_) + i + 1, sizeof(RID));
             }
+            // 内部节点的孩子比关键字多一个
+            memcpy(right->rids(file_header_) + i, right->rids(file_header_) + i + 1, sizeof(RID));
             right->key_num--;
 
             rc = disk_buffer_pool_->get_this_page(
-                file_id_, left->rids[left->key_num].page_num, &tmphandle);
+                file_id_, left->rids(file_header_)[left->key_num].page_num, &tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wlatch();
             rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
             if (rc != SUCCESS) {
                 return rc;
@@ -1257,32 +1489,36 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
         } else {
+            memcpy(right->rids(file_header_) + right->key_num + 1,
+                   right->rids(file_header_) + right->key_num, sizeof(RID));
             for (i = right->key_num; i > 0; i--) {
-                memcpy(right->keys + i * file_header_.key_length,
-                       right->keys + (i - 1) * file_header_.key_length,
+                memcpy(right->keys() + i * file_header_.key_length,
+                       right->keys() + (i - 1) * file_header_.key_length,
                        file_header_.key_length);
-                memcpy(right->rids + i, right->rids + i - 1, sizeof(RID));
+                memcpy(right->rids(file_header_) + i, right->rids(file_header_) + i - 1, sizeof(RID));
             }
-            memcpy(right->keys, parent->keys + k * file_header_.key_length,
+            memcpy(right->keys(), parent->keys() + k * file_header_.key_length,
                    file_header_.key_length);
-            memcpy(right->rids, left->rids + left->key_num, sizeof(RID));
+            memcpy(right->rids(file_header_), left->rids(file_header_) + left->key_num, sizeof(RID));
 
             right->key_num++;
-            memcpy(parent->keys + k * file_header_.key_length,
-                   left->keys + (left->key_num - 1) * file_header_.key_length,
+            memcpy(parent->keys() + k * file_header_.key_length,
+                   left->keys() + (left->key_num - 1) * file_header_.key_length,
                    file_header_.key_length);
             left->key_num--;
 
             rc = disk_buffer_pool_->get_this_page(
-                file_id_, right->rids[0].page_num, &tmphandle);
+                file_id_, right->rids(file_header_)[0].page_num, &tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wlatch();
             rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
             if (rc != SUCCESS) {
                 return rc;
@@ -1293,6 +1529,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&tmphandle);
             if (rc != SUCCESS) {
                 return rc;
@@ -1303,6 +1540,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    left_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&left_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -1313,6 +1551,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
         return rc;
     }
 
+    right_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&right_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -1322,6 +1561,7 @@ RC BplusTreeHandler::redistribute_nodes(PageNum leaf_page, PageNum right_page) {
     if (rc != SUCCESS) {
         return rc;
     }
+    parent_handle.wunlatch();
     rc = disk_buffer_pool_->unpin_page(&parent_handle);
     if (rc != SUCCESS) {
         return rc;
@@ -1347,6 +1587,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
     if (rc != SUCCESS) {
         return rc;
     }
+    page_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1356,10 +1597,11 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
     if (node->parent == -1) {
         if (node->key_num == 0 && node->is_leaf == false) {
             rc = disk_buffer_pool_->get_this_page(
-                file_id_, node->rids[0].page_num, &tmphandle);
+                file_id_, node->rids(file_header_)[0].page_num, &tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wlatch();
             rc = disk_buffer_pool_->get_data(&tmphandle, &pdata);
             if (rc != SUCCESS) {
                 return rc;
@@ -1370,14 +1612,16 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
             if (rc != SUCCESS) {
                 return rc;
             }
+            tmphandle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&tmphandle);
             if (rc != SUCCESS) {
                 return rc;
             }
 
-            file_header_.root_page = node->rids[0].page_num;
+            file_header_.root_page = node->rids(file_header_)[0].page_num;
             header_dirty_ = true;
 
+            page_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&page_handle);
             if (rc != SUCCESS) {
                 return rc;
@@ -1389,6 +1633,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
             return SUCCESS;
         }
 
+        page_handle.wunlatch();
         rc = disk_buffer_pool_->unpin_page(&page_handle);
         if (rc != SUCCESS) {
             return rc;
@@ -1402,6 +1647,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
         min_key = (file_header_.order + 1) / 2 - 1;
 
     if (node->key_num >= min_key) {
+        page_handle.wunlatch();
         rc = disk_buffer_pool_->unpin_page(&page_handle);
         if (rc != SUCCESS) {
             return rc;
@@ -1414,6 +1660,7 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
     if (rc != SUCCESS) {
         return rc;
     }
+    parent_handle.wlatch();
     rc = disk_buffer_pool_->get_data(&parent_handle, &pdata);
     if (rc != SUCCESS) {
         return rc;
@@ -1423,18 +1670,19 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
 
     delete_index = 0;
     while (delete_index <= parent->key_num) {
-        if ((parent->rids[delete_index].page_num) == page_num) break;
+        if ((parent->rids(file_header_)[delete_index].page_num) == page_num) break;
         delete_index++;
     }
 
     if (delete_index == 0) {
         leaf_page = page_num;
-        right_page = parent->rids[delete_index + 1].page_num;
+        right_page = parent->rids(file_header_)[delete_index + 1].page_num;
         rc = disk_buffer_pool_->get_this_page(file_id_, right_page,
                                               &right_handle);
         if (rc != SUCCESS) {
             return rc;
         }
+        right_handle.wlatch();
         rc = disk_buffer_pool_->get_data(&right_handle, &pdata);
         if (rc != SUCCESS) {
             return rc;
@@ -1442,28 +1690,34 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
         right = (IndexNode *)(pdata + sizeof(IndexFileHeader));
 
         if (right->key_num > min_key) {
+            page_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&page_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            parent_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&parent_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            right_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&right_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
             return redistribute_nodes(page_num, right_page);
         } else {
+            page_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&page_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            parent_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&parent_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            right_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&right_handle);
             if (rc != SUCCESS) {
                 return rc;
@@ -1471,12 +1725,13 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
             return coalesce_node(page_num, right_page);
         }
     } else {
-        leaf_page = parent->rids[delete_index - 1].page_num;
+        leaf_page = parent->rids(file_header_)[delete_index - 1].page_num;
         rc =
             disk_buffer_pool_->get_this_page(file_id_, leaf_page, &left_handle);
         if (rc != SUCCESS) {
             return rc;
         }
+        left_handle.wlatch();
         rc = disk_buffer_pool_->get_data(&left_handle, &pdata);
         if (rc != SUCCESS) {
             return rc;
@@ -1484,28 +1739,34 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
         left = (IndexNode *)(pdata + sizeof(IndexFileHeader));
 
         if (left->key_num > min_key) {
+            page_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&page_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            parent_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&parent_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            left_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&left_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
             return redistribute_nodes(leaf_page, page_num);
         } else {
+            page_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&page_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            parent_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&parent_handle);
             if (rc != SUCCESS) {
                 return rc;
             }
+            left_handle.wunlatch();
             rc = disk_buffer_pool_->unpin_page(&left_handle);
             if (rc != SUCCESS) {
                 return rc;
@@ -1517,8 +1778,8 @@ RC BplusTreeHandler::delete_entry_internal(PageNum page_num, const char *pkey) {
 
 RC BplusTreeHandler::delete_entry(const char *data, const RID *rid) {
     RC rc;
-    PageNum leaf_page;
-    char *pkey;
+    BPPageHandle page_handle;
+    char *pkey, *pdata;
     pkey = (char *)malloc(file_header_.key_length);
     if (nullptr == pkey) {
         LOG_ERROR("Failed to alloc memory for key. size=%d",
@@ -1528,18 +1789,41 @@ RC BplusTreeHandler::delete_entry(const char *data, const RID *rid) {
     memcpy(pkey, data, file_header_.attr_length);
     memcpy(pkey + file_header_.attr_length, rid, sizeof(*rid));
 
-    rc = find_leaf(pkey, &leaf_page);
-    if (rc != SUCCESS) {
-        free(pkey);
-        return rc;
+    // 删除之后叶子节点不会过少时只加树的读锁
+    pthread_rwlock_rdlock(&tree_latch_);
+    rc = crab_to_leaf(pkey, true, &page_handle);
+    bool done = rc != SUCCESS;
+    if (rc == SUCCESS) {
+        disk_buffer_pool_->get_data(&page_handle, &pdata);
+        IndexNode *leaf = get_index_node(pdata);
+        if (leaf->parent == -1 || leaf->key_num > file_header_.order / 2) {
+            rc = delete_from_node(leaf, pkey);
+            if (rc == SUCCESS) {
+                disk_buffer_pool_->mark_dirty(&page_handle);
+            }
+            done = true;
+        }
+        page_handle.wunlatch();
+        disk_buffer_pool_->unpin_page(&page_handle);
+    }
+    pthread_rwlock_unlock(&tree_latch_);
+
+    if (!done) {
+        pthread_rwlock_wrlock(&tree_latch_);
+        rc = delete_entry_exclusive(pkey);
+        pthread_rwlock_unlock(&tree_latch_);
     }
-    rc = delete_entry_internal(leaf_page, pkey);
+    free(pkey);
+    return rc;
+}
+
+RC BplusTreeHandler::delete_entry_exclusive(const char *pkey) {
+    PageNum leaf_page;
+    RC rc = find_leaf(pkey, &leaf_page);
     if (rc != SUCCESS) {
-        free(pkey);
         return rc;
     }
-    free(pkey);
-    return SUCCESS;
+    return delete_entry_internal(leaf_page, pkey);
 }
 
 RC BplusTreeHandler::print_tree() {
@@ -1563,7 +1847,7 @@ RC BplusTreeHandler::print_tree() {
     node = get_index_node(pdata);
 
     while (!node->is_leaf) {
-        page_num = node->rids[0].page_num;
+        page_num = node->rids(file_header_)[0].page_num;
         rc = disk_buffer_pool_->unpin_page(&page_handle);
         if (rc != SUCCESS) {
             return rc;
@@ -1577,23 +1861,20 @@ RC BplusTreeHandler::print_tree() {
             return rc;
         }
         node = (IndexNode *)(pdata + sizeof(IndexFileHeader));
-        node->keys = (char *)node + sizeof(IndexNode);
-        node->rids =
-            (RID *)(node->keys + file_header_.order * file_header_.key_length);
     }
     page_num = 1;
     while (page_num != 0) {
         for (i = 0; i < node->key_num; i++) {
-            pkey = node->keys + i * file_header_.key_length;
+            pkey = node->keys() + i * file_header_.key_length;
             printf("key : %d,rids (page_num:%d slotnum %d)\n", *(int *)pkey,
-                   node->rids[i].page_num, node->rids[i].slot_num);
+                   node->rids(file_header_)[i].page_num, node->rids(file_header_)[i].slot_num);
         }
         printf("next node:%d\n", page_num);
         rc = disk_buffer_pool_->unpin_page(&page_handle);
         if (rc != SUCCESS) {
             return rc;
         }
-        page_num = node->rids[file_header_.order - 1].page_num;
+        page_num = node->rids(file_header_)[file_header_.order - 1].page_num;
         if (page_num == 0) break;
         rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
         if (rc != SUCCESS) {
@@ -1613,178 +1894,135 @@ RC BplusTreeHandler::print_tree() {
     return SUCCESS;
 }
 
-RC BplusTreeHandler::find_first_index_satisfied(CompOp compop, const char *key,
+RC BplusTreeHandler::find_first_index_satisfied(const char *key, int attr_num,
+                                                bool inclusive,
                                                 PageNum *page_num,
                                                 int *rididx) {
     BPPageHandle page_handle;
     IndexNode *node;
-    PageNum leaf_page, next;
-    char *pdata, *pkey;
+    PageNum next;
+    char *pdata;
     RC rc;
-    int i, tmp;
-    RID rid;
-    if (compop == LESS_THAN || compop == LESS_EQUAL || compop == NOT_EQUAL ||
-        compop == IS_NULL || compop == NOT_NULL) {
-        rc = get_first_leaf_page(page_num);
-        if (rc != SUCCESS) {
-            return rc;
-        }
-        *rididx = 0;
-        return SUCCESS;
-    }
-    rid.page_num = -1;
-    rid.slot_num = -1;
-    pkey = (char *)malloc(file_header_.key_length);
-    if (pkey == nullptr) {
-        LOG_ERROR("Failed to alloc memory for key. size=%d",
-                  file_header_.key_length);
-        return RC::NOMEM;
-    }
-    memcpy(pkey, key, file_header_.attr_length);
-    memcpy(pkey + file_header_.attr_length, &rid, sizeof(RID));
+    int i;
 
-    rc = find_leaf(pkey, &leaf_page);
+    rc = crab_to_leaf(attr_num > 0 ? key : nullptr, false, &page_handle,
+                      attr_num);
     if (rc != SUCCESS) {
-        free(pkey);
         return rc;
     }
-    free(pkey);
-
-    next = leaf_page;
+    if (attr_num == 0) {
+        disk_buffer_pool_->get_page_num(&page_handle, page_num);
+        *rididx = 0;
+        page_handle.runlatch();
+        disk_buffer_pool_->unpin_page(&page_handle);
+        return SUCCESS;
+    }
 
-    while (next > 0) {
-        rc = disk_buffer_pool_->get_this_page(file_id_, next, &page_handle);
-        if (rc != SUCCESS) {
-            return rc;
+    while (true) {
+        disk_buffer_pool_->get_data(&page_handle, &pdata);
+        node = get_index_node(pdata);
+        i = search_node(file_header_, node, key, attr_num, !inclusive);
+        if (i < node->key_num) {
+            disk_buffer_pool_->get_page_num(&page_handle, page_num);
+            *rididx = i;
+            page_handle.runlatch();
+            disk_buffer_pool_->unpin_page(&page_handle);
+            return SUCCESS;
         }
-        rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+        next = node->rids(file_header_)[file_header_.order - 1].page_num;
+        if (next <= 0) {
+            break;
+        }
+        // 沿着叶子节点从左向右加锁，和其它线程的加锁顺序一致
+        BPPageHandle next_handle;
+        rc = disk_buffer_pool_->get_this_page(file_id_, next, &next_handle);
         if (rc != SUCCESS) {
+            page_handle.runlatch();
+            disk_buffer_pool_->unpin_page(&page_handle);
             return rc;
         }
-
-        node = get_index_node(pdata);
-        for (i = 0; i < node->key_num; i++) {
-            tmp = CompareKey(node->keys + i * file_header_.key_length, key,
-                             file_header_.attr_type, file_header_.attr_length);
-            if (compop == EQUAL_TO || compop == GREAT_EQUAL) {
-                if (tmp >= 0) {
-                    rc =
-                        disk_buffer_pool_->get_page_num(&page_handle, page_num);
-                    if (rc != SUCCESS) {
-                        return rc;
-                    }
-                    *rididx = i;
-                    rc = disk_buffer_pool_->unpin_page(&page_handle);
-                    if (rc != SUCCESS) {
-                        return rc;
-                    }
-                    return SUCCESS;
-                }
-            }
-            if (compop == GREAT_THAN) {
-                if (tmp > 0) {
-                    rc =
-                        disk_buffer_pool_->get_page_num(&page_handle, page_num);
-                    if (rc != SUCCESS) {
-                        return rc;
-                    }
-                    *rididx = i;
-                    rc = disk_buffer_pool_->unpin_page(&page_handle);
-                    if (rc != SUCCESS) {
-                        return rc;
-                    }
-                    return SUCCESS;
-                }
-            }
-        }
-        next = node->rids[file_header_.order - 1].page_num;
-    }
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if (rc != SUCCESS) {
-        return rc;
+        next_handle.rlatch();
+        page_handle.runlatch();
+        disk_buffer_pool_->unpin_page(&page_handle);
+        page_handle = next_handle;
     }
+    page_handle.runlatch();
+    disk_buffer_pool_->unpin_page(&page_handle);
     return RC::RECORD_EOF;
 }
 
 RC BplusTreeHandler::get_first_leaf_page(PageNum *leaf_page) {
-    RC rc;
     BPPageHandle page_handle;
-    PageNum page_num;
-    IndexNode *node;
-    char *pdata;
-
-    rc = disk_buffer_pool_->get_this_page(file_id_, file_header_.root_page,
-                                          &page_handle);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-    rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
+    RC rc = crab_to_leaf(nullptr, false, &page_handle);
     if (rc != SUCCESS) {
         return rc;
     }
+    disk_buffer_pool_->get_page_num(&page_handle, leaf_page);
+    page_handle.runlatch();
+    return disk_buffer_pool_->unpin_page(&page_handle);
+}
 
-    node = get_index_node(pdata);
+BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &index_handler)
+    : index_handler_(index_handler) {}
 
-    while (node->is_leaf == false) {
-        page_num = node->rids[0].page_num;
-        rc = disk_buffer_pool_->unpin_page(&page_handle);
-        if (rc != SUCCESS) {
-            return rc;
-        }
+RC BplusTreeScanner::open(CompOp comp_op, const char *value, int attr_num) {
+    const int total_attr_num = index_handler_.file_header_.attr_num;
+    if (attr_num <= 0 || attr_num > total_attr_num) {
+        attr_num = total_attr_num;
+    }
 
-        rc = disk_buffer_pool_->get_this_page(file_id_, page_num, &page_handle);
-        if (rc != SUCCESS) {
-            return rc;
-        }
-        rc = disk_buffer_pool_->get_data(&page_handle, &pdata);
-        if (rc != SUCCESS) {
+    // 前attr_num-1列相等，转换成最后一列的范围
+    switch (comp_op) {
+        case EQUAL_TO:
+            return open(value, attr_num, true, value, attr_num, true);
+        case GREAT_EQUAL:
+        case GREAT_THAN:
+            return open(value, attr_num, comp_op == GREAT_EQUAL, value,
+                        attr_num - 1, true);
+        case LESS_EQUAL:
+        case LESS_THAN:
+            return open(value, attr_num - 1, true, value, attr_num,
+                        comp_op == LESS_EQUAL);
+        case NOT_EQUAL: {
+            RC rc = open(value, attr_num - 1, true, value, attr_num - 1, true);
+            if (rc == SUCCESS) {
+                excluded_key_.assign(
+                    value,
+                    value + prefix_length(index_handler_.file_header_,
+                                          attr_num));
+                excluded_attr_num_ = attr_num;
+            }
             return rc;
         }
-
-        node = get_index_node(pdata);
-    }
-    rc = disk_buffer_pool_->get_page_num(&page_handle, leaf_page);
-    if (rc != SUCCESS) {
-        return rc;
-    }
-    rc = disk_buffer_pool_->unpin_page(&page_handle);
-    if (rc != SUCCESS) {
-        return rc;
+        default:
+            return open(nullptr, 0, true, nullptr, 0, true);
     }
-    return SUCCESS;
 }
 
-BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &index_handler)
-    : index_handler_(index_handler) {}
-
-RC BplusTreeScanner::open(CompOp comp_op, const char *value) {
-    RC rc;
+RC BplusTreeScanner::open(const char *left_key, int left_attr_num,
+                          bool left_inclusive, const char *right_key,
+                          int right_attr_num, bool right_inclusive) {
     if (opened_) {
         return RC::RECORD_OPENNED;
     }
 
-    comp_op_ = comp_op;
-
-    char *value_copy = (char *)malloc(index_handler_.file_header_.attr_length);
-    if (value_copy == nullptr) {
-        LOG_ERROR("Failed to alloc memory for value. size=%d",
-                  index_handler_.file_header_.attr_length);
-        return RC::NOMEM;
-    }
-    memcpy(value_copy, value, index_handler_.file_header_.attr_length);
-    value_ = value_copy;  // free value_
-    rc = index_handler_.find_first_index_satisfied(
-        comp_op, value, &next_page_num_, &index_in_node_);
-    if (rc != SUCCESS) {
-        if (rc == RC::RECORD_EOF) {
-            next_page_num_ = -1;
-            index_in_node_ = -1;
-        } else
-            return rc;
-    }
-    num_fixed_pages_ = 1;
-    next_index_of_page_handle_ = 0;
-    pinned_page_count_ = 0;
+    const IndexFileHeader &file_header = index_handler_.file_header_;
+    left_attr_num_ = left_key != nullptr ? left_attr_num : 0;
+    left_inclusive_ = left_inclusive;
+    left_key_.assign(left_key,
+                     left_key + prefix_length(file_header, left_attr_num_));
+    right_attr_num_ = right_key != nullptr ? right_attr_num : 0;
+    right_inclusive_ = right_inclusive;
+    right_key_.assign(right_key,
+                      right_key + prefix_length(file_header, right_attr_num_));
+    excluded_key_.clear();
+    excluded_attr_num_ = 0;
+
+    // 第一次调用next_entry时才定位到第一个满足条件的项
+    eof_ = false;
+    page_num_ = -1;
+    index_in_node_ = -1;
+    last_key_.clear();
     opened_ = true;
     return SUCCESS;
 }
@@ -1793,239 +2031,180 @@ RC BplusTreeScanner::close() {
     if (!opened_) {
         return RC::RECORD_SCANCLOSED;
     }
-    free((void *)value_);
-    value_ = nullptr;
     opened_ = false;
     return RC::SUCCESS;
 }
 
 RC BplusTreeScanner::next_entry(RID *rid) {
-    RC rc;
     if (!opened_) {
         return RC::RECORD_CLOSED;
     }
-    rc = get_next_idx_in_memory(
-        rid);  //和RM中一样，有可能有错误，一次只查当前页和当前页的下一页，有待确定
-    if (rc == RC::RECORD_NO_MORE_IDX_IN_MEM) {
-        rc = find_idx_pages();
-        if (rc != SUCCESS) {
-            return rc;
+    if (eof_) {
+        return RC::RECORD_EOF;
+    }
+
+    DiskBufferPool *disk_buffer_pool = index_handler_.disk_buffer_pool_;
+    pthread_rwlock_rdlock(&index_handler_.tree_latch_);
+    // 上次返回之后其它线程可能修改过树，只有第一个叶子需要检查位置是否还有效
+    bool verify = !last_key_.empty();
+    RC rc = verify ? RC::SUCCESS : locate();
+    while (rc == SUCCESS && page_num_ > 0) {
+        BPPageHandle page_handle;
+        rc = disk_buffer_pool->get_this_page(index_handler_.file_id_, page_num_,
+                                             &page_handle);
+        if (verify && rc == RC::BUFFERPOOL_INVALID_PAGE_NUM) {
+            // 叶子节点合并之后已经被释放了
+            verify = false;
+            rc = locate();
+            continue;
         }
-        return get_next_idx_in_memory(rid);
-    } else {
         if (rc != SUCCESS) {
-            return rc;
+            break;
+        }
+        bool moved = false;
+        rc = next_in_leaf(page_handle, verify, &moved, rid);
+        disk_buffer_pool->unpin_page(&page_handle);
+        verify = false;
+        if (moved) {
+            rc = locate();
+        } else if (rc == RC::RECORD_NO_MORE_IDX_IN_MEM) {
+            rc = SUCCESS;
+        } else {
+            break;
         }
     }
-    return SUCCESS;
-}
+    pthread_rwlock_unlock(&index_handler_.tree_latch_);
 
-RC BplusTreeScanner::find_idx_pages() {
-    RC rc;
-    if (!opened_) {
-        return RC::RECORD_CLOSED;
+    if (rc == SUCCESS && page_num_ <= 0) {
+        rc = RC::RECORD_EOF;
     }
-    if (pinned_page_count_ > 0) {
-        for (int i = 0; i < pinned_page_count_; i++) {
-            rc =
-                index_handler_.disk_buffer_pool_->unpin_page(page_handles_ + i);
-            if (rc != SUCCESS) {
-                return rc;
-            }
-        }
+    if (rc == RC::RECORD_EOF) {
+        eof_ = true;
     }
-    next_index_of_page_handle_ = 0;
-    pinned_page_count_ = 0;
+    return rc;
+}
 
-    for (int i = 0; i < num_fixed_pages_; i++) {
-        if (next_page_num_ <= 0) break;
-        rc = index_handler_.disk_buffer_pool_->get_this_page(
-            index_handler_.file_id_, next_page_num_, page_handles_ + i);
-        if (rc != SUCCESS) {
-            return rc;
-        }
-        char *pdata;
-        rc = index_handler_.disk_buffer_pool_->get_data(page_handles_ + i,
-                                                        &pdata);
-        if (rc != SUCCESS) {
-            return rc;
+// 没有返回过任何项时从下界开始找，否则从根节点重新找到最后返回的项的位置
+RC BplusTreeScanner::locate() {
+    if (last_key_.empty()) {
+        RC rc = index_handler_.find_first_index_satisfied(
+            left_key_.data(), left_attr_num_, left_inclusive_, &page_num_,
+            &index_in_node_);
+        if (rc == RC::RECORD_EOF) {
+            page_num_ = -1;
+            return SUCCESS;
         }
+        return rc;
+    }
 
-        IndexNode *node = index_handler_.get_index_node(pdata);
-        pinned_page_count_++;
-        next_page_num_ =
-            node->rids[index_handler_.file_header_.order - 1].page_num;
+    // 叶子内的位置由next_in_leaf加latch之后再查找
+    BPPageHandle page_handle;
+    RC rc = index_handler_.crab_to_leaf(last_key_.data(), false, &page_handle);
+    if (rc != SUCCESS) {
+        return rc;
     }
-    if (pinned_page_count_ > 0) return SUCCESS;
-    return RC::RECORD_EOF;
+    index_handler_.disk_buffer_pool_->get_page_num(&page_handle, &page_num_);
+    index_in_node_ = 0;
+    page_handle.runlatch();
+    return index_handler_.disk_buffer_pool_->unpin_page(&page_handle);
 }
 
-RC BplusTreeScanner::get_next_idx_in_memory(RID *rid) {
+/**
+ * 在page_handle对应的叶子上找满足条件的项。
+ * 这个叶子上没有了时把page_num_移到兄弟节点，返回RECORD_NO_MORE_IDX_IN_MEM。
+ * verify为true时从index_in_node_继续，叶子上次返回之后变化过时设置moved，需要重新定位；
+ * 否则是本次调用中刚进入这个叶子，在叶子内重新查找开始的位置
+ */
+RC BplusTreeScanner::next_in_leaf(BPPageHandle &page_handle, bool verify,
+                                  bool *moved, RID *rid) {
+    const IndexFileHeader &file_header = index_handler_.file_header_;
+    const int key_length = file_header.key_length;
     char *pdata;
-    IndexNode *node;
-    RC rc;
-    if (next_index_of_page_handle_ >= pinned_page_count_) {
-        return RC::RECORD_NO_MORE_IDX_IN_MEM;
+    RC rc = index_handler_.disk_buffer_pool_->get_data(&page_handle, &pdata);
+    if (rc != SUCCESS) {
+        LOG_ERROR("Failed to get data from disk buffer pool. rc=%s", strrc(rc));
+        return rc;
     }
 
-    if (next_page_num_ == -1 && index_in_node_ == -1) {
-        return RC::RECORD_EOF;
+    page_handle.rlatch();
+    IndexNode *node = index_handler_.get_index_node(pdata);
+    if (verify &&
+        (!node->is_leaf || index_in_node_ <= 0 ||
+         index_in_node_ > node->key_num ||
+         CmpKey(file_header, node->keys() + (index_in_node_ - 1) * key_length,
+                last_key_.data()) != 0)) {
+        page_handle.runlatch();
+        *moved = true;
+        return SUCCESS;
     }
 
-    for (; next_index_of_page_handle_ < pinned_page_count_;
-         next_index_of_page_handle_++) {
-        rc = index_handler_.disk_buffer_pool_->get_data(
-            page_handles_ + next_index_of_page_handle_, &pdata);
-        if (rc != SUCCESS) {
-            LOG_ERROR("Failed to get data from disk buffer pool. rc=%s", strrc);
-            return rc;
+    PageNum next_page_num = node->rids(file_header)[file_header.order - 1].page_num;
+    if (!verify) {
+        // 持有树的读锁期间叶子不会分裂合并，但是加latch之前其它线程可能插入删除过，
+        // 之前得到的下标不可靠
+        if (!last_key_.empty()) {
+            index_in_node_ =
+                search_node(file_header, node, last_key_.data(), 0, true);
+        } else if (left_attr_num_ > 0) {
+            index_in_node_ = search_node(file_header, node, left_key_.data(),
+                                         left_attr_num_, !left_inclusive_);
+        } else {
+            index_in_node_ = 0;
         }
-
-        node = index_handler_.get_index_node(pdata);
-        for (; index_in_node_ < node->key_num; index_in_node_++) {
-            if (satisfy_condition(node->keys +
-                                  index_in_node_ *
-                                      index_handler_.file_header_.key_length)) {
-                memcpy(rid, node->rids + index_in_node_, sizeof(RID));
-                index_in_node_++;
-                return SUCCESS;
-            }
+        if (next_page_num > 0) {
+            // 叶子节点的页号不连续，刚进入一个叶子时按兄弟指针预读下一个叶子
+            index_handler_.disk_buffer_pool_->prefetch_page(
+                index_handler_.file_id_, next_page_num);
         }
-
-        index_in_node_ = 0;
     }
+    for (; index_in_node_ < node->key_num; index_in_node_++) {
+        const char *key = node->keys() + index_in_node_ * key_length;
+        if (satisfy_condition(key)) {
+            memcpy(rid, node->rids(file_header) + index_in_node_, sizeof(RID));
+            last_key_.assign(key, key + key_length);
+            index_in_node_++;
+            page_handle.runlatch();
+            return SUCCESS;
+        }
+        if (beyond_range(key)) {
+            page_handle.runlatch();
+            return RC::RECORD_EOF;
+        }
+    }
+    // 兄弟指针是持有latch期间读到的，这个叶子分裂出来的兄弟节点不会被跳过
+    page_handle.runlatch();
+    page_num_ = next_page_num;
+    index_in_node_ = 0;
     return RC::RECORD_NO_MORE_IDX_IN_MEM;
 }
-bool BplusTreeScanner::satisfy_condition(const char *pkey) {
-    int i1 = 0, i2 = 0;
-    float f1 = 0, f2 = 0;
-    const char *s1 = nullptr, *s2 = nullptr;
 
-    if (comp_op_ == NO_OP) {
-        return true;
+bool BplusTreeScanner::satisfy_condition(const char *pkey) {
+    const IndexFileHeader &file_header = index_handler_.file_header_;
+    if (left_attr_num_ > 0) {
+        int result =
+            compare_attrs(file_header, pkey, left_key_.data(), left_attr_num_);
+        if (result < 0 || (result == 0 && !left_inclusive_)) {
+            return false;
+        }
     }
-
-    AttrType attr_type = index_handler_.file_header_.attr_type;
-    switch (attr_type) {
-        case INTS:
-            i1 = *(int *)pkey;
-            i2 = *(int *)value_;
-            break;
-        case FLOATS:
-            f1 = *(float *)pkey;
-            f2 = *(float *)value_;
-            break;
-        case DATES:
-        case CHARS:
-            s1 = pkey;
-            s2 = value_;
-            break;
-        default:
-            LOG_PANIC("Unknown attr type: %d", attr_type);
+    if (right_attr_num_ > 0) {
+        int result = compare_attrs(file_header, pkey, right_key_.data(),
+                                   right_attr_num_);
+        if (result > 0 || (result == 0 && !right_inclusive_)) {
+            return false;
+        }
     }
+    return excluded_attr_num_ == 0 ||
+           compare_attrs(file_header, pkey, excluded_key_.data(),
+                         excluded_attr_num_) != 0;
+}
 
-    bool flag = false;
-
-    int attr_length = index_handler_.file_header_.attr_length;
-    switch (comp_op_) {
-        case EQUAL_TO:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 == i2);
-                    break;
-                case FLOATS:
-                    flag = 0 == float_compare(f1, f2);
-                    break;
-                case DATES:
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) == 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        case LESS_THAN:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 < i2);
-                    break;
-                case FLOATS:
-                    flag = (f1 < f2);
-                    break;
-                case DATES:
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) < 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        case GREAT_THAN:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 > i2);
-                    break;
-                case FLOATS:
-                    flag = (f1 > f2);
-                    break;
-                case DATES:
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) > 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        case LESS_EQUAL:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 <= i2);
-                    break;
-                case DATES:
-                case FLOATS:
-                    flag = (f1 <= f2);
-                    break;
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) <= 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        case GREAT_EQUAL:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 >= i2);
-                    break;
-                case DATES:
-                case FLOATS:
-                    flag = (f1 >= f2);
-                    break;
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) >= 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        case NOT_EQUAL:
-            switch (attr_type) {
-                case INTS:
-                    flag = (i1 != i2);
-                    break;
-                case DATES:
-                case FLOATS:
-                    flag = 0 != float_compare(f1, f2);
-                    break;
-                case CHARS:
-                    flag = (strncmp(s1, s2, attr_length) != 0);
-                    break;
-                default:
-                    LOG_PANIC("Unknown attr type: %d", attr_type);
-            }
-            break;
-        default:
-            LOG_PANIC("Unknown comp op: %d", comp_op_);
+// 超过上界之后，后面的项都不会满足条件
+bool BplusTreeScanner::beyond_range(const char *pkey) {
+    if (right_attr_num_ == 0) {
+        return false;
     }
-    return flag;
+    int result = compare_attrs(index_handler_.file_header_, pkey,
+                               right_key_.data(), right_attr_num_);
+    return result > 0 || (result == 0 && !right_inclusive_);
 }
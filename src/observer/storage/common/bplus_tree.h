@@ -13,25 +13,41 @@ See the Mulan PSL v2 for more details. */
 #ifndef __OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
 #define __OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
 
+#include <pthread.h>
+
 #include "record_manager.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/default/disk_buffer_pool.h"
 
 struct IndexFileHeader {
-    int attr_length;
+    int attr_length;  // 所有列的总长度
     int key_length;
-    AttrType attr_type;
+    AttrType attr_type;  // 第一列的类型
     PageNum root_page;  // 初始时，root_page一定是1
     int node_num;
     int order;
+    int attr_num;  // 多列索引的列数，key是各列的值按顺序拼接起来的
+    AttrType attr_types[MAX_NUM];
+    int attr_lengths[MAX_NUM];
 };
 
 struct IndexNode {
     int is_leaf;
     int key_num;
     PageNum parent;
-    char *keys;
-    RID *rids;
+    // 以前在这里保存keys和rids的指针，保留位置，已有的索引文件格式不变。
+    // 指针随页面所在的帧变化，只加读锁时也不能写页面，所以改成每次计算
+    char *unused_keys;
+    RID *unused_rids;
+
+    char *keys() { return (char *)this + sizeof(IndexNode); }
+    const char *keys() const { return (const char *)this + sizeof(IndexNode); }
+    RID *rids(const IndexFileHeader &header) {
+        return (RID *)(keys() + header.order * header.key_length);
+    }
+    const RID *rids(const IndexFileHeader &header) const {
+        return (const RID *)(keys() + header.order * header.key_length);
+    }
 };
 
 struct TreeNode {
@@ -49,20 +65,35 @@ struct Tree {
     TreeNode *root;
 };
 
+/**
+ * B+树的并发控制：
+ * 树的读锁(tree_latch_)下节点只会增删叶子节点中的项，不会分裂、合并，也不会更换根节点。
+ * 查找、扫描和不会让叶子节点分裂或者过少的插入、删除只加树的读锁，从根节点向下加页面的latch，
+ * 锁住子节点之后再释放父节点(latch crabbing)，读操作对叶子节点加读锁，写操作对叶子节点加写锁。
+ * 需要分裂或者合并节点时释放所有的latch，加树的写锁之后重新执行，修改的页面同样要加写锁，
+ * 防止后台刷盘写出修改了一半的页面
+ */
 class BplusTreeHandler {
 public:
     /**
      * 此函数创建一个名为fileName的索引。
      * attrType描述被索引属性的类型，attrLength描述被索引属性的长度
+     * buffer_pool为nullptr时使用全局缓冲池
      */
-    RC create(const char *file_name, AttrType attr_type, int attr_length);
+    RC create(const char *file_name, AttrType attr_type, int attr_length,
+              DiskBufferPool *buffer_pool = nullptr);
+    /**
+     * 创建attr_num列的多列索引，key按照列的顺序依次比较
+     */
+    RC create(const char *file_name, int attr_num, const AttrType attr_types[],
+              const int attr_lengths[], DiskBufferPool *buffer_pool = nullptr);
 
     /**
      * 打开名为fileName的索引文件。
      * 如果方法调用成功，则indexHandle为指向被打开的索引句柄的指针。
      * 索引句柄用于在索引中插入或删除索引项，也可用于索引的扫描
      */
-    RC open(const char *file_name);
+    RC open(const char *file_name, DiskBufferPool *buffer_pool = nullptr);
 
     /**
      * 关闭句柄indexHandle对应的索引文件
@@ -92,11 +123,31 @@ public:
 
 public:
     BplusTreeHandler(bool is_unique);
+    ~BplusTreeHandler();
     bool is_unique() const { return is_unique_; }
     RC print();
     RC print_tree();
 
 protected:
+    /**
+     * 从根节点向下找到pkey所在的叶子节点，pkey为nullptr时找最左边的叶子节点。
+     * attr_num大于0时pkey只有前attr_num列，找可能包含前缀不小于pkey的项的最左边的叶子节点。
+     * 返回时叶子节点被pin住并且加了latch，exclusive时是写锁，否则是读锁。
+     * 调用者要持有树的读锁
+     */
+    RC crab_to_leaf(const char *pkey, bool exclusive, BPPageHandle *leaf_handle,
+                    int attr_num = 0);
+    /**
+     * 在加了写锁并且没有满的叶子节点中插入/删除一项
+     */
+    RC insert_into_node(IndexNode *leaf, const char *pkey, const RID *rid);
+    RC delete_from_node(IndexNode *node, const char *pkey);
+    /**
+     * 持有树的写锁时插入/删除，可能分裂或者合并节点
+     */
+    RC insert_entry_exclusive(const char *pkey, const RID *rid);
+    RC delete_entry_exclusive(const char *pkey);
+
     RC find_leaf(const char *pkey, PageNum *leaf_page);
     RC insert_into_leaf(PageNum leaf_page, const char *pkey, const RID *rid);
     RC insert_into_leaf_after_split(PageNum leaf_page, const char *pkey,
@@ -115,8 +166,13 @@ protected:
     RC coalesce_node(PageNum leaf_page, PageNum right_page);
     RC redistribute_nodes(PageNum left_page, PageNum right_page);
 
-    RC find_first_index_satisfied(CompOp comp_op, const char *pkey,
-                                  PageNum *page_num, int *rididx);
+    /**
+     * 找到前attr_num列不小于pkey的第一项，inclusive为false时要大于pkey。
+     * attr_num为0时从第一项开始
+     */
+    RC find_first_index_satisfied(const char *pkey, int attr_num,
+                                  bool inclusive, PageNum *page_num,
+                                  int *rididx);
     RC get_first_leaf_page(PageNum *leaf_page);
 
 private:
@@ -128,6 +184,7 @@ private:
     bool header_dirty_ = false;
     bool is_unique_ = false;
     IndexFileHeader file_header_;
+    pthread_rwlock_t tree_latch_;
 
 private:
     friend class BplusTreeScanner;
@@ -140,13 +197,25 @@ public:
     /**
      * 用于在indexHandle对应的索引上初始化一个基于条件的扫描。
      * compOp和*value指定比较符和比较值，indexScan为初始化后的索引扫描结构指针
-     * 没有带两个边界的范围扫描
+     * value是前attr_num列的值，前attr_num-1列相等、第attr_num列满足compOp的项才返回，
+     * attr_num为0时比较所有列
+     */
+    RC open(CompOp comp_op, const char *value, int attr_num = 0);
+
+    /**
+     * 范围扫描，返回前left_attr_num列不小于left_key并且前right_attr_num列不大于right_key的项，
+     * inclusive为false时不包含与边界相等的项。
+     * attr_num为0时这一边没有边界，超过上界之后扫描直接结束
      */
-    RC open(CompOp comp_op, const char *value);
+    RC open(const char *left_key, int left_attr_num, bool left_inclusive,
+            const char *right_key, int right_attr_num, bool right_inclusive);
 
     /**
      * 用于继续索引扫描，获得下一个满足条件的索引项，
-     * 并返回该索引项对应的记录的ID
+     * 并返回该索引项对应的记录的ID。
+     * 每次调用只固定一个叶子页面，返回之前就释放，两次调用之间不持有任何页面和latch，
+     * 其它线程可以修改、合并扫描中的叶子节点。叶子节点变化之后按最后返回的key重新定位，
+     * 不会重复返回已经返回过的项
      */
     RC next_entry(RID *rid);
 
@@ -162,22 +231,27 @@ public:
     // RC getIndexTree(char *fileName, Tree *index);
 
 private:
-    RC get_next_idx_in_memory(RID *rid);
-    RC find_idx_pages();
+    RC locate();
+    RC next_in_leaf(BPPageHandle &page_handle, bool verify, bool *moved,
+                    RID *rid);
     bool satisfy_condition(const char *key);
+    bool beyond_range(const char *key);
 
 private:
     BplusTreeHandler &index_handler_;
     bool opened_ = false;
-    CompOp comp_op_ = NO_OP;       // 用于比较的操作符
-    const char *value_ = nullptr;  // 与属性行比较的值
-    int num_fixed_pages_ = -1;  // 固定在缓冲区中的页，与指定的页面固定策略有关
-    int pinned_page_count_ = 0;  // 实际固定在缓冲区的页面数
-    BPPageHandle
-        page_handles_[BP_BUFFER_SIZE];  // 固定在缓冲区页面所对应的页面操作列表
-    int next_index_of_page_handle_ = -1;  // 当前被扫描页面的操作索引
-    int index_in_node_ = -1;              // 当前B+ Tree页面上的key index
-    PageNum next_page_num_ = -1;  // 下一个将要被读入的页面号
+    std::vector<char> left_key_;   // 下界，只有前left_attr_num_列
+    int left_attr_num_ = 0;        // 为0时没有下界
+    bool left_inclusive_ = true;
+    std::vector<char> right_key_;  // 上界，只有前right_attr_num_列
+    int right_attr_num_ = 0;       // 为0时没有上界
+    bool right_inclusive_ = true;
+    std::vector<char> excluded_key_;  // 不等于条件要跳过的值
+    int excluded_attr_num_ = 0;       // 为0时不跳过
+    bool eof_ = false;
+    PageNum page_num_ = -1;   // 下一次要读的叶子页面，小于等于0时没有更多的叶子
+    int index_in_node_ = -1;  // page_num_页面上下一个要检查的key index
+    std::vector<char> last_key_;  // 最后返回的一项的key和RID，没有返回过时为空
 };
 
 #endif  //__OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
\ No newline at end of file
@@ -18,17 +18,27 @@ See the Mulan PSL v2 for more details. */
 BplusTreeIndex::~BplusTreeIndex() noexcept { close(); }
 
 RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta,
-                          const FieldMeta &field_meta) {
+                          const std::vector<FieldMeta> &field_metas,
+                          DiskBufferPool *buffer_pool) {
     if (inited_) {
         return RC::RECORD_OPENNED;
     }
 
-    RC rc = Index::init(index_meta, field_meta);
+    RC rc = Index::init(index_meta, field_metas);
     if (rc != RC::SUCCESS) {
         return rc;
     }
 
-    rc = index_handler_.create(file_name, field_meta.type(), field_meta.len());
+    std::vector<AttrType> attr_types;
+    std::vector<int> attr_lengths;
+    for (const FieldMeta &field_meta : field_metas) {
+        attr_types.push_back(field_meta.type());
+        attr_lengths.push_back(field_meta.nullable() ? field_meta.len() - 1
+                                                     : field_meta.len());
+    }
+    rc = index_handler_.create(file_name, field_metas.size(),
+                               attr_types.data(), attr_lengths.data(),
+                               buffer_pool);
     if (RC::SUCCESS == rc) {
         inited_ = true;
     }
@@ -36,16 +46,17 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta,
 }
 
 RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta,
-                        const FieldMeta &field_meta) {
+                        const std::vector<FieldMeta> &field_metas,
+                        DiskBufferPool *buffer_pool) {
     if (inited_) {
         return RC::RECORD_OPENNED;
     }
-    RC rc = Index::init(index_meta, field_meta);
+    RC rc = Index::init(index_meta, field_metas);
     if (rc != RC::SUCCESS) {
         return rc;
     }
 
-    rc = index_handler_.open(file_name);
+    rc = index_handler_.open(file_name, buffer_pool);
     if (RC::SUCCESS == rc) {
         inited_ = true;
     }
@@ -60,30 +71,66 @@ RC BplusTreeIndex::close() {
     return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::insert_entry(const char *record, const RID *rid) {
-    if (field_meta_.nullable()) {
-        bool is_null = *(bool *)(record + field_meta_.offset());
-        if (is_null) {
-            return RC::SUCCESS;
+bool BplusTreeIndex::make_key(const char *record,
+                              std::vector<char> &key) const {
+    key.clear();
+    for (const FieldMeta &field_meta : field_metas_) {
+        const char *value = record + field_meta.offset();
+        int len = field_meta.len();
+        if (field_meta.nullable()) {
+            bool is_null = *(bool *)value;
+            if (is_null) {
+                return false;
+            }
+            value++;
+            len--;
         }
+        key.insert(key.end(), value, value + len);
+    }
+    return true;
+}
+
+RC BplusTreeIndex::insert_entry(const char *record, const RID *rid) {
+    std::vector<char> key;
+    if (!make_key(record, key)) {
+        return RC::SUCCESS;
     }
-    return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+    return index_handler_.insert_entry(key.data(), rid);
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid) {
-    if (field_meta_.nullable()) {
-        bool is_null = *(bool *)(record + field_meta_.offset());
-        if (is_null) {
-            return RC::SUCCESS;
-        }
+    std::vector<char> key;
+    if (!make_key(record, key)) {
+        return RC::SUCCESS;
     }
-    return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+    return index_handler_.delete_entry(key.data(), rid);
+}
+
+IndexScanner *BplusTreeIndex::create_scanner(CompOp comp_op, const char *value,
+                                             int attr_num) {
+    BplusTreeScanner *bplus_tree_scanner = new BplusTreeScanner(index_handler_);
+    RC rc = bplus_tree_scanner->open(comp_op, value, attr_num);
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to open index scanner. rc=%d:%s", rc, strrc(rc));
+        delete bplus_tree_scanner;
+        return nullptr;
+    }
+
+    BplusTreeIndexScanner *index_scanner =
+        new BplusTreeIndexScanner(bplus_tree_scanner);
+    return index_scanner;
 }
 
-IndexScanner *BplusTreeIndex::create_scanner(CompOp comp_op,
-                                             const char *value) {
+IndexScanner *BplusTreeIndex::create_scanner(const char *left_key,
+                                             int left_attr_num,
+                                             bool left_inclusive,
+                                             const char *right_key,
+                                             int right_attr_num,
+                                             bool right_inclusive) {
     BplusTreeScanner *bplus_tree_scanner = new BplusTreeScanner(index_handler_);
-    RC rc = bplus_tree_scanner->open(comp_op, value);
+    RC rc = bplus_tree_scanner->open(left_key, left_attr_num, left_inclusive,
+                                     right_key, right_attr_num,
+                                     right_inclusive);
     if (rc != RC::SUCCESS) {
         LOG_ERROR("Failed to open index scanner. rc=%d:%s", rc, strrc(rc));
         delete bplus_tree_scanner;
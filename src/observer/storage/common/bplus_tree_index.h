@@ -23,19 +23,33 @@ public:
     virtual ~BplusTreeIndex() noexcept;
 
     RC create(const char *file_name, const IndexMeta &index_meta,
-              const FieldMeta &field_meta);
+              const std::vector<FieldMeta> &field_metas,
+              DiskBufferPool *buffer_pool = nullptr);
     RC open(const char *file_name, const IndexMeta &index_meta,
-            const FieldMeta &field_meta);
+            const std::vector<FieldMeta> &field_metas,
+            DiskBufferPool *buffer_pool = nullptr);
     RC close();
 
     bool is_unique() override { return index_handler_.is_unique(); }
     RC insert_entry(const char *record, const RID *rid) override;
     RC delete_entry(const char *record, const RID *rid) override;
 
-    IndexScanner *create_scanner(CompOp comp_op, const char *value) override;
+    IndexScanner *create_scanner(CompOp comp_op, const char *value,
+                                 int attr_num = 0) override;
+    IndexScanner *create_scanner(const char *left_key, int left_attr_num,
+                                 bool left_inclusive, const char *right_key,
+                                 int right_attr_num,
+                                 bool right_inclusive) override;
 
     RC sync() override;
 
+private:
+    /**
+     * 把索引各列的值按顺序拼接成key，可以为空的列去掉空标记。
+     * 有一列为空时返回false，空值不放到索引中
+     */
+    bool make_key(const char *record, std::vector<char> &key) const;
+
 private:
     bool inited_ = false;
     BplusTreeHandler index_handler_;
@@ -14,7 +14,15 @@ See the Mulan PSL v2 for more details. */
 #include "condition_filter.h"
 
 #include <stddef.h>
+#include <string.h>
 
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "common/lang/bitmap.h"
 #include "common/log/log.h"
 #include "record_manager.h"
 #include "session/session.h"
@@ -48,6 +56,264 @@ static bool judge_cmp_result(CompOp comp_op, int cmp_result) {
 
 ConditionFilter::~ConditionFilter() {}
 
+void ConditionFilter::filter_batch(const Record *records, int num,
+                                   char *select) const {
+    Bitmap bitmap(select, num);
+    for (int i = 0; i < num; i++) {
+        if (bitmap.get_bit(i) && !filter(records[i])) {
+            bitmap.clear_bit(i);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 编译之后的比较函数。数值字段先从记录中取到连续的数组里，再整体比较，
+// 支持AVX2时一次比较8个值
+typedef DefaultConditionFilter::CompiledCondition CompiledCondition;
+typedef DefaultConditionFilter::BatchKernel BatchKernel;
+
+static const int KERNEL_BATCH = 64;
+
+template <CompOp op, typename T>
+static inline bool compare_value(T value, T constant) {
+    switch (op) {
+        case EQUAL_TO:
+            return value == constant;
+        case LESS_EQUAL:
+            return value <= constant;
+        case NOT_EQUAL:
+            return value != constant;
+        case LESS_THAN:
+            return value < constant;
+        case GREAT_EQUAL:
+            return value >= constant;
+        case GREAT_THAN:
+            return value > constant;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+static inline T constant_of(const CompiledCondition &cond);
+template <>
+inline int constant_of<int>(const CompiledCondition &cond) {
+    return cond.constant.int_value;
+}
+template <>
+inline float constant_of<float>(const CompiledCondition &cond) {
+    return cond.constant.float_value;
+}
+
+/**
+ * 取出记录中的字段值，返回非空的记录的位图
+ */
+template <typename FieldT, typename T>
+static inline uint64_t gather_values(const CompiledCondition &cond,
+                                     const Record *records, int num,
+                                     T *values) {
+    uint64_t not_null = 0;
+    for (int i = 0; i < num; i++) {
+        const char *data = records[i].data;
+        FieldT value;
+        memcpy(&value, data + cond.offset, sizeof(value));
+        values[i] = (T)value;
+        if (cond.null_offset < 0 || !data[cond.null_offset]) {
+            not_null |= (uint64_t)1 << i;
+        }
+    }
+    return not_null;
+}
+
+template <CompOp op, typename T>
+static uint64_t compare_scalar(const T *values, int num, T constant) {
+    uint64_t bits = 0;
+    for (int i = 0; i < num; i++) {
+        bits |= (uint64_t)compare_value<op>(values[i], constant) << i;
+    }
+    return bits;
+}
+
+#if defined(__x86_64__)
+template <CompOp op>
+__attribute__((target("avx2"))) static uint64_t compare_avx2(
+    const int *values, int num, int constant) {
+    const __m256i c = _mm256_set1_epi32(constant);
+    uint64_t bits = 0;
+    int i = 0;
+    for (; i + 8 <= num; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i m;
+        bool negate = false;
+        switch (op) {
+            case EQUAL_TO:
+                m = _mm256_cmpeq_epi32(v, c);
+                break;
+            case NOT_EQUAL:
+                m = _mm256_cmpeq_epi32(v, c);
+                negate = true;
+                break;
+            case GREAT_THAN:
+                m = _mm256_cmpgt_epi32(v, c);
+                break;
+            case LESS_EQUAL:
+                m = _mm256_cmpgt_epi32(v, c);
+                negate = true;
+                break;
+            case LESS_THAN:
+                m = _mm256_cmpgt_epi32(c, v);
+                break;
+            default:  // GREAT_EQUAL
+                m = _mm256_cmpgt_epi32(c, v);
+                negate = true;
+                break;
+        }
+        uint64_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        if (negate) {
+            mask ^= 0xFF;
+        }
+        bits |= mask << i;
+    }
+    return bits | (compare_scalar<op>(values + i, num - i, constant) << i);
+}
+
+template <CompOp op>
+__attribute__((target("avx2"))) static uint64_t compare_avx2(
+    const float *values, int num, float constant) {
+    const __m256 c = _mm256_set1_ps(constant);
+    uint64_t bits = 0;
+    int i = 0;
+    for (; i + 8 <= num; i += 8) {
+        __m256 v = _mm256_loadu_ps(values + i);
+        __m256 m;
+        switch (op) {
+            case EQUAL_TO:
+                m = _mm256_cmp_ps(v, c, _CMP_EQ_OQ);
+                break;
+            case NOT_EQUAL:
+                m = _mm256_cmp_ps(v, c, _CMP_NEQ_UQ);
+                break;
+            case GREAT_THAN:
+                m = _mm256_cmp_ps(v, c, _CMP_GT_OQ);
+                break;
+            case LESS_EQUAL:
+                m = _mm256_cmp_ps(v, c, _CMP_LE_OQ);
+                break;
+            case LESS_THAN:
+                m = _mm256_cmp_ps(v, c, _CMP_LT_OQ);
+                break;
+            default:  // GREAT_EQUAL
+                m = _mm256_cmp_ps(v, c, _CMP_GE_OQ);
+                break;
+        }
+        bits |= (uint64_t)_mm256_movemask_ps(m) << i;
+    }
+    return bits | (compare_scalar<op>(values + i, num - i, constant) << i);
+}
+
+static bool cpu_support_avx2() {
+    static const bool support = __builtin_cpu_supports("avx2");
+    return support;
+}
+#endif
+
+template <typename FieldT, typename T, CompOp op, bool simd>
+static uint64_t numeric_kernel(const CompiledCondition &cond,
+                               const Record *records, int num) {
+    T values[KERNEL_BATCH];
+    uint64_t not_null = gather_values<FieldT>(cond, records, num, values);
+#if defined(__x86_64__)
+    if (simd) {
+        return not_null & compare_avx2<op>(values, num, constant_of<T>(cond));
+    }
+#endif
+    return not_null & compare_scalar<op>(values, num, constant_of<T>(cond));
+}
+
+template <CompOp op>
+static uint64_t string_kernel(const CompiledCondition &cond,
+                              const Record *records, int num) {
+    uint64_t bits = 0;
+    for (int i = 0; i < num; i++) {
+        const char *data = records[i].data;
+        if (cond.null_offset >= 0 && data[cond.null_offset]) {
+            continue;
+        }
+        // 字段写满时末尾没有'\0'，最多比较字段的长度
+        int cmp_result = strncmp(data + cond.offset, cond.constant.str_value,
+                                 cond.len);
+        if (cmp_result == 0 &&
+            strlen(cond.constant.str_value) > (size_t)cond.len) {
+            cmp_result = -1;
+        }
+        bits |= (uint64_t)compare_value<op>(cmp_result, 0) << i;
+    }
+    return bits;
+}
+
+template <template <CompOp> class KernelOf>
+static BatchKernel select_kernel(CompOp comp_op) {
+    switch (comp_op) {
+        case EQUAL_TO:
+            return KernelOf<EQUAL_TO>::kernel;
+        case LESS_EQUAL:
+            return KernelOf<LESS_EQUAL>::kernel;
+        case NOT_EQUAL:
+            return KernelOf<NOT_EQUAL>::kernel;
+        case LESS_THAN:
+            return KernelOf<LESS_THAN>::kernel;
+        case GREAT_EQUAL:
+            return KernelOf<GREAT_EQUAL>::kernel;
+        case GREAT_THAN:
+            return KernelOf<GREAT_THAN>::kernel;
+        default:
+            return nullptr;
+    }
+}
+
+template <typename FieldT, typename T, bool simd>
+struct NumericKernel {
+    template <CompOp op>
+    struct Of {
+        static constexpr BatchKernel kernel =
+            numeric_kernel<FieldT, T, op, simd>;
+    };
+};
+
+template <CompOp op>
+struct StringKernel {
+    static constexpr BatchKernel kernel = string_kernel<op>;
+};
+
+template <typename FieldT, typename T>
+static BatchKernel select_numeric_kernel(CompOp comp_op) {
+#if defined(__x86_64__)
+    if (cpu_support_avx2()) {
+        return select_kernel<NumericKernel<FieldT, T, true>::template Of>(
+            comp_op);
+    }
+#endif
+    return select_kernel<NumericKernel<FieldT, T, false>::template Of>(
+        comp_op);
+}
+
+CompOp mirror_comp_op(CompOp comp_op) {
+    switch (comp_op) {
+        case LESS_EQUAL:
+            return GREAT_EQUAL;
+        case LESS_THAN:
+            return GREAT_THAN;
+        case GREAT_EQUAL:
+            return LESS_EQUAL;
+        case GREAT_THAN:
+            return LESS_THAN;
+        default:
+            return comp_op;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 DefaultConditionFilter::DefaultConditionFilter() {
     left_.is_attr = false;
     left_.data.field_meta = nullptr;
@@ -85,9 +351,53 @@ RC DefaultConditionFilter::init(const ConDesc& left, const ConDesc& right,
     left_type_ = left_type;
     right_type_ = right_type;
     comp_op_ = comp_op;
+    compile();
     return RC::SUCCESS;
 }
 
+void DefaultConditionFilter::compile() {
+    // 只编译字段和非空常量的比较，其它的条件走通用的比较
+    kernel_ = nullptr;
+    if (left_.is_attr == right_.is_attr) {
+        return;
+    }
+    const ConDesc &attr = left_.is_attr ? left_ : right_;
+    const Value *value = left_.is_attr ? right_.data.value : left_.data.value;
+    AttrType field_type = left_.is_attr ? left_type_ : right_type_;
+    CompOp comp_op = left_.is_attr ? comp_op_ : mirror_comp_op(comp_op_);
+    if (value == nullptr || value->data == nullptr) {
+        return;
+    }
+
+    const FieldMeta *field_meta = attr.data.field_meta;
+    compiled_.offset = field_meta->offset();
+    compiled_.null_offset = -1;
+    compiled_.len = field_meta->len();
+    if (field_meta->nullable()) {
+        compiled_.null_offset = field_meta->offset();
+        compiled_.offset += 1;
+        compiled_.len -= 1;
+    }
+
+    if (field_type == INTS && value->type == INTS) {
+        compiled_.constant.int_value = *(int *)value->data;
+        kernel_ = select_numeric_kernel<int, int>(comp_op);
+    } else if ((field_type == INTS || field_type == FLOATS) &&
+               (value->type == INTS || value->type == FLOATS)) {
+        // 整数和浮点数比较时都转换成浮点数
+        compiled_.constant.float_value = value->type == INTS
+                                             ? *(int *)value->data
+                                             : *(float *)value->data;
+        kernel_ = field_type == INTS
+                      ? select_numeric_kernel<int, float>(comp_op)
+                      : select_numeric_kernel<float, float>(comp_op);
+    } else if ((field_type == CHARS || field_type == DATES) &&
+               (value->type == CHARS || value->type == DATES)) {
+        compiled_.constant.str_value = (const char *)value->data;
+        kernel_ = select_kernel<StringKernel>(comp_op);
+    }
+}
+
 RC DefaultConditionFilter::init(Table& table, const Condition& condition) {
     const TableMeta& table_meta = table.table_meta();
     ConDesc left;
@@ -176,6 +486,10 @@ static bool value_compare(const Value& lhs, const Value& rhs, CompOp comp_op) {
 }
 
 bool DefaultConditionFilter::filter(const Record& rec) const {
+    if (kernel_ != nullptr) {
+        return kernel_(compiled_, &rec, 1) != 0;
+    }
+
     Value left_value, right_value;
 
     if (left_.is_attr) {
@@ -218,6 +532,23 @@ bool DefaultConditionFilter::filter(const Record& rec) const {
     return value_compare(left_value, right_value, comp_op_);
 }
 
+void DefaultConditionFilter::filter_batch(const Record* records, int num,
+                                          char* select) const {
+    if (kernel_ == nullptr) {
+        ConditionFilter::filter_batch(records, num, select);
+        return;
+    }
+
+    for (int i = 0; i < num; i += KERNEL_BATCH) {
+        const int n = std::min(KERNEL_BATCH, num - i);
+        uint64_t bits = kernel_(compiled_, records + i, n);
+        char* bytes = select + i / 8;
+        for (int j = 0; j * 8 < n; j++) {
+            bytes[j] &= (char)(bits >> (j * 8));
+        }
+    }
+}
+
 CompositeConditionFilter::~CompositeConditionFilter() {
     if (memory_owner_) {
         delete[] filters_;
@@ -276,3 +607,10 @@ bool CompositeConditionFilter::filter(const Record& rec) const {
     }
     return true;
 }
+
+void CompositeConditionFilter::filter_batch(const Record* records, int num,
+                                            char* select) const {
+    for (int i = 0; i < filter_num_; i++) {
+        filters_[i]->filter_batch(records, num, select);
+    }
+}
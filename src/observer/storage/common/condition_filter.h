@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #ifndef __OBSERVER_STORAGE_COMMON_CONDITION_FILTER_H_
 #define __OBSERVER_STORAGE_COMMON_CONDITION_FILTER_H_
 
+#include <stdint.h>
+
 #include <vector>
 
 #include "rc.h"
@@ -25,6 +27,11 @@ class Table;
 
 class FieldMeta;
 
+/**
+ * 交换比较的两边时对应的比较符号
+ */
+CompOp mirror_comp_op(CompOp comp_op);
+
 struct ConDesc {
     bool is_attr;  // 是否属性，false 表示是值
     union {
@@ -43,6 +50,14 @@ public:
      * @return true means match condition, false means failed to match.
      */
     virtual bool filter(const Record &rec) const = 0;
+
+    /**
+     * Filter a batch of records
+     * @param select bitmap of num bits, bits of the records failed to match
+     * condition are cleared
+     */
+    virtual void filter_batch(const Record *records, int num,
+                              char *select) const;
 };
 
 class DefaultConditionFilter : public ConditionFilter {
@@ -55,6 +70,8 @@ public:
     RC init(Table &table, const Condition &condition);
 
     virtual bool filter(const Record &rec) const;
+    virtual void filter_batch(const Record *records, int num,
+                              char *select) const;
 
 public:
     const ConDesc &left() const { return left_; }
@@ -63,12 +80,42 @@ public:
 
     CompOp comp_op() const { return comp_op_; }
 
+    /**
+     * 属性和常量的比较在init时编译成按照类型和比较符号特化的函数
+     */
+    bool compiled() const { return kernel_ != nullptr; }
+
+    /**
+     * 编译之后的条件，统一成 字段 comp_op 常量 的形式
+     */
+    struct CompiledCondition {
+        int offset = 0;         // 字段值在记录中的偏移
+        int null_offset = -1;   // 可以为空的字段的空标记的偏移
+        int len = 0;            // 字段的长度
+        union {
+            int int_value;
+            float float_value;
+            const char *str_value;
+        } constant;
+    };
+    /**
+     * 最多比较64条记录，返回满足条件的记录的位图
+     */
+    typedef uint64_t (*BatchKernel)(const CompiledCondition &cond,
+                                    const Record *records, int num);
+
+private:
+    void compile();
+
 private:
     ConDesc left_;
     ConDesc right_;
     AttrType left_type_ = UNDEFINED;
     AttrType right_type_ = UNDEFINED;
     CompOp comp_op_ = NO_OP;
+
+    CompiledCondition compiled_;
+    BatchKernel kernel_ = nullptr;
 };
 
 class CompositeConditionFilter : public ConditionFilter {
@@ -79,6 +126,8 @@ public:
     RC init(const ConditionFilter *filters[], int filter_num);
     RC init(Table &table, const Condition *conditions, int condition_num);
     virtual bool filter(const Record &rec) const;
+    virtual void filter_batch(const Record *records, int num,
+                              char *select) const;
 
 public:
     int filter_num() const { return filter_num_; }
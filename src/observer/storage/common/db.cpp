@@ -164,4 +164,19 @@ RC Db::sync() {
   }
   LOG_INFO("Sync db over. db=%s", name_.c_str());
   return rc;
+}
+
+RC Db::vacuum(int free_percent) {
+  RC rc = RC::SUCCESS;
+  for (const auto &table_pair : opened_tables_) {
+    Table *table = table_pair.second;
+    int moved = 0;
+    rc = table->vacuum(free_percent, &moved);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to vacuum table. table=%s.%s, rc=%d:%s", name_.c_str(),
+                table->name(), rc, strrc(rc));
+      return rc;
+    }
+  }
+  return rc;
 }
\ No newline at end of file
@@ -43,6 +43,11 @@ class Db {
 
   RC sync();
 
+  /**
+   * 整理所有表的数据文件，参考Table::vacuum
+   */
+  RC vacuum(int free_percent);
+
  private:
   RC open_all_tables();
 
@@ -43,16 +43,32 @@ public:
     virtual RC insert_entry(const char *record, const RID *rid) = 0;
     virtual RC delete_entry(const char *record, const RID *rid) = 0;
 
-    virtual IndexScanner *create_scanner(CompOp comp_op, const char *value) = 0;
+    /**
+     * value是索引前attr_num列的值按顺序拼接起来的key，
+     * 前attr_num-1列要相等，第attr_num列与value中对应的值满足comp_op。
+     * attr_num为0时表示索引的全部列
+     */
+    virtual IndexScanner *create_scanner(CompOp comp_op, const char *value,
+                                         int attr_num = 0) = 0;
+    /**
+     * 范围扫描，前left_attr_num列不小于left_key并且前right_attr_num列不大于right_key，
+     * inclusive为false时不包含边界，attr_num为0时这一边没有边界
+     */
+    virtual IndexScanner *create_scanner(const char *left_key,
+                                         int left_attr_num, bool left_inclusive,
+                                         const char *right_key,
+                                         int right_attr_num,
+                                         bool right_inclusive) = 0;
 
     virtual RC sync() = 0;
 
 protected:
-    RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+    RC init(const IndexMeta &index_meta,
+            const std::vector<FieldMeta> &field_metas);
 
 protected:
     IndexMeta index_meta_;
-    FieldMeta field_meta_;  /// 当前实现仅考虑一个字段的索引
+    std::vector<FieldMeta> field_metas_;  /// 按照索引中列的顺序排列
 };
 
 class IndexScanner {
@@ -45,7 +45,7 @@ typedef struct {
     IndexHandle *pIXIndexHandle;
     CompOp compOp;
     char *value;
-    BPPageHandle pfPageHandles[BP_BUFFER_SIZE];
+    BPPageHandle pfPageHandle;
     PageNum pnNext;
 } IndexScan;
 
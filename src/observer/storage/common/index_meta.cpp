@@ -22,29 +22,42 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_FIELD_NAMES("field_names");
 const static Json::StaticString FIELD_IS_UNIQUE("is_unique");
 
 RC IndexMeta::init(const char *name, const FieldMeta &field, bool is_unique) {
-    if (nullptr == name || common::is_blank(name)) {
+    return init(name, std::vector<const FieldMeta *>{&field}, is_unique);
+}
+
+RC IndexMeta::init(const char *name,
+                   const std::vector<const FieldMeta *> &fields,
+                   bool is_unique) {
+    if (nullptr == name || common::is_blank(name) || fields.empty()) {
         return RC::INVALID_ARGUMENT;
     }
 
     name_ = name;
-    field_ = field.name();
+    fields_.clear();
+    for (const FieldMeta *field : fields) {
+        fields_.push_back(field->name());
+    }
     is_unique_ = is_unique;
     return RC::SUCCESS;
 }
 
 void IndexMeta::to_json(Json::Value &json_value) const {
     json_value[FIELD_NAME] = name_;
-    json_value[FIELD_FIELD_NAME] = field_;
+    Json::Value fields_value;
+    for (const std::string &field : fields_) {
+        fields_value.append(field);
+    }
+    json_value[FIELD_FIELD_NAMES] = std::move(fields_value);
     json_value[FIELD_IS_UNIQUE] = is_unique_;
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value,
                         IndexMeta &index) {
     const Json::Value &name_value = json_value[FIELD_NAME];
-    const Json::Value &field_value = json_value[FIELD_FIELD_NAME];
     const Json::Value &unique_value = json_value[FIELD_IS_UNIQUE];
     if (!name_value.isString()) {
         LOG_ERROR("Index name is not a string. json value=%s",
@@ -52,29 +65,53 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value,
         return RC::GENERIC_ERROR;
     }
 
-    if (!field_value.isString()) {
-        LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
-                  name_value.asCString(), field_value.toStyledString().c_str());
+    // 只有一列的旧版本元数据保存在field_name中
+    Json::Value fields_value = json_value[FIELD_FIELD_NAMES];
+    if (fields_value.isNull()) {
+        fields_value.append(json_value[FIELD_FIELD_NAME]);
+    }
+    if (!fields_value.isArray() || fields_value.empty()) {
+        LOG_ERROR("Field names of index [%s] is not an array. json value=%s",
+                  name_value.asCString(),
+                  fields_value.toStyledString().c_str());
         return RC::GENERIC_ERROR;
     }
 
-    const FieldMeta *field = table.field(field_value.asCString());
-    if (nullptr == field) {
-        LOG_ERROR("Deserialize index [%s]: no such field: %s",
-                  name_value.asCString(), field_value.asCString());
-        return RC::SCHEMA_FIELD_MISSING;
+    std::vector<const FieldMeta *> fields;
+    for (const Json::Value &field_value : fields_value) {
+        if (!field_value.isString()) {
+            LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
+                      name_value.asCString(),
+                      field_value.toStyledString().c_str());
+            return RC::GENERIC_ERROR;
+        }
+
+        const FieldMeta *field = table.field(field_value.asCString());
+        if (nullptr == field) {
+            LOG_ERROR("Deserialize index [%s]: no such field: %s",
+                      name_value.asCString(), field_value.asCString());
+            return RC::SCHEMA_FIELD_MISSING;
+        }
+        fields.push_back(field);
     }
 
-    return index.init(name_value.asCString(), *field, unique_value.asBool());
+    return index.init(name_value.asCString(), fields, unique_value.asBool());
 }
 
 const char *IndexMeta::name() const { return name_.c_str(); }
 
-const char *IndexMeta::field() const { return field_.c_str(); }
+const char *IndexMeta::field() const { return fields_[0].c_str(); }
+
+const char *IndexMeta::field(int i) const { return fields_[i].c_str(); }
+
+int IndexMeta::field_num() const { return fields_.size(); }
 
 bool IndexMeta::is_unique() const { return is_unique_; }
 
 void IndexMeta::desc(std::ostream &os) const {
-    os << "index name=" << name_ << ", field=" << field_
-       << ", unique=" << (is_unique_ ? "yes" : "no");
+    os << "index name=" << name_ << ", field=";
+    for (size_t i = 0; i < fields_.size(); i++) {
+        os << (i == 0 ? "" : ",") << fields_[i];
+    }
+    os << ", unique=" << (is_unique_ ? "yes" : "no");
 }
\ No newline at end of file
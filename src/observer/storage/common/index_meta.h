@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #define __OBSERVER_STORAGE_COMMON_INDEX_META_H__
 
 #include <string>
+#include <vector>
 
 #include "rc.h"
 
@@ -30,10 +31,17 @@ public:
     IndexMeta() = default;
 
     RC init(const char *name, const FieldMeta &field, bool is_unique);
+    /**
+     * 多列索引，fields按照索引中列的顺序排列
+     */
+    RC init(const char *name, const std::vector<const FieldMeta *> &fields,
+            bool is_unique);
 
 public:
     const char *name() const;
-    const char *field() const;
+    const char *field() const;  // 第一列
+    const char *field(int i) const;
+    int field_num() const;
     bool is_unique() const;
 
     void desc(std::ostream &os) const;
@@ -45,7 +53,7 @@ public:
 
 private:
     std::string name_;
-    std::string field_;
+    std::vector<std::string> fields_;
     bool is_unique_;
 };
 #endif  // __OBSERVER_STORAGE_COMMON_INDEX_META_H__
\ No newline at end of file
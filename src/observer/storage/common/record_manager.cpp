@@ -12,6 +12,16 @@ See the Mulan PSL v2 for more details. */
 //
 #include "storage/common/record_manager.h"
 
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
 #include "common/lang/bitmap.h"
 #include "common/log/log.h"
 #include "condition_filter.h"
@@ -53,6 +63,175 @@ int page_header_size(int record_capacity) {
     const int bitmap_size = page_bitmap_size(record_capacity);
     return align8(page_fix_size() + bitmap_size);
 }
+
+/**
+ * SLOTTED格式的页面。页头之后是记录，从前向后增长；
+ * 槽位目录在页面的末尾，第i个槽位在倒数第i+1个位置，从后向前增长
+ */
+enum SlottedPageType {
+    SLOTTED_DATA_PAGE = 0x53444154,  // "SDAT"
+    OVERFLOW_PAGE = 0x4F564552,      // "OVER"
+};
+
+struct SlottedPageHeader {
+    int page_type;    // 数据页或者溢出页，和OverflowPageHeader对齐
+    int record_num;   // 当前页面记录的个数
+    int slot_count;   // 槽位目录的长度，包括已经删除的槽位
+    int free_offset;  // 记录区之后空闲空间的起始位置
+    int free_space;   // 所有空闲空间的大小，包括删除和更新之后留下的碎片
+};
+
+struct Slot {
+    uint16_t offset;  // 记录在页面中的偏移，0表示空闲槽位
+    uint16_t length;  // 最高位表示记录保存在溢出页中，槽位中是OverflowRef
+};
+
+static const uint16_t SLOT_OVERFLOW = 0x8000;
+static const uint16_t SLOT_LENGTH_MASK = 0x7FFF;
+
+struct OverflowRef {
+    PageNum first_page;
+    int length;  // 编码之后的记录长度
+};
+
+struct OverflowPageHeader {
+    int page_type;
+    PageNum next_page;  // 下一个溢出页，最后一页是-1
+    int data_len;       // 本页保存的数据长度
+};
+
+static SlottedPageHeader *slotted_header(const BPPageHandle &page_handle) {
+    return (SlottedPageHeader *)page_handle.frame->page->data;
+}
+
+static Slot *slot_of(const BPPageHandle &page_handle, int page_size,
+                     int slot_num) {
+    return (Slot *)(page_handle.frame->page->data + page_size -
+                    (slot_num + 1) * sizeof(Slot));
+}
+
+static int slot_length(const Slot *slot) {
+    return slot->length & SLOT_LENGTH_MASK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const char *record_format_name(RecordFormat format) {
+    return format == RecordFormat::SLOTTED ? "slotted" : "fixed";
+}
+
+bool record_format_from_name(const char *name, RecordFormat &format) {
+    if (0 == strcasecmp(name, "fixed")) {
+        format = RecordFormat::FIXED;
+    } else if (0 == strcasecmp(name, "slotted")) {
+        format = RecordFormat::SLOTTED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace {
+struct RecordFormatRegistry {
+    std::mutex mutex;
+    RecordFormat default_format = RecordFormat::FIXED;
+    std::map<std::string, RecordFormat> table_formats;
+};
+
+RecordFormatRegistry &record_format_registry() {
+    static RecordFormatRegistry registry;
+    return registry;
+}
+}  // namespace
+
+void assign_table_record_format(const char *table_name, RecordFormat format) {
+    RecordFormatRegistry &registry = record_format_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (table_name == nullptr) {
+        registry.default_format = format;
+    } else {
+        registry.table_formats[table_name] = format;
+    }
+}
+
+RecordFormat theTableRecordFormat(const char *table_name) {
+    RecordFormatRegistry &registry = record_format_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto iter = registry.table_formats.find(table_name);
+    if (iter != registry.table_formats.end()) {
+        return iter->second;
+    }
+    return registry.default_format;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RecordLayout::add_var_field(int offset, int len) {
+    var_fields_.emplace_back(offset, len);
+    std::sort(var_fields_.begin(), var_fields_.end());
+}
+
+static int trimmed_len(const char *data, int len) {
+    while (len > 0 && data[len - 1] == '\0') {
+        len--;
+    }
+    return len;
+}
+
+int RecordLayout::encoded_size(const char *record) const {
+    int size = record_size_;
+    for (const auto &field : var_fields_) {
+        size += sizeof(uint16_t) +
+                trimmed_len(record + field.first, field.second) - field.second;
+    }
+    return size;
+}
+
+int RecordLayout::encode(const char *record, char *buf) const {
+    // 定长部分原样复制，变长字段保存为2字节的长度加上去掉末尾'\0'的内容
+    int pos = 0;
+    int out = 0;
+    for (const auto &field : var_fields_) {
+        memcpy(buf + out, record + pos, field.first - pos);
+        out += field.first - pos;
+        uint16_t len = trimmed_len(record + field.first, field.second);
+        memcpy(buf + out, &len, sizeof(len));
+        out += sizeof(len);
+        memcpy(buf + out, record + field.first, len);
+        out += len;
+        pos = field.first + field.second;
+    }
+    memcpy(buf + out, record + pos, record_size_ - pos);
+    return out + record_size_ - pos;
+}
+
+RC RecordLayout::decode(const char *buf, int len, char *record) const {
+    int pos = 0;
+    int in = 0;
+    for (const auto &field : var_fields_) {
+        int fixed_len = field.first - pos;
+        uint16_t var_len = 0;
+        if (in + fixed_len + (int)sizeof(var_len) > len) {
+            return RC::RECORD_INVALIDRECSIZE;
+        }
+        memcpy(record + pos, buf + in, fixed_len);
+        in += fixed_len;
+        memcpy(&var_len, buf + in, sizeof(var_len));
+        in += sizeof(var_len);
+        if (var_len > field.second || in + var_len > len) {
+            return RC::RECORD_INVALIDRECSIZE;
+        }
+        memcpy(record + field.first, buf + in, var_len);
+        memset(record + field.first + var_len, 0, field.second - var_len);
+        in += var_len;
+        pos = field.first + field.second;
+    }
+    // 为了能够原地放下溢出页的引用，短记录的后面可能有填充
+    if (in + record_size_ - pos > len) {
+        return RC::RECORD_INVALIDRECSIZE;
+    }
+    memcpy(record + pos, buf + in, record_size_ - pos);
+    return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 RecordPageHandler::RecordPageHandler()
     : disk_buffer_pool_(nullptr),
@@ -66,7 +245,31 @@ RecordPageHandler::RecordPageHandler()
 RecordPageHandler::~RecordPageHandler() { deinit(); }
 
 RC RecordPageHandler::init(DiskBufferPool &buffer_pool, int file_id,
-                           PageNum page_num) {
+                           PageNum page_num, bool readonly,
+                           const RecordLayout *layout) {
+    RC ret = init_page(buffer_pool, file_id, page_num, readonly);
+    if (ret != RC::SUCCESS) {
+        return ret;
+    }
+
+    layout_ = layout;
+    if (is_slotted()) {
+        ret = buffer_pool.get_page_data_size(file_id, &page_size_);
+        if (ret == RC::SUCCESS &&
+            slotted_header(page_handle_)->page_type != SLOTTED_DATA_PAGE) {
+            LOG_TRACE("Not a record page, file_id:page_num %d:%d.", file_id,
+                      page_num);
+            ret = RC::BUFFERPOOL_INVALID_PAGE_NUM;
+        }
+        if (ret != RC::SUCCESS) {
+            deinit();
+        }
+    }
+    return ret;
+}
+
+RC RecordPageHandler::init_page(DiskBufferPool &buffer_pool, int file_id,
+                                PageNum page_num, bool readonly) {
     if (disk_buffer_pool_ != nullptr) {
         LOG_WARN("Disk buffer pool has been opened for file_id:page_num %d:%d.",
                  file_id, page_num);
@@ -74,8 +277,12 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, int file_id,
     }
 
     RC ret = RC::SUCCESS;
-    if ((ret = buffer_pool.get_this_page(file_id, page_num, &page_handle_)) !=
-        RC::SUCCESS) {
+    if (readonly) {
+        ret = buffer_pool.get_readonly_page(file_id, page_num, &page_handle_);
+    } else {
+        ret = buffer_pool.get_this_page(file_id, page_num, &page_handle_);
+    }
+    if (ret != RC::SUCCESS) {
         LOG_ERROR("Failed to get page handle from disk buffer pool. ret=%d:%s",
                   ret, strrc(ret));
         return ret;
@@ -98,8 +305,9 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, int file_id,
 }
 
 RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, int file_id,
-                                      PageNum page_num, int record_size) {
-    RC ret = init(buffer_pool, file_id, page_num);
+                                      PageNum page_num, int record_size,
+                                      const RecordLayout *layout) {
+    RC ret = init_page(buffer_pool, file_id, page_num, false);
     if (ret != RC::SUCCESS) {
         LOG_ERROR(
             "Failed to init empty page file_id:page_num:record_size %d:%d:%d.",
@@ -107,7 +315,18 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, int file_id,
         return ret;
     }
 
-    int page_size = sizeof(page_handle_.frame->page.data);
+    int page_size = 0;
+    ret = buffer_pool.get_page_data_size(file_id, &page_size);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("Failed to get page data size. ret=%d:%s", ret, strrc(ret));
+        return ret;
+    }
+    layout_ = layout;
+    if (is_slotted()) {
+        page_size_ = page_size;
+        return slotted_init_empty_page();
+    }
+
     int record_phy_size = align8(record_size);
     page_header_->record_num = 0;
     page_header_->record_capacity =
@@ -116,7 +335,7 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, int file_id,
     page_header_->record_size = record_phy_size;
     page_header_->first_record_offset =
         page_header_size(page_header_->record_capacity);
-    bitmap_ = page_handle_.frame->page.data + page_fix_size();
+    bitmap_ = page_handle_.frame->page->data + page_fix_size();
 
     memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
     ret = disk_buffer_pool_->mark_dirty(&page_handle_);
@@ -131,7 +350,7 @@ RC RecordPageHandler::deinit() {
     // if (page_header_ != nullptr) {
     //   disk_buffer_pool_->unpin_page(&page_handle_);
     //   disk_buffer_pool_->force_page(file_id_,
-    //   page_handle_.frame->page.page_num); page_header_ = nullptr;
+    //   page_handle_.frame->page->page_num); page_header_ = nullptr;
     // }
     if (disk_buffer_pool_ != nullptr) {
         RC rc = disk_buffer_pool_->unpin_page(&page_handle_);
@@ -141,15 +360,25 @@ RC RecordPageHandler::deinit() {
                 strrc(rc));
         }
         disk_buffer_pool_ = nullptr;
+        // 页面已经unpin，只读映射的帧已经释放
+        page_header_ = nullptr;
+        bitmap_ = nullptr;
+        layout_ = nullptr;
     }
 
     return RC::SUCCESS;
 }
 
 RC RecordPageHandler::insert_record(const char *data, RID *rid) {
+    if (is_slotted()) {
+        return slotted_insert_record(data, rid);
+    }
+
+    page_handle_.wlatch();
     if (page_header_->record_num == page_header_->record_capacity) {
+        page_handle_.wunlatch();
         LOG_WARN("Page is full, file_id:page_num %d:%d.", file_id_,
-                 page_handle_.frame->page.page_num);
+                 page_handle_.frame->page->page_num);
         return RC::RECORD_NOMEM;
     }
 
@@ -160,12 +389,13 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid) {
     page_header_->record_num++;
 
     // assert index < page_header_->record_capacity
-    char *record_data = page_handle_.frame->page.data +
+    char *record_data = page_handle_.frame->page->data +
                         page_header_->first_record_offset +
                         (index * page_header_->record_size);
     memcpy(record_data, data, page_header_->record_real_size);
 
     RC rc = disk_buffer_pool_->mark_dirty(&page_handle_);
+    page_handle_.wunlatch();
     if (rc != RC::SUCCESS) {
         LOG_ERROR("Failed to mark page dirty. rc =%d:%s", rc, strrc(rc));
         // hard to rollback
@@ -182,24 +412,29 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid) {
 }
 
 RC RecordPageHandler::update_record(const Record *rec) {
+    if (is_slotted()) {
+        return slotted_update_record(rec);
+    }
+
     RC ret = RC::SUCCESS;
 
     if (rec->rid.slot_num >= page_header_->record_capacity) {
         LOG_ERROR(
             "Invalid slot_num %d, exceed page's record capacity, "
             "file_id:page_num %d:%d.",
-            rec->rid.slot_num, file_id_, page_handle_.frame->page.page_num);
+            rec->rid.slot_num, file_id_, page_handle_.frame->page->page_num);
         return RC::INVALID_ARGUMENT;
     }
 
+    page_handle_.wlatch();
     Bitmap bitmap(bitmap_, page_header_->record_capacity);
     if (!bitmap.get_bit(rec->rid.slot_num)) {
         LOG_ERROR("Invalid slot_num %d, slot is empty, file_id:page_num %d:%d.",
                   rec->rid.slot_num, file_id_,
-                  page_handle_.frame->page.page_num);
+                  page_handle_.frame->page->page_num);
         ret = RC::RECORD_RECORD_NOT_EXIST;
     } else {
-        char *record_data = page_handle_.frame->page.data +
+        char *record_data = page_handle_.frame->page->data +
                             page_header_->first_record_offset +
                             (rec->rid.slot_num * page_header_->record_size);
         memcpy(record_data, rec->data, page_header_->record_real_size);
@@ -208,6 +443,7 @@ RC RecordPageHandler::update_record(const Record *rec) {
             LOG_ERROR("Failed to mark page dirty. ret=%s", strrc(ret));
         }
     }
+    page_handle_.wunlatch();
 
     LOG_TRACE("Update record. page num=%d,slot=%d", rec->rid.page_num,
               rec->rid.slot_num);
@@ -215,16 +451,21 @@ RC RecordPageHandler::update_record(const Record *rec) {
 }
 
 RC RecordPageHandler::delete_record(const RID *rid) {
+    if (is_slotted()) {
+        return slotted_delete_record(rid);
+    }
+
     RC ret = RC::SUCCESS;
 
     if (rid->slot_num >= page_header_->record_capacity) {
         LOG_ERROR(
             "Invalid slot_num %d, exceed page's record capacity, "
             "file_id:page_num %d:%d.",
-            rid->slot_num, file_id_, page_handle_.frame->page.page_num);
+            rid->slot_num, file_id_, page_handle_.frame->page->page_num);
         return RC::INVALID_ARGUMENT;
     }
 
+    page_handle_.wlatch();
     Bitmap bitmap(bitmap_, page_header_->record_capacity);
     if (bitmap.get_bit(rid->slot_num)) {
         bitmap.clear_bit(rid->slot_num);
@@ -236,38 +477,40 @@ RC RecordPageHandler::delete_record(const RID *rid) {
             // hard to rollback
         }
 
-        if (page_header_->record_num == 0) {
-            DiskBufferPool *disk_buffer_pool = disk_buffer_pool_;
-            int file_id = file_id_;
-            PageNum page_num = get_page_num();
-            deinit();
-            disk_buffer_pool->dispose_page(file_id, page_num);
-        }
+        page_handle_.wunlatch();
     } else {
+        page_handle_.wunlatch();
         LOG_ERROR("Invalid slot_num %d, slot is empty, file_id:page_num %d:%d.",
-                  rid->slot_num, file_id_, page_handle_.frame->page.page_num);
+                  rid->slot_num, file_id_, page_handle_.frame->page->page_num);
         ret = RC::RECORD_RECORD_NOT_EXIST;
     }
     return ret;
 }
 
 RC RecordPageHandler::get_record(const RID *rid, Record *rec) {
+    if (is_slotted()) {
+        return slotted_get_record(rid, rec);
+    }
+
     if (rid->slot_num >= page_header_->record_capacity) {
         LOG_ERROR(
             "Invalid slot_num:%d, exceed page's record capacity, "
             "file_id:page_num %d:%d.",
-            rid->slot_num, file_id_, page_handle_.frame->page.page_num);
+            rid->slot_num, file_id_, page_handle_.frame->page->page_num);
         return RC::RECORD_INVALIDRID;
     }
 
+    page_handle_.rlatch();
     Bitmap bitmap(bitmap_, page_header_->record_capacity);
-    if (!bitmap.get_bit(rid->slot_num)) {
+    bool exists = bitmap.get_bit(rid->slot_num);
+    page_handle_.runlatch();
+    if (!exists) {
         LOG_ERROR("Invalid slot_num:%d, slot is empty, file_id:page_num %d:%d.",
-                  rid->slot_num, file_id_, page_handle_.frame->page.page_num);
+                  rid->slot_num, file_id_, page_handle_.frame->page->page_num);
         return RC::RECORD_RECORD_NOT_EXIST;
     }
 
-    char *data = page_handle_.frame->page.data +
+    char *data = page_handle_.frame->page->data +
                  page_header_->first_record_offset +
                  (page_header_->record_size * rid->slot_num);
 
@@ -277,26 +520,51 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec) {
     return RC::SUCCESS;
 }
 
+RC RecordPageHandler::copy_record(const RID *rid, Record *rec,
+                                  std::vector<char> &buffer) {
+    RC ret = get_record(rid, rec);
+    if (ret != RC::SUCCESS) {
+        return ret;
+    }
+    if (is_slotted()) {
+        // 已经解码到页面处理器的缓冲区中
+        buffer.assign(rec->data, rec->data + record_size());
+    } else {
+        // 记录指向页面，update_record_in_place在写锁下修改
+        page_handle_.rlatch();
+        buffer.assign(rec->data, rec->data + record_size());
+        page_handle_.runlatch();
+    }
+    rec->data = buffer.data();
+    return RC::SUCCESS;
+}
+
 RC RecordPageHandler::get_first_record(Record *rec) {
     rec->rid.slot_num = -1;
     return get_next_record(rec);
 }
 
 RC RecordPageHandler::get_next_record(Record *rec) {
+    if (is_slotted()) {
+        return slotted_get_next_record(rec);
+    }
+
     if (rec->rid.slot_num >= page_header_->record_capacity - 1) {
         LOG_ERROR(
             "Invalid slot_num:%d, exceed page's record capacity, "
             "file_id:page_num %d:%d.",
-            rec->rid.slot_num, file_id_, page_handle_.frame->page.page_num);
+            rec->rid.slot_num, file_id_, page_handle_.frame->page->page_num);
         return RC::RECORD_EOF;
     }
 
+    page_handle_.rlatch();
     Bitmap bitmap(bitmap_, page_header_->record_capacity);
     int index = bitmap.next_setted_bit(rec->rid.slot_num + 1);
+    page_handle_.runlatch();
 
     if (index < 0) {
         LOG_TRACE("There is no empty slot, file_id:page_num %d:%d.", file_id_,
-                  page_handle_.frame->page.page_num);
+                  page_handle_.frame->page->page_num);
         return RC::RECORD_EOF;
     }
 
@@ -304,30 +572,656 @@ RC RecordPageHandler::get_next_record(Record *rec) {
     rec->rid.slot_num = index;
     // rec->valid = true;
 
-    char *record_data = page_handle_.frame->page.data +
+    char *record_data = page_handle_.frame->page->data +
                         page_header_->first_record_offset +
                         (index * page_header_->record_size);
     rec->data = record_data;
     return RC::SUCCESS;
 }
 
+RC RecordPageHandler::get_records(RecordBatch &batch) {
+    if (is_slotted()) {
+        return slotted_get_records(batch);
+    }
+
+    char *records = page_handle_.frame->page->data +
+                    page_header_->first_record_offset;
+    const PageNum page_num = get_page_num();
+    const int capacity = page_header_->record_capacity;
+    const int bitmap_size = page_bitmap_size(capacity);
+
+    // 按照8字节一组读取位图，跳过全空的字，用ctz取出每个有效的槽位
+    page_handle_.rlatch();
+    batch.records.reserve(batch.records.size() + page_header_->record_num);
+    for (int byte = 0; byte < bitmap_size; byte += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        memcpy(&word, bitmap_ + byte,
+               std::min((int)sizeof(uint64_t), bitmap_size - byte));
+        while (word != 0) {
+            int slot_num = byte * 8 + __builtin_ctzll(word);
+            word &= word - 1;
+            if (slot_num >= capacity) {
+                break;
+            }
+            Record record;
+            record.rid.page_num = page_num;
+            record.rid.slot_num = slot_num;
+            record.data = records + slot_num * page_header_->record_size;
+            batch.records.push_back(record);
+        }
+    }
+    page_handle_.runlatch();
+    return RC::SUCCESS;
+}
+
 PageNum RecordPageHandler::get_page_num() const {
     if (nullptr == page_header_) {
         return (PageNum)(-1);
     }
-    return page_handle_.frame->page.page_num;
+    return page_handle_.frame->page->page_num;
 }
 
 bool RecordPageHandler::is_full() const {
     return page_header_->record_num >= page_header_->record_capacity;
 }
 
+bool RecordPageHandler::can_insert(const char *data) const {
+    if (!is_slotted()) {
+        return !is_full();
+    }
+
+    const SlottedPageHeader *header = slotted_header(page_handle_);
+    int need = inline_size(layout_->encoded_size(data));
+    int slot_num = 0;
+    while (slot_num < header->slot_count &&
+           slot_of(page_handle_, page_size_, slot_num)->offset != 0) {
+        slot_num++;
+    }
+    if (slot_num == header->slot_count) {
+        need += sizeof(Slot);
+    }
+    return header->free_space >= need;
+}
+
+bool RecordPageHandler::is_empty() const {
+    if (is_slotted()) {
+        return slotted_header(page_handle_)->record_num == 0;
+    }
+    return page_header_->record_num == 0;
+}
+
+int RecordPageHandler::free_space() const {
+    if (is_slotted()) {
+        return slotted_header(page_handle_)->free_space;
+    }
+    return page_header_->record_capacity - page_header_->record_num;
+}
+
+int RecordPageHandler::record_size() const {
+    if (is_slotted()) {
+        return layout_->record_size();
+    }
+    return page_header_->record_real_size;
+}
+
+int RecordPageHandler::space_capacity() const {
+    if (is_slotted()) {
+        return page_size_ - sizeof(SlottedPageHeader);
+    }
+    return page_header_->record_capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RC RecordPageHandler::slotted_init_empty_page() {
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    header->page_type = SLOTTED_DATA_PAGE;
+    header->record_num = 0;
+    header->slot_count = 0;
+    header->free_offset = sizeof(SlottedPageHeader);
+    header->free_space = page_size_ - sizeof(SlottedPageHeader);
+
+    RC ret = disk_buffer_pool_->mark_dirty(&page_handle_);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("Failed to mark page dirty. ret=%s", strrc(ret));
+    }
+    return RC::SUCCESS;
+}
+
+static int slotted_inline_size(int page_size, int encoded_size) {
+    // 超过页面四分之一的记录放到溢出页，保证每页至少能放下几条记录。
+    // 槽位中至少要能放下溢出页的引用，更新时可以原地改成溢出记录
+    const int max_inline_size = (page_size - sizeof(SlottedPageHeader)) / 4;
+    if (encoded_size > max_inline_size) {
+        return sizeof(OverflowRef);
+    }
+    return std::max(encoded_size, (int)sizeof(OverflowRef));
+}
+
+int RecordPageHandler::inline_size(int encoded_size) const {
+    return slotted_inline_size(page_size_, encoded_size);
+}
+
+void RecordPageHandler::compact() {
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    char *data = page_handle_.frame->page->data;
+    std::vector<char> records(page_size_);
+    int offset = sizeof(SlottedPageHeader);
+    for (int i = 0; i < header->slot_count; i++) {
+        Slot *slot = slot_of(page_handle_, page_size_, i);
+        if (slot->offset == 0) {
+            continue;
+        }
+        memcpy(records.data() + offset, data + slot->offset, slot_length(slot));
+        slot->offset = offset;
+        offset += slot_length(slot);
+    }
+    memcpy(data + sizeof(SlottedPageHeader),
+           records.data() + sizeof(SlottedPageHeader),
+           offset - sizeof(SlottedPageHeader));
+    header->free_offset = offset;
+}
+
+RC RecordPageHandler::place_payload(int slot_num, const char *payload, int len,
+                                    bool overflow) {
+    // 调用者保证free_space足够，连续的空闲空间不够时整理碎片
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    int contiguous = page_size_ - header->slot_count * (int)sizeof(Slot) -
+                     header->free_offset;
+    if (contiguous < len) {
+        compact();
+    }
+
+    Slot *slot = slot_of(page_handle_, page_size_, slot_num);
+    memcpy(page_handle_.frame->page->data + header->free_offset, payload, len);
+    slot->offset = header->free_offset;
+    slot->length = len | (overflow ? SLOT_OVERFLOW : 0);
+    header->free_offset += len;
+    header->free_space -= len;
+    return RC::SUCCESS;
+}
+
+RC RecordPageHandler::write_overflow(const char *data, int len,
+                                     PageNum *first_page) {
+    const int chunk_size = page_size_ - sizeof(OverflowPageHeader);
+    *first_page = -1;
+    BPPageHandle prev_handle;
+    RC rc = RC::SUCCESS;
+    for (int written = 0; written < len; written += chunk_size) {
+        BPPageHandle page_handle;
+        rc = disk_buffer_pool_->allocate_page(file_id_, &page_handle);
+        if (rc != RC::SUCCESS) {
+            LOG_ERROR("Failed to allocate overflow page. file_id=%d, rc=%s",
+                      file_id_, strrc(rc));
+            break;
+        }
+
+        char *page_data = page_handle.frame->page->data;
+        OverflowPageHeader *header = (OverflowPageHeader *)page_data;
+        header->page_type = OVERFLOW_PAGE;
+        header->next_page = -1;
+        header->data_len = std::min(chunk_size, len - written);
+        memcpy(page_data + sizeof(OverflowPageHeader), data + written,
+               header->data_len);
+        disk_buffer_pool_->mark_dirty(&page_handle);
+
+        PageNum page_num = page_handle.frame->page->page_num;
+        if (*first_page < 0) {
+            *first_page = page_num;
+        } else {
+            ((OverflowPageHeader *)prev_handle.frame->page->data)->next_page =
+                page_num;
+            disk_buffer_pool_->mark_dirty(&prev_handle);
+            disk_buffer_pool_->unpin_page(&prev_handle);
+        }
+        prev_handle = page_handle;
+    }
+
+    if (*first_page >= 0) {
+        disk_buffer_pool_->unpin_page(&prev_handle);
+    }
+    if (rc != RC::SUCCESS && *first_page >= 0) {
+        free_overflow(*first_page);
+        *first_page = -1;
+    }
+    return rc;
+}
+
+RC RecordPageHandler::read_overflow(PageNum first_page, int len, char *data) {
+    int read = 0;
+    PageNum page_num = first_page;
+    while (read < len && page_num >= 0) {
+        BPPageHandle page_handle;
+        RC rc =
+            disk_buffer_pool_->get_readonly_page(file_id_, page_num, &page_handle);
+        if (rc != RC::SUCCESS) {
+            LOG_ERROR("Failed to get overflow page %d. file_id=%d, rc=%s",
+                      page_num, file_id_, strrc(rc));
+            return rc;
+        }
+
+        const char *page_data = page_handle.frame->page->data;
+        const OverflowPageHeader *header = (const OverflowPageHeader *)page_data;
+        if (header->page_type != OVERFLOW_PAGE ||
+            header->data_len > len - read) {
+            disk_buffer_pool_->unpin_page(&page_handle);
+            LOG_ERROR("Invalid overflow page %d. file_id=%d", page_num,
+                      file_id_);
+            return RC::RECORD_INVALIDRECSIZE;
+        }
+        memcpy(data + read, page_data + sizeof(OverflowPageHeader),
+               header->data_len);
+        read += header->data_len;
+        page_num = header->next_page;
+        disk_buffer_pool_->unpin_page(&page_handle);
+    }
+    return read == len ? RC::SUCCESS : RC::RECORD_INVALIDRECSIZE;
+}
+
+RC RecordPageHandler::free_overflow(PageNum first_page) {
+    PageNum page_num = first_page;
+    while (page_num >= 0) {
+        BPPageHandle page_handle;
+        RC rc =
+            disk_buffer_pool_->get_readonly_page(file_id_, page_num, &page_handle);
+        if (rc != RC::SUCCESS) {
+            return rc;
+        }
+        PageNum next_page =
+            ((const OverflowPageHeader *)page_handle.frame->page->data)
+                ->next_page;
+        disk_buffer_pool_->unpin_page(&page_handle);
+        rc = disk_buffer_pool_->dispose_page(file_id_, page_num);
+        if (rc != RC::SUCCESS) {
+            LOG_ERROR("Failed to dispose overflow page %d. file_id=%d, rc=%s",
+                      page_num, file_id_, strrc(rc));
+            return rc;
+        }
+        page_num = next_page;
+    }
+    return RC::SUCCESS;
+}
+
+RC RecordPageHandler::slotted_insert_record(const char *data, RID *rid) {
+    const int encoded_size = layout_->encoded_size(data);
+    std::vector<char> payload(std::max(encoded_size, (int)sizeof(OverflowRef)));
+    layout_->encode(data, payload.data());
+    int len = inline_size(encoded_size);
+    bool overflow = len < encoded_size;
+
+    page_handle_.wlatch();
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    int slot_num = 0;
+    while (slot_num < header->slot_count &&
+           slot_of(page_handle_, page_size_, slot_num)->offset != 0) {
+        slot_num++;
+    }
+    int need = len + (slot_num == header->slot_count ? sizeof(Slot) : 0);
+    if (header->free_space < need) {
+        page_handle_.wunlatch();
+        LOG_WARN("Page is full, file_id:page_num %d:%d.", file_id_,
+                 page_handle_.frame->page->page_num);
+        return RC::RECORD_NOMEM;
+    }
+
+    if (overflow) {
+        OverflowRef ref;
+        ref.length = encoded_size;
+        RC rc = write_overflow(payload.data(), encoded_size, &ref.first_page);
+        if (rc != RC::SUCCESS) {
+            page_handle_.wunlatch();
+            return rc;
+        }
+        memcpy(payload.data(), &ref, sizeof(ref));
+    }
+
+    if (slot_num == header->slot_count) {
+        // 新的槽位占用连续空闲空间的末尾，先把碎片整理出来
+        int contiguous = page_size_ - header->slot_count * (int)sizeof(Slot) -
+                         header->free_offset;
+        if (contiguous < need) {
+            compact();
+        }
+        header->slot_count++;
+        header->free_space -= sizeof(Slot);
+        Slot *slot = slot_of(page_handle_, page_size_, slot_num);
+        slot->offset = 0;
+        slot->length = 0;
+    }
+    place_payload(slot_num, payload.data(), len, overflow);
+    header->record_num++;
+
+    RC rc = disk_buffer_pool_->mark_dirty(&page_handle_);
+    page_handle_.wunlatch();
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to mark page dirty. rc =%d:%s", rc, strrc(rc));
+    }
+
+    if (rid) {
+        rid->page_num = get_page_num();
+        rid->slot_num = slot_num;
+    }
+    return RC::SUCCESS;
+}
+
+RC RecordPageHandler::slotted_update_record(const Record *rec) {
+    const int encoded_size = layout_->encoded_size(rec->data);
+    std::vector<char> payload(std::max(encoded_size, (int)sizeof(OverflowRef)));
+    layout_->encode(rec->data, payload.data());
+    int len = inline_size(encoded_size);
+
+    page_handle_.wlatch();
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    Slot *slot = rec->rid.slot_num >= 0 && rec->rid.slot_num < header->slot_count
+                     ? slot_of(page_handle_, page_size_, rec->rid.slot_num)
+                     : nullptr;
+    if (slot == nullptr || slot->offset == 0) {
+        page_handle_.wunlatch();
+        LOG_ERROR("Invalid slot_num %d, slot is empty, file_id:page_num %d:%d.",
+                  rec->rid.slot_num, file_id_,
+                  page_handle_.frame->page->page_num);
+        return RC::RECORD_RECORD_NOT_EXIST;
+    }
+
+    const int old_len = slot_length(slot);
+    OverflowRef old_ref;
+    old_ref.first_page = -1;
+    if (slot->length & SLOT_OVERFLOW) {
+        memcpy(&old_ref, page_handle_.frame->page->data + slot->offset,
+               sizeof(old_ref));
+    }
+
+    // 页面中放不下变长之后的记录时改成溢出记录，RID保持不变
+    if (len > old_len && header->free_space + old_len < len) {
+        len = sizeof(OverflowRef);
+    }
+    bool overflow = len < encoded_size;
+    if (overflow) {
+        OverflowRef ref;
+        ref.length = encoded_size;
+        RC rc = write_overflow(payload.data(), encoded_size, &ref.first_page);
+        if (rc != RC::SUCCESS) {
+            page_handle_.wunlatch();
+            return rc;
+        }
+        memcpy(payload.data(), &ref, sizeof(ref));
+    }
+
+    if (len <= old_len) {
+        memcpy(page_handle_.frame->page->data + slot->offset, payload.data(),
+               len);
+        slot->length = len | (overflow ? SLOT_OVERFLOW : 0);
+        header->free_space += old_len - len;
+    } else {
+        slot->offset = 0;
+        slot->length = 0;
+        header->free_space += old_len;
+        place_payload(rec->rid.slot_num, payload.data(), len, overflow);
+    }
+
+    RC ret = disk_buffer_pool_->mark_dirty(&page_handle_);
+    page_handle_.wunlatch();
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("Failed to mark page dirty. ret=%s", strrc(ret));
+    }
+    if (old_ref.first_page >= 0) {
+        free_overflow(old_ref.first_page);
+    }
+    return ret;
+}
+
+RC RecordPageHandler::slotted_delete_record(const RID *rid) {
+    page_handle_.wlatch();
+    SlottedPageHeader *header = slotted_header(page_handle_);
+    Slot *slot = rid->slot_num >= 0 && rid->slot_num < header->slot_count
+                     ? slot_of(page_handle_, page_size_, rid->slot_num)
+                     : nullptr;
+    if (slot == nullptr || slot->offset == 0) {
+        page_handle_.wunlatch();
+        LOG_ERROR("Invalid slot_num %d, slot is empty, file_id:page_num %d:%d.",
+                  rid->slot_num, file_id_, page_handle_.frame->page->page_num);
+        return RC::RECORD_RECORD_NOT_EXIST;
+    }
+
+    OverflowRef ref;
+    ref.first_page = -1;
+    if (slot->length & SLOT_OVERFLOW) {
+        memcpy(&ref, page_handle_.frame->page->data + slot->offset, sizeof(ref));
+    }
+    header->free_space += slot_length(slot);
+    slot->offset = 0;
+    slot->length = 0;
+    header->record_num--;
+
+    // 回收目录末尾的空闲槽位
+    while (header->slot_count > 0 &&
+           slot_of(page_handle_, page_size_, header->slot_count - 1)->offset ==
+               0) {
+        header->slot_count--;
+        header->free_space += sizeof(Slot);
+    }
+
+    RC ret = disk_buffer_pool_->mark_dirty(&page_handle_);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("failed to mark page dirty in delete record. ret=%d:%s", ret,
+                  strrc(ret));
+    }
+    page_handle_.wunlatch();
+
+    if (ref.first_page >= 0) {
+        free_overflow(ref.first_page);
+    }
+    return RC::SUCCESS;
+}
+
+RC RecordPageHandler::slotted_get_record(const RID *rid, Record *rec) {
+    page_handle_.rlatch();
+    const SlottedPageHeader *header = slotted_header(page_handle_);
+    const Slot *slot =
+        rid->slot_num >= 0 && rid->slot_num < header->slot_count
+            ? slot_of(page_handle_, page_size_, rid->slot_num)
+            : nullptr;
+    if (slot == nullptr || slot->offset == 0) {
+        page_handle_.runlatch();
+        LOG_ERROR("Invalid slot_num:%d, slot is empty, file_id:page_num %d:%d.",
+                  rid->slot_num, file_id_, page_handle_.frame->page->page_num);
+        return RC::RECORD_RECORD_NOT_EXIST;
+    }
+
+    RC rc = RC::SUCCESS;
+    record_buf_.resize(layout_->record_size());
+    const char *payload = page_handle_.frame->page->data + slot->offset;
+    if (slot->length & SLOT_OVERFLOW) {
+        OverflowRef ref;
+        memcpy(&ref, payload, sizeof(ref));
+        std::vector<char> encoded(ref.length);
+        rc = read_overflow(ref.first_page, ref.length, encoded.data());
+        if (rc == RC::SUCCESS) {
+            rc = layout_->decode(encoded.data(), ref.length, record_buf_.data());
+        }
+    } else {
+        rc = layout_->decode(payload, slot_length(slot), record_buf_.data());
+    }
+    page_handle_.runlatch();
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to decode record. file_id:page_num:slot_num %d:%d:%d",
+                  file_id_, rid->page_num, rid->slot_num);
+        return rc;
+    }
+
+    rec->rid = *rid;
+    rec->data = record_buf_.data();
+    return RC::SUCCESS;
+}
+
+RC RecordPageHandler::slotted_get_next_record(Record *rec) {
+    page_handle_.rlatch();
+    const int slot_count = slotted_header(page_handle_)->slot_count;
+    int slot_num = rec->rid.slot_num + 1;
+    while (slot_num < slot_count &&
+           slot_of(page_handle_, page_size_, slot_num)->offset == 0) {
+        slot_num++;
+    }
+    page_handle_.runlatch();
+    if (slot_num >= slot_count) {
+        return RC::RECORD_EOF;
+    }
+
+    RID rid;
+    rid.page_num = get_page_num();
+    rid.slot_num = slot_num;
+    return slotted_get_record(&rid, rec);
+}
+
+RC RecordPageHandler::slotted_get_records(RecordBatch &batch) {
+    const int record_size = layout_->record_size();
+    const PageNum page_num = get_page_num();
+    const size_t first = batch.records.size();
+
+    page_handle_.rlatch();
+    const SlottedPageHeader *header = slotted_header(page_handle_);
+    batch.buffer.resize((first + header->record_num) * record_size);
+    RC rc = RC::SUCCESS;
+    for (int slot_num = 0; slot_num < header->slot_count && rc == RC::SUCCESS;
+         slot_num++) {
+        const Slot *slot = slot_of(page_handle_, page_size_, slot_num);
+        if (slot->offset == 0) {
+            continue;
+        }
+
+        const size_t index = batch.records.size();
+        if ((index + 1) * record_size > batch.buffer.size()) {
+            batch.buffer.resize((index + 1) * record_size);
+        }
+        char *record_data = batch.buffer.data() + index * record_size;
+        const char *payload = page_handle_.frame->page->data + slot->offset;
+        if (slot->length & SLOT_OVERFLOW) {
+            OverflowRef ref;
+            memcpy(&ref, payload, sizeof(ref));
+            std::vector<char> encoded(ref.length);
+            rc = read_overflow(ref.first_page, ref.length, encoded.data());
+            if (rc == RC::SUCCESS) {
+                rc = layout_->decode(encoded.data(), ref.length, record_data);
+            }
+        } else {
+            rc = layout_->decode(payload, slot_length(slot), record_data);
+        }
+
+        Record record;
+        record.rid.page_num = page_num;
+        record.rid.slot_num = slot_num;
+        record.data = nullptr;  // buffer可能还会扩容，最后再设置
+        batch.records.push_back(record);
+    }
+    page_handle_.runlatch();
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to decode records. file_id:page_num %d:%d", file_id_,
+                  page_num);
+        batch.records.resize(first);
+        return rc;
+    }
+
+    // 前面的批次也可能因为扩容移动了位置
+    for (size_t i = 0; i < batch.records.size(); i++) {
+        batch.records[i].data = batch.buffer.data() + i * record_size;
+    }
+    return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int RecordFreeSpaceMap::bucket_of(int free_space) const {
+    if (free_space <= 0 || capacity_ <= 0) {
+        return 0;
+    }
+    // 空闲空间(0, capacity]平均分到桶1 ~ BUCKET_NUM-1
+    return 1 + (int)((int64_t)(free_space - 1) * (BUCKET_NUM - 1) / capacity_);
+}
+
+int RecordFreeSpaceMap::bucket_min_space(int bucket) const {
+    if (bucket <= 0) {
+        return 0;
+    }
+    // bucket_of(space) == bucket的最小的space
+    int64_t n = (int64_t)(bucket - 1) * capacity_;
+    return (int)((n + BUCKET_NUM - 2) / (BUCKET_NUM - 1)) + 1;
+}
+
+void RecordFreeSpaceMap::update(PageNum page_num, int free_space,
+                                int capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    int bucket = bucket_of(free_space);
+    auto iter = page_buckets_.find(page_num);
+    if (iter != page_buckets_.end()) {
+        if (iter->second == bucket) {
+            return;
+        }
+        buckets_[iter->second].erase(page_num);
+        iter->second = bucket;
+    } else {
+        page_buckets_.emplace(page_num, bucket);
+    }
+    buckets_[bucket].insert(page_num);
+}
+
+void RecordFreeSpaceMap::remove(PageNum page_num) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = page_buckets_.find(page_num);
+    if (iter != page_buckets_.end()) {
+        buckets_[iter->second].erase(page_num);
+        page_buckets_.erase(iter);
+    }
+}
+
+void RecordFreeSpaceMap::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    page_buckets_.clear();
+    for (std::set<PageNum> &bucket : buckets_) {
+        bucket.clear();
+    }
+}
+
+PageNum RecordFreeSpaceMap::find(int need, PageNum before) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 优先使用空闲空间少的页面，让数据集中在前面的页面上
+    int bucket = std::max(1, bucket_of(need));
+    if (bucket_min_space(bucket) < need) {
+        bucket++;
+    }
+    for (; bucket < BUCKET_NUM; bucket++) {
+        const std::set<PageNum> &pages = buckets_[bucket];
+        if (!pages.empty() && (before < 0 || *pages.begin() < before)) {
+            return *pages.begin();
+        }
+    }
+    return -1;
+}
+
+void RecordFreeSpaceMap::sparse_pages(int free_percent,
+                                      std::vector<PageNum> &pages) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int min_space = (int)((int64_t)capacity_ * free_percent / 100);
+    pages.clear();
+    for (int bucket = 1; bucket < BUCKET_NUM; bucket++) {
+        if (bucket_min_space(bucket) >= min_space) {
+            pages.insert(pages.end(), buckets_[bucket].begin(),
+                         buckets_[bucket].end());
+        }
+    }
+    std::sort(pages.begin(), pages.end(), std::greater<PageNum>());
+}
+
+int RecordFreeSpaceMap::page_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return page_buckets_.size();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::RecordFileHandler()
     : disk_buffer_pool_(nullptr), file_id_(-1) {}
 
-RC RecordFileHandler::init(DiskBufferPool &buffer_pool, int file_id) {
+RC RecordFileHandler::init(DiskBufferPool &buffer_pool, int file_id,
+                           const RecordLayout &layout) {
     RC ret = RC::SUCCESS;
 
     if (disk_buffer_pool_ != nullptr) {
@@ -337,6 +1231,7 @@ RC RecordFileHandler::init(DiskBufferPool &buffer_pool, int file_id) {
 
     disk_buffer_pool_ = &buffer_pool;
     file_id_ = file_id;
+    layout_ = layout;
 
     LOG_TRACE("Successfully open %d.", file_id);
     return ret;
@@ -346,45 +1241,81 @@ void RecordFileHandler::close() {
     if (disk_buffer_pool_ != nullptr) {
         disk_buffer_pool_ = nullptr;
     }
+    free_space_map_.clear();
+    free_space_loaded_ = false;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size,
-                                    RID *rid) {
-    RC ret = RC::SUCCESS;
-    // 找到没有填满的页面
+RC RecordFileHandler::load_free_space_map() {
+    RC ret = disk_buffer_pool_->get_page_data_size(file_id_, &page_data_size_);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("Failed to get page data size. file_id=%d, ret=%d:%s",
+                  file_id_, ret, strrc(ret));
+        return ret;
+    }
+
     int page_count = 0;
     if ((ret = disk_buffer_pool_->get_page_count(file_id_, &page_count)) !=
         RC::SUCCESS) {
-        LOG_ERROR("Failed to get page count while inserting record");
+        LOG_ERROR("Failed to get page count while loading free space map");
         return ret;
     }
 
-    PageNum current_page_num = record_page_handler_.get_page_num();
-    if (current_page_num < 0) {
-        if (page_count >= 2) {  // 当前buffer pool 有页面时才尝试加载第一页
-            // 参考diskBufferPool，pageNum从1开始
-            if ((ret = record_page_handler_.init(*disk_buffer_pool_, file_id_,
-                                                 1)) != RC::SUCCESS) {
-                LOG_ERROR("Failed to init record page handler.ret=%d", ret);
-                return ret;
-            }
-            current_page_num = record_page_handler_.get_page_num();
-        } else {
-            current_page_num = 0;
+    free_space_map_.clear();
+    // 参考diskBufferPool，pageNum从1开始
+    for (PageNum page_num = 1; page_num < page_count; page_num++) {
+        RecordPageHandler page_handler;
+        ret = page_handler.init(*disk_buffer_pool_, file_id_, page_num, true,
+                                &layout_);
+        if (ret == RC::BUFFERPOOL_INVALID_PAGE_NUM) {
+            continue;
         }
+        if (ret != RC::SUCCESS) {
+            LOG_ERROR("Failed to init record page handler. page num=%d, "
+                      "ret=%d:%s",
+                      page_num, ret, strrc(ret));
+            return ret;
+        }
+        free_space_map_.update(page_num, page_handler.free_space(),
+                               page_handler.space_capacity());
+    }
+
+    free_space_loaded_ = true;
+    LOG_INFO("Load free space map of file %d, %d record pages.", file_id_,
+             free_space_map_.page_count());
+    return RC::SUCCESS;
+}
+
+int RecordFileHandler::space_needed(const char *data) const {
+    if (layout_.format() != RecordFormat::SLOTTED) {
+        return 1;
+    }
+    // 按照要新增一个槽位计算，可能会多估几个字节
+    return slotted_inline_size(page_data_size_, layout_.encoded_size(data)) +
+           sizeof(Slot);
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size,
+                                    RID *rid) {
+    return insert_record(data, record_size, rid, -1, true);
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size,
+                                    RID *rid, PageNum before, bool allocate) {
+    RC ret = RC::SUCCESS;
+    if (!free_space_loaded_ && (ret = load_free_space_map()) != RC::SUCCESS) {
+        return ret;
     }
 
+    // 从空闲空间表中找到能放下记录的页面
+    const int need = space_needed(data);
     bool page_found = false;
-    for (int i = 0; i < page_count; i++) {
-        current_page_num =
-            (current_page_num + i) % page_count;  // 从当前打开的页面开始查找
-        if (current_page_num == 0) {
-            continue;
-        }
+    PageNum current_page_num = -1;
+    while (!page_found &&
+           (current_page_num = free_space_map_.find(need, before)) >= 0) {
         if (current_page_num != record_page_handler_.get_page_num()) {
             record_page_handler_.deinit();
             ret = record_page_handler_.init(*disk_buffer_pool_, file_id_,
-                                            current_page_num);
+                                            current_page_num, false, &layout_);
             if (ret != RC::SUCCESS && ret != RC::BUFFERPOOL_INVALID_PAGE_NUM) {
                 LOG_ERROR(
                     "Failed to init record page handler. page number is %d. "
@@ -392,14 +1323,26 @@ RC RecordFileHandler::insert_record(const char *data, int record_size,
                     current_page_num, ret, strrc(ret));
                 return ret;
             }
+            if (ret == RC::BUFFERPOOL_INVALID_PAGE_NUM) {
+                free_space_map_.remove(current_page_num);
+                continue;
+            }
         }
 
-        if (!record_page_handler_.is_full()) {
-            page_found = true;
-            break;
+        page_found = record_page_handler_.can_insert(data);
+        if (!page_found) {
+            // 空闲空间有碎片或者已经过期，按照页面上的实际值更新
+            free_space_map_.update(current_page_num,
+                                   std::min(record_page_handler_.free_space(),
+                                            need - 1),
+                                   record_page_handler_.space_capacity());
         }
     }
 
+    if (!page_found && !allocate) {
+        return RC::RECORD_NOMEM;
+    }
+
     // 找不到就分配一个新的页面
     if (!page_found) {
         BPPageHandle page_handle;
@@ -412,10 +1355,11 @@ RC RecordFileHandler::insert_record(const char *data, int record_size,
             return ret;
         }
 
-        current_page_num = page_handle.frame->page.page_num;
+        current_page_num = page_handle.frame->page->page_num;
         record_page_handler_.deinit();
         ret = record_page_handler_.init_empty_page(
-            *disk_buffer_pool_, file_id_, current_page_num, record_size);
+            *disk_buffer_pool_, file_id_, current_page_num, record_size,
+            &layout_);
         if (ret != RC::SUCCESS) {
             LOG_ERROR("Failed to init empty page. file_id:%d, ret:%d", file_id_,
                       ret);
@@ -430,38 +1374,127 @@ RC RecordFileHandler::insert_record(const char *data, int record_size,
     }
 
     // 找到空闲位置
-    return record_page_handler_.insert_record(data, rid);
+    ret = record_page_handler_.insert_record(data, rid);
+    free_space_map_.update(current_page_num, record_page_handler_.free_space(),
+                           record_page_handler_.space_capacity());
+    return ret;
+}
+
+RC RecordFileHandler::sparse_pages(int free_percent,
+                                   std::vector<PageNum> &pages) {
+    RC ret = RC::SUCCESS;
+    if (!free_space_loaded_ && (ret = load_free_space_map()) != RC::SUCCESS) {
+        return ret;
+    }
+    free_space_map_.sparse_pages(free_percent, pages);
+    return RC::SUCCESS;
+}
+
+RC RecordFileHandler::get_page_records(PageNum page_num, RecordBatch &batch) {
+    batch.clear();
+    RecordPageHandler page_handler;
+    RC ret = page_handler.init(*disk_buffer_pool_, file_id_, page_num, true,
+                               &layout_);
+    if (ret != RC::SUCCESS) {
+        return ret;
+    }
+    ret = page_handler.get_records(batch);
+    if (ret != RC::SUCCESS || layout_.format() == RecordFormat::SLOTTED) {
+        return ret;
+    }
+
+    // FIXED格式的记录指向页面，复制出来之后页面就可以释放
+    const int record_size = page_handler.record_size();
+    batch.buffer.resize(batch.records.size() * record_size);
+    for (size_t i = 0; i < batch.records.size(); i++) {
+        char *data = batch.buffer.data() + i * record_size;
+        memcpy(data, batch.records[i].data, record_size);
+        batch.records[i].data = data;
+    }
+    return RC::SUCCESS;
+}
+
+RC RecordFileHandler::relocate_record(const char *data, PageNum before,
+                                      RID *rid) {
+    // 只会用到已有页面的空闲空间，所以不需要记录的大小
+    return insert_record(data, 0, rid, before, false);
+}
+
+RC RecordFileHandler::dispose_empty_page(PageNum page_num) {
+    if (page_num == record_page_handler_.get_page_num()) {
+        record_page_handler_.deinit();
+    }
+    RC ret = disk_buffer_pool_->dispose_page(file_id_, page_num);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR("Failed to dispose empty page %d. file_id=%d, ret=%d:%s",
+                  page_num, file_id_, ret, strrc(ret));
+        return ret;
+    }
+    free_space_map_.remove(page_num);
+    return RC::SUCCESS;
 }
 
 RC RecordFileHandler::update_record(const Record *rec) {
     RC ret = RC::SUCCESS;
 
     RecordPageHandler page_handler;
-    if ((ret != page_handler.init(*disk_buffer_pool_, file_id_,
-                                  rec->rid.page_num)) != RC::SUCCESS) {
+    if ((ret = page_handler.init(*disk_buffer_pool_, file_id_,
+                                  rec->rid.page_num, false, &layout_)) !=
+        RC::SUCCESS) {
         LOG_ERROR(
             "Failed to init record page handler.page number=%d, file_id=%d",
             rec->rid.page_num, file_id_);
         return ret;
     }
 
-    return page_handler.update_record(rec);
+    ret = page_handler.update_record(rec);
+    free_space_map_.update(rec->rid.page_num, page_handler.free_space(),
+                           page_handler.space_capacity());
+    return ret;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid) {
     RC ret = RC::SUCCESS;
+    if (rid->page_num == record_page_handler_.get_page_num()) {
+        // 页面删空之后要释放，不能被插入使用的处理器固定住
+        record_page_handler_.deinit();
+    }
+
     RecordPageHandler page_handler;
-    if ((ret != page_handler.init(*disk_buffer_pool_, file_id_,
-                                  rid->page_num)) != RC::SUCCESS) {
+    if ((ret = page_handler.init(*disk_buffer_pool_, file_id_,
+                                  rid->page_num, false, &layout_)) !=
+        RC::SUCCESS) {
         LOG_ERROR(
             "Failed to init record page handler.page number=%d, file_id:%d",
             rid->page_num, file_id_);
         return ret;
     }
-    return page_handler.delete_record(rid);
+    ret = page_handler.delete_record(rid);
+    if (ret != RC::SUCCESS) {
+        return ret;
+    }
+
+    const int free_space = page_handler.free_space();
+    const int capacity = page_handler.space_capacity();
+    if (page_handler.is_empty()) {
+        // 页面删空之后释放。扫描等其它线程还固定着页面时释放失败，
+        // 页面留在空闲空间表中，之后的插入或者vacuum还能用到它
+        page_handler.deinit();
+        RC rc = disk_buffer_pool_->dispose_page(file_id_, rid->page_num);
+        if (rc == RC::SUCCESS) {
+            free_space_map_.remove(rid->page_num);
+            return RC::SUCCESS;
+        }
+        LOG_WARN("Failed to dispose empty page %d, keep it. file_id=%d, "
+                 "rc=%d:%s",
+                 rid->page_num, file_id_, rc, strrc(rc));
+    }
+    free_space_map_.update(rid->page_num, free_space, capacity);
+    return RC::SUCCESS;
 }
 
-RC RecordFileHandler::get_record(const RID *rid, Record *rec) {
+RC RecordFileHandler::get_record(const RID *rid, Record *rec,
+                                 std::vector<char> &buffer) {
     // lock?
     RC ret = RC::SUCCESS;
     if (nullptr == rid || nullptr == rec) {
@@ -469,34 +1502,45 @@ RC RecordFileHandler::get_record(const RID *rid, Record *rec) {
         return RC::INVALID_ARGUMENT;
     }
     RecordPageHandler page_handler;
-    if ((ret != page_handler.init(*disk_buffer_pool_, file_id_,
-                                  rid->page_num)) != RC::SUCCESS) {
+    if ((ret = page_handler.init(*disk_buffer_pool_, file_id_,
+                                  rid->page_num, true, &layout_)) !=
+        RC::SUCCESS) {
         LOG_ERROR(
             "Failed to init record page handler.page number=%d, file_id:%d",
             rid->page_num, file_id_);
         return ret;
     }
 
-    return page_handler.get_record(rid, rec);
+    // 页面处理器析构之后页面不再被固定，返回之前把记录复制出来
+    return page_handler.copy_record(rid, rec, buffer);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileScanner::RecordFileScanner()
-    : disk_buffer_pool_(nullptr), file_id_(-1), condition_filter_(nullptr) {}
+    : disk_buffer_pool_(nullptr),
+      file_id_(-1),
+      next_batch_page_(1),
+      condition_filter_(nullptr),
+      layout_(nullptr) {}
 
 RC RecordFileScanner::open_scan(DiskBufferPool &buffer_pool, int file_id,
-                                ConditionFilter *condition_filter) {
+                                ConditionFilter *condition_filter,
+                                const RecordLayout *layout) {
     close_scan();
 
     disk_buffer_pool_ = &buffer_pool;
     file_id_ = file_id;
+    layout_ = layout;
+    next_batch_page_ = 1;  // from 1 参考DiskBufferPool
 
     condition_filter_ = condition_filter;
     return RC::SUCCESS;
 }
 
 RC RecordFileScanner::close_scan() {
+    // 关闭之后不再固定当前页面，页面删空之后才能释放
+    record_page_handler_.deinit();
     if (disk_buffer_pool_ != nullptr) {
         disk_buffer_pool_ = nullptr;
     }
@@ -542,7 +1586,8 @@ RC RecordFileScanner::get_next_record(Record *rec) {
             record_page_handler_.get_page_num()) {
             record_page_handler_.deinit();
             ret = record_page_handler_.init(*disk_buffer_pool_, file_id_,
-                                            current_record.rid.page_num);
+                                            current_record.rid.page_num, true,
+                                            layout_);
             if (ret != RC::SUCCESS && ret != RC::BUFFERPOOL_INVALID_PAGE_NUM) {
                 LOG_ERROR("Failed to init record page handler. page num=%d",
                           current_record.rid.page_num);
@@ -575,3 +1620,60 @@ RC RecordFileScanner::get_next_record(Record *rec) {
     }
     return ret;
 }
+
+RC RecordFileScanner::next_batch(RecordBatch &batch) {
+    if (nullptr == disk_buffer_pool_) {
+        LOG_ERROR("Scanner has been closed.");
+        return RC::RECORD_CLOSED;
+    }
+
+    batch.clear();
+    int page_count = 0;
+    RC ret = disk_buffer_pool_->get_page_count(file_id_, &page_count);
+    if (ret != RC::SUCCESS) {
+        LOG_ERROR(
+            "Failed to get page count while getting next batch. file id=%d",
+            file_id_);
+        return RC::RECORD_EOF;
+    }
+
+    while (next_batch_page_ < page_count) {
+        const PageNum page_num = next_batch_page_++;
+        // 上一批记录可能指向当前固定的页面，换页之后才能释放
+        record_page_handler_.deinit();
+        ret = record_page_handler_.init(*disk_buffer_pool_, file_id_, page_num,
+                                        true, layout_);
+        if (RC::BUFFERPOOL_INVALID_PAGE_NUM == ret) {
+            continue;
+        }
+        if (ret != RC::SUCCESS) {
+            LOG_ERROR("Failed to init record page handler. page num=%d",
+                      page_num);
+            return ret;
+        }
+
+        ret = record_page_handler_.get_records(batch);
+        if (ret != RC::SUCCESS) {
+            return ret;
+        }
+
+        if (condition_filter_ != nullptr) {
+            // 整批过滤，再按照选择位图留下满足条件的记录
+            const int num = batch.size();
+            select_.assign((num + 7) / 8, (char)0xFF);
+            condition_filter_->filter_batch(batch.records.data(), num,
+                                            select_.data());
+            Bitmap select(select_.data(), num);
+            int count = 0;
+            for (int i = select.next_setted_bit(0); i >= 0;
+                 i = select.next_setted_bit(i + 1)) {
+                batch.records[count++] = batch.records[i];
+            }
+            batch.records.resize(count);
+        }
+        if (!batch.records.empty()) {
+            return RC::SUCCESS;
+        }
+    }
+    return RC::RECORD_EOF;
+}
@@ -13,6 +13,12 @@ See the Mulan PSL v2 for more details. */
 #ifndef __OBSERVER_STORAGE_COMMON_RECORD_MANAGER_H_
 #define __OBSERVER_STORAGE_COMMON_RECORD_MANAGER_H_
 
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "storage/default/disk_buffer_pool.h"
 
 typedef int SlotNum;
@@ -42,13 +48,82 @@ struct Record {
     char *data;  // record's data
 };
 
+/**
+ * 一个页面上的一批记录。FIXED格式的记录直接指向页面，SLOTTED格式的记录解码到buffer中，
+ * 在下次获取批量记录或者关闭扫描之前有效
+ */
+struct RecordBatch {
+    std::vector<Record> records;
+    std::vector<char> buffer;
+
+    int size() const { return records.size(); }
+    void clear() {
+        records.clear();
+        buffer.clear();
+    }
+};
+
+/**
+ * 记录在页面上的存储格式。
+ * FIXED: 页面按照记录大小划分成固定的槽位，字符串字段总是占用声明的最大长度；
+ * SLOTTED: 页面尾部是槽位目录，记录按照实际长度保存，过长的记录保存到溢出页
+ */
+enum class RecordFormat { FIXED, SLOTTED };
+
+const char *record_format_name(RecordFormat format);
+bool record_format_from_name(const char *name, RecordFormat &format);
+
+/**
+ * 设置新建的表使用的记录格式，table_name为空时设置默认格式
+ */
+void assign_table_record_format(const char *table_name, RecordFormat format);
+RecordFormat theTableRecordFormat(const char *table_name);
+
+/**
+ * 文件中记录的格式。SLOTTED格式的记录在页面上保存编码后的内容，变长字段去掉末尾的'\0'，
+ * 读取时再解码成定长的记录，上层仍然按照字段偏移访问记录
+ */
+class RecordLayout {
+public:
+    RecordLayout() = default;
+    RecordLayout(RecordFormat format, int record_size)
+        : format_(format), record_size_(record_size) {}
+
+    /**
+     * 添加一个变长字段，字段的内容在记录中的[offset, offset + len)
+     */
+    void add_var_field(int offset, int len);
+
+    RecordFormat format() const { return format_; }
+    int record_size() const { return record_size_; }
+
+    int encoded_size(const char *record) const;
+    /**
+     * 把记录编码到buf中，buf的大小至少为encoded_size，返回编码后的长度
+     */
+    int encode(const char *record, char *buf) const;
+    RC decode(const char *buf, int len, char *record) const;
+
+private:
+    RecordFormat format_ = RecordFormat::FIXED;
+    int record_size_ = 0;
+    std::vector<std::pair<int, int>> var_fields_;  // (offset, len)，按照偏移排序
+};
+
 class RecordPageHandler {
 public:
     RecordPageHandler();
     ~RecordPageHandler();
-    RC init(DiskBufferPool &buffer_pool, int file_id, PageNum page_num);
+    /**
+     * @param readonly 只读取页面上的记录，开启了mmap_read时可以直接读文件映射
+     * @param layout 文件中记录的格式，为空时是FIXED格式。
+     *               SLOTTED格式的文件中，溢出页返回BUFFERPOOL_INVALID_PAGE_NUM
+     */
+    RC init(DiskBufferPool &buffer_pool, int file_id, PageNum page_num,
+            bool readonly = false, const RecordLayout *layout = nullptr);
     RC init_empty_page(DiskBufferPool &buffer_pool, int file_id,
-                       PageNum page_num, int record_size);
+                       PageNum page_num, int record_size,
+                       const RecordLayout *layout = nullptr);
     RC deinit();
 
     RC insert_record(const char *data, RID *rid);
@@ -61,20 +136,80 @@ public:
         if (rc != RC::SUCCESS) {
             return rc;
         }
+        if (is_slotted()) {
+            // 拿到的是解码之后的副本，修改之后重新编码写回页面
+            rc = updater(record);
+            RC rc2 = update_record(&record);
+            return rc != RC::SUCCESS ? rc : rc2;
+        }
+        // FIXED格式直接修改页面，刷盘和扫描在读锁下复制页面，不能看到改了一半的记录
+        page_handle_.wlatch();
         rc = updater(record);
-        disk_buffer_pool_->mark_dirty(&page_handle_);
+        if (rc == RC::SUCCESS) {
+            disk_buffer_pool_->mark_dirty(&page_handle_);
+        }
+        page_handle_.wunlatch();
         return rc;
     }
 
+    /**
+     * 删除记录。页面删空之后仍然保留，由调用者决定是否释放
+     */
     RC delete_record(const RID *rid);
 
     RC get_record(const RID *rid, Record *rec);
+    /**
+     * 把记录复制到buffer中，rec->data指向buffer，页面处理器释放之后仍然有效
+     */
+    RC copy_record(const RID *rid, Record *rec, std::vector<char> &buffer);
     RC get_first_record(Record *rec);
     RC get_next_record(Record *rec);
+    /**
+     * 把页面上所有的记录追加到batch中
+     */
+    RC get_records(RecordBatch &batch);
 
     PageNum get_page_num() const;
 
     bool is_full() const;
+    bool is_empty() const;
+    /**
+     * 页面中是否还能放下这条记录
+     */
+    bool can_insert(const char *data) const;
+
+    /**
+     * 页面的空闲空间。FIXED格式是空闲槽位的个数，SLOTTED格式是空闲的字节数
+     */
+    int free_space() const;
+    /**
+     * 空页面的空闲空间，和free_space的单位相同
+     */
+    int space_capacity() const;
+    int record_size() const;
+
+private:
+    RC init_page(DiskBufferPool &buffer_pool, int file_id, PageNum page_num,
+                 bool readonly);
+    bool is_slotted() const {
+        return layout_ != nullptr && layout_->format() == RecordFormat::SLOTTED;
+    }
+
+    RC slotted_init_empty_page();
+    RC slotted_insert_record(const char *data, RID *rid);
+    RC slotted_update_record(const Record *rec);
+    RC slotted_delete_record(const RID *rid);
+    RC slotted_get_record(const RID *rid, Record *rec);
+    RC slotted_get_next_record(Record *rec);
+    RC slotted_get_records(RecordBatch &batch);
+
+    int inline_size(int encoded_size) const;
+    RC place_payload(int slot_num, const char *payload, int len,
+                     bool overflow);
+    void compact();
+    RC write_overflow(const char *data, int len, PageNum *first_page);
+    RC read_overflow(PageNum first_page, int len, char *data);
+    RC free_overflow(PageNum first_page);
 
 private:
     DiskBufferPool *disk_buffer_pool_;
@@ -82,14 +217,57 @@ private:
     BPPageHandle page_handle_;
     PageHeader *page_header_;
     char *bitmap_;
+
+    const RecordLayout *layout_ = nullptr;
+    int page_size_ = 0;              // 页面数据区的大小
+    std::vector<char> record_buf_;   // SLOTTED格式解码之后的记录
+};
+
+/**
+ * 记录文件的空闲空间表。按照空闲空间占页面的比例把页面放到几个桶里，
+ * 插入时直接从能放下记录的最小的桶里取一个页面，不需要遍历文件。
+ * 空闲空间的单位参考RecordPageHandler::free_space
+ */
+class RecordFreeSpaceMap {
+public:
+    static const int BUCKET_NUM = 8;
+
+    void update(PageNum page_num, int free_space, int capacity);
+    void remove(PageNum page_num);
+    void clear();
+
+    /**
+     * 查找一个空闲空间不少于need的页面，before不小于0时只查找页号小于before的页面，
+     * 找不到返回-1
+     */
+    PageNum find(int need, PageNum before = -1) const;
+    int page_count() const;
+
+    /**
+     * 空闲空间不少于页面的free_percent%的页面，按照页号从大到小排列
+     */
+    void sparse_pages(int free_percent, std::vector<PageNum> &pages) const;
+
+private:
+    int bucket_of(int free_space) const;
+    int bucket_min_space(int bucket) const;
+
+private:
+    mutable std::mutex mutex_;
+    int capacity_ = 0;
+    std::map<PageNum, int> page_buckets_;
+    std::set<PageNum> buckets_[BUCKET_NUM];  // 桶0是没有空闲空间的页面
 };
 
 class RecordFileHandler {
 public:
     RecordFileHandler();
-    RC init(DiskBufferPool &buffer_pool, int file_id);
+    RC init(DiskBufferPool &buffer_pool, int file_id,
+            const RecordLayout &layout = RecordLayout());
     void close();
 
+    const RecordLayout &layout() const { return layout_; }
+
     /**
      * 更新指定文件中的记录，rec指向的记录结构中的rid字段为要更新的记录的标识符，
      * pData字段指向新的记录内容
@@ -114,30 +292,70 @@ public:
     RC insert_record(const char *data, int record_size, RID *rid);
 
     /**
-     * 获取指定文件中标识符为rid的记录内容到rec指向的记录结构中
+     * 获取指定文件中标识符为rid的记录内容到rec指向的记录结构中。
+     * 记录复制(SLOTTED格式是解码)到调用者提供的buffer中，返回之后页面不再被固定，
+     * rec->data在buffer被修改或者释放之前有效
      * @param rid
      * @param rec
+     * @param buffer
      * @return
      */
-    RC get_record(const RID *rid, Record *rec);
+    RC get_record(const RID *rid, Record *rec, std::vector<char> &buffer);
 
     template <class RecordUpdater>  // 改成普通模式, 不使用模板
     RC update_record_in_place(const RID *rid, RecordUpdater updater) {
         RC rc = RC::SUCCESS;
         RecordPageHandler page_handler;
-        if ((rc != page_handler.init(*disk_buffer_pool_, file_id_,
-                                     rid->page_num)) != RC::SUCCESS) {
+        if ((rc = page_handler.init(*disk_buffer_pool_, file_id_,
+                                     rid->page_num, false, &layout_)) !=
+            RC::SUCCESS) {
             return rc;
         }
 
-        return page_handler.update_record_in_place(rid, updater);
+        rc = page_handler.update_record_in_place(rid, updater);
+        // SLOTTED格式的记录长度可能变化
+        free_space_map_.update(rid->page_num, page_handler.free_space(),
+                               page_handler.space_capacity());
+        return rc;
+    }
+
+    const RecordFreeSpaceMap &free_space_map() const {
+        return free_space_map_;
     }
 
+    /**
+     * 整理文件时使用。找出空闲空间不少于free_percent%的页面，按照页号从大到小排列
+     */
+    RC sparse_pages(int free_percent, std::vector<PageNum> &pages);
+    /**
+     * 把页面上所有记录的副本读到batch中
+     */
+    RC get_page_records(PageNum page_num, RecordBatch &batch);
+    /**
+     * 把记录插入到页号小于before的已有页面上，不分配新的页面，没有空间时返回RECORD_NOMEM
+     */
+    RC relocate_record(const char *data, PageNum before, RID *rid);
+    /**
+     * 释放一个没有记录的页面
+     */
+    RC dispose_empty_page(PageNum page_num);
+
 private:
+    RC insert_record(const char *data, int record_size, RID *rid,
+                     PageNum before, bool allocate);
+
     DiskBufferPool *disk_buffer_pool_;
     int file_id_;  // 参考DiskBufferPool中的fileId
+    RecordLayout layout_;
 
     RecordPageHandler record_page_handler_;  // 目前只有insert record使用
+
+    RC load_free_space_map();
+    int space_needed(const char *data) const;
+
+    bool free_space_loaded_ = false;  // 第一次插入时遍历文件建立空闲空间表
+    int page_data_size_ = 0;
+    RecordFreeSpaceMap free_space_map_;
 };
 
 class RecordFileScanner {
@@ -158,7 +376,8 @@ public:
      * @return
      */
     RC open_scan(DiskBufferPool &buffer_pool, int file_id,
-                 ConditionFilter *condition_filter);
+                 ConditionFilter *condition_filter,
+                 const RecordLayout *layout = nullptr);
 
     /**
      * 关闭一个文件扫描，释放相应的资源
@@ -177,11 +396,21 @@ public:
      */
     RC get_next_record(Record *rec);
 
+    /**
+     * 按页面批量获取符合扫描条件的记录，每次返回一个页面上的记录，
+     * 没有更多的记录时返回RECORD_EOF。
+     * 和get_next_record各自维护扫描的位置，不要混合使用
+     */
+    RC next_batch(RecordBatch &batch);
+
 private:
     DiskBufferPool *disk_buffer_pool_;
     int file_id_;  // 参考DiskBufferPool中的fileId
+    PageNum next_batch_page_;  // next_batch下一个要读的页面
 
     ConditionFilter *condition_filter_;
+    std::vector<char> select_;  // next_batch过滤记录用的选择位图
+    const RecordLayout *layout_;
     RecordPageHandler record_page_handler_;
 };
 
@@ -29,8 +29,24 @@ See the Mulan PSL v2 for more details. */
 #include "storage/default/disk_buffer_pool.h"
 #include "storage/trx/trx.h"
 
+/**
+ * 在作用域内持有表的vacuum_latch_读锁
+ */
+class VacuumReadGuard {
+public:
+    explicit VacuumReadGuard(pthread_rwlock_t *latch) : latch_(latch) {
+        pthread_rwlock_rdlock(latch_);
+    }
+    ~VacuumReadGuard() { pthread_rwlock_unlock(latch_); }
+
+private:
+    pthread_rwlock_t *latch_;
+};
+
 Table::Table()
-    : data_buffer_pool_(nullptr), file_id_(-1), record_handler_(nullptr) {}
+    : data_buffer_pool_(nullptr), file_id_(-1), record_handler_(nullptr) {
+    pthread_rwlock_init(&vacuum_latch_, nullptr);
+}
 
 Table::~Table() {
     if (record_handler_) {
@@ -42,6 +58,7 @@ Table::~Table() {
         data_buffer_pool_->close_file(file_id_);
         data_buffer_pool_ = nullptr;
     }
+    pthread_rwlock_destroy(&vacuum_latch_);
 
     LOG_INFO("Table has been closed: %s", name());
 }
@@ -84,8 +101,8 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
     close(fd);
 
     // 创建文件
-    if ((rc = table_meta_.init(name, attribute_count, attributes)) !=
-        RC::SUCCESS) {
+    if ((rc = table_meta_.init(name, attribute_count, attributes,
+                               theTableRecordFormat(name))) != RC::SUCCESS) {
         LOG_ERROR("Failed to init table meta. name:%s, ret:%d", name, rc);
         return rc;  // delete table file
     }
@@ -104,8 +121,9 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
 
     std::string data_file =
         std::string(base_dir) + "/" + name + TABLE_DATA_SUFFIX;
-    data_buffer_pool_ = theGlobalDiskBufferPool();
-    rc = data_buffer_pool_->create_file(data_file.c_str());
+    data_buffer_pool_ = theTableBufferPool(name, false);
+    rc = data_buffer_pool_->create_file(data_file.c_str(), 0,
+                                        theTablePageCompression(name));
     if (rc != RC::SUCCESS) {
         LOG_ERROR(
             "Failed to create disk buffer pool of data file. file name=%s",
@@ -164,7 +182,7 @@ RC Table::drop() {
     // 删除data文件
     std::string data_file =
         base_dir_ + "/" + table_meta_.name() + TABLE_DATA_SUFFIX;
-    if (unlink(data_file.c_str()) != 0) {
+    if (DiskBufferPool::remove_file(data_file.c_str()) != RC::SUCCESS) {
         LOG_ERROR("Failed to remove data file. file name=%s",
                   data_file.c_str());
         return RC::IOERR;
@@ -197,19 +215,25 @@ RC Table::open(const char *meta_file, const char *base_dir) {
     const int index_num = table_meta_.index_num();
     for (int i = 0; i < index_num; i++) {
         const IndexMeta *index_meta = table_meta_.index(i);
-        const FieldMeta *field_meta = table_meta_.field(index_meta->field());
-        if (field_meta == nullptr) {
-            LOG_PANIC(
-                "Found invalid index meta info which has a non-exists field. "
-                "table=%s, index=%s, field=%s",
-                name(), index_meta->name(), index_meta->field());
-            return RC::GENERIC_ERROR;
+        std::vector<FieldMeta> field_metas;
+        for (int j = 0; j < index_meta->field_num(); j++) {
+            const FieldMeta *field_meta =
+                table_meta_.field(index_meta->field(j));
+            if (field_meta == nullptr) {
+                LOG_PANIC(
+                    "Found invalid index meta info which has a non-exists "
+                    "field. table=%s, index=%s, field=%s",
+                    name(), index_meta->name(), index_meta->field(j));
+                return RC::GENERIC_ERROR;
+            }
+            field_metas.push_back(*field_meta);
         }
 
         BplusTreeIndex *index = new BplusTreeIndex(index_meta->is_unique());
         std::string index_file =
             index_data_file(base_dir, name(), index_meta->name());
-        rc = index->open(index_file.c_str(), *index_meta, *field_meta);
+        rc = index->open(index_file.c_str(), *index_meta, field_metas,
+                         theTableBufferPool(name(), true));
         if (rc != RC::SUCCESS) {
             delete index;
             LOG_ERROR(
@@ -223,18 +247,19 @@ RC Table::open(const char *meta_file, const char *base_dir) {
 }
 
 RC Table::commit_insert(Trx *trx, const RID &rid) {
-    Record record;
-    RC rc = record_handler_->get_record(&rid, &record);
-    if (rc != RC::SUCCESS) {
-        return rc;
-    }
-
-    return trx->commit_insert(this, record);
+    VacuumReadGuard guard(&vacuum_latch_);
+    // get_record拿到的记录可能是只读映射或者解码后的副本，修改要通过页面写回
+    return record_handler_->update_record_in_place(
+        &rid, [this, trx](Record &record) {
+            return trx->commit_insert(this, record);
+        });
 }
 
 RC Table::rollback_insert(Trx *trx, const RID &rid) {
+    VacuumReadGuard guard(&vacuum_latch_);
     Record record;
-    RC rc = record_handler_->get_record(&rid, &record);
+    std::vector<char> record_buf;
+    RC rc = record_handler_->get_record(&rid, &record, record_buf);
     if (rc != RC::SUCCESS) {
         return rc;
     }
@@ -354,6 +379,7 @@ RC Table::insert_record(Trx *trx, int value_num, const Value *values) {
     }
 
     LOG_DEBUG("ZD: value_num=%d", value_num);
+    VacuumReadGuard guard(&vacuum_latch_);
     std::vector<Record *> record_vector;
     RC rc = make_records(value_num, values, record_vector);
     if (rc != RC::SUCCESS) {
@@ -498,7 +524,7 @@ RC Table::init_record_handler(const char *base_dir) {
     std::string data_file =
         std::string(base_dir) + "/" + table_meta_.name() + TABLE_DATA_SUFFIX;
     if (nullptr == data_buffer_pool_) {
-        data_buffer_pool_ = theGlobalDiskBufferPool();
+        data_buffer_pool_ = theTableBufferPool(table_meta_.name(), false);
     }
 
     int data_buffer_pool_file_id;
@@ -510,8 +536,19 @@ RC Table::init_record_handler(const char *base_dir) {
         return rc;
     }
 
+    // SLOTTED格式的表中字符串字段按照实际长度保存
+    RecordLayout layout(table_meta_.record_format(), table_meta_.record_size());
+    for (int i = table_meta_.sys_field_num(); i < table_meta_.field_num();
+         i++) {
+        const FieldMeta *field = table_meta_.field(i);
+        if (field->type() == CHARS) {
+            layout.add_var_field(field->offset(), field->len());
+        }
+    }
+
     record_handler_ = new RecordFileHandler();
-    rc = record_handler_->init(*data_buffer_pool_, data_buffer_pool_file_id);
+    rc = record_handler_->init(*data_buffer_pool_, data_buffer_pool_file_id,
+                               layout);
     if (rc != RC::SUCCESS) {
         LOG_ERROR("Failed to init record handler. rc=%d:%s", rc, strrc(rc));
         return rc;
@@ -548,6 +585,7 @@ static RC scan_record_reader_adapter(Record *record, void *context) {
 RC Table::scan_record(Trx *trx, ConditionFilter *filter, int limit,
                       void *context,
                       void (*record_reader)(const char *data, void *context)) {
+    VacuumReadGuard guard(&vacuum_latch_);
     RecordReaderScanAdapter adapter(record_reader, context);
     return scan_record(trx, filter, limit, (void *)&adapter,
                        scan_record_reader_adapter);
@@ -576,24 +614,33 @@ RC Table::scan_record(Trx *trx, ConditionFilter *filter, int limit,
 
     RC rc = RC::SUCCESS;
     RecordFileScanner scanner;
-    rc = scanner.open_scan(*data_buffer_pool_, file_id_, filter);
+    rc = scanner.open_scan(*data_buffer_pool_, file_id_, filter,
+                           &record_handler_->layout());
     if (rc != RC::SUCCESS) {
         LOG_ERROR("failed to open scanner. file id=%d. rc=%d:%s", file_id_, rc,
                   strrc(rc));
         return rc;
     }
 
+    // 按页面批量读取记录，每个页面只需要固定和检查一次
     int record_count = 0;
-    Record record;
-    rc = scanner.get_first_record(&record);
-    for (; RC::SUCCESS == rc && record_count < limit;
-         rc = scanner.get_next_record(&record)) {
-        if (trx == nullptr || trx->is_visible(this, &record)) {
-            rc = record_reader(&record, context);
-            if (rc != RC::SUCCESS) {
+    RecordBatch batch;
+    while (record_count < limit &&
+           RC::SUCCESS == (rc = scanner.next_batch(batch))) {
+        for (Record &record : batch.records) {
+            if (record_count >= limit) {
                 break;
             }
-            record_count++;
+            if (trx == nullptr || trx->is_visible(this, &record)) {
+                rc = record_reader(&record, context);
+                if (rc != RC::SUCCESS) {
+                    break;
+                }
+                record_count++;
+            }
+        }
+        if (rc != RC::SUCCESS) {
+            break;
         }
     }
 
@@ -614,6 +661,7 @@ RC Table::scan_record_by_index(Trx *trx, IndexScanner *scanner,
     RC rc = RC::SUCCESS;
     RID rid;
     Record record;
+    std::vector<char> record_buf;
     int record_count = 0;
     while (record_count < limit) {
         rc = scanner->next_entry(&rid);
@@ -626,7 +674,7 @@ RC Table::scan_record_by_index(Trx *trx, IndexScanner *scanner,
             break;
         }
 
-        rc = record_handler_->get_record(&rid, &record);
+        rc = record_handler_->get_record(&rid, &record, record_buf);
         if (rc != RC::SUCCESS) {
             LOG_ERROR("Failed to fetch record of rid=%d:%d, rc=%d:%s",
                       rid.page_num, rid.slot_num, rc, strrc(rc));
@@ -667,24 +715,55 @@ static RC insert_index_record_reader_adapter(Record *record, void *context) {
     return inserter.insert_index(record);
 }
 
-RC Table::create_index(Trx *trx, const char *index_name,
-                       const char *attribute_name, bool is_unique) {
+RC Table::create_index(Trx *trx, const char *index_name, int attribute_num,
+                       const char *const attribute_names[], bool is_unique) {
     if (index_name == nullptr || common::is_blank(index_name) ||
-        attribute_name == nullptr || common::is_blank(attribute_name)) {
+        attribute_num <= 0 || attribute_num > MAX_NUM) {
         return RC::INVALID_ARGUMENT;
     }
-    if (table_meta_.index(index_name) != nullptr ||
-        table_meta_.find_index_by_field((attribute_name))) {
+    VacuumReadGuard guard(&vacuum_latch_);
+    if (table_meta_.index(index_name) != nullptr) {
         return RC::SCHEMA_INDEX_EXIST;
     }
 
-    const FieldMeta *field_meta = table_meta_.field(attribute_name);
-    if (!field_meta) {
-        return RC::SCHEMA_FIELD_MISSING;
+    std::vector<const FieldMeta *> fields;
+    std::vector<FieldMeta> field_metas;
+    for (int i = 0; i < attribute_num; i++) {
+        const char *attribute_name = attribute_names[i];
+        if (attribute_name == nullptr || common::is_blank(attribute_name)) {
+            return RC::INVALID_ARGUMENT;
+        }
+        const FieldMeta *field_meta = table_meta_.field(attribute_name);
+        if (!field_meta) {
+            return RC::SCHEMA_FIELD_MISSING;
+        }
+        // 同一列在一个索引中只能出现一次
+        if (std::find(fields.begin(), fields.end(), field_meta) !=
+            fields.end()) {
+            return RC::INVALID_ARGUMENT;
+        }
+        fields.push_back(field_meta);
+        field_metas.push_back(*field_meta);
+    }
+
+    // 相同的列按相同的顺序只能建一个索引
+    for (int i = 0; i < table_meta_.index_num(); i++) {
+        const IndexMeta *index_meta = table_meta_.index(i);
+        if (index_meta->field_num() != attribute_num) {
+            continue;
+        }
+        int j = 0;
+        while (j < attribute_num &&
+               0 == strcmp(index_meta->field(j), fields[j]->name())) {
+            j++;
+        }
+        if (j == attribute_num) {
+            return RC::SCHEMA_INDEX_EXIST;
+        }
     }
 
     IndexMeta new_index_meta;
-    RC rc = new_index_meta.init(index_name, *field_meta, is_unique);
+    RC rc = new_index_meta.init(index_name, fields, is_unique);
     if (rc != RC::SUCCESS) {
         return rc;
     }
@@ -693,7 +772,8 @@ RC Table::create_index(Trx *trx, const char *index_name,
     BplusTreeIndex *index = new BplusTreeIndex(is_unique);
     std::string index_file =
         index_data_file(base_dir_.c_str(), name(), index_name);
-    rc = index->create(index_file.c_str(), new_index_meta, *field_meta);
+    rc = index->create(index_file.c_str(), new_index_meta, field_metas,
+                       theTableBufferPool(name(), true));
     if (rc != RC::SUCCESS) {
         delete index;
         LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s",
@@ -806,6 +886,7 @@ RC Table::update_record(Trx *trx, const char *attribute_name,
         condition_filters.push_back(condition_filter);
     }
 
+    VacuumReadGuard guard(&vacuum_latch_);
     std::vector<RID> wait_update_rids;
     CompositeConditionFilter condition_filter;
     condition_filter.init((const ConditionFilter **)condition_filters.data(),
@@ -851,25 +932,27 @@ RC Table::update_record(Trx *trx, const char *attribute_name,
 
     for (RID &rid : wait_update_rids) {
         LOG_DEBUG("ZD: rid(%d, %d)", rid.page_num, rid.slot_num);
-        Record record;
-        RC rc = record_handler_->get_record(&rid, &record);
+        RC rc = record_handler_->update_record_in_place(
+            &rid, [&](Record &record) {
+                char *old_value = record.data + field_meta->offset();
+                // 更新索引
+                if (nullptr != index) {
+                    RC rc = index->insert_entry(new_value, &rid);
+                    if (RC::SUCCESS != rc) {
+                        return rc;
+                    }
+                    rc = index->delete_entry(old_value, &rid);
+                    if (RC::SUCCESS != rc) {
+                        return rc;
+                    }
+                }
+                memcpy(record.data + field_meta->offset(), new_value,
+                       field_meta->len());
+                return RC::SUCCESS;
+            });
         if (rc != SUCCESS) {
             return rc;
         }
-        char *old_value = record.data + field_meta->offset();
-        // 更新索引
-        if (nullptr != index) {
-            RC rc = index->insert_entry(new_value, &rid);
-            if (RC::SUCCESS != rc) {
-                return rc;
-            }
-            rc = index->delete_entry(old_value, &rid);
-            if (RC::SUCCESS != rc) {
-                return rc;
-            }
-        }
-        memcpy(record.data + field_meta->offset(), new_value,
-               field_meta->len());
     }
     free(new_value);
     *updated_count = wait_update_rids.size();
@@ -904,6 +987,7 @@ static RC record_reader_delete_adapter(Record *record, void *context) {
 }
 
 RC Table::delete_record(Trx *trx, ConditionFilter *filter, int *deleted_count) {
+    VacuumReadGuard guard(&vacuum_latch_);
     RecordDeleter deleter(*this, trx);
     RC rc =
         scan_record(trx, filter, -1, &deleter, record_reader_delete_adapter);
@@ -916,7 +1000,11 @@ RC Table::delete_record(Trx *trx, ConditionFilter *filter, int *deleted_count) {
 RC Table::delete_record(Trx *trx, Record *record) {
     RC rc = RC::SUCCESS;
     if (trx != nullptr) {
-        rc = trx->delete_record(this, record);
+        // 扫描出来的记录不能原地修改，通过页面写回删除标记
+        rc = record_handler_->update_record_in_place(
+            &record->rid, [this, trx](Record &page_record) {
+                return trx->delete_record(this, &page_record);
+            });
     } else {
         rc = delete_entry_of_indexes(record->data, record->rid,
                                      false);  // 重复代码 refer to commit_delete
@@ -932,9 +1020,11 @@ RC Table::delete_record(Trx *trx, Record *record) {
 }
 
 RC Table::commit_delete(Trx *trx, const RID &rid) {
+    VacuumReadGuard guard(&vacuum_latch_);
     RC rc = RC::SUCCESS;
     Record record;
-    rc = record_handler_->get_record(&rid, &record);
+    std::vector<char> record_buf;
+    rc = record_handler_->get_record(&rid, &record, record_buf);
     if (rc != RC::SUCCESS) {
         return rc;
     }
@@ -953,14 +1043,13 @@ RC Table::commit_delete(Trx *trx, const RID &rid) {
 }
 
 RC Table::rollback_delete(Trx *trx, const RID &rid) {
+    VacuumReadGuard guard(&vacuum_latch_);
     RC rc = RC::SUCCESS;
-    Record record;
-    rc = record_handler_->get_record(&rid, &record);
-    if (rc != RC::SUCCESS) {
-        return rc;
-    }
-
-    return trx->rollback_delete(this, record);  // update record in place
+    rc = record_handler_->update_record_in_place(
+        &rid, [this, trx](Record &record) {
+            return trx->rollback_delete(this, record);  // update record in place
+        });
+    return rc;
 }
 
 RC Table::insert_entry_of_indexes(const char *record, const RID &rid) {
@@ -997,51 +1086,149 @@ Index *Table::find_index(const char *index_name) const {
     return nullptr;
 }
 
-IndexScanner *Table::find_index_for_scan(const DefaultConditionFilter &filter) {
-    const ConDesc *field_cond_desc = nullptr;
-    const ConDesc *value_cond_desc = nullptr;
-    if (filter.left().is_attr && !filter.right().is_attr) {
-        field_cond_desc = &filter.left();
-        value_cond_desc = &filter.right();
-    } else if (filter.right().is_attr && !filter.left().is_attr) {
-        field_cond_desc = &filter.right();
-        value_cond_desc = &filter.left();
-    }
-    if (field_cond_desc == nullptr || value_cond_desc == nullptr) {
-        return nullptr;
-    }
+static void append_index_value(std::vector<char> &key,
+                               const FieldMeta *field_meta,
+                               const Value *value) {
+    const char *data = (const char *)value->data;
+    const int len =
+        field_meta->nullable() ? field_meta->len() - 1 : field_meta->len();
+    int copy_len = len;
+    if (CHARS == field_meta->type() || DATES == field_meta->type()) {
+        copy_len = std::min<int>(len, strlen(data) + 1);
+    }
+    const size_t offset = key.size();
+    key.resize(offset + len, 0);
+    memcpy(key.data() + offset, data, copy_len);
+}
 
-    // 对于空值的条件不走索引
-    if (AttrType::NULLS == value_cond_desc->data.value->type) {
-        return nullptr;
-    }
+IndexScanner *Table::find_index_for_scan(
+    const std::vector<const DefaultConditionFilter *> &filters) {
+    // 统一成 字段 comp_op 常量 的形式
+    struct FieldCondition {
+        const FieldMeta *field_meta;
+        const Value *value;
+        CompOp comp_op;
+    };
+    std::vector<FieldCondition> conditions;
+    for (const DefaultConditionFilter *filter : filters) {
+        FieldCondition condition;
+        if (filter->left().is_attr && !filter->right().is_attr) {
+            condition.field_meta = filter->left().data.field_meta;
+            condition.value = filter->right().data.value;
+            condition.comp_op = filter->comp_op();
+        } else if (filter->right().is_attr && !filter->left().is_attr) {
+            condition.field_meta = filter->right().data.field_meta;
+            condition.value = filter->left().data.value;
+            condition.comp_op = mirror_comp_op(filter->comp_op());
+        } else {
+            continue;
+        }
+        if (nullptr == condition.field_meta) {
+            LOG_PANIC("Cannot find field. table=%s", name());
+            return nullptr;
+        }
 
-    const FieldMeta *field_meta = field_cond_desc->data.field_meta;
-    if (nullptr == field_meta) {
-        LOG_PANIC("Cannot find field. table=%s", name());
-        return nullptr;
+        // 对于空值和类型不一致的条件不走索引
+        const AttrType field_type = condition.field_meta->type();
+        const AttrType value_type = condition.value->type;
+        const bool both_string =
+            (CHARS == field_type || DATES == field_type) &&
+            (CHARS == value_type || DATES == value_type);
+        if (AttrType::NULLS == value_type ||
+            (field_type != value_type && !both_string)) {
+            continue;
+        }
+        switch (condition.comp_op) {
+            case EQUAL_TO:
+            case LESS_THAN:
+            case LESS_EQUAL:
+            case GREAT_THAN:
+            case GREAT_EQUAL:
+                conditions.push_back(condition);
+                break;
+            default:
+                break;
+        }
     }
-
-    const IndexMeta *index_meta =
-        table_meta_.find_index_by_field(field_meta->name());
-    if (nullptr == index_meta) {
+    if (conditions.empty()) {
         return nullptr;
     }
 
-    Index *index = find_index(index_meta->name());
-    if (nullptr == index) {
+    // 前面的列都是相等条件，最后一列可以有上下界
+    struct IndexMatch {
+        Index *index = nullptr;
+        std::vector<const FieldCondition *> equals;
+        const FieldCondition *lower = nullptr;
+        const FieldCondition *upper = nullptr;
+
+        // 相等条件的列优先，其次是边界的个数
+        int score() const {
+            return equals.size() * 3 + (lower != nullptr) + (upper != nullptr);
+        }
+    };
+    IndexMatch best;
+    for (Index *index : indexes_) {
+        const IndexMeta &index_meta = index->index_meta();
+        IndexMatch match;
+        match.index = index;
+        for (int i = 0; i < index_meta.field_num(); i++) {
+            const FieldCondition *equal = nullptr;
+            for (const FieldCondition &condition : conditions) {
+                if (0 != strcmp(condition.field_meta->name(),
+                                index_meta.field(i))) {
+                    continue;
+                }
+                if (EQUAL_TO == condition.comp_op) {
+                    equal = &condition;
+                } else if (GREAT_THAN == condition.comp_op ||
+                           GREAT_EQUAL == condition.comp_op) {
+                    match.lower = match.lower ? match.lower : &condition;
+                } else {
+                    match.upper = match.upper ? match.upper : &condition;
+                }
+            }
+            if (equal == nullptr) {
+                break;
+            }
+            match.equals.push_back(equal);
+            match.lower = nullptr;
+            match.upper = nullptr;
+        }
+        if (match.score() > best.score()) {
+            best = match;
+        }
+    }
+    if (best.score() == 0) {
         return nullptr;
     }
 
-    // todo: 空值索引
-    // if (AttrType::NULLS == value_cond_desc->data.value->type) {
-    //     void *data = malloc(field_meta->len());
-    //     set_min_value_as_null(data, field_meta->type());
-    //     return index->create_scanner(filter.comp_op(), (const char *)data);
-    // }
-
-    return index->create_scanner(
-        filter.comp_op(), (const char *)value_cond_desc->data.value->data);
+    // 按索引中列的格式拼接比较值，索引中的列不带空标记
+    std::vector<char> prefix;
+    for (const FieldCondition *condition : best.equals) {
+        append_index_value(prefix, condition->field_meta, condition->value);
+    }
+    const int prefix_attr_num = best.equals.size();
+    std::vector<char> left_key(prefix);
+    int left_attr_num = prefix_attr_num;
+    bool left_inclusive = true;
+    if (best.lower != nullptr) {
+        append_index_value(left_key, best.lower->field_meta,
+                           best.lower->value);
+        left_attr_num++;
+        left_inclusive = GREAT_EQUAL == best.lower->comp_op;
+    }
+    std::vector<char> right_key(prefix);
+    int right_attr_num = prefix_attr_num;
+    bool right_inclusive = true;
+    if (best.upper != nullptr) {
+        append_index_value(right_key, best.upper->field_meta,
+                           best.upper->value);
+        right_attr_num++;
+        right_inclusive = LESS_EQUAL == best.upper->comp_op;
+    }
+    return best.index->create_scanner(left_key.data(), left_attr_num,
+                                      left_inclusive, right_key.data(),
+                                      right_attr_num, right_inclusive);
 }
 
 IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter) {
@@ -1050,10 +1237,11 @@ IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter) {
     }
 
     // remove dynamic_cast
+    std::vector<const DefaultConditionFilter *> default_condition_filters;
     const DefaultConditionFilter *default_condition_filter =
         dynamic_cast<const DefaultConditionFilter *>(filter);
     if (default_condition_filter != nullptr) {
-        return find_index_for_scan(*default_condition_filter);
+        default_condition_filters.push_back(default_condition_filter);
     }
 
     const CompositeConditionFilter *composite_condition_filter =
@@ -1061,14 +1249,124 @@ IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter) {
     if (composite_condition_filter != nullptr) {
         int filter_num = composite_condition_filter->filter_num();
         for (int i = 0; i < filter_num; i++) {
-            IndexScanner *scanner =
-                find_index_for_scan(&composite_condition_filter->filter(i));
-            if (scanner != nullptr) {
-                return scanner;  // 可以找到一个最优的，比如比较符号是=
+            default_condition_filter =
+                dynamic_cast<const DefaultConditionFilter *>(
+                    &composite_condition_filter->filter(i));
+            if (default_condition_filter != nullptr) {
+                default_condition_filters.push_back(default_condition_filter);
             }
         }
     }
-    return nullptr;
+    return find_index_for_scan(default_condition_filters);
+}
+
+RC Table::vacuum(int free_percent, int *moved) {
+    int moved_count = 0;
+    std::vector<PageNum> pages;
+    RC rc = record_handler_->sparse_pages(free_percent, pages);
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to find sparse pages. table=%s, rc=%d:%s", name(),
+                  rc, strrc(rc));
+        return rc;
+    }
+
+    RecordBatch batch;
+    for (PageNum page_num : pages) {
+        // 每个页面单独加写锁，整理一个页面期间DML和扫描等待
+        pthread_rwlock_wrlock(&vacuum_latch_);
+        rc = vacuum_page(page_num, batch, &moved_count);
+        pthread_rwlock_unlock(&vacuum_latch_);
+
+        // 前面的页面已经放不下了
+        if (rc == RC::RECORD_NOMEM) {
+            rc = RC::SUCCESS;
+            break;
+        }
+        if (rc != RC::SUCCESS) {
+            break;
+        }
+    }
+
+    if (moved != nullptr) {
+        *moved = moved_count;
+    }
+    if (moved_count > 0) {
+        LOG_INFO("Vacuum table over. table=%s, moved %d records", name(),
+                 moved_count);
+    }
+    return rc;
+}
+
+RC Table::vacuum_page(PageNum page_num, RecordBatch &batch, int *moved) {
+    // 持有vacuum_latch_的写锁，这里读到的记录在移动完成之前不会被删除或者修改
+    RC rc = record_handler_->get_page_records(page_num, batch);
+    if (rc == RC::BUFFERPOOL_INVALID_PAGE_NUM) {
+        return RC::SUCCESS;
+    }
+    if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to read records of page %d. table=%s, rc=%d:%s",
+                  page_num, name(), rc, strrc(rc));
+        return rc;
+    }
+
+    if (batch.records.empty()) {
+        // 删除最后一条记录时页面被扫描等固定着，没能释放。现在仍然被固定的话留到下次
+        rc = record_handler_->dispose_empty_page(page_num);
+        return rc == RC::BUFFERPOOL_PAGE_PINNED ? RC::SUCCESS : rc;
+    }
+
+    const int trx_offset = table_meta_.trx_field()->offset();
+    for (Record &record : batch.records) {
+        // 事务还没有结束的记录，回滚或者提交时还要用RID找到它
+        if (*(const int32_t *)(record.data + trx_offset) != 0) {
+            continue;
+        }
+
+        RID new_rid;
+        rc = record_handler_->relocate_record(record.data, page_num, &new_rid);
+        if (rc != RC::SUCCESS) {
+            return rc;
+        }
+
+        // 先删除旧的索引项，否则唯一索引会拒绝插入相同的键值
+        rc = delete_entry_of_indexes(record.data, record.rid, false);
+        if (rc == RC::SUCCESS) {
+            rc = insert_entry_of_indexes(record.data, new_rid);
+            if (rc != RC::SUCCESS) {
+                delete_entry_of_indexes(record.data, new_rid, false);
+            }
+        }
+        if (rc != RC::SUCCESS) {
+            LOG_ERROR(
+                "Failed to move index entries of record(rid=%d.%d). "
+                "table=%s, rc=%d:%s",
+                record.rid.page_num, record.rid.slot_num, name(), rc,
+                strrc(rc));
+            RC rc2 = insert_entry_of_indexes(record.data, record.rid);
+            if (rc2 == RC::SUCCESS) {
+                rc2 = record_handler_->delete_record(&new_rid);
+            }
+            if (rc2 != RC::SUCCESS) {
+                LOG_PANIC(
+                    "Failed to rollback moving record(rid=%d.%d). "
+                    "table=%s, rc=%d:%s",
+                    record.rid.page_num, record.rid.slot_num, name(), rc2,
+                    strrc(rc2));
+            }
+            return rc;
+        }
+
+        rc = record_handler_->delete_record(&record.rid);
+        if (rc != RC::SUCCESS) {
+            LOG_PANIC("Failed to delete moved record(rid=%d.%d). "
+                      "table=%s, rc=%d:%s",
+                      record.rid.page_num, record.rid.slot_num, name(), rc,
+                      strrc(rc));
+            return rc;
+        }
+        (*moved)++;
+    }
+    return RC::SUCCESS;
 }
 
 RC Table::sync() {
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #ifndef __OBSERVER_STORAGE_COMMON_TABLE_H__
 #define __OBSERVER_STORAGE_COMMON_TABLE_H__
 
+#include <pthread.h>
+
 #include "storage/common/table_meta.h"
 
 class DiskBufferPool;
@@ -21,6 +23,7 @@ class RecordFileHandler;
 class ConditionFilter;
 class DefaultConditionFilter;
 struct Record;
+struct RecordBatch;
 struct RID;
 class Index;
 class IndexScanner;
@@ -62,8 +65,11 @@ public:
     RC scan_record(Trx *trx, ConditionFilter *filter, int limit, void *context,
                    void (*record_reader)(const char *data, void *context));
 
-    RC create_index(Trx *trx, const char *index_name,
-                    const char *attribute_name, bool is_unique);
+    /**
+     * 在attribute_names指定的列上创建索引，多列索引按照列的顺序比较
+     */
+    RC create_index(Trx *trx, const char *index_name, int attribute_num,
+                    const char *const attribute_names[], bool is_unique);
 
 public:
     const char *name() const;
@@ -72,6 +78,14 @@ public:
 
     RC sync();
 
+    /**
+     * 把空闲空间不少于free_percent%的页面上的记录搬到前面的页面上，
+     * 空出来的页面交还给文件。有未提交事务的记录不会移动。
+     * 整理每个页面时持有vacuum_latch_的写锁，和DML、扫描互斥
+     * @param moved 返回移动的记录数
+     */
+    RC vacuum(int free_percent, int *moved);
+
 public:
     RC commit_insert(Trx *trx, const RID &rid);
     RC commit_delete(Trx *trx, const RID &rid);
@@ -85,7 +99,13 @@ private:
                             ConditionFilter *filter, int limit, void *context,
                             RC (*record_reader)(Record *record, void *context));
     IndexScanner *find_index_for_scan(const ConditionFilter *filter);
-    IndexScanner *find_index_for_scan(const DefaultConditionFilter &filter);
+    RC vacuum_page(PageNum page_num, RecordBatch &batch, int *moved);
+    /**
+     * 按照索引的列依次匹配条件，前面的列用相等条件，
+     * 最后一列可以用同一个字段上的上下界做范围扫描，选匹配列数最多的索引
+     */
+    IndexScanner *find_index_for_scan(
+        const std::vector<const DefaultConditionFilter *> &filters);
 
     RC insert_record(Trx *trx, Record *record);
     RC insert_records(Trx *trx, std::vector<Record *> &record_vector);
@@ -116,6 +136,8 @@ private:
     int file_id_;
     RecordFileHandler *record_handler_;  /// 记录操作
     std::vector<Index *> indexes_;
+    /// DML、扫描和事务提交回滚持有读锁，vacuum移动记录时持有写锁
+    pthread_rwlock_t vacuum_latch_;
 };
 
 #endif  // __OBSERVER_STORAGE_COMMON_TABLE_H__
\ No newline at end of file
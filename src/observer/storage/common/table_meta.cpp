@@ -22,6 +22,7 @@ See the Mulan PSL v2 for more details. */
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_RECORD_FORMAT("record_format");
 
 std::vector<FieldMeta> TableMeta::sys_fields_;
 
@@ -29,13 +30,15 @@ TableMeta::TableMeta(const TableMeta &other)
     : name_(other.name_),
       fields_(other.fields_),
       indexes_(other.indexes_),
-      record_size_(other.record_size_) {}
+      record_size_(other.record_size_),
+      record_format_(other.record_format_) {}
 
 void TableMeta::swap(TableMeta &other) noexcept {
     name_.swap(other.name_);
     fields_.swap(other.fields_);
     indexes_.swap(other.indexes_);
     std::swap(record_size_, other.record_size_);
+    std::swap(record_format_, other.record_format_);
 }
 
 RC TableMeta::init_sys_fields() {
@@ -52,7 +55,7 @@ RC TableMeta::init_sys_fields() {
 }
 
 RC TableMeta::init(const char *name, int field_num,
-                   const AttrInfo attributes[]) {
+                   const AttrInfo attributes[], RecordFormat record_format) {
     if (nullptr == name || '\0' == name[0]) {
         LOG_ERROR("Name cannot be empty");
         return RC::INVALID_ARGUMENT;
@@ -98,6 +101,7 @@ RC TableMeta::init(const char *name, int field_num,
     }
 
     record_size_ = field_offset;
+    record_format_ = record_format;
 
     name_ = name;
     LOG_INFO("Init table meta success. table name=%s", name);
@@ -162,6 +166,8 @@ int TableMeta::index_num() const { return indexes_.size(); }
 
 int TableMeta::record_size() const { return record_size_; }
 
+RecordFormat TableMeta::record_format() const { return record_format_; }
+
 int TableMeta::serialize(std::ostream &ss) const {
     Json::Value table_value;
     table_value[FIELD_TABLE_NAME] = name_;
@@ -182,6 +188,7 @@ int TableMeta::serialize(std::ostream &ss) const {
         indexes_value.append(std::move(index_value));
     }
     table_value[FIELD_INDEXES] = std::move(indexes_value);
+    table_value[FIELD_RECORD_FORMAT] = record_format_name(record_format_);
 
     Json::StreamWriterBuilder builder;
     Json::StreamWriter *writer = builder.newStreamWriter();
@@ -248,6 +255,18 @@ int TableMeta::deserialize(std::istream &is) {
     fields_.swap(fields);
     record_size_ = fields_.back().offset() + fields_.back().len();
 
+    // 没有记录格式的是旧版本创建的表，都是FIXED格式
+    record_format_ = RecordFormat::FIXED;
+    const Json::Value &record_format_value = table_value[FIELD_RECORD_FORMAT];
+    if (!record_format_value.isNull() &&
+        (!record_format_value.isString() ||
+         !record_format_from_name(record_format_value.asCString(),
+                                  record_format_))) {
+        LOG_ERROR("Invalid record format. json value=%s",
+                  record_format_value.toStyledString().c_str());
+        return -1;
+    }
+
     const Json::Value &indexes_value = table_value[FIELD_INDEXES];
     if (!indexes_value.empty()) {
         if (!indexes_value.isArray()) {
@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "rc.h"
 #include "storage/common/field_meta.h"
 #include "storage/common/index_meta.h"
+#include "storage/common/record_manager.h"
 
 class TableMeta : public common::Serializable {
 public:
@@ -31,7 +32,8 @@ public:
 
     void swap(TableMeta &other) noexcept;
 
-    RC init(const char *name, int field_num, const AttrInfo attributes[]);
+    RC init(const char *name, int field_num, const AttrInfo attributes[],
+            RecordFormat record_format = RecordFormat::FIXED);
 
     RC add_index(const IndexMeta &index);
 
@@ -50,6 +52,7 @@ public:
     int index_num() const;
 
     int record_size() const;
+    RecordFormat record_format() const;
 
 public:
     int serialize(std::ostream &os) const override;
@@ -67,6 +70,7 @@ private:
     std::vector<IndexMeta> indexes_;
 
     int record_size_ = 0;
+    RecordFormat record_format_ = RecordFormat::FIXED;
 
     static std::vector<FieldMeta> sys_fields_;
 };
@@ -0,0 +1,228 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/default/bp_replacer.h"
+
+#include <strings.h>
+
+bool bp_replace_policy_from_string(const char *name, BPReplacePolicy &policy)
+{
+  if (0 == strcasecmp(name, "LRU")) {
+    policy = BPReplacePolicy::LRU;
+  } else if (0 == strcasecmp(name, "CLOCK")) {
+    policy = BPReplacePolicy::CLOCK;
+  } else if (0 == strcasecmp(name, "2Q")) {
+    policy = BPReplacePolicy::TWO_Q;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *bp_replace_policy_name(BPReplacePolicy policy)
+{
+  switch (policy) {
+    case BPReplacePolicy::LRU:
+      return "LRU";
+    case BPReplacePolicy::CLOCK:
+      return "CLOCK";
+    case BPReplacePolicy::TWO_Q:
+      return "2Q";
+  }
+  return "unknown";
+}
+
+BPReplacer *BPReplacer::create(BPReplacePolicy policy, int size)
+{
+  switch (policy) {
+    case BPReplacePolicy::CLOCK:
+      return new ClockReplacer(size);
+    case BPReplacePolicy::TWO_Q:
+      return new TwoQReplacer(size);
+    case BPReplacePolicy::LRU:
+    default:
+      return new LruReplacer(size);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LruReplacer::LruReplacer(int size) : positions_(size), in_list_(size, false)
+{}
+
+void LruReplacer::insert(int frame_id, uint64_t page_key)
+{
+  remove(frame_id);
+  lru_list_.push_front(frame_id);
+  positions_[frame_id] = lru_list_.begin();
+  in_list_[frame_id] = true;
+}
+
+void LruReplacer::access(int frame_id)
+{
+  if (in_list_[frame_id]) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, positions_[frame_id]);
+  }
+}
+
+void LruReplacer::remove(int frame_id)
+{
+  if (in_list_[frame_id]) {
+    lru_list_.erase(positions_[frame_id]);
+    in_list_[frame_id] = false;
+  }
+}
+
+int LruReplacer::victim(const std::function<bool(int)> &evictable)
+{
+  for (auto iter = lru_list_.rbegin(); iter != lru_list_.rend(); ++iter) {
+    if (evictable(*iter)) {
+      return *iter;
+    }
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ClockReplacer::ClockReplacer(int size) : size_(size), in_use_(size, false), referenced_(size, false)
+{}
+
+void ClockReplacer::insert(int frame_id, uint64_t page_key)
+{
+  in_use_[frame_id] = true;
+  referenced_[frame_id] = true;
+}
+
+void ClockReplacer::access(int frame_id)
+{
+  referenced_[frame_id] = true;
+}
+
+void ClockReplacer::remove(int frame_id)
+{
+  in_use_[frame_id] = false;
+  referenced_[frame_id] = false;
+}
+
+int ClockReplacer::victim(const std::function<bool(int)> &evictable)
+{
+  // 转两圈，第一圈清除所有访问位
+  for (int i = 0; i < 2 * size_; i++) {
+    int frame_id = hand_;
+    hand_ = (hand_ + 1) % size_;
+    if (!in_use_[frame_id] || !evictable(frame_id)) {
+      continue;
+    }
+    if (referenced_[frame_id]) {
+      referenced_[frame_id] = false;
+      continue;
+    }
+    return frame_id;
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TwoQReplacer::TwoQReplacer(int size)
+    : kin_(size / 4 > 0 ? size / 4 : 1),
+      kout_(size / 2 > 0 ? size / 2 : 1),
+      queues_(size, NONE),
+      positions_(size),
+      page_keys_(size, 0)
+{}
+
+void TwoQReplacer::insert(int frame_id, uint64_t page_key)
+{
+  remove(frame_id);
+  page_keys_[frame_id] = page_key;
+  auto out_iter = a1out_keys_.find(page_key);
+  if (out_iter != a1out_keys_.end()) {
+    // 最近被淘汰过又被访问，说明是热点页面
+    a1out_.erase(out_iter->second);
+    a1out_keys_.erase(out_iter);
+    am_.push_front(frame_id);
+    positions_[frame_id] = am_.begin();
+    queues_[frame_id] = AM;
+  } else {
+    a1in_.push_front(frame_id);
+    positions_[frame_id] = a1in_.begin();
+    queues_[frame_id] = A1IN;
+  }
+}
+
+void TwoQReplacer::access(int frame_id)
+{
+  // A1in中的页面被访问时不做调整，避免一次扫描中的多次访问把页面提升为热点
+  if (queues_[frame_id] == AM) {
+    am_.splice(am_.begin(), am_, positions_[frame_id]);
+  }
+}
+
+void TwoQReplacer::remove(int frame_id)
+{
+  switch (queues_[frame_id]) {
+    case A1IN:
+      a1in_.erase(positions_[frame_id]);
+      break;
+    case AM:
+      am_.erase(positions_[frame_id]);
+      break;
+    default:
+      break;
+  }
+  queues_[frame_id] = NONE;
+}
+
+void TwoQReplacer::evict(int frame_id)
+{
+  if (queues_[frame_id] == A1IN) {
+    remember_evicted(page_keys_[frame_id]);
+  }
+  remove(frame_id);
+}
+
+int TwoQReplacer::victim(const std::function<bool(int)> &evictable)
+{
+  int frame_id = -1;
+  if (a1in_.size() > kin_ || am_.empty()) {
+    frame_id = victim_in(a1in_, evictable);
+    if (frame_id < 0) {
+      frame_id = victim_in(am_, evictable);
+    }
+  } else {
+    frame_id = victim_in(am_, evictable);
+    if (frame_id < 0) {
+      frame_id = victim_in(a1in_, evictable);
+    }
+  }
+  return frame_id;
+}
+
+int TwoQReplacer::victim_in(const std::list<int> &queue, const std::function<bool(int)> &evictable)
+{
+  for (auto iter = queue.rbegin(); iter != queue.rend(); ++iter) {
+    if (evictable(*iter)) {
+      return *iter;
+    }
+  }
+  return -1;
+}
+
+void TwoQReplacer::remember_evicted(uint64_t page_key)
+{
+  if (a1out_keys_.find(page_key) != a1out_keys_.end()) {
+    return;
+  }
+  a1out_.push_front(page_key);
+  a1out_keys_[page_key] = a1out_.begin();
+  if (a1out_.size() > kout_) {
+    a1out_keys_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifndef __OBSERVER_STORAGE_DEFAULT_BP_REPLACER_H_
+#define __OBSERVER_STORAGE_DEFAULT_BP_REPLACER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+enum class BPReplacePolicy {
+  LRU,
+  CLOCK,
+  TWO_Q,
+};
+
+/**
+ * 根据配置中的名字(LRU/CLOCK/2Q，不区分大小写)获取淘汰策略
+ * @return 名字不合法时返回false
+ */
+bool bp_replace_policy_from_string(const char *name, BPReplacePolicy &policy);
+const char *bp_replace_policy_name(BPReplacePolicy policy);
+
+/**
+ * 缓冲池的页面淘汰策略。帧用[0, size)的下标表示。
+ * 只有被insert之后、remove之前的帧才会被选为淘汰对象
+ */
+class BPReplacer {
+public:
+  virtual ~BPReplacer() = default;
+
+  /**
+   * 页面被加载到帧中。page_key标识页面，供需要历史信息的策略(2Q)使用
+   */
+  virtual void insert(int frame_id, uint64_t page_key) = 0;
+
+  /**
+   * 缓冲区命中
+   */
+  virtual void access(int frame_id) = 0;
+
+  /**
+   * 帧被释放，不再参与淘汰
+   */
+  virtual void remove(int frame_id) = 0;
+
+  /**
+   * 帧中的页面被淘汰，默认与remove相同
+   */
+  virtual void evict(int frame_id)
+  {
+    remove(frame_id);
+  }
+
+  /**
+   * 挑选一个淘汰对象，evictable用于跳过被pin住的帧。
+   * 只挑选，不会把帧移除，找不到时返回-1
+   */
+  virtual int victim(const std::function<bool(int)> &evictable) = 0;
+
+  static BPReplacer *create(BPReplacePolicy policy, int size);
+};
+
+class LruReplacer : public BPReplacer {
+public:
+  explicit LruReplacer(int size);
+
+  void insert(int frame_id, uint64_t page_key) override;
+  void access(int frame_id) override;
+  void remove(int frame_id) override;
+  int victim(const std::function<bool(int)> &evictable) override;
+
+private:
+  std::list<int> lru_list_;  // 头部是最近访问的
+  std::vector<std::list<int>::iterator> positions_;
+  std::vector<bool> in_list_;
+};
+
+/**
+ * 每个帧一个访问位，时钟指针扫过时清除访问位，访问位为0的帧被淘汰
+ */
+class ClockReplacer : public BPReplacer {
+public:
+  explicit ClockReplacer(int size);
+
+  void insert(int frame_id, uint64_t page_key) override;
+  void access(int frame_id) override;
+  void remove(int frame_id) override;
+  int victim(const std::function<bool(int)> &evictable) override;
+
+private:
+  int size_;
+  int hand_ = 0;
+  std::vector<bool> in_use_;
+  std::vector<bool> referenced_;
+};
+
+/**
+ * 2Q算法。第一次被加载的页面进入A1in(FIFO)，从A1in淘汰的页面记录在A1out中，
+ * 只有在A1out中还能找到的页面再次被加载时才会进入Am(LRU)。
+ * 这样全表扫描只会冲掉A1in，不会影响Am中的热点页面(比如B+树的内部节点)
+ */
+class TwoQReplacer : public BPReplacer {
+public:
+  explicit TwoQReplacer(int size);
+
+  void insert(int frame_id, uint64_t page_key) override;
+  void access(int frame_id) override;
+  void remove(int frame_id) override;
+  void evict(int frame_id) override;
+  int victim(const std::function<bool(int)> &evictable) override;
+
+private:
+  enum Queue { NONE, A1IN, AM };
+
+  int victim_in(const std::list<int> &queue, const std::function<bool(int)> &evictable);
+  void remember_evicted(uint64_t page_key);
+
+private:
+  size_t kin_;   // A1in的目标大小
+  size_t kout_;  // A1out最多记录的页面数
+  std::list<int> a1in_;  // 头部是最新加载的
+  std::list<int> am_;    // 头部是最近访问的
+  std::list<uint64_t> a1out_;
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> a1out_keys_;
+  std::vector<Queue> queues_;
+  std::vector<std::list<int>::iterator> positions_;
+  std::vector<uint64_t> page_keys_;
+};
+
+#endif  // __OBSERVER_STORAGE_DEFAULT_BP_REPLACER_H_
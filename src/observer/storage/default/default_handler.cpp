@@ -129,13 +129,15 @@ RC DefaultHandler::drop_table(const char *dbname, const char *relation_name) {
 
 RC DefaultHandler::create_index(Trx *trx, const char *dbname,
                                 const char *relation_name,
-                                const char *index_name,
-                                const char *attribute_name, bool is_unique) {
+                                const char *index_name, int attribute_num,
+                                const char *const attribute_names[],
+                                bool is_unique) {
     Table *table = find_table(dbname, relation_name);
     if (nullptr == table) {
         return RC::SCHEMA_TABLE_NOT_EXIST;
     }
-    return table->create_index(trx, index_name, attribute_name, is_unique);
+    return table->create_index(trx, index_name, attribute_num, attribute_names,
+                               is_unique);
 }
 
 RC DefaultHandler::drop_index(Trx *trx, const char *dbname,
@@ -220,4 +222,18 @@ RC DefaultHandler::sync() {
         }
     }
     return rc;
+}
+
+RC DefaultHandler::vacuum(int free_percent) {
+    RC rc = RC::SUCCESS;
+    for (const auto &db_pair : opened_dbs_) {
+        Db *db = db_pair.second;
+        rc = db->vacuum(free_percent);
+        if (rc != RC::SUCCESS) {
+            LOG_ERROR("Failed to vacuum db. name=%s, rc=%d:%s", db->name(), rc,
+                      strrc(rc));
+            return rc;
+        }
+    }
+    return rc;
 }
\ No newline at end of file
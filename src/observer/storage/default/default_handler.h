@@ -91,7 +91,8 @@ public:
     RC drop_table(const char *dbname, const char *relation_name);
 
     /**
-     * 该函数在关系relName的属性attrName上创建名为indexName的索引。
+     * 该函数在关系relName的属性attrName上创建名为indexName的索引，
+     * 有多个属性时创建多列索引。
      * 函数首先检查在标记属性上是否已经存在一个索引，
      * 如果存在，则返回一个非零的错误码。
      * 否则，创建该索引。
@@ -99,12 +100,12 @@ public:
      * ②逐个扫描被索引的记录，并向索引文件中插入索引项；③关闭索引
      * @param indexName
      * @param relName
-     * @param attrName
+     * @param attrNames
      * @return
      */
     RC create_index(Trx *trx, const char *dbname, const char *relation_name,
-                    const char *index_name, const char *attribute_name,
-                    bool is_unique);
+                    const char *index_name, int attribute_num,
+                    const char *const attribute_names[], bool is_unique);
 
     /**
      * 该函数用来删除名为indexName的索引。
@@ -163,6 +164,7 @@ public:
     Table *find_table(const char *dbname, const char *table_name) const;
 
     RC sync();
+    RC vacuum(int free_percent);
 
 public:
     static DefaultHandler &get_default();
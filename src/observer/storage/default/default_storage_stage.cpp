@@ -28,23 +28,107 @@ See the Mulan PSL v2 for more details. */
 #include "event/session_event.h"
 #include "event/sql_event.h"
 #include "event/storage_event.h"
+#include "event/vacuum_event.h"
 #include "rc.h"
 #include "session/session.h"
 #include "storage/common/condition_filter.h"
+#include "storage/common/record_manager.h"
 #include "storage/common/table.h"
 #include "storage/common/table_meta.h"
 #include "storage/default/default_handler.h"
+#include "storage/default/disk_buffer_pool.h"
 #include "storage/trx/trx.h"
 
 using namespace common;
 
 const std::string DefaultStorageStage::QUERY_METRIC_TAG =
     "DefaultStorageStage.query";
+const std::string DefaultStorageStage::BUFFER_POOL_METRIC_TAG =
+    "DefaultStorageStage.buffer_pool";
 const char *CONF_BASE_DIR = "BaseDir";
 const char *CONF_SYSTEM_DB = "SystemDb";
+const char *CONF_STORAGE = "STORAGE";
+const char *CONF_BUFFER_POOL_MB = "BUFFER_POOL_MB";
+const char *CONF_BUFFER_POOL_POLICY = "BUFFER_POOL_POLICY";
+const char *CONF_FLUSH_INTERVAL_MS = "FLUSH_INTERVAL_MS";
+const char *CONF_CLEAN_FRAME_PERCENT = "CLEAN_FRAME_PERCENT";
+const char *CONF_IO_THREADS = "IO_THREADS";
+const char *CONF_READ_AHEAD_PAGES = "READ_AHEAD_PAGES";
+const char *CONF_DIRECT_IO = "DIRECT_IO";
+const char *CONF_MMAP_READ = "MMAP_READ";
+const char *CONF_BUFFER_POOL_DUMP_FILE = "BUFFER_POOL_DUMP_FILE";
+const char *CONF_BUFFER_POOL_DUMP_INTERVAL_S = "BUFFER_POOL_DUMP_INTERVAL_S";
+const char *CONF_PAGE_SIZE = "PAGE_SIZE";
+const char *CONF_BUFFER_POOLS = "BUFFER_POOLS";
+const char *CONF_DATA_BUFFER_POOL = "DATA_BUFFER_POOL";
+const char *CONF_INDEX_BUFFER_POOL = "INDEX_BUFFER_POOL";
+const char *CONF_TABLE_BUFFER_POOLS = "TABLE_BUFFER_POOLS";
+const char *CONF_RECORD_FORMAT = "RECORD_FORMAT";
+const char *CONF_TABLE_RECORD_FORMATS = "TABLE_RECORD_FORMATS";
+const char *CONF_PAGE_COMPRESSION = "PAGE_COMPRESSION";
+const char *CONF_TABLE_PAGE_COMPRESSIONS = "TABLE_PAGE_COMPRESSIONS";
+const char *CONF_VACUUM_INTERVAL_S = "VACUUM_INTERVAL_S";
+const char *CONF_VACUUM_FREE_PERCENT = "VACUUM_FREE_PERCENT";
 
 const char *DEFAULT_SYSTEM_DB = "sys";
 
+/**
+ * 定期输出缓冲池的命中、未命中、淘汰次数、预读的效果、页面校验失败的次数，
+ * 以及压缩文件的压缩率（写入的压缩后大小/原始大小）和平均解压时间。
+ * 计数是所有页面大小的BPManager之和
+ */
+class BufferPoolMetric : public Gauge {
+public:
+    BufferPoolMetric(const DiskBufferPool &buffer_pool)
+        : buffer_pool_(buffer_pool) {
+        snapshot_value_ = &value_;
+    }
+
+    void snapshot() override {
+        uint64_t hit = 0;
+        uint64_t miss = 0;
+        uint64_t evict = 0;
+        uint64_t prefetch = 0;
+        uint64_t prefetch_hit = 0;
+        uint64_t prefetch_wasted = 0;
+        for (const BPManager *bp_manager : buffer_pool_.bp_managers()) {
+            hit += bp_manager->hit_count();
+            miss += bp_manager->miss_count();
+            evict += bp_manager->evict_count();
+            prefetch += bp_manager->prefetch_count();
+            prefetch_hit += bp_manager->prefetch_hit_count();
+            prefetch_wasted += bp_manager->prefetch_wasted_count();
+        }
+        double hit_rate = hit + miss == 0 ? 0.0 : (double)hit / (hit + miss);
+        uint64_t raw_bytes = buffer_pool_.compress_raw_bytes();
+        double compress_ratio =
+            raw_bytes == 0
+                ? 0.0
+                : (double)buffer_pool_.compress_stored_bytes() / raw_bytes;
+        uint64_t decompress = buffer_pool_.decompress_count();
+        uint64_t decompress_avg_ns =
+            decompress == 0 ? 0 : buffer_pool_.decompress_ns() / decompress;
+
+        std::stringstream oss;
+        oss << "policy:"
+            << bp_replace_policy_name(buffer_pool_.bp_manager().policy())
+            << ",hit:" << hit << ",miss:" << miss << ",evict:" << evict
+            << ",hit_rate:" << hit_rate << ",prefetch:" << prefetch
+            << ",prefetch_hit:" << prefetch_hit
+            << ",prefetch_wasted:" << prefetch_wasted
+            << ",checksum_failure:" << buffer_pool_.checksum_failure_count()
+            << ",compress_ratio:" << compress_ratio
+            << ",decompress:" << decompress
+            << ",decompress_avg_ns:" << decompress_avg_ns;
+        std::string value = oss.str();
+        value_.setValue(value);
+    }
+
+private:
+    const DiskBufferPool &buffer_pool_;
+    SnapshotBasic<std::string> value_;
+};
+
 //! Constructor
 DefaultStorageStage::DefaultStorageStage(const char *tag)
     : Stage(tag), handler_(nullptr) {}
@@ -90,6 +174,272 @@ bool DefaultStorageStage::set_properties() {
         LOG_INFO("Use %s as system db", sys_db);
     }
 
+    // 缓冲池大小，单位MB，没有配置时使用默认的帧数
+    std::map<std::string, std::string> storage_section =
+        get_properties()->get(CONF_STORAGE);
+    int frame_num = BP_BUFFER_SIZE;
+    iter = storage_section.find(CONF_BUFFER_POOL_MB);
+    if (iter != storage_section.end()) {
+        long pool_mb = 0;
+        if (!str_to_val(iter->second, pool_mb) || pool_mb <= 0) {
+            LOG_ERROR("Invalid config %s: %s", CONF_BUFFER_POOL_MB,
+                      iter->second.c_str());
+            return false;
+        }
+        frame_num = (int)(pool_mb * 1024 * 1024 / BP_PAGE_SIZE);
+    }
+
+    BPReplacePolicy policy = BPReplacePolicy::LRU;
+    iter = storage_section.find(CONF_BUFFER_POOL_POLICY);
+    if (iter != storage_section.end() &&
+        !bp_replace_policy_from_string(iter->second.c_str(), policy)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_BUFFER_POOL_POLICY,
+                  iter->second.c_str());
+        return false;
+    }
+
+    // 页面读写的异步IO线程数，0表示在工作线程上同步读写
+    int io_threads = 0;
+    iter = storage_section.find(CONF_IO_THREADS);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, io_threads) || io_threads < 0)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_IO_THREADS,
+                  iter->second.c_str());
+        return false;
+    }
+
+    // 新建的数据和索引文件的页面大小，已经存在的文件使用自己文件头中记录的大小。
+    // 缓冲池的大部分内存分给这个页面大小
+    int page_size = BP_PAGE_SIZE;
+    iter = storage_section.find(CONF_PAGE_SIZE);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, page_size) ||
+         !DiskBufferPool::is_valid_page_size(page_size))) {
+        LOG_ERROR("Invalid config %s: %s", CONF_PAGE_SIZE,
+                  iter->second.c_str());
+        return false;
+    }
+
+    if (RC::SUCCESS != init_global_disk_buffer_pool(frame_num, policy,
+                                                    io_threads, page_size)) {
+        LOG_ERROR("Failed to init disk buffer pool");
+        return false;
+    }
+
+    // 其它命名的缓冲池，格式为 名称:大小(MB)，多个之间用逗号分隔
+    iter = storage_section.find(CONF_BUFFER_POOLS);
+    if (iter != storage_section.end()) {
+        std::vector<std::string> pools;
+        split_string(iter->second, ",", pools);
+        for (std::string &pool : pools) {
+            strip(pool);
+            if (pool.empty()) {
+                continue;
+            }
+            std::string::size_type pos = pool.find(':');
+            long pool_mb = 0;
+            if (pos == std::string::npos ||
+                !str_to_val(pool.substr(pos + 1), pool_mb) || pool_mb <= 0 ||
+                RC::SUCCESS != init_named_disk_buffer_pool(
+                                   pool.substr(0, pos).c_str(),
+                                   (int)(pool_mb * 1024 * 1024 / BP_PAGE_SIZE),
+                                   policy, io_threads, page_size)) {
+                LOG_ERROR("Invalid config %s: %s", CONF_BUFFER_POOLS,
+                          iter->second.c_str());
+                return false;
+            }
+        }
+    }
+
+    // 数据文件和索引文件默认使用的缓冲池
+    std::string data_pool = DEFAULT_BUFFER_POOL_NAME;
+    std::string index_pool = DEFAULT_BUFFER_POOL_NAME;
+    iter = storage_section.find(CONF_DATA_BUFFER_POOL);
+    if (iter != storage_section.end() && !iter->second.empty()) {
+        data_pool = iter->second;
+    }
+    iter = storage_section.find(CONF_INDEX_BUFFER_POOL);
+    if (iter != storage_section.end() && !iter->second.empty()) {
+        index_pool = iter->second;
+    }
+    if (RC::SUCCESS != assign_table_buffer_pool(nullptr, data_pool.c_str(),
+                                                index_pool.c_str())) {
+        LOG_ERROR("Invalid config %s: %s or %s: %s", CONF_DATA_BUFFER_POOL,
+                  data_pool.c_str(), CONF_INDEX_BUFFER_POOL,
+                  index_pool.c_str());
+        return false;
+    }
+
+    // 单独指定缓冲池的表，格式为 表名:数据缓冲池[:索引缓冲池]
+    iter = storage_section.find(CONF_TABLE_BUFFER_POOLS);
+    if (iter != storage_section.end()) {
+        std::vector<std::string> tables;
+        split_string(iter->second, ",", tables);
+        for (std::string &table : tables) {
+            strip(table);
+            if (table.empty()) {
+                continue;
+            }
+            std::vector<std::string> fields;
+            split_string(table, ":", fields);
+            if (fields.size() < 2 || fields.size() > 3 ||
+                RC::SUCCESS != assign_table_buffer_pool(
+                                   fields[0].c_str(), fields[1].c_str(),
+                                   fields.back().c_str())) {
+                LOG_ERROR("Invalid config %s: %s", CONF_TABLE_BUFFER_POOLS,
+                          iter->second.c_str());
+                return false;
+            }
+        }
+    }
+
+    // 新建的表的记录格式，已经存在的表使用元数据中记录的格式
+    iter = storage_section.find(CONF_RECORD_FORMAT);
+    if (iter != storage_section.end()) {
+        RecordFormat record_format = RecordFormat::FIXED;
+        if (!record_format_from_name(iter->second.c_str(), record_format)) {
+            LOG_ERROR("Invalid config %s: %s", CONF_RECORD_FORMAT,
+                      iter->second.c_str());
+            return false;
+        }
+        assign_table_record_format(nullptr, record_format);
+    }
+
+    // 单独指定记录格式的表，格式为 表名:fixed|slotted
+    iter = storage_section.find(CONF_TABLE_RECORD_FORMATS);
+    if (iter != storage_section.end()) {
+        std::vector<std::string> tables;
+        split_string(iter->second, ",", tables);
+        for (std::string &table : tables) {
+            strip(table);
+            if (table.empty()) {
+                continue;
+            }
+            std::string::size_type pos = table.find(':');
+            RecordFormat record_format = RecordFormat::FIXED;
+            if (pos == std::string::npos ||
+                !record_format_from_name(table.c_str() + pos + 1,
+                                         record_format)) {
+                LOG_ERROR("Invalid config %s: %s", CONF_TABLE_RECORD_FORMATS,
+                          iter->second.c_str());
+                return false;
+            }
+            assign_table_record_format(table.substr(0, pos).c_str(),
+                                       record_format);
+        }
+    }
+
+    // 新建的表的数据文件的页面压缩算法，已经存在的表按照有没有页面映射文件判断
+    iter = storage_section.find(CONF_PAGE_COMPRESSION);
+    if (iter != storage_section.end()) {
+        PageCompression compression = PageCompression::NONE;
+        if (!page_compression_from_name(iter->second.c_str(), compression) ||
+            !page_compression_supported(compression)) {
+            LOG_ERROR("Invalid config %s: %s", CONF_PAGE_COMPRESSION,
+                      iter->second.c_str());
+            return false;
+        }
+        assign_table_page_compression(nullptr, compression);
+    }
+
+    // 单独指定压缩算法的表，格式为 表名:none|zlib|lz4|zstd
+    iter = storage_section.find(CONF_TABLE_PAGE_COMPRESSIONS);
+    if (iter != storage_section.end()) {
+        std::vector<std::string> tables;
+        split_string(iter->second, ",", tables);
+        for (std::string &table : tables) {
+            strip(table);
+            if (table.empty()) {
+                continue;
+            }
+            std::string::size_type pos = table.find(':');
+            PageCompression compression = PageCompression::NONE;
+            if (pos == std::string::npos ||
+                !page_compression_from_name(table.c_str() + pos + 1,
+                                            compression) ||
+                !page_compression_supported(compression)) {
+                LOG_ERROR("Invalid config %s: %s",
+                          CONF_TABLE_PAGE_COMPRESSIONS, iter->second.c_str());
+                return false;
+            }
+            assign_table_page_compression(table.substr(0, pos).c_str(),
+                                          compression);
+        }
+    }
+
+    // 定期整理数据文件，没有配置间隔时不整理
+    iter = storage_section.find(CONF_VACUUM_INTERVAL_S);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, vacuum_interval_s_) ||
+         vacuum_interval_s_ < 0)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_VACUUM_INTERVAL_S,
+                  iter->second.c_str());
+        return false;
+    }
+    iter = storage_section.find(CONF_VACUUM_FREE_PERCENT);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, vacuum_free_percent_) ||
+         vacuum_free_percent_ <= 0 || vacuum_free_percent_ > 100)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_VACUUM_FREE_PERCENT,
+                  iter->second.c_str());
+        return false;
+    }
+
+    // 数据和索引文件是否使用O_DIRECT读写
+    iter = storage_section.find(CONF_DIRECT_IO);
+    bool direct_io =
+        iter != storage_section.end() && iter->second.compare("true") == 0;
+
+    // 只读查询是否直接读取数据和索引文件的内存映射
+    iter = storage_section.find(CONF_MMAP_READ);
+    bool mmap_read =
+        iter != storage_section.end() && iter->second.compare("true") == 0;
+
+    // 顺序读时最多预读的页数，没有配置时不预读
+    int read_ahead_pages = 0;
+    iter = storage_section.find(CONF_READ_AHEAD_PAGES);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, read_ahead_pages) ||
+         read_ahead_pages < 0)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_READ_AHEAD_PAGES,
+                  iter->second.c_str());
+        return false;
+    }
+
+    // 后台刷脏页，没有配置刷盘间隔时不启动
+    int flush_interval_ms = 0;
+    int clean_percent = 0;
+    iter = storage_section.find(CONF_FLUSH_INTERVAL_MS);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, flush_interval_ms) ||
+         flush_interval_ms < 0)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_FLUSH_INTERVAL_MS,
+                  iter->second.c_str());
+        return false;
+    }
+    iter = storage_section.find(CONF_CLEAN_FRAME_PERCENT);
+    if (iter != storage_section.end() &&
+        (!str_to_val(iter->second, clean_percent) || clean_percent < 0 ||
+         clean_percent > 100)) {
+        LOG_ERROR("Invalid config %s: %s", CONF_CLEAN_FRAME_PERCENT,
+                  iter->second.c_str());
+        return false;
+    }
+
+    for (auto &pool : all_disk_buffer_pools()) {
+        DiskBufferPool *buffer_pool = pool.second;
+        buffer_pool->set_direct_io(direct_io);
+        buffer_pool->set_mmap_read(mmap_read);
+        buffer_pool->set_read_ahead(read_ahead_pages);
+        if (flush_interval_ms > 0 &&
+            RC::SUCCESS !=
+                buffer_pool->start_flusher(flush_interval_ms, clean_percent)) {
+            LOG_ERROR("Failed to start flusher of buffer pool %s",
+                      pool.first.c_str());
+            return false;
+        }
+    }
+
     handler_ = &DefaultHandler::get_default();
     if (RC::SUCCESS != handler_->init(base_dir)) {
         LOG_ERROR("Failed to init default handler");
@@ -108,6 +458,42 @@ bool DefaultStorageStage::set_properties() {
         return false;
     }
 
+    // 重新加载上次保存的缓冲池页面，预热完成之后才开始接受连接
+    iter = storage_section.find(CONF_BUFFER_POOL_DUMP_FILE);
+    if (iter != storage_section.end() && !iter->second.empty()) {
+        std::string dump_file = iter->second;
+        if (dump_file[0] != '/') {
+            dump_file = std::string(base_dir) + "/" + dump_file;
+        }
+        int dump_interval_s = 0;
+        std::map<std::string, std::string>::iterator interval_iter =
+            storage_section.find(CONF_BUFFER_POOL_DUMP_INTERVAL_S);
+        if (interval_iter != storage_section.end() &&
+            (!str_to_val(interval_iter->second, dump_interval_s) ||
+             dump_interval_s < 0)) {
+            LOG_ERROR("Invalid config %s: %s",
+                      CONF_BUFFER_POOL_DUMP_INTERVAL_S,
+                      interval_iter->second.c_str());
+            return false;
+        }
+
+        // 每个缓冲池一个页面列表，命名的缓冲池在文件名后面加上缓冲池的名称
+        for (auto &pool : all_disk_buffer_pools()) {
+            std::string pool_dump_file = dump_file;
+            if (pool.first != DEFAULT_BUFFER_POOL_NAME) {
+                pool_dump_file += "." + pool.first;
+            }
+            DiskBufferPool *buffer_pool = pool.second;
+            if (RC::SUCCESS != buffer_pool->warm_up(pool_dump_file.c_str()) ||
+                RC::SUCCESS != buffer_pool->start_page_list_dumper(
+                                   pool_dump_file.c_str(), dump_interval_s)) {
+                LOG_ERROR("Failed to warm up buffer pool from %s",
+                          pool_dump_file.c_str());
+                return false;
+            }
+        }
+    }
+
     Session &default_session = Session::default_session();
     default_session.set_current_db(sys_db);
 
@@ -123,6 +509,26 @@ bool DefaultStorageStage::initialize() {
     query_metric_ = new SimpleTimer();
     metricsRegistry.register_metric(QUERY_METRIC_TAG, query_metric_);
 
+    // 每个缓冲池单独统计，命名的缓冲池的标签后面加上名称
+    for (auto &pool : all_disk_buffer_pools()) {
+        std::string tag = BUFFER_POOL_METRIC_TAG;
+        if (pool.first != DEFAULT_BUFFER_POOL_NAME) {
+            tag += "." + pool.first;
+        }
+        Metric *metric = new BufferPoolMetric(*pool.second);
+        metricsRegistry.register_metric(tag, metric);
+        buffer_pool_metrics_.push_back(metric);
+    }
+
+    if (vacuum_interval_s_ > 0) {
+        if (next_stage_list_.empty()) {
+            LOG_ERROR("TimerStage is required by %s", CONF_VACUUM_INTERVAL_S);
+            return false;
+        }
+        timer_stage_ = next_stage_list_.front();
+        add_event(new VacuumEvent());
+    }
+
     LOG_TRACE("Exit");
     return true;
 }
@@ -140,6 +546,12 @@ void DefaultStorageStage::cleanup() {
 
 void DefaultStorageStage::handle_event(StageEvent *event) {
     LOG_TRACE("Enter\n");
+    if (dynamic_cast<VacuumEvent *>(event) != nullptr) {
+        schedule_vacuum(event);
+        LOG_TRACE("Exit\n");
+        return;
+    }
+
     TimerStat timerStat(*query_metric_);
 
     StorageEvent *storage_event = static_cast<StorageEvent *>(event);
@@ -215,8 +627,8 @@ void DefaultStorageStage::handle_event(StageEvent *event) {
             const CreateIndex &create_index = sql->sstr.create_index;
             rc = handler_->create_index(
                 current_trx, current_db, create_index.relation_name,
-                create_index.index_name, create_index.attribute_name,
-                create_index.is_unique);
+                create_index.index_name, create_index.attribute_num,
+                create_index.attribute_names, create_index.is_unique);
             snprintf(response, sizeof(response), "%s\n",
                      rc == RC::SUCCESS ? "SUCCESS" : "FAILURE");
         } break;
@@ -285,12 +697,43 @@ void DefaultStorageStage::handle_event(StageEvent *event) {
 void DefaultStorageStage::callback_event(StageEvent *event,
                                          CallbackContext *context) {
     LOG_TRACE("Enter\n");
+    if (dynamic_cast<VacuumEvent *>(event) != nullptr) {
+        RC rc = handler_->vacuum(vacuum_free_percent_);
+        if (rc != RC::SUCCESS) {
+            LOG_WARN("Failed to vacuum data files. rc=%d:%s", rc, strrc(rc));
+        }
+        // do it again.
+        add_event(event);
+        LOG_TRACE("Exit\n");
+        return;
+    }
+
     StorageEvent *storage_event = static_cast<StorageEvent *>(event);
     storage_event->exe_event()->done_immediate();
     LOG_TRACE("Exit\n");
     return;
 }
 
+void DefaultStorageStage::schedule_vacuum(StageEvent *event) {
+    CompletionCallback *cb =
+        new (std::nothrow) CompletionCallback(this, nullptr);
+    if (cb == nullptr) {
+        LOG_ERROR("Failed to new callback for VacuumEvent");
+        event->done();
+        return;
+    }
+    TimerRegisterEvent *tm_event = new (std::nothrow)
+        TimerRegisterEvent(event, (u64_t)vacuum_interval_s_ * USEC_PER_SEC);
+    if (tm_event == nullptr) {
+        LOG_ERROR("Failed to new TimerRegisterEvent");
+        delete cb;
+        event->done();
+        return;
+    }
+    event->push_callback(cb);
+    timer_stage_->add_event(tm_event);
+}
+
 /**
  * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
  * @param table  要导入的表
@@ -18,6 +18,8 @@ See the Mulan PSL v2 for more details. */
 #include "common/seda/stage.h"
 #include "common/metrics/metrics.h"
 
+#include <vector>
+
 class DefaultHandler;
 
 class DefaultStorageStage : public common::Stage {
@@ -38,13 +40,19 @@ protected:
 
 private:
   std::string load_data(const char *db_name, const char *table_name, const char *file_name);
+  void schedule_vacuum(common::StageEvent *event);
 
 protected:
   common::SimpleTimer *query_metric_ = nullptr;
   static const std::string QUERY_METRIC_TAG;
+  std::vector<common::Metric *> buffer_pool_metrics_;
+  static const std::string BUFFER_POOL_METRIC_TAG;
 
 private:
   DefaultHandler * handler_;
+  common::Stage *timer_stage_ = nullptr;
+  int vacuum_interval_s_ = 0;    // 整理数据文件的间隔，0表示不整理
+  int vacuum_free_percent_ = 50; // 空闲空间不少于这个比例的页面需要整理
 };
 
 #endif //__OBSERVER_STORAGE_DEFAULT_STORAGE_STAGE_H__
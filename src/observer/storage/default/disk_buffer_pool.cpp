@@ -13,10 +13,27 @@ See the Mulan PSL v2 for more details. */
 //
 #include "disk_buffer_pool.h"
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+#include "common/lang/bitmap.h"
+#include "common/math/crc32c.h"
 #include "common/log/log.h"
 
+static const size_t MMAP_MIN_SIZE = 1UL << 30;  // 只读映射至少映射的长度，给文件增长留出余量
+static const size_t FLUSH_BATCH_PAGES = 64;     // 一次pwritev最多合并的页面数
+static const size_t FLUSH_INFLIGHT_BATCHES = 8;  // 刷脏页时同时在途的写请求数
+static const int READ_AHEAD_TRIGGER = 2;         // 连续顺序读多少次之后开始预读
+static const int READ_AHEAD_MIN_PAGES = 4;       // 第一次预读的页数
+static const int READ_AHEAD_MAX_GAP = 4;         // 跳过的页(比如已经删除的页)不超过这个数仍然算顺序读
+
 using namespace common;
 
 unsigned long current_time()
@@ -26,497 +43,2147 @@ unsigned long current_time()
   return tp.tv_sec * 1000 * 1000 * 1000UL + tp.tv_nsec;
 }
 
-DiskBufferPool *theGlobalDiskBufferPool()
+static DiskBufferPool *global_disk_buffer_pool = nullptr;
+
+RC init_global_disk_buffer_pool(int frame_num, BPReplacePolicy policy, int io_threads, int page_size)
 {
-  static DiskBufferPool *instance = new DiskBufferPool();
+  if (global_disk_buffer_pool != nullptr) {
+    LOG_WARN("Global disk buffer pool has been initialized");
+    return RC::GENERIC_ERROR;
+  }
 
-  return instance;
+  global_disk_buffer_pool = new DiskBufferPool(frame_num, policy, io_threads, page_size);
+  LOG_INFO("Init global disk buffer pool with %d frames, replace policy %s, io threads %d",
+      frame_num, bp_replace_policy_name(policy), io_threads);
+  return RC::SUCCESS;
 }
 
-RC DiskBufferPool::create_file(const char *file_name)
+DiskBufferPool *theGlobalDiskBufferPool()
 {
-  int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
-  if (fd < 0) {
-    LOG_ERROR("Failed to create %s, due to %s.", file_name, strerror(errno));
-    return RC::SCHEMA_DB_EXIST;
+  if (global_disk_buffer_pool == nullptr) {
+    global_disk_buffer_pool = new DiskBufferPool();
   }
 
-  close(fd);
+  return global_disk_buffer_pool;
+}
 
-  /**
-   * Here don't care about the failure
-   */
-  fd = open(file_name, O_RDWR);
-  if (fd < 0) {
-    LOG_ERROR("Failed to open for readwrite %s, due to %s.", file_name, strerror(errno));
-    return RC::IOERR_ACCESS;
+namespace {
+/**
+ * 命名的缓冲池和表到缓冲池的映射，启动时根据配置建立
+ */
+struct BufferPoolRegistry {
+  std::mutex mutex;
+  std::map<std::string, DiskBufferPool *> pools;
+  std::string data_pool = DEFAULT_BUFFER_POOL_NAME;
+  std::string index_pool = DEFAULT_BUFFER_POOL_NAME;
+  std::map<std::string, std::pair<std::string, std::string>> table_pools;  // 表名 -> (数据, 索引)
+};
+
+BufferPoolRegistry &buffer_pool_registry()
+{
+  static BufferPoolRegistry registry;
+  return registry;
+}
+
+DiskBufferPool *find_buffer_pool(BufferPoolRegistry &registry, const std::string &name)
+{
+  if (name == DEFAULT_BUFFER_POOL_NAME) {
+    return theGlobalDiskBufferPool();
   }
+  auto iter = registry.pools.find(name);
+  return iter == registry.pools.end() ? nullptr : iter->second;
+}
+}  // namespace
 
-  Page page;
-  memset(&page, 0, sizeof(Page));
+RC init_named_disk_buffer_pool(const char *name, int frame_num, BPReplacePolicy policy, int io_threads, int page_size)
+{
+  BufferPoolRegistry &registry = buffer_pool_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (name == nullptr || *name == '\0' || find_buffer_pool(registry, name) != nullptr) {
+    LOG_ERROR("Invalid or duplicate buffer pool name %s", name == nullptr ? "null" : name);
+    return RC::INVALID_ARGUMENT;
+  }
 
-  BPFileSubHeader *fileSubHeader;
-  fileSubHeader = (BPFileSubHeader *)page.data;
-  fileSubHeader->allocated_pages = 1;
-  fileSubHeader->page_count = 1;
+  registry.pools[name] = new DiskBufferPool(frame_num, policy, io_threads, page_size);
+  LOG_INFO("Init disk buffer pool %s with %d frames, replace policy %s, io threads %d",
+      name, frame_num, bp_replace_policy_name(policy), io_threads);
+  return RC::SUCCESS;
+}
 
-  char *bitmap = page.data + (int)BP_FILE_SUB_HDR_SIZE;
-  bitmap[0] |= 0x01;
-  if (lseek(fd, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_SEEK;
+DiskBufferPool *theNamedDiskBufferPool(const char *name)
+{
+  BufferPoolRegistry &registry = buffer_pool_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return find_buffer_pool(registry, name);
+}
+
+std::vector<std::pair<std::string, DiskBufferPool *>> all_disk_buffer_pools()
+{
+  BufferPoolRegistry &registry = buffer_pool_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<std::pair<std::string, DiskBufferPool *>> pools;
+  pools.emplace_back(DEFAULT_BUFFER_POOL_NAME, theGlobalDiskBufferPool());
+  for (auto &item : registry.pools) {
+    pools.emplace_back(item.first, item.second);
   }
+  return pools;
+}
 
-  if (write(fd, (char *)&page, sizeof(Page)) != sizeof(Page)) {
-    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_WRITE;
+RC assign_table_buffer_pool(const char *table_name, const char *data_pool, const char *index_pool)
+{
+  BufferPoolRegistry &registry = buffer_pool_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (find_buffer_pool(registry, data_pool) == nullptr || find_buffer_pool(registry, index_pool) == nullptr) {
+    LOG_ERROR("No such buffer pool %s or %s", data_pool, index_pool);
+    return RC::NOTFOUND;
   }
 
-  close(fd);
-  LOG_INFO("Successfully create %s.", file_name);
+  if (table_name == nullptr) {
+    registry.data_pool = data_pool;
+    registry.index_pool = index_pool;
+  } else {
+    registry.table_pools[table_name] = std::make_pair(std::string(data_pool), std::string(index_pool));
+  }
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::open_file(const char *file_name, int *file_id)
+DiskBufferPool *theTableBufferPool(const char *table_name, bool index)
 {
-  int fd, i;
-  // This part isn't gentle, the better method is using LRU queue.
-  for (i = 0; i < MAX_OPEN_FILE; i++) {
-    if (open_list_[i]) {
-      if (!strcmp(open_list_[i]->file_name, file_name)) {
-        *file_id = i;
-        LOG_INFO("%s has already been opened.", file_name);
-        return RC::SUCCESS;
+  BufferPoolRegistry &registry = buffer_pool_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::string name = index ? registry.index_pool : registry.data_pool;
+  auto iter = registry.table_pools.find(table_name);
+  if (iter != registry.table_pools.end()) {
+    name = index ? iter->second.second : iter->second.first;
+  }
+  return find_buffer_pool(registry, name);
+}
+
+void cleanup_global_disk_buffer_pool()
+{
+  if (global_disk_buffer_pool == nullptr) {
+    return;
+  }
+  for (auto &item : all_disk_buffer_pools()) {
+    item.second->stop_page_list_dumper();
+    item.second->stop_flusher();
+    item.second->flush_all_files();
+  }
+}
+
+BPManager::BPManager(int size, BPReplacePolicy policy, int page_size) : page_size_(page_size), policy_(policy)
+{
+  void *pages = nullptr;
+  if (size <= 0 || posix_memalign(&pages, BP_PAGE_SIZE, (size_t)size * page_size) != 0) {
+    LOG_ERROR("Failed to allocate %d pages of %d bytes for buffer pool", size, page_size);
+    size = 0;
+  }
+
+  this->size = size;
+  pages_ = (char *)pages;
+  frame = new Frame[size];
+  allocated = new bool[size];
+  free_list_.reserve(size);
+  for (int i = size - 1; i >= 0; i--) {
+    allocated[i] = false;
+    frame[i].page = (Page *)(pages_ + (size_t)i * page_size);
+    frame[i].dirty = false;
+    frame[i].pin_count = 0;
+    frame[i].acc_time = 0;
+    frame[i].prefetched = false;
+    frame[i].file_desc = -1;
+    pthread_rwlock_init(&frame[i].latch, nullptr);
+    free_list_.push_back(frame + i);
+  }
+  replacer_ = BPReplacer::create(policy, size);
+}
+
+BPManager::~BPManager()
+{
+  for (int i = 0; i < size; i++) {
+    pthread_rwlock_destroy(&frame[i].latch);
+  }
+  delete[] frame;
+  delete[] allocated;
+  ::free(pages_);
+  delete replacer_;
+  replacer_ = nullptr;
+  size = 0;
+  frame = nullptr;
+  allocated = nullptr;
+  pages_ = nullptr;
+}
+
+/**
+ * 从空闲链表或者淘汰一个页面得到一个帧。返回的帧不在页表中，其它线程看不到
+ */
+RC BPManager::take_frame(Frame **buffer, bool flush_dirty)
+{
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!free_list_.empty()) {
+      Frame *buf = free_list_.back();
+      free_list_.pop_back();
+      allocated[buf - frame] = true;
+      *buffer = buf;
+      return RC::SUCCESS;
+    }
+
+    Frame *victim = find_victim();
+    if (victim == nullptr) {
+      LOG_ERROR("All pages have been used and pinned.");
+      return RC::NOMEM;
+    }
+
+    uint64_t key = page_key(victim->file_desc, victim->page->page_num);
+    PageTablePartition &part = partition(key);
+    std::unique_lock<std::mutex> part_lock(part.mutex);
+    if (victim->pin_count != 0) {
+      // 挑选之后被其它线程pin住了，重新挑选
+      continue;
+    }
+
+    if (!victim->dirty) {
+      part.table.erase(key);
+      part_lock.unlock();
+      {
+        std::lock_guard<std::mutex> replacer_lock(replacer_mutex_);
+        replacer_->evict(victim - frame);
       }
+      evict_count_++;
+      if (victim->prefetched.exchange(false)) {
+        prefetch_wasted_count_++;
+      }
+      *buffer = victim;
+      return RC::SUCCESS;
+    }
+
+    if (!flusher_ || !flush_dirty) {
+      return RC::NOMEM;
+    }
+
+    // 脏页先pin住再刷盘，刷盘的时候不持有任何锁
+    victim->pin_count++;
+    part_lock.unlock();
+    lock.unlock();
+
+    RC rc = flusher_(victim);
+    victim->pin_count--;
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush block of %d for %d.", victim->page->page_num, victim->file_desc);
+      return rc;
     }
   }
-  i = 0;
-  while (i < MAX_OPEN_FILE && open_list_[i++])
-    ;
-  if (i >= MAX_OPEN_FILE && open_list_[i - 1]) {
-    LOG_ERROR("Failed to open file %s, because too much files has been opened.", file_name);
-    return RC::BUFFERPOOL_OPEN_TOO_MANY_FILES;
+}
+
+void BPManager::publish(Frame *buf, uint64_t key)
+{
+  partition(key).table[key] = buf;
+  std::lock_guard<std::mutex> replacer_lock(replacer_mutex_);
+  replacer_->insert(buf - frame, key);
+}
+
+void BPManager::release_frame(Frame *buf)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  allocated[buf - frame] = false;
+  buf->dirty = false;
+  buf->pin_count = 0;
+  buf->prefetched = false;
+  buf->file_desc = -1;
+  free_list_.push_back(buf);
+}
+
+Frame *BPManager::alloc(int file_desc, PageNum page_num)
+{
+  Frame *buf = nullptr;
+  if (take_frame(&buf) != RC::SUCCESS) {
+    return nullptr;
   }
 
-  if ((fd = open(file_name, O_RDWR)) < 0) {
-    LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
-    return RC::IOERR_ACCESS;
+  buf->dirty = false;
+  buf->pin_count = 0;
+  buf->acc_time = current_time();
+  buf->prefetched = false;
+  buf->file_desc = file_desc;
+  buf->page->page_num = page_num;
+
+  uint64_t key = page_key(file_desc, page_num);
+  std::lock_guard<std::mutex> part_lock(partition(key).mutex);
+  publish(buf, key);
+  return buf;
+}
+
+RC BPManager::alloc(int file_desc, PageNum page_num, const FrameInitializer &init, Frame **frame)
+{
+  Frame *buf = nullptr;
+  RC rc = take_frame(&buf);
+  if (rc != RC::SUCCESS) {
+    return rc;
   }
-  LOG_INFO("Successfully open file %s.", file_name);
 
-  BPFileHandle *file_handle = new (std::nothrow) BPFileHandle();
-  if (file_handle == nullptr) {
-    LOG_ERROR("Failed to alloc memory of BPFileHandle for %s.", file_name);
-    close(fd);
-    return RC::NOMEM;
+  buf->dirty = false;
+  buf->pin_count = 1;
+  buf->acc_time = current_time();
+  buf->prefetched = false;
+  buf->file_desc = file_desc;
+  buf->page->page_num = page_num;
+  if (init) {
+    rc = init(buf);
+    if (rc != RC::SUCCESS) {
+      release_frame(buf);
+      return rc;
+    }
   }
 
-  RC tmp;
-  file_handle->bopen = true;
-  int file_name_len = strlen(file_name) + 1;
-  char *cloned_file_name = new char[file_name_len];
-  snprintf(cloned_file_name, file_name_len, "%s", file_name);
-  cloned_file_name[file_name_len - 1] = '\0';
-  file_handle->file_name = cloned_file_name;
-  file_handle->file_desc = fd;
-  if ((tmp = allocate_block(&file_handle->hdr_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to allocate block for %s's BPFileHandle.", file_name);
-    delete file_handle;
-    close(fd);
-    return tmp;
+  uint64_t key = page_key(file_desc, page_num);
+  PageTablePartition &part = partition(key);
+  std::unique_lock<std::mutex> part_lock(part.mutex);
+  auto iter = part.table.find(key);
+  if (iter != part.table.end()) {
+    // 其它线程已经加载了这个页面
+    Frame *existing = iter->second;
+    existing->pin_count++;
+    part_lock.unlock();
+    release_frame(buf);
+    *frame = existing;
+    return RC::SUCCESS;
   }
-  file_handle->hdr_frame->dirty = false;
-  file_handle->hdr_frame->acc_time = current_time();
-  file_handle->hdr_frame->file_desc = fd;
-  file_handle->hdr_frame->pin_count = 1;
-  if ((tmp = load_page(0, file_handle, file_handle->hdr_frame)) != RC::SUCCESS) {
-    file_handle->hdr_frame->pin_count = 0;
-    dispose_block(file_handle->hdr_frame);
-    close(fd);
-    delete file_handle;
-    return tmp;
+
+  publish(buf, key);
+  *frame = buf;
+  return RC::SUCCESS;
+}
+
+RC BPManager::alloc_prefetch(int file_desc, PageNum page_num, Frame **frame)
+{
+  uint64_t key = page_key(file_desc, page_num);
+  {
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+    if (!prefetching_.insert(key).second) {
+      return RC::GENERIC_ERROR;
+    }
+    prefetching_count_++;
   }
 
-  file_handle->hdr_page = &(file_handle->hdr_frame->page);
-  file_handle->bitmap = file_handle->hdr_page->data + BP_FILE_SUB_HDR_SIZE;
-  file_handle->file_sub_header = (BPFileSubHeader *)file_handle->hdr_page->data;
-  open_list_[i - 1] = file_handle;
-  *file_id = i - 1;
-  LOG_INFO("Successfully open %s. file_id=%d, hdr_frame=%p", file_name, *file_id, file_handle->hdr_frame);
+  Frame *buf = nullptr;
+  RC rc = take_frame(&buf, false);
+  if (rc != RC::SUCCESS) {
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+    prefetching_.erase(key);
+    prefetching_count_--;
+    prefetch_cond_.notify_all();
+    return rc;
+  }
+
+  buf->dirty = false;
+  buf->pin_count = 1;
+  buf->acc_time = current_time();
+  buf->prefetched = false;
+  buf->file_desc = file_desc;
+  buf->page->page_num = page_num;
+  prefetch_count_++;
+  *frame = buf;
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::close_file(int file_id)
+void BPManager::complete_prefetch(Frame *buf, PageNum page_num, bool success)
 {
-  RC tmp;
-  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to close file, due to invalid fileId %d", file_id);
-    return tmp;
+  uint64_t key = page_key(buf->file_desc, page_num);
+  if (!success) {
+    release_frame(buf);
+  } else {
+    PageTablePartition &part = partition(key);
+    std::unique_lock<std::mutex> part_lock(part.mutex);
+    if (part.table.find(key) != part.table.end()) {
+      // 预读期间前台线程已经自己加载了这个页面
+      part_lock.unlock();
+      prefetch_wasted_count_++;
+      release_frame(buf);
+    } else {
+      buf->prefetched = true;
+      buf->pin_count = 0;
+      publish(buf, key);
+    }
   }
 
-  BPFileHandle *file_handle = open_list_[file_id];
-  file_handle->hdr_frame->pin_count--;
-  if ((tmp = force_all_pages(file_handle)) != RC::SUCCESS) {
-    file_handle->hdr_frame->pin_count++;
-    LOG_ERROR("Failed to closeFile %d:%s, due to failed to force all pages.", file_id, file_handle->file_name);
-    return tmp;
+  std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+  prefetching_.erase(key);
+  prefetching_count_--;
+  prefetch_cond_.notify_all();
+}
+
+bool BPManager::wait_prefetch(int file_desc, PageNum page_num)
+{
+  if (prefetching_count_ == 0) {
+    return false;
   }
 
-  if (close(file_handle->file_desc) < 0) {
-    LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_id, file_handle->file_name, strerror(errno));
-    return RC::IOERR_CLOSE;
+  uint64_t key = page_key(file_desc, page_num);
+  std::unique_lock<std::mutex> prefetch_lock(prefetch_mutex_);
+  if (prefetching_.count(key) == 0) {
+    return false;
   }
-  open_list_[file_id] = nullptr;
-  delete (file_handle);
-  LOG_INFO("Successfully close file %d:%s.", file_id, file_handle->file_name);
-  return RC::SUCCESS;
+  prefetch_cond_.wait(prefetch_lock, [this, key]() { return prefetching_.count(key) == 0; });
+  return true;
 }
 
-RC DiskBufferPool::get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle)
+Frame *BPManager::lookup(uint64_t key, bool pin, bool access)
 {
-  RC tmp;
-  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %d, due to invalid fileId %d", page_num, file_id);
-    return tmp;
+  Frame *buf = nullptr;
+  {
+    PageTablePartition &part = partition(key);
+    std::lock_guard<std::mutex> part_lock(part.mutex);
+    auto iter = part.table.find(key);
+    if (iter != part.table.end()) {
+      buf = iter->second;
+      if (pin) {
+        buf->pin_count++;
+      }
+    }
   }
 
-  BPFileHandle *file_handle = open_list_[file_id];
-  if ((tmp = check_page_num(page_num, file_handle)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %s:%d, due to invalid pageNum.", file_handle->file_name, page_num);
-    return tmp;
+  if (!access) {
+    return buf;
   }
 
-  for (int i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (!bp_manager_.allocated[i])
-      continue;
-    if (bp_manager_.frame[i].file_desc != file_handle->file_desc)
-      continue;
+  if (buf == nullptr) {
+    miss_count_++;
+    return nullptr;
+  }
+
+  hit_count_++;
+  if (buf->prefetched.exchange(false)) {
+    prefetch_hit_count_++;
+  }
+  buf->acc_time = current_time();
+  std::lock_guard<std::mutex> replacer_lock(replacer_mutex_);
+  replacer_->access(buf - frame);
+  return buf;
+}
+
+Frame *BPManager::get(int file_desc, PageNum page_num)
+{
+  return lookup(page_key(file_desc, page_num), false, true);
+}
+
+Frame *BPManager::pin(int file_desc, PageNum page_num, bool access)
+{
+  return lookup(page_key(file_desc, page_num), true, access);
+}
+
+void BPManager::mark_dirty(Frame *buf)
+{
+  if (buf->dirty.exchange(true)) {
+    return;
+  }
+
+  dirty_count_++;
+  std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+  dirty_list_.push_back(page_key(buf->file_desc, buf->page->page_num));
+}
+
+bool BPManager::clear_dirty(Frame *buf)
+{
+  if (!buf->dirty.exchange(false)) {
+    return false;
+  }
+  dirty_count_--;
+  return true;
+}
+
+std::vector<uint64_t> BPManager::take_dirty_list()
+{
+  std::vector<uint64_t> dirty_list;
+  std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+  dirty_list.swap(dirty_list_);
+  return dirty_list;
+}
+
+void BPManager::requeue_dirty(uint64_t key)
+{
+  std::lock_guard<std::mutex> dirty_lock(dirty_mutex_);
+  dirty_list_.push_back(key);
+}
+
+Frame *BPManager::find(int file_desc, PageNum page_num)
+{
+  uint64_t key = page_key(file_desc, page_num);
+  PageTablePartition &part = partition(key);
+  std::lock_guard<std::mutex> part_lock(part.mutex);
+  auto iter = part.table.find(key);
+  if (iter == part.table.end()) {
+    return nullptr;
+  }
+  return iter->second;
+}
+
+Frame *BPManager::find_victim()
+{
+  std::lock_guard<std::mutex> replacer_lock(replacer_mutex_);
+  int victim = replacer_->victim([this](int frame_id) { return frame[frame_id].pin_count == 0; });
+  if (victim < 0) {
+    return nullptr;
+  }
+  return frame + victim;
+}
+
+void BPManager::free(Frame *buf)
+{
+  int pos = buf - frame;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!allocated[pos]) {
+    return;
+  }
 
-    // This page has been loaded.
-    if (bp_manager_.frame[i].page.page_num == page_num) {
-      page_handle->frame = bp_manager_.frame + i;
-      page_handle->frame->pin_count++;
-      page_handle->frame->acc_time = current_time();
-      page_handle->open = true;
+  uint64_t key = page_key(buf->file_desc, buf->page->page_num);
+  {
+    std::lock_guard<std::mutex> part_lock(partition(key).mutex);
+    partition(key).table.erase(key);
+  }
+  recycle(buf);
+}
+
+RC BPManager::free_if_unpinned(int file_desc, PageNum page_num, bool discard_dirty)
+{
+  uint64_t key = page_key(file_desc, page_num);
+  std::lock_guard<std::mutex> lock(mutex_);
+  PageTablePartition &part = partition(key);
+  Frame *buf = nullptr;
+  {
+    // 与take_frame相同，pin只需要分区锁，必须在分区锁内确认没有被pin住之后再从页表中删除
+    std::lock_guard<std::mutex> part_lock(part.mutex);
+    auto iter = part.table.find(key);
+    if (iter == part.table.end()) {
       return RC::SUCCESS;
     }
+    buf = iter->second;
+    if (buf->pin_count != 0 || (!discard_dirty && buf->dirty)) {
+      return RC::BUFFERPOOL_PAGE_PINNED;
+    }
+    part.table.erase(iter);
+  }
+  recycle(buf);
+  return RC::SUCCESS;
+}
+
+/**
+ * 把已经从页表中删除的帧放回空闲链表，调用者需要持有mutex_
+ */
+void BPManager::recycle(Frame *buf)
+{
+  int pos = buf - frame;
+  {
+    std::lock_guard<std::mutex> replacer_lock(replacer_mutex_);
+    replacer_->remove(pos);
+  }
+  allocated[pos] = false;
+  clear_dirty(buf);
+  if (buf->prefetched.exchange(false)) {
+    prefetch_wasted_count_++;
   }
+  buf->file_desc = -1;
+  free_list_.push_back(buf);
+}
 
-  // Allocate one page and load the data into this page
-  if ((tmp = allocate_block(&(page_handle->frame))) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to alloc page.", file_handle->file_name, page_num);
-    return tmp;
+std::vector<Frame *> BPManager::find_list(int file_desc)
+{
+  std::vector<Frame *> frames;
+  for (PageTablePartition &part : partitions_) {
+    std::lock_guard<std::mutex> part_lock(part.mutex);
+    for (auto &item : part.table) {
+      if (item.second->file_desc == file_desc) {
+        frames.push_back(item.second);
+      }
+    }
   }
-  page_handle->frame->dirty = false;
-  page_handle->frame->file_desc = file_handle->file_desc;
-  page_handle->frame->pin_count = 1;
-  page_handle->frame->acc_time = current_time();
-  if ((tmp = load_page(page_num, file_handle, page_handle->frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %s:%d", file_handle->file_name, page_num);
-    page_handle->frame->pin_count = 0;
-    dispose_block(page_handle->frame);
-    return tmp;
+  return frames;
+}
+
+std::vector<uint64_t> BPManager::resident_list()
+{
+  std::vector<uint64_t> keys;
+  for (PageTablePartition &part : partitions_) {
+    std::lock_guard<std::mutex> part_lock(part.mutex);
+    for (auto &item : part.table) {
+      keys.push_back(item.first);
+    }
+  }
+  return keys;
+}
+
+/**
+ * 总内存为frame_num个BP_PAGE_SIZE，默认页面大小分到(100 - BP_OTHER_PAGE_SIZE_PERCENT)%，
+ * 其它页面大小平分剩下的部分，所有页面大小加起来不超过总内存。
+ * 文件头页常驻缓冲区，每种页面大小至少留BP_MIN_FRAME_NUM帧，很小的缓冲池会因此略微超出
+ */
+static int size_class_frame_num(int frame_num, int default_page_size, int page_size)
+{
+  int64_t total = (int64_t)frame_num * BP_PAGE_SIZE;
+  int64_t others = total * BP_OTHER_PAGE_SIZE_PERCENT / 100;
+  int64_t bytes = page_size == default_page_size ? total - others : others / (BP_PAGE_SIZE_CLASS_NUM - 1);
+  int64_t num = bytes / page_size;
+  return num > BP_MIN_FRAME_NUM ? (int)num : BP_MIN_FRAME_NUM;
+}
+
+DiskBufferPool::DiskBufferPool(int frame_num, BPReplacePolicy policy, int io_threads, int default_page_size)
+    : bp_manager_(size_class_frame_num(frame_num, default_page_size, BP_PAGE_SIZE), policy),
+      page_io_(PageIO::create(io_threads)),
+      frame_num_(frame_num),
+      policy_(policy),
+      default_page_size_(is_valid_page_size(default_page_size) ? default_page_size : BP_PAGE_SIZE)
+{
+  bp_manager_.set_flusher([this](Frame *frame) { return flush_block(frame); });
+  bp_managers_[0] = &bp_manager_;
+  for (int i = 1; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+    bp_managers_[i] = nullptr;
+  }
+  LOG_INFO("Disk buffer pool uses %s page io", page_io_->name());
+}
+
+DiskBufferPool::~DiskBufferPool()
+{
+  stop_page_list_dumper();
+  stop_flusher();
+  delete page_io_;
+  for (int i = 1; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+    delete bp_managers_[i].load();
+  }
+  for (Frame *frame : copy_frames_) {
+    pthread_rwlock_destroy(&frame->latch);
+    ::free(frame->page);
+    delete frame;
+  }
+}
+
+bool DiskBufferPool::is_valid_page_size(int page_size)
+{
+  for (int i = 0; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+    if (page_size == (BP_PAGE_SIZE << i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+RC DiskBufferPool::set_default_page_size(int page_size)
+{
+  if (!is_valid_page_size(page_size)) {
+    LOG_ERROR("Invalid page size %d", page_size);
+    return RC::INVALID_ARGUMENT;
+  }
+  default_page_size_ = page_size;
+  return RC::SUCCESS;
+}
+
+/**
+ * 每种页面大小一个BPManager。BP_PAGE_SIZE的在构造时创建，
+ * 其它大小的在第一次打开这种页面大小的文件时创建，内存按size_class_frame_num划分
+ */
+BPManager *DiskBufferPool::get_bp_manager(int page_size)
+{
+  int index = 0;
+  while (index < BP_PAGE_SIZE_CLASS_NUM && (BP_PAGE_SIZE << index) != page_size) {
+    index++;
+  }
+  if (index >= BP_PAGE_SIZE_CLASS_NUM) {
+    return nullptr;
+  }
+
+  BPManager *bp_manager = bp_managers_[index];
+  if (bp_manager != nullptr) {
+    return bp_manager;
+  }
+
+  std::lock_guard<std::mutex> lock(managers_mutex_);
+  bp_manager = bp_managers_[index];
+  if (bp_manager == nullptr) {
+    bp_manager = new BPManager(size_class_frame_num(frame_num_, default_page_size_, page_size), policy_, page_size);
+    bp_manager->set_flusher([this](Frame *frame) { return flush_block(frame); });
+    bp_managers_[index] = bp_manager;
+    LOG_INFO("Create buffer pool of %d frames for %d bytes pages", bp_manager->size, page_size);
+  }
+  return bp_manager;
+}
+
+std::vector<const BPManager *> DiskBufferPool::bp_managers() const
+{
+  std::vector<const BPManager *> bp_managers;
+  for (int i = 0; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+    const BPManager *bp_manager = bp_managers_[i];
+    if (bp_manager != nullptr) {
+      bp_managers.push_back(bp_manager);
+    }
+  }
+  return bp_managers;
+}
+
+BPManager &DiskBufferPool::manager_of(Frame *frame)
+{
+  for (int i = 1; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+    BPManager *bp_manager = bp_managers_[i];
+    if (bp_manager != nullptr && bp_manager->owns(frame)) {
+      return *bp_manager;
+    }
+  }
+  return bp_manager_;
+}
+
+RC DiskBufferPool::create_file(const char *file_name, int page_size, PageCompression compression)
+{
+  if (page_size == 0) {
+    page_size = default_page_size_;
+  }
+  if (!is_valid_page_size(page_size)) {
+    LOG_ERROR("Failed to create %s, due to invalid page size %d.", file_name, page_size);
+    return RC::INVALID_ARGUMENT;
+  }
+  if (!page_compression_supported(compression)) {
+    LOG_ERROR("Failed to create %s, compression %s is not supported by this build.",
+        file_name, page_compression_name(compression));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
+  if (fd < 0) {
+    LOG_ERROR("Failed to create %s, due to %s.", file_name, strerror(errno));
+    return RC::SCHEMA_DB_EXIST;
+  }
+
+  close(fd);
+
+  /**
+   * Here don't care about the failure
+   */
+  fd = open(file_name, O_RDWR);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open for readwrite %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  std::vector<char> buffer(page_size, 0);
+  Page *page = (Page *)buffer.data();
+
+  BPFileSubHeader *fileSubHeader;
+  fileSubHeader = (BPFileSubHeader *)page->data;
+  fileSubHeader->magic = BP_FILE_MAGIC;
+  fileSubHeader->format_version = BP_FILE_FORMAT_VERSION;
+  fileSubHeader->allocated_pages = 1;
+  fileSubHeader->page_count = 1;
+  fileSubHeader->page_size = page_size;
+
+  char *bitmap = page->data + (int)BP_FILE_SUB_HDR_SIZE;
+  bitmap[0] |= 0x01;
+  set_page_checksum(page, page_size);
+  if (lseek(fd, 0, SEEK_SET) == -1) {
+    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
+    close(fd);
+    return RC::IOERR_SEEK;
+  }
+
+  if (write(fd, buffer.data(), page_size) != page_size) {
+    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
+    close(fd);
+    return RC::IOERR_WRITE;
+  }
+
+  close(fd);
+
+  // 有没有页面映射决定了文件是否压缩，新建的文件不能沿用之前残留的映射
+  if (compression != PageCompression::NONE) {
+    RC rc = PageMap::create(file_name, compression, page_size);
+    if (rc != RC::SUCCESS) {
+      unlink(file_name);
+      return rc;
+    }
+  } else if (PageMap::exists(file_name)) {
+    unlink(PageMap::map_file_name(file_name).c_str());
+  }
+  LOG_INFO("Successfully create %s. compression=%s", file_name, page_compression_name(compression));
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::remove_file(const char *file_name)
+{
+  if (PageMap::exists(file_name) && unlink(PageMap::map_file_name(file_name).c_str()) != 0) {
+    LOG_ERROR("Failed to remove page map of %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_DELETE;
+  }
+  if (unlink(file_name) != 0) {
+    LOG_ERROR("Failed to remove %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_DELETE;
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::open_file(const char *file_name, int *file_id)
+{
+  std::lock_guard<std::mutex> lock(open_list_mutex_);
+  int fd, i;
+  // This part isn't gentle, the better method is using LRU queue.
+  for (i = 0; i < MAX_OPEN_FILE; i++) {
+    if (open_list_[i]) {
+      if (!strcmp(open_list_[i]->file_name, file_name)) {
+        *file_id = i;
+        LOG_INFO("%s has already been opened.", file_name);
+        return RC::SUCCESS;
+      }
+    }
+  }
+  i = 0;
+  while (i < MAX_OPEN_FILE && open_list_[i++])
+    ;
+  if (i >= MAX_OPEN_FILE && open_list_[i - 1]) {
+    LOG_ERROR("Failed to open file %s, because too much files has been opened.", file_name);
+    return RC::BUFFERPOOL_OPEN_TOO_MANY_FILES;
+  }
+
+  bool direct_io = direct_io_;
+  fd = open(file_name, direct_io ? (O_RDWR | O_DIRECT) : O_RDWR);
+  if (fd < 0 && direct_io && errno == EINVAL) {
+    LOG_WARN("File system of %s does not support O_DIRECT, use buffered io instead.", file_name);
+    direct_io = false;
+    fd = open(file_name, O_RDWR);
+  }
+  if (fd >= 0 && direct_io && PageMap::exists(file_name)) {
+    // 压缩的页面长度不是块大小的整数倍
+    close(fd);
+    direct_io = false;
+    fd = open(file_name, O_RDWR);
+  }
+  if (fd < 0) {
+    LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+  LOG_INFO("Successfully open file %s. direct io=%d", file_name, direct_io);
+
+  BPFileHandle *file_handle = new (std::nothrow) BPFileHandle();
+  if (file_handle == nullptr) {
+    LOG_ERROR("Failed to alloc memory of BPFileHandle for %s.", file_name);
+    close(fd);
+    return RC::NOMEM;
+  }
+
+  RC tmp;
+  file_handle->bopen = true;
+  int file_name_len = strlen(file_name) + 1;
+  char *cloned_file_name = new char[file_name_len];
+  snprintf(cloned_file_name, file_name_len, "%s", file_name);
+  cloned_file_name[file_name_len - 1] = '\0';
+  file_handle->file_name = cloned_file_name;
+  file_handle->file_desc = fd;
+  file_handle->direct_io = direct_io;
+  tmp = read_file_header(fd, file_name, &file_handle->page_size);
+  if (tmp == RC::SUCCESS && PageMap::exists(file_name)) {
+    file_handle->page_map = new PageMap();
+    tmp = file_handle->page_map->open(file_name, fd);
+    if (tmp == RC::SUCCESS) {
+      std::lock_guard<std::mutex> page_maps_lock(page_maps_mutex_);
+      page_maps_[fd] = file_handle->page_map;
+    }
+  }
+  if (tmp == RC::SUCCESS) {
+    file_handle->bp_manager = get_bp_manager(file_handle->page_size);
+    tmp = allocate_block(*file_handle->bp_manager,
+        fd,
+        0,
+        [this, file_handle](Frame *frame) { return load_page(0, file_handle, frame); },
+        &file_handle->hdr_frame);
+  }
+  if (tmp != RC::SUCCESS) {
+    LOG_ERROR("Failed to load header page of %s.", file_name);
+    if (file_handle->page_map != nullptr) {
+      std::lock_guard<std::mutex> page_maps_lock(page_maps_mutex_);
+      page_maps_.erase(fd);
+      delete file_handle->page_map;
+    }
+    close(fd);
+    delete file_handle;
+    return tmp;
+  }
+
+  file_handle->hdr_page = file_handle->hdr_frame->page;
+  file_handle->bitmap = file_handle->hdr_page->data + BP_FILE_SUB_HDR_SIZE;
+  file_handle->file_sub_header = (BPFileSubHeader *)file_handle->hdr_page->data;
+  file_handle->group_pages = BP_GROUP_PAGES_OF(file_handle->page_size);
+  if (mmap_read_ && file_handle->page_map == nullptr) {
+    map_file(file_handle);
+  }
+  open_list_[i - 1] = file_handle;
+  *file_id = i - 1;
+  LOG_INFO("Successfully open %s. file_id=%d, hdr_frame=%p", file_name, *file_id, file_handle->hdr_frame);
+  return RC::SUCCESS;
+}
+
+/**
+ * 检查文件格式并读出页面大小，文件头所在页的前BP_PAGE_SIZE个字节一定存在
+ */
+RC DiskBufferPool::read_file_header(int fd, const char *file_name, int *page_size)
+{
+  void *buffer = nullptr;
+  if (posix_memalign(&buffer, BP_PAGE_SIZE, BP_PAGE_SIZE) != 0) {
+    return RC::NOMEM;
+  }
+
+  RC rc = page_io_->read(fd, 0, buffer, BP_PAGE_SIZE);
+  if (rc == RC::SUCCESS) {
+    const BPFileSubHeader *sub_header = (BPFileSubHeader *)((Page *)buffer)->data;
+    *page_size = sub_header->page_size;
+    if (sub_header->magic != BP_FILE_MAGIC || sub_header->format_version != BP_FILE_FORMAT_VERSION) {
+      LOG_ERROR("Unsupported file format of %s. magic=%x, version=%u, expect magic=%x, version=%u",
+          file_name, sub_header->magic, sub_header->format_version, BP_FILE_MAGIC, BP_FILE_FORMAT_VERSION);
+      rc = RC::BUFFERPOOL_FILEERR;
+    } else if (!is_valid_page_size(*page_size)) {
+      LOG_ERROR("Invalid page size %d in file header of %s", *page_size, file_name);
+      rc = RC::BUFFERPOOL_PAGE_CORRUPTED;
+    }
+  }
+  ::free(buffer);
+  return rc;
+}
+
+/**
+ * 映射长度是当前文件大小的两倍，并且不小于MMAP_MIN_SIZE。
+ * 只会访问文件中已经存在的页面，所以映射超出文件末尾的部分是安全的
+ */
+void DiskBufferPool::map_file(BPFileHandle *file_handle)
+{
+  struct stat st;
+  if (fstat(file_handle->file_desc, &st) < 0) {
+    LOG_WARN("Failed to stat %s, read pages through buffer pool. error=%s", file_handle->file_name, strerror(errno));
+    return;
+  }
+
+  size_t mmap_size = std::max((size_t)st.st_size * 2, MMAP_MIN_SIZE);
+  void *addr = mmap(nullptr, mmap_size, PROT_READ, MAP_SHARED, file_handle->file_desc, 0);
+  if (addr == MAP_FAILED) {
+    LOG_WARN("Failed to mmap %s, read pages through buffer pool. error=%s", file_handle->file_name, strerror(errno));
+    return;
+  }
+  file_handle->mmap_addr = (char *)addr;
+  file_handle->mmap_size = mmap_size;
+  file_handle->mmap_seqs = new MmapPageSeqs;
+  std::lock_guard<std::mutex> lock(mmap_seqs_mutex_);
+  mmap_seqs_[file_handle->file_desc] = file_handle->mmap_seqs;
+  LOG_INFO("Successfully mmap %s. size=%lu", file_handle->file_name, (unsigned long)mmap_size);
+}
+
+void DiskBufferPool::unmap_file(BPFileHandle *file_handle)
+{
+  if (file_handle->mmap_addr == nullptr) {
+    return;
+  }
+  if (munmap(file_handle->mmap_addr, file_handle->mmap_size) < 0) {
+    LOG_WARN("Failed to munmap %s. error=%s", file_handle->file_name, strerror(errno));
+  }
+  file_handle->mmap_addr = nullptr;
+  file_handle->mmap_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(mmap_seqs_mutex_);
+    mmap_seqs_.erase(file_handle->file_desc);
+  }
+  delete file_handle->mmap_seqs;
+  file_handle->mmap_seqs = nullptr;
+}
+
+RC DiskBufferPool::close_file(int file_id)
+{
+  std::lock_guard<std::mutex> lock(open_list_mutex_);
+  RC tmp;
+  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to close file, due to invalid fileId %d", file_id);
+    return tmp;
+  }
+
+  BPFileHandle *file_handle = open_list_[file_id];
+  wait_prefetch(file_handle);
+  file_handle->hdr_frame->pin_count--;
+  if ((tmp = force_all_pages(file_handle)) != RC::SUCCESS) {
+    file_handle->hdr_frame->pin_count++;
+    LOG_ERROR("Failed to closeFile %d:%s, due to failed to force all pages.", file_id, file_handle->file_name);
+    return tmp;
+  }
+
+  unmap_file(file_handle);
+  if (file_handle->page_map != nullptr) {
+    std::lock_guard<std::mutex> page_maps_lock(page_maps_mutex_);
+    page_maps_.erase(file_handle->file_desc);
+    delete file_handle->page_map;
+    file_handle->page_map = nullptr;
+  }
+  if (close(file_handle->file_desc) < 0) {
+    LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_id, file_handle->file_name, strerror(errno));
+    return RC::IOERR_CLOSE;
+  }
+  open_list_[file_id] = nullptr;
+  LOG_INFO("Successfully close file %d:%s.", file_id, file_handle->file_name);
+  delete (file_handle);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle)
+{
+  RC tmp;
+  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %d, due to invalid fileId %d", page_num, file_id);
+    return tmp;
+  }
+
+  BPFileHandle *file_handle = open_list_[file_id];
+  if ((tmp = check_page_num(page_num, file_handle)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d, due to invalid pageNum.", file_handle->file_name, page_num);
+    return tmp;
+  }
+
+  // This page has been loaded.
+  file_handle->bp_manager->wait_prefetch(file_handle->file_desc, page_num);
+  Frame *frame = file_handle->bp_manager->pin(file_handle->file_desc, page_num);
+  if (frame != nullptr) {
+    page_handle->frame = frame;
+    page_handle->open = true;
+    read_ahead(file_handle, page_num);
+    return RC::SUCCESS;
+  }
+
+  // Allocate one page and load the data into this page
+  tmp = allocate_block(*file_handle->bp_manager,
+      file_handle->file_desc,
+      page_num,
+      [this, file_handle, page_num](Frame *frame) { return load_page(page_num, file_handle, frame); },
+      &(page_handle->frame));
+  if (tmp != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d", file_handle->file_name, page_num);
+    return tmp;
+  }
+
+  page_handle->open = true;
+  read_ahead(file_handle, page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::get_readonly_page(int file_id, PageNum page_num, BPPageHandle *page_handle)
+{
+  RC rc = check_file_id(file_id);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %d, due to invalid fileId %d", page_num, file_id);
+    return rc;
+  }
+
+  BPFileHandle *file_handle = open_list_[file_id];
+  const size_t offset = (size_t)page_num * file_handle->page_size;
+  if (file_handle->mmap_addr == nullptr || page_num < 0 || offset + file_handle->page_size > file_handle->mmap_size) {
+    return get_this_page(file_id, page_num, page_handle);
+  }
+  if ((rc = check_page_num(page_num, file_handle)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d, due to invalid pageNum.", file_handle->file_name, page_num);
+    return rc;
+  }
+
+  // 缓冲区中的页面可能还有没有刷盘的修改
+  file_handle->bp_manager->wait_prefetch(file_handle->file_desc, page_num);
+  Frame *frame = file_handle->bp_manager->pin(file_handle->file_desc, page_num, false);
+  bool mapped = frame == nullptr;
+  if (mapped) {
+    // 页面随时可能被刷盘的线程写回文件，复制到私有的帧中，复制前后版本号不同说明可能读到了一半的写入
+    MmapPageSeqs *seqs = file_handle->mmap_seqs;
+    uint32_t version = 0;
+    if (!seqs->begin_read(page_num, &version)) {
+      mmap_read_conflict_count_++;
+      return get_this_page(file_id, page_num, page_handle);
+    }
+    frame = take_copy_frame();
+    if (frame == nullptr) {
+      return get_this_page(file_id, page_num, page_handle);
+    }
+    frame->file_desc = file_handle->file_desc;
+    memcpy(frame->page, file_handle->mmap_addr + offset, file_handle->page_size);
+    if (!seqs->end_read(page_num, version)) {
+      mmap_read_conflict_count_++;
+      return_copy_frame(frame);
+      return get_this_page(file_id, page_num, page_handle);
+    }
+    if (!seqs->is_verified(page_num, version)) {
+      if (!verify_page(frame->page, page_num, file_handle->page_size)) {
+        checksum_failure_count_++;
+        LOG_ERROR("Checksum mismatch of mapped page %s:%d", file_handle->file_name, page_num);
+        return_copy_frame(frame);
+        return RC::BUFFERPOOL_PAGE_CORRUPTED;
+      }
+      seqs->set_verified(page_num, version);
+    }
+    mmap_read_count_++;
+  }
+
+  page_handle->frame = frame;
+  page_handle->mapped = mapped;
+  page_handle->open = true;
+  read_ahead(file_handle, page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::allocate_page(int file_id, BPPageHandle *page_handle)
+{
+  RC tmp;
+  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
+    return tmp;
+  }
+
+  BPFileHandle *file_handle = open_list_[file_id];
+  std::unique_lock<std::mutex> file_lock(file_handle->mutex);
+
+  if ((file_handle->file_sub_header->allocated_pages) < (file_handle->file_sub_header->page_count)) {
+    // There is one free page
+    PageNum page_num = BP_INVALID_PAGE_NUM;
+    tmp = find_free_page(file_handle, &page_num);
+    if (tmp == RC::SUCCESS) {
+      if ((tmp = set_page_allocated(file_handle, page_num, true)) != RC::SUCCESS) {
+        return tmp;
+      }
+      pthread_rwlock_wrlock(&file_handle->hdr_frame->latch);
+      (file_handle->file_sub_header->allocated_pages)++;
+      file_handle->bp_manager->mark_dirty(file_handle->hdr_frame);
+      pthread_rwlock_unlock(&file_handle->hdr_frame->latch);
+      file_lock.unlock();
+      return get_this_page(file_id, page_num, page_handle);
+    }
+    if (tmp != RC::BUFFERPOOL_EOF) {
+      LOG_ERROR("Failed to find free page of %s. rc=%d:%s", file_handle->file_name, tmp, strrc(tmp));
+      return tmp;
+    }
+  }
+
+  PageNum page_num = file_handle->file_sub_header->page_count;
+  if (is_bitmap_page(file_handle, page_num)) {
+    // 文件增长到了新的一组，先追加这一组的位图页
+    if ((tmp = append_bitmap_page(file_handle, page_num)) != RC::SUCCESS) {
+      return tmp;
+    }
+    page_num++;
+  }
+
+  int page_size = file_handle->page_size;
+  tmp = allocate_block(*file_handle->bp_manager,
+      file_handle->file_desc,
+      page_num,
+      [page_num, page_size](Frame *frame) {
+        memset(frame->page, 0, page_size);
+        frame->page->page_num = page_num;
+        return RC::SUCCESS;
+      },
+      &(page_handle->frame));
+  if (tmp != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate page %s, due to no free page.", file_handle->file_name);
+    return tmp;
+  }
+
+  // Use flush operation to extion file
+  manager_of(page_handle->frame).mark_dirty(page_handle->frame);
+  if ((tmp = flush_block(page_handle->frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to alloc page %s , due to failed to extend one page.", file_handle->file_name);
+    page_handle->frame->pin_count--;
+    dispose_block(page_handle->frame);
+    return tmp;
+  }
+
+  if ((tmp = set_page_allocated(file_handle, page_num, true)) != RC::SUCCESS) {
+    page_handle->frame->pin_count--;
+    return tmp;
+  }
+
+  pthread_rwlock_wrlock(&file_handle->hdr_frame->latch);
+  file_handle->file_sub_header->allocated_pages++;
+  file_handle->file_sub_header->page_count++;
+  file_handle->bp_manager->mark_dirty(file_handle->hdr_frame);
+  pthread_rwlock_unlock(&file_handle->hdr_frame->latch);
+  file_handle->free_page_hint = page_num + 1;
+
+  page_handle->open = true;
+  return RC::SUCCESS;
+}
+
+bool DiskBufferPool::is_bitmap_page(BPFileHandle *file_handle, PageNum page_num) const
+{
+  return page_num != 0 && page_num % file_handle->group_pages == 0;
+}
+
+/**
+ * pin住第group组的位图所在的帧，用完之后调用者负责unpin
+ */
+RC DiskBufferPool::get_bitmap_frame(BPFileHandle *file_handle, int group, Frame **frame)
+{
+  if (group == 0) {
+    file_handle->hdr_frame->pin_count++;
+    *frame = file_handle->hdr_frame;
+    return RC::SUCCESS;
+  }
+
+  PageNum page_num = (PageNum)group * file_handle->group_pages;
+  *frame = file_handle->bp_manager->pin(file_handle->file_desc, page_num);
+  if (*frame != nullptr) {
+    return RC::SUCCESS;
+  }
+  return allocate_block(*file_handle->bp_manager,
+      file_handle->file_desc,
+      page_num,
+      [this, file_handle, page_num](Frame *frame) { return load_page(page_num, file_handle, frame); },
+      frame);
+}
+
+static char *group_bitmap(BPFileHandle *file_handle, Frame *frame)
+{
+  return frame == file_handle->hdr_frame ? file_handle->bitmap : frame->page->data;
+}
+
+bool DiskBufferPool::is_page_allocated(BPFileHandle *file_handle, PageNum page_num)
+{
+  int group = page_num / file_handle->group_pages;
+  int index = page_num % file_handle->group_pages;
+  if (group == 0) {
+    return (file_handle->bitmap[index / 8] & (1 << (index % 8))) != 0;
+  }
+
+  Frame *frame = nullptr;
+  if (get_bitmap_frame(file_handle, group, &frame) != RC::SUCCESS) {
+    return false;
+  }
+  pthread_rwlock_rdlock(&frame->latch);
+  bool allocated = common::Bitmap(group_bitmap(file_handle, frame), file_handle->group_pages).get_bit(index);
+  pthread_rwlock_unlock(&frame->latch);
+  frame->pin_count--;
+  return allocated;
+}
+
+RC DiskBufferPool::set_page_allocated(BPFileHandle *file_handle, PageNum page_num, bool allocated)
+{
+  Frame *frame = nullptr;
+  RC rc = get_bitmap_frame(file_handle, page_num / file_handle->group_pages, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to load bitmap of %s:%d. rc=%d:%s", file_handle->file_name, page_num, rc, strrc(rc));
+    return rc;
+  }
+
+  pthread_rwlock_wrlock(&frame->latch);
+  common::Bitmap bitmap(group_bitmap(file_handle, frame), file_handle->group_pages);
+  if (allocated) {
+    bitmap.set_bit(page_num % file_handle->group_pages);
+  } else {
+    bitmap.clear_bit(page_num % file_handle->group_pages);
+  }
+  file_handle->bp_manager->mark_dirty(frame);
+  pthread_rwlock_unlock(&frame->latch);
+  frame->pin_count--;
+  return RC::SUCCESS;
+}
+
+/**
+ * 从free_page_hint开始逐组查找空闲页面，找到之后把hint移到它后面，
+ * 所以连续分配时每次只需要检查很少的几个字节。需要持有file_handle->mutex
+ */
+RC DiskBufferPool::find_free_page(BPFileHandle *file_handle, PageNum *page_num)
+{
+  const int group_pages = file_handle->group_pages;
+  const PageNum page_count = file_handle->file_sub_header->page_count;
+  PageNum start = file_handle->free_page_hint;
+  while (start < page_count) {
+    int group = start / group_pages;
+    Frame *frame = nullptr;
+    RC rc = get_bitmap_frame(file_handle, group, &frame);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    PageNum group_start = (PageNum)group * group_pages;
+    pthread_rwlock_rdlock(&frame->latch);
+    common::Bitmap bitmap(group_bitmap(file_handle, frame), std::min(group_pages, page_count - group_start));
+    int index = bitmap.next_unsetted_bit(start - group_start);
+    pthread_rwlock_unlock(&frame->latch);
+    frame->pin_count--;
+
+    if (index >= 0) {
+      *page_num = group_start + index;
+      file_handle->free_page_hint = *page_num + 1;
+      return RC::SUCCESS;
+    }
+    start = group_start + group_pages;
+  }
+
+  file_handle->free_page_hint = page_count;
+  return RC::BUFFERPOOL_EOF;
+}
+
+/**
+ * 在文件末尾追加一个位图页，位图中只有它自己被标记为已分配。需要持有file_handle->mutex
+ */
+RC DiskBufferPool::append_bitmap_page(BPFileHandle *file_handle, PageNum page_num)
+{
+  int page_size = file_handle->page_size;
+  Frame *frame = nullptr;
+  RC rc = allocate_block(*file_handle->bp_manager,
+      file_handle->file_desc,
+      page_num,
+      [page_num, page_size](Frame *frame) {
+        memset(frame->page, 0, page_size);
+        frame->page->page_num = page_num;
+        frame->page->data[0] |= 0x01;
+        return RC::SUCCESS;
+      },
+      &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate bitmap page %s:%d.", file_handle->file_name, page_num);
+    return rc;
+  }
+
+  file_handle->bp_manager->mark_dirty(frame);
+  rc = flush_block(frame);
+  frame->pin_count--;
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to extend %s with bitmap page %d.", file_handle->file_name, page_num);
+    dispose_block(frame);
+    return rc;
+  }
+
+  pthread_rwlock_wrlock(&file_handle->hdr_frame->latch);
+  file_handle->file_sub_header->allocated_pages++;
+  file_handle->file_sub_header->page_count++;
+  file_handle->bp_manager->mark_dirty(file_handle->hdr_frame);
+  pthread_rwlock_unlock(&file_handle->hdr_frame->latch);
+  LOG_INFO("Append bitmap page %s:%d", file_handle->file_name, page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::get_page_num(BPPageHandle *page_handle, PageNum *page_num)
+{
+  if (!page_handle->open)
+    return RC::BUFFERPOOL_CLOSED;
+  *page_num = page_handle->frame->page->page_num;
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::get_data(BPPageHandle *page_handle, char **data)
+{
+  if (!page_handle->open)
+    return RC::BUFFERPOOL_CLOSED;
+  *data = page_handle->frame->page->data;
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::mark_dirty(BPPageHandle *page_handle)
+{
+  if (page_handle->mapped) {
+    LOG_ERROR("Failed to mark dirty page %d, which is mapped read only.", page_handle->frame->page->page_num);
+    return RC::READONLY;
+  }
+  manager_of(page_handle->frame).mark_dirty(page_handle->frame);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::unpin_page(BPPageHandle *page_handle)
+{
+  page_handle->open = false;
+  if (page_handle->mapped) {
+    return_copy_frame(page_handle->frame);
+    page_handle->frame = nullptr;
+    page_handle->mapped = false;
+    return RC::SUCCESS;
+  }
+  page_handle->frame->pin_count--;
+  return RC::SUCCESS;
+}
+
+/**
+ * dispose_page will delete the data of the page of pageNum
+ * force_page will flush the page of pageNum
+ * @param fileID
+ * @param pageNum
+ * @return
+ */
+RC DiskBufferPool::dispose_page(int file_id, PageNum page_num)
+{
+  RC rc;
+  if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
+    return rc;
+  }
+
+  BPFileHandle *file_handle = open_list_[file_id];
+  if ((rc = check_page_num(page_num, file_handle)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to dispose page %s:%d, due to invalid pageNum", file_handle->file_name, page_num);
+    return rc;
+  }
+
+  std::lock_guard<std::mutex> file_lock(file_handle->mutex);
+  if ((rc = file_handle->bp_manager->free_if_unpinned(file_handle->file_desc, page_num, true)) != RC::SUCCESS) {
+    return rc;
+  }
+
+  if ((rc = set_page_allocated(file_handle, page_num, false)) != RC::SUCCESS) {
+    return rc;
+  }
+  pthread_rwlock_wrlock(&file_handle->hdr_frame->latch);
+  file_handle->bp_manager->mark_dirty(file_handle->hdr_frame);
+  file_handle->file_sub_header->allocated_pages--;
+  // file_handle->pFileSubHeader->pageCount--;
+  pthread_rwlock_unlock(&file_handle->hdr_frame->latch);
+  file_handle->free_page_hint = std::min(file_handle->free_page_hint, page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::force_page(int file_id, PageNum page_num)
+{
+  RC rc;
+  if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
+    return rc;
+  }
+  BPFileHandle *file_handle = open_list_[file_id];
+  return force_page(file_handle, page_num);
+}
+/**
+ * dispose_page will delete the data of the page of pageNum
+ * force_page will flush the page of pageNum
+ * @param fileHandle
+ * @param pageNum
+ * @return
+ */
+RC DiskBufferPool::force_page(BPFileHandle *file_handle, PageNum page_num)
+{
+  if (page_num == -1) {
+    return force_all_pages(file_handle);
+  }
+
+  // 刷盘期间pin住，帧不会被淘汰或者释放
+  Frame *frame = file_handle->bp_manager->pin(file_handle->file_desc, page_num, false);
+  if (frame == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (frame->pin_count > 1) {
+    rc = RC::BUFFERPOOL_PAGE_PINNED;
+  } else if (frame->dirty && (rc = flush_block(frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush page:%s:%d.", file_handle->file_name, page_num);
+  }
+  frame->pin_count--;
+  if (rc == RC::SUCCESS) {
+    // 刷盘之后又被其它线程pin住或者修改过时不能释放
+    rc = file_handle->bp_manager->free_if_unpinned(file_handle->file_desc, page_num, false);
+  }
+  if (rc == RC::BUFFERPOOL_PAGE_PINNED) {
+    LOG_ERROR("Page :%s:%d has been pinned.", file_handle->file_name, page_num);
+  }
+  return rc;
+}
+
+RC DiskBufferPool::flush_all_pages(int file_id)
+{
+  RC rc = check_file_id(file_id);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush pages due to invalid file_id %d", file_id);
+    return rc;
+  }
+
+  // 文件仍然打开，只刷脏页，不能释放文件头等被pin住的帧
+  BPFileHandle *file_handle = open_list_[file_id];
+  std::vector<Frame *> frames = file_handle->bp_manager->find_list(file_handle->file_desc);
+  for (Frame *frame : frames) {
+    if (frame->dirty && (rc = flush_block(frame)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush all pages' of %s.", file_handle->file_name);
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::flush_all_files()
+{
+  RC rc = RC::SUCCESS;
+  std::lock_guard<std::mutex> lock(open_list_mutex_);
+  for (int i = 0; i < MAX_OPEN_FILE; i++) {
+    if (open_list_[i] != nullptr) {
+      RC tmp = flush_all_pages(i);
+      if (tmp != RC::SUCCESS) {
+        rc = tmp;
+      }
+    }
+  }
+  return rc;
+}
+
+RC DiskBufferPool::force_all_pages(BPFileHandle *file_handle)
+{
+  std::vector<Frame *> frames = file_handle->bp_manager->find_list(file_handle->file_desc);
+  for (Frame *frame : frames) {
+    if (frame->dirty) {
+      RC rc = flush_block(frame);
+      if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to flush all pages' of %s.", file_handle->file_name);
+        return rc;
+      }
+    }
+    file_handle->bp_manager->free(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::flush_block(Frame *frame)
+{
+  // The better way is use mmap the block into memory,
+  // so it is easier to flush data to file.
+
+  // 先清除脏标记再复制，复制之后被修改的话会重新标记为脏页
+  BPManager &bp_manager = manager_of(frame);
+  const int page_size = bp_manager.page_size();
+  void *buffer = nullptr;
+  if (posix_memalign(&buffer, BP_PAGE_SIZE, page_size) != 0) {
+    return RC::NOMEM;
+  }
+  bp_manager.clear_dirty(frame);
+  pthread_rwlock_rdlock(&frame->latch);
+  Page *page = (Page *)buffer;
+  memcpy(page, frame->page, page_size);
+  pthread_rwlock_unlock(&frame->latch);
+  set_page_checksum(page, page_size);
+
+  s64_t offset = ((s64_t)page->page_num) * page_size;
+  RC rc = RC::SUCCESS;
+  PageMap *page_map = page->page_num == 0 ? nullptr : page_map_of(frame->file_desc);
+  if (page_map != nullptr) {
+    int stored_size = 0;
+    rc = page_map->write_page(page->page_num, (const char *)page, &stored_size);
+    if (rc == RC::SUCCESS) {
+      compress_raw_bytes_ += page_size;
+      compress_stored_bytes_ += stored_size;
+    }
+  } else {
+    MmapPageSeqs *seqs = mmap_seqs_of(frame->file_desc);
+    if (seqs != nullptr) {
+      seqs->begin_write(page->page_num);
+    }
+    rc = page_io_->write(frame->file_desc, offset, page, page_size);
+    if (seqs != nullptr) {
+      seqs->end_write(page->page_num);
+    }
+  }
+  ::free(buffer);
+  if (rc != RC::SUCCESS) {
+    bp_manager.mark_dirty(frame);
+    LOG_ERROR("Failed to flush page %lld of %d.", offset, frame->file_desc);
+    return rc;
+  }
+  LOG_DEBUG("Flush block. file desc=%d, page num=%d", frame->file_desc, frame->page->page_num);
+
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::allocate_block(BPManager &bp_manager, int file_desc, PageNum page_num,
+    const BPManager::FrameInitializer &init, Frame **buffer)
+{
+  RC rc = bp_manager.alloc(file_desc, page_num, init, buffer);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate block for %d:%d. rc=%d:%s", file_desc, page_num, rc, strrc(rc));
+    return rc;
+  }
+
+  LOG_DEBUG("Allocate block frame=%p", *buffer);
+  wakeup_flusher_if_needed(bp_manager);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::start_flusher(int interval_ms, int clean_percent)
+{
+  std::lock_guard<std::mutex> lock(flusher_mutex_);
+  if (flusher_running_) {
+    LOG_WARN("Disk buffer pool flusher has been started");
+    return RC::GENERIC_ERROR;
+  }
+  if (interval_ms <= 0 || clean_percent < 0 || clean_percent > 100) {
+    LOG_ERROR("Invalid flusher arguments. interval_ms=%d, clean_percent=%d", interval_ms, clean_percent);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  flush_interval_ms_ = interval_ms;
+  clean_percent_ = clean_percent;
+  flusher_running_ = true;
+  flusher_ = std::thread(&DiskBufferPool::flusher_loop, this);
+  LOG_INFO("Start disk buffer pool flusher. interval=%dms, clean percent=%d", interval_ms, clean_percent);
+  return RC::SUCCESS;
+}
+
+void DiskBufferPool::stop_flusher()
+{
+  {
+    std::lock_guard<std::mutex> lock(flusher_mutex_);
+    if (!flusher_running_) {
+      return;
+    }
+    flusher_running_ = false;
+  }
+  flusher_cond_.notify_one();
+  flusher_.join();
+}
+
+void DiskBufferPool::wakeup_flusher_if_needed(const BPManager &bp_manager)
+{
+  // 干净帧的比例低于目标时提前唤醒刷脏页线程，避免前台在淘汰时刷盘
+  if (clean_percent_ <= 0) {
+    return;
+  }
+  int dirty_limit = bp_manager.size * (100 - clean_percent_) / 100;
+  if (bp_manager.dirty_count() <= dirty_limit) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(flusher_mutex_);
+  if (flusher_running_ && !flusher_wakeup_) {
+    flusher_wakeup_ = true;
+    flusher_cond_.notify_one();
+  }
+}
+
+void DiskBufferPool::flusher_loop()
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(flusher_mutex_);
+      flusher_cond_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_), [this]() {
+        return !flusher_running_ || flusher_wakeup_;
+      });
+      if (!flusher_running_) {
+        break;
+      }
+      flusher_wakeup_ = false;
+    }
+
+    for (int i = 0; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+      BPManager *bp_manager = bp_managers_[i];
+      if (bp_manager == nullptr) {
+        continue;
+      }
+      RC rc = flush_dirty_pages(*bp_manager);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("Failed to flush dirty pages in background. rc=%d:%s", rc, strrc(rc));
+      }
+    }
+  }
+  LOG_INFO("Disk buffer pool flusher exit");
+}
+
+RC DiskBufferPool::dump_page_list(const char *path)
+{
+  std::vector<std::pair<std::string, PageNum>> pages;
+  {
+    std::lock_guard<std::mutex> lock(open_list_mutex_);
+    std::unordered_map<int, const char *> file_names;
+    for (BPFileHandle *file_handle : open_list_) {
+      if (file_handle != nullptr) {
+        file_names[file_handle->file_desc] = file_handle->file_name;
+      }
+    }
+    for (int i = 0; i < BP_PAGE_SIZE_CLASS_NUM; i++) {
+      BPManager *bp_manager = bp_managers_[i];
+      if (bp_manager == nullptr) {
+        continue;
+      }
+      for (uint64_t key : bp_manager->resident_list()) {
+        auto iter = file_names.find(BPManager::key_file_desc(key));
+        PageNum page_num = BPManager::key_page_num(key);
+        // 文件头在打开文件时就会加载
+        if (iter != file_names.end() && page_num != 0) {
+          pages.emplace_back(iter->second, page_num);
+        }
+      }
+    }
+  }
+  std::sort(pages.begin(), pages.end());
+
+  // 先写临时文件再改名，进程中途退出也不会留下不完整的列表
+  std::string tmp_path = std::string(path) + ".tmp";
+  std::fstream fs;
+  fs.open(tmp_path, std::ios_base::out | std::ios_base::trunc);
+  if (!fs.is_open()) {
+    LOG_ERROR("Failed to open file for write. file name=%s, errmsg=%s", tmp_path.c_str(), strerror(errno));
+    return RC::IOERR;
+  }
+  for (const auto &page : pages) {
+    fs << page.second << ' ' << page.first << '\n';
   }
-
-  page_handle->open = true;
+  fs.close();
+  if (fs.fail() || rename(tmp_path.c_str(), path) < 0) {
+    LOG_ERROR("Failed to write page list %s. errmsg=%s", path, strerror(errno));
+    unlink(tmp_path.c_str());
+    return RC::IOERR_WRITE;
+  }
+  LOG_INFO("Dump %d pages of buffer pool to %s", (int)pages.size(), path);
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_page(int file_id, BPPageHandle *page_handle)
+RC DiskBufferPool::warm_up(const char *path)
 {
-  RC tmp;
-  if ((tmp = check_file_id(file_id)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
-    return tmp;
+  std::fstream fs;
+  fs.open(path, std::ios_base::in);
+  if (!fs.is_open()) {
+    LOG_INFO("No page list %s, skip warming up buffer pool", path);
+    return RC::SUCCESS;
   }
 
-  BPFileHandle *file_handle = open_list_[file_id];
+  std::map<std::string, std::vector<PageNum>> file_pages;
+  PageNum page_num = 0;
+  std::string file_name;
+  while (fs >> page_num && fs.get() == ' ' && std::getline(fs, file_name)) {
+    file_pages[file_name].push_back(page_num);
+  }
+  fs.close();
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<BPFileHandle *> file_handles;
+  std::unordered_map<BPManager *, int> loaded;  // 不超过每个BPManager的帧数，避免预热的页面互相淘汰
+  for (auto &item : file_pages) {
+    BPFileHandle *file_handle = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(open_list_mutex_);
+      for (BPFileHandle *opened : open_list_) {
+        if (opened != nullptr && item.first == opened->file_name) {
+          file_handle = opened;
+          break;
+        }
+      }
+    }
+    if (file_handle == nullptr) {
+      LOG_INFO("%s is not opened, skip warming up %d pages", item.first.c_str(), (int)item.second.size());
+      continue;
+    }
 
-  int byte = 0, bit = 0;
-  if ((file_handle->file_sub_header->allocated_pages) < (file_handle->file_sub_header->page_count)) {
-    // There is one free page
-    for (int i = 0; i < file_handle->file_sub_header->page_count; i++) {
-      byte = i / 8;
-      bit = i % 8;
-      if (((file_handle->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_handle->file_sub_header->allocated_pages)++;
-        file_handle->bitmap[byte] |= (1 << bit);
-        return get_this_page(file_id, i, page_handle);
+    std::vector<PageNum> &pages = item.second;
+    std::sort(pages.begin(), pages.end());
+    pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+    // 页号连续的页面合并成一次读，所有文件的读请求同时交给page io
+    int &count = loaded[file_handle->bp_manager];
+    size_t i = 0;
+    while (i < pages.size() && count < file_handle->bp_manager->size) {
+      size_t j = i + 1;
+      while (j < pages.size() && pages[j] == pages[j - 1] + 1 && j - i < FLUSH_BATCH_PAGES &&
+             count + (int)(j - i) < file_handle->bp_manager->size) {
+        j++;
       }
+      prefetch_pages(file_handle, pages[i], (int)(j - i));
+      count += (int)(j - i);
+      i = j;
     }
+    file_handles.push_back(file_handle);
   }
 
-  if ((tmp = allocate_block(&(page_handle->frame))) != RC::SUCCESS) {
-    LOG_ERROR("Failed to allocate page %s, due to no free page.", file_handle->file_name);
-    return tmp;
+  int page_count = 0;
+  for (auto &item : loaded) {
+    page_count += item.second;
   }
-
-  PageNum page_num = file_handle->file_sub_header->page_count;
-  file_handle->file_sub_header->allocated_pages++;
-  file_handle->file_sub_header->page_count++;
-
-  byte = page_num / 8;
-  bit = page_num % 8;
-  file_handle->bitmap[byte] |= (1 << bit);
-  file_handle->hdr_frame->dirty = true;
-
-  page_handle->frame->dirty = false;
-  page_handle->frame->file_desc = file_handle->file_desc;
-  page_handle->frame->pin_count = 1;
-  page_handle->frame->acc_time = current_time();
-  memset(&(page_handle->frame->page), 0, sizeof(Page));
-  page_handle->frame->page.page_num = file_handle->file_sub_header->page_count - 1;
-
-  // Use flush operation to extion file
-  if ((tmp = flush_block(page_handle->frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc page %s , due to failed to extend one page.", file_handle->file_name);
-    return tmp;
+  for (BPFileHandle *file_handle : file_handles) {
+    wait_prefetch(file_handle);
   }
-
-  page_handle->open = true;
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+  LOG_INFO("Warm up buffer pool with %d pages of %d files from %s in %lldms",
+      page_count, (int)file_handles.size(), path, (long long)elapsed.count());
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::get_page_num(BPPageHandle *page_handle, PageNum *page_num)
+RC DiskBufferPool::start_page_list_dumper(const char *path, int interval_s)
 {
-  if (!page_handle->open)
-    return RC::BUFFERPOOL_CLOSED;
-  *page_num = page_handle->frame->page.page_num;
-  return RC::SUCCESS;
-}
+  std::lock_guard<std::mutex> lock(dumper_mutex_);
+  if (dumper_running_) {
+    LOG_WARN("Disk buffer pool page list dumper has been started");
+    return RC::GENERIC_ERROR;
+  }
+  if (interval_s < 0) {
+    LOG_ERROR("Invalid page list dump interval %d", interval_s);
+    return RC::INVALID_ARGUMENT;
+  }
 
-RC DiskBufferPool::get_data(BPPageHandle *page_handle, char **data)
-{
-  if (!page_handle->open)
-    return RC::BUFFERPOOL_CLOSED;
-  *data = page_handle->frame->page.data;
+  dump_path_ = path;
+  dump_interval_s_ = interval_s;
+  dumper_running_ = true;
+  if (interval_s > 0) {
+    dumper_ = std::thread(&DiskBufferPool::dumper_loop, this);
+  }
+  LOG_INFO("Start disk buffer pool page list dumper. path=%s, interval=%ds", path, interval_s);
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::mark_dirty(BPPageHandle *page_handle)
+void DiskBufferPool::stop_page_list_dumper()
 {
-  page_handle->frame->dirty = true;
-  return RC::SUCCESS;
+  {
+    std::lock_guard<std::mutex> lock(dumper_mutex_);
+    if (!dumper_running_) {
+      return;
+    }
+    dumper_running_ = false;
+  }
+  dumper_cond_.notify_one();
+  if (dumper_.joinable()) {
+    dumper_.join();
+  }
+  dump_page_list(dump_path_.c_str());
 }
 
-RC DiskBufferPool::unpin_page(BPPageHandle *page_handle)
+void DiskBufferPool::dumper_loop()
 {
-  page_handle->open = false;
-  page_handle->frame->pin_count--;
-  return RC::SUCCESS;
+  std::unique_lock<std::mutex> lock(dumper_mutex_);
+  while (true) {
+    dumper_cond_.wait_for(
+        lock, std::chrono::seconds(dump_interval_s_), [this]() { return !dumper_running_; });
+    if (!dumper_running_) {
+      break;
+    }
+    lock.unlock();
+    dump_page_list(dump_path_.c_str());
+    lock.lock();
+  }
+  LOG_INFO("Disk buffer pool page list dumper exit");
 }
 
 /**
- * dispose_page will delete the data of the page of pageNum
- * force_page will flush the page of pageNum
- * @param fileID
- * @param pageNum
- * @return
+ * 按照(文件, 页号)的顺序刷脏页，页号连续的页面合并成一次写，
+ * 攒够FLUSH_INFLIGHT_BATCHES次写之后一起提交给page io
  */
-RC DiskBufferPool::dispose_page(int file_id, PageNum page_num)
+RC DiskBufferPool::flush_dirty_pages(BPManager &bp_manager)
 {
-  RC rc;
-  if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
-    return rc;
-  }
+  std::vector<uint64_t> keys = bp_manager.take_dirty_list();
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 
-  BPFileHandle *file_handle = open_list_[file_id];
-  if ((rc = check_page_num(page_num, file_handle)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to dispose page %s:%d, due to invalid pageNum", file_handle->file_name, page_num);
-    return rc;
-  }
+  RC rc = RC::SUCCESS;
+  std::vector<std::vector<Frame *>> batches;
+  for (uint64_t key : keys) {
+    Frame *frame = bp_manager.pin(BPManager::key_file_desc(key), BPManager::key_page_num(key), false);
+    if (frame == nullptr) {
+      continue;  // 已经被淘汰或者释放了
+    }
 
-  for (int i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (!bp_manager_.allocated[i])
+    // 不能阻塞等待写锁，否则可能与持有多个页面latch的线程死锁
+    if (pthread_rwlock_tryrdlock(&frame->latch) != 0) {
+      frame->pin_count--;
+      bp_manager.requeue_dirty(key);
+      continue;
+    }
+    if (!frame->dirty) {
+      pthread_rwlock_unlock(&frame->latch);
+      frame->pin_count--;
       continue;
-    if (bp_manager_.frame[i].file_desc != file_handle->file_desc) {
+    }
+    // 压缩的页面长度不定，不能合并写
+    if (page_map_of(frame->file_desc) != nullptr) {
+      pthread_rwlock_unlock(&frame->latch);
+      RC ret = flush_block(frame);
+      if (ret != RC::SUCCESS) {
+        rc = ret;
+      }
+      frame->pin_count--;
       continue;
     }
 
-    if (bp_manager_.frame[i].page.page_num == page_num) {
-      if (bp_manager_.frame[i].pin_count != 0)
-        return RC::BUFFERPOOL_PAGE_PINNED;
-      bp_manager_.allocated[i] = false;
+    if (!batches.empty()) {
+      Frame *last = batches.back().back();
+      if (batches.back().size() >= FLUSH_BATCH_PAGES || last->file_desc != frame->file_desc ||
+          last->page->page_num + 1 != frame->page->page_num) {
+        if (batches.size() >= FLUSH_INFLIGHT_BATCHES) {
+          RC ret = flush_batches(bp_manager, batches);
+          if (ret != RC::SUCCESS) {
+            rc = ret;
+          }
+        }
+        batches.emplace_back();
+      }
+    } else {
+      batches.emplace_back();
     }
+    batches.back().push_back(frame);
   }
 
-  file_handle->hdr_frame->dirty = true;
-  file_handle->file_sub_header->allocated_pages--;
-  // file_handle->pFileSubHeader->pageCount--;
-  char tmp = 1 << (page_num % 8);
-  file_handle->bitmap[page_num / 8] &= ~tmp;
-  return RC::SUCCESS;
-}
-
-RC DiskBufferPool::force_page(int file_id, PageNum page_num)
-{
-  RC rc;
-  if ((rc = check_file_id(file_id)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc page, due to invalid fileId %d", file_id);
-    return rc;
+  if (!batches.empty()) {
+    RC ret = flush_batches(bp_manager, batches);
+    if (ret != RC::SUCCESS) {
+      rc = ret;
+    }
   }
-  BPFileHandle *file_handle = open_list_[file_id];
-  return force_page(file_handle, page_num);
+  return rc;
 }
+
 /**
- * dispose_page will delete the data of the page of pageNum
- * force_page will flush the page of pageNum
- * @param fileHandle
- * @param pageNum
- * @return
+ * 写多批页号连续的页面，每批一个请求，所有请求同时在途。
+ * 调用者已经pin住这些页面并加了读锁。页面复制到写缓冲区之后就释放读锁，写完之后unpin
  */
-RC DiskBufferPool::force_page(BPFileHandle *file_handle, PageNum page_num)
+RC DiskBufferPool::flush_batches(BPManager &bp_manager, std::vector<std::vector<Frame *>> &batches)
 {
-  int i;
-  for (i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (!bp_manager_.allocated[i])
-      continue;
-
-    Frame *frame = &bp_manager_.frame[i];
-    if (frame->file_desc != file_handle->file_desc)
-      continue;
-    if (frame->page.page_num != page_num && page_num != -1) {
-      continue;
+  size_t page_size = bp_manager.page_size();
+  std::vector<PageIORequest> requests(batches.size());
+  std::vector<struct iovec> iov;
+  size_t page_count = 0;
+  for (const std::vector<Frame *> &frames : batches) {
+    page_count += frames.size();
+  }
+  iov.reserve(page_count);
+  void *buffer = nullptr;
+  if (posix_memalign(&buffer, BP_PAGE_SIZE, page_count * page_size) != 0) {
+    for (std::vector<Frame *> &frames : batches) {
+      for (Frame *frame : frames) {
+        pthread_rwlock_unlock(&frame->latch);
+        frame->pin_count--;
+      }
     }
+    batches.clear();
+    return RC::NOMEM;
+  }
 
-    if (frame->pin_count != 0) {
-      LOG_ERROR("Page :%s:%d has been pinned.", file_handle->file_name, page_num);
-      return RC::BUFFERPOOL_PAGE_PINNED;
+  for (size_t i = 0; i < batches.size(); i++) {
+    std::vector<Frame *> &frames = batches[i];
+    PageIORequest &request = requests[i];
+    request.type = PageIORequest::WRITE;
+    request.fd = frames.front()->file_desc;
+    request.offset = ((off_t)frames.front()->page->page_num) * page_size;
+    request.iov = iov.data() + iov.size();
+    request.iovcnt = (int)frames.size();
+    for (Frame *frame : frames) {
+      // checksum写在副本中，不修改共享的帧
+      Page *page = (Page *)((char *)buffer + iov.size() * page_size);
+      bp_manager.clear_dirty(frame);
+      memcpy(page, frame->page, page_size);
+      pthread_rwlock_unlock(&frame->latch);
+      set_page_checksum(page, page_size);
+      iov.push_back(iovec{page, page_size});
     }
+  }
 
-    if (frame->dirty) {
-      RC rc = RC::SUCCESS;
-      if ((rc = flush_block(frame)) != RC::SUCCESS) {
-        LOG_ERROR("Failed to flush page:%s:%d.", file_handle->file_name, page_num);
-        return rc;
+  // 正在写回的页面不能从文件映射中读
+  std::vector<MmapPageSeqs *> seqs(batches.size(), nullptr);
+  for (size_t i = 0; i < batches.size(); i++) {
+    seqs[i] = mmap_seqs_of(requests[i].fd);
+    for (Frame *frame : batches[i]) {
+      if (seqs[i] != nullptr) {
+        seqs[i]->begin_write(frame->page->page_num);
       }
     }
-    bp_manager_.allocated[i] = false;
-    return RC::SUCCESS;
   }
-  return RC::SUCCESS;
+  RC rc = page_io_->submit_and_wait(requests.data(), (int)requests.size());
+  for (size_t i = 0; i < batches.size(); i++) {
+    for (Frame *frame : batches[i]) {
+      if (seqs[i] != nullptr) {
+        seqs[i]->end_write(frame->page->page_num);
+      }
+    }
+  }
+  ::free(buffer);
+
+  for (size_t i = 0; i < batches.size(); i++) {
+    std::vector<Frame *> &frames = batches[i];
+    LOG_DEBUG("Flush %d pages from %d of %d. rc=%d", (int)frames.size(), frames.front()->page->page_num,
+        frames.front()->file_desc, requests[i].rc);
+    for (Frame *frame : frames) {
+      if (requests[i].rc != RC::SUCCESS) {
+        bp_manager.mark_dirty(frame);
+      }
+      frame->pin_count--;
+    }
+  }
+  batches.clear();
+  return rc;
 }
 
-RC DiskBufferPool::flush_all_pages(int file_id)
+void DiskBufferPool::set_direct_io(bool direct_io)
+{
+  direct_io_ = direct_io;
+}
+
+void DiskBufferPool::set_mmap_read(bool mmap_read)
+{
+  mmap_read_ = mmap_read;
+}
+
+void DiskBufferPool::set_read_ahead(int max_pages)
+{
+  read_ahead_max_ = max_pages > 0 ? max_pages : 0;
+}
+
+RC DiskBufferPool::prefetch_page(int file_id, PageNum page_num)
 {
   RC rc = check_file_id(file_id);
   if (rc != RC::SUCCESS) {
-    LOG_ERROR("Failed to flush pages due to invalid file_id %d", file_id);
     return rc;
   }
-
-  BPFileHandle *file_handle = open_list_[file_id];
-  return force_all_pages(file_handle);
+  if (read_ahead_max_ <= 0 || page_num <= 0) {
+    return RC::SUCCESS;
+  }
+  prefetch_pages(open_list_[file_id], page_num, 1);
+  return RC::SUCCESS;
 }
 
-RC DiskBufferPool::force_all_pages(BPFileHandle *file_handle)
+/**
+ * 记录文件的访问位置。连续顺序读READ_AHEAD_TRIGGER次以后开始预读，
+ * 访问进入上一次预读窗口的后半段时发起下一次预读，窗口翻倍直到read_ahead_max_
+ */
+void DiskBufferPool::read_ahead(BPFileHandle *file_handle, PageNum page_num)
 {
+  if (read_ahead_max_ <= 0) {
+    return;
+  }
 
-  for (int i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (!bp_manager_.allocated[i])
-      continue;
-
-    if (bp_manager_.frame[i].file_desc != file_handle->file_desc)
-      continue;
+  PageNum start = 0;
+  PageNum end = 0;
+  {
+    std::lock_guard<std::mutex> lock(file_handle->read_ahead_mutex);
+    if (page_num == file_handle->last_page_num) {
+      return;
+    }
+    if (file_handle->last_page_num != BP_INVALID_PAGE_NUM && page_num > file_handle->last_page_num &&
+        page_num - file_handle->last_page_num <= READ_AHEAD_MAX_GAP) {
+      file_handle->sequential_count++;
+    } else {
+      file_handle->sequential_count = 0;
+      file_handle->read_ahead_window = 0;
+      file_handle->read_ahead_end = 0;
+    }
+    file_handle->last_page_num = page_num;
 
-    if (bp_manager_.frame[i].dirty) {
-      RC rc = flush_block(&bp_manager_.frame[i]);
-      if (rc != RC::SUCCESS) {
-        LOG_ERROR("Failed to flush all pages' of %s.", file_handle->file_name);
-        return rc;
-      }
+    if (file_handle->sequential_count < READ_AHEAD_TRIGGER ||
+        file_handle->read_ahead_end > page_num + file_handle->read_ahead_window / 2) {
+      return;
     }
-    bp_manager_.allocated[i] = false;
-  }
-  return RC::SUCCESS;
-}
 
-RC DiskBufferPool::flush_block(Frame *frame)
-{
-  // The better way is use mmap the block into memory,
-  // so it is easier to flush data to file.
+    int window = file_handle->read_ahead_window * 2;
+    if (window < READ_AHEAD_MIN_PAGES) {
+      window = READ_AHEAD_MIN_PAGES;
+    }
+    if (window > read_ahead_max_) {
+      window = read_ahead_max_;
+    }
+    file_handle->read_ahead_window = window;
 
-  s64_t offset = ((s64_t)frame->page.page_num) * sizeof(Page);
-  if (lseek(frame->file_desc, offset, SEEK_SET) == offset - 1) {
-    LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, frame->file_desc, strerror(errno));
-    return RC::IOERR_SEEK;
+    start = std::max(file_handle->read_ahead_end, page_num + 1);
+    end = page_num + 1 + window;
+    file_handle->read_ahead_end = end;
   }
 
-  if (write(frame->file_desc, &(frame->page), sizeof(Page)) != sizeof(Page)) {
-    LOG_ERROR("Failed to flush page %lld of %d due to %s.", offset, frame->file_desc, strerror(errno));
-    return RC::IOERR_WRITE;
+  if (start < end) {
+    prefetch_pages(file_handle, start, end - start);
   }
-  frame->dirty = false;
-  LOG_DEBUG("Flush block. file desc=%d, page num=%d", frame->file_desc, frame->page.page_num);
-
-  return RC::SUCCESS;
 }
 
-// ! LRU
-RC DiskBufferPool::allocate_block(Frame **buffer)
+namespace {
+struct PrefetchTask {
+  std::vector<Frame *> frames;
+  std::vector<PageNum> page_nums;
+  std::vector<struct iovec> iov;
+  std::vector<PageIORequest> requests;
+  std::vector<size_t> first_frames;  // 每个请求的第一个帧在frames中的下标
+};
+}  // namespace
+
+/**
+ * 把[start, start + count)中有效并且不在缓冲区中的页面异步读入，页号连续的页面合并成一个请求
+ */
+void DiskBufferPool::prefetch_pages(BPFileHandle *file_handle, PageNum start, int count)
 {
+  if (file_handle->page_map != nullptr) {
+    return;
+  }
 
-  // There is one Frame which is free.
-  for (int i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (!bp_manager_.allocated[i]) {
-      bp_manager_.allocated[i] = true;
-      *buffer = bp_manager_.frame + i;
-      LOG_DEBUG("Allocate block frame=%p", bp_manager_.frame + i);
-      return RC::SUCCESS;
-    }
+  // 映射范围内的页面只读查询直接访问映射，交给内核预读
+  const size_t offset = (size_t)start * file_handle->page_size;
+  const size_t length = (size_t)count * file_handle->page_size;
+  if (file_handle->mmap_addr != nullptr && offset + length <= file_handle->mmap_size) {
+    madvise(file_handle->mmap_addr + offset, length, MADV_WILLNEED);
+    return;
   }
 
-  int min = 0;
-  unsigned long mintime = 0;
-  bool flag = false;
-  for (int i = 0; i < BP_BUFFER_SIZE; i++) {
-    if (bp_manager_.frame[i].pin_count != 0)
+  std::vector<PageNum> page_nums;
+  pthread_rwlock_rdlock(&file_handle->hdr_frame->latch);
+  PageNum end = std::min(start + count, file_handle->file_sub_header->page_count);
+  pthread_rwlock_unlock(&file_handle->hdr_frame->latch);
+  for (PageNum page_num = start; page_num < end; page_num++) {
+    if (is_bitmap_page(file_handle, page_num) || !is_page_allocated(file_handle, page_num)) {
       continue;
-    if (!flag) {
-      flag = true;
-      min = i;
-      mintime = bp_manager_.frame[i].acc_time;
     }
-    if (bp_manager_.frame[i].acc_time < mintime) {
-      min = i;
-      mintime = bp_manager_.frame[i].acc_time;
+    if (file_handle->bp_manager->find(file_handle->file_desc, page_num) != nullptr) {
+      continue;
     }
+    page_nums.push_back(page_num);
   }
-  if (!flag) {
-    LOG_ERROR("All pages have been used and pinned.");
-    return RC::NOMEM;
+  if (page_nums.empty()) {
+    return;
   }
 
-  if (bp_manager_.frame[min].dirty) {
-    RC rc = flush_block(&(bp_manager_.frame[min]));
-    if (rc != RC::SUCCESS) {
-      LOG_ERROR("Failed to flush block of %d for %d.", min, bp_manager_.frame[min].file_desc);
-      return rc;
+  PrefetchTask *task = new PrefetchTask;
+  task->iov.reserve(page_nums.size());
+  for (PageNum page_num : page_nums) {
+    Frame *frame = nullptr;
+    if (file_handle->bp_manager->alloc_prefetch(file_handle->file_desc, page_num, &frame) != RC::SUCCESS) {
+      break;  // 没有可以直接使用的帧，剩下的页面不再预读
+    }
+
+    if (task->page_nums.empty() || task->page_nums.back() + 1 != page_num) {
+      PageIORequest request;
+      request.type = PageIORequest::READ;
+      request.fd = file_handle->file_desc;
+      request.offset = ((off_t)page_num) * file_handle->page_size;
+      task->requests.push_back(request);
+      task->first_frames.push_back(task->frames.size());
     }
+    task->frames.push_back(frame);
+    task->page_nums.push_back(page_num);
+    task->iov.push_back(iovec{frame->page, (size_t)file_handle->page_size});
+    task->requests.back().iovcnt++;
   }
-  *buffer = bp_manager_.frame + min;
-  return RC::SUCCESS;
+  if (task->frames.empty()) {
+    delete task;
+    return;
+  }
+  for (size_t i = 0; i < task->requests.size(); i++) {
+    task->requests[i].iov = task->iov.data() + task->first_frames[i];
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    file_handle->prefetching++;
+  }
+  LOG_DEBUG("Prefetch %d pages from %d of %s", (int)task->frames.size(), page_nums.front(), file_handle->file_name);
+  page_io_->submit(task->requests.data(), (int)task->requests.size(), [this, task, file_handle]() {
+    for (size_t i = 0; i < task->requests.size(); i++) {
+      bool success = task->requests[i].rc == RC::SUCCESS;
+      for (int j = 0; j < task->requests[i].iovcnt; j++) {
+        size_t index = task->first_frames[i] + j;
+        // 校验失败的页面丢弃，真正访问时重新读取并报告错误
+        bool valid = success &&
+                     verify_page(task->frames[index]->page, task->page_nums[index], file_handle->page_size);
+        file_handle->bp_manager->complete_prefetch(task->frames[index], task->page_nums[index], valid);
+      }
+    }
+    delete task;
+
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    file_handle->prefetching--;
+    prefetch_cond_.notify_all();
+  });
+}
+
+void DiskBufferPool::wait_prefetch(BPFileHandle *file_handle)
+{
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  prefetch_cond_.wait(lock, [file_handle]() { return file_handle->prefetching == 0; });
 }
 
 RC DiskBufferPool::dispose_block(Frame *buf)
 {
   if (buf->pin_count != 0) {
-    LOG_WARN("Begin to free page %d of %d, but it's pinned.", buf->page.page_num, buf->file_desc);
+    LOG_WARN("Begin to free page %d of %d, but it's pinned.", buf->page->page_num, buf->file_desc);
     return RC::LOCKED_UNLOCK;
   }
   if (buf->dirty) {
     RC rc = flush_block(buf);
     if (rc != RC::SUCCESS) {
-      LOG_WARN("Failed to flush block %d of %d during dispose block.", buf->page.page_num, buf->file_desc);
+      LOG_WARN("Failed to flush block %d of %d during dispose block.", buf->page->page_num, buf->file_desc);
       return rc;
     }
   }
-  buf->dirty = false;
-  int pos = buf - bp_manager_.frame;
-  bp_manager_.allocated[pos] = false;
+  manager_of(buf).free(buf);
   LOG_DEBUG("dispost block frame =%p", buf);
   return RC::SUCCESS;
 }
@@ -534,6 +2201,16 @@ RC DiskBufferPool::check_file_id(int file_id)
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::get_page_data_size(int file_id, int *data_size)
+{
+  RC rc = check_file_id(file_id);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  *data_size = BP_PAGE_DATA_SIZE_OF(open_list_[file_id]->page_size);
+  return RC::SUCCESS;
+}
+
 RC DiskBufferPool::get_page_count(int file_id, int *page_count)
 {
   RC rc = RC::SUCCESS;
@@ -550,7 +2227,8 @@ RC DiskBufferPool::check_page_num(PageNum page_num, BPFileHandle *file_handle)
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_handle->file_name);
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
-  if ((file_handle->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+  // 位图页不能被上层使用
+  if (is_bitmap_page(file_handle, page_num) || !is_page_allocated(file_handle, page_num)) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_handle->file_name);
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
@@ -559,17 +2237,176 @@ RC DiskBufferPool::check_page_num(PageNum page_num, BPFileHandle *file_handle)
 
 RC DiskBufferPool::load_page(PageNum page_num, BPFileHandle *file_handle, Frame *frame)
 {
-  s64_t offset = ((s64_t)page_num) * sizeof(Page);
-  if (lseek(file_handle->file_desc, offset, SEEK_SET) == -1) {
-    LOG_ERROR(
-        "Failed to load page %s:%d, due to failed to lseek:%s.", file_handle->file_name, page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
+  s64_t offset = ((s64_t)page_num) * file_handle->page_size;
+  RC rc = RC::SUCCESS;
+  if (file_handle->page_map != nullptr && page_num != 0) {
+    uint64_t decompress_ns = 0;
+    rc = file_handle->page_map->read_page(page_num, (char *)frame->page, &decompress_ns);
+    if (decompress_ns > 0) {
+      decompress_count_++;
+      decompress_ns_ += decompress_ns;
+    }
+  } else {
+    rc = page_io_->read(file_handle->file_desc, offset, frame->page, file_handle->page_size);
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d, due to failed to read data.", file_handle->file_name, page_num);
+    return rc;
   }
-  if (read(file_handle->file_desc, &(frame->page), sizeof(Page)) != sizeof(Page)) {
-    LOG_ERROR(
-        "Failed to load page %s:%d, due to failed to read data:%s.", file_handle->file_name, page_num, strerror(errno));
-    return RC::IOERR_READ;
+  if (!verify_page(frame->page, page_num, file_handle->page_size)) {
+    checksum_failure_count_++;
+    LOG_ERROR("Failed to load page %s:%d, due to checksum mismatch.", file_handle->file_name, page_num);
+    return RC::BUFFERPOOL_PAGE_CORRUPTED;
   }
   return RC::SUCCESS;
 }
+
+PageMap *DiskBufferPool::page_map_of(int file_desc)
+{
+  std::lock_guard<std::mutex> lock(page_maps_mutex_);
+  if (page_maps_.empty()) {
+    return nullptr;
+  }
+  auto iter = page_maps_.find(file_desc);
+  return iter == page_maps_.end() ? nullptr : iter->second;
+}
+
+MmapPageSeqs *DiskBufferPool::mmap_seqs_of(int file_desc)
+{
+  std::lock_guard<std::mutex> lock(mmap_seqs_mutex_);
+  if (mmap_seqs_.empty()) {
+    return nullptr;
+  }
+  auto iter = mmap_seqs_.find(file_desc);
+  return iter == mmap_seqs_.end() ? nullptr : iter->second;
+}
+
+/**
+ * 复制映射中页面的帧在句柄unpin之后放回copy_frames_重复使用，避免每次读都分配内存
+ */
+Frame *DiskBufferPool::take_copy_frame()
+{
+  {
+    std::lock_guard<std::mutex> lock(copy_frames_mutex_);
+    if (!copy_frames_.empty()) {
+      Frame *frame = copy_frames_.back();
+      copy_frames_.pop_back();
+      return frame;
+    }
+  }
+
+  void *buffer = nullptr;
+  if (posix_memalign(&buffer, BP_PAGE_SIZE, BP_MAX_PAGE_SIZE) != 0) {
+    LOG_ERROR("Failed to alloc memory for mapped page.");
+    return nullptr;
+  }
+  Frame *frame = new Frame;
+  frame->dirty = false;
+  frame->pin_count = 1;
+  frame->acc_time = 0;
+  frame->prefetched = false;
+  frame->file_desc = -1;
+  frame->page = (Page *)buffer;
+  pthread_rwlock_init(&frame->latch, nullptr);
+  return frame;
+}
+
+void DiskBufferPool::return_copy_frame(Frame *frame)
+{
+  static const size_t MAX_COPY_FRAMES = 64;
+  {
+    std::lock_guard<std::mutex> lock(copy_frames_mutex_);
+    if (copy_frames_.size() < MAX_COPY_FRAMES) {
+      copy_frames_.push_back(frame);
+      return;
+    }
+  }
+  pthread_rwlock_destroy(&frame->latch);
+  ::free(frame->page);
+  delete frame;
+}
+
+static uint32_t page_checksum(const Page *page, int page_size)
+{
+  uint32_t crc = common::crc32c(0, &page->page_num, sizeof(page->page_num));
+  return common::crc32c(crc, page->data, BP_PAGE_DATA_SIZE_OF(page_size));
+}
+
+void DiskBufferPool::set_page_checksum(Page *page, int page_size)
+{
+  page->checksum = page_checksum(page, page_size);
+}
+
+bool DiskBufferPool::verify_page(const Page *page, PageNum page_num, int page_size)
+{
+  if (page->page_num == page_num && page->checksum == page_checksum(page, page_size)) {
+    return true;
+  }
+
+  // 文件扩展之后还没有写过的页面
+  const char *p = (const char *)page;
+  return p[0] == 0 && memcmp(p, p + 1, page_size - 1) == 0;
+}
+
+RC DiskBufferPool::verify_file(const char *file_name, std::vector<PageNum> &corrupted_pages)
+{
+  corrupted_pages.clear();
+  int fd = open(file_name, O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  std::vector<char> buffer(BP_MAX_PAGE_SIZE);
+  Page *page = (Page *)buffer.data();
+  RC rc = RC::SUCCESS;
+  if (pread(fd, buffer.data(), BP_PAGE_SIZE, 0) != BP_PAGE_SIZE) {
+    LOG_ERROR("Failed to read header of %s.", file_name);
+    rc = RC::IOERR_SHORT_READ;
+  }
+  const BPFileSubHeader *sub_header = (BPFileSubHeader *)page->data;
+  const int page_size = sub_header->page_size;
+  if (rc == RC::SUCCESS &&
+      (sub_header->magic != BP_FILE_MAGIC || sub_header->format_version != BP_FILE_FORMAT_VERSION)) {
+    LOG_ERROR("Unsupported file format of %s. magic=%x, version=%u", file_name, sub_header->magic,
+        sub_header->format_version);
+    rc = RC::BUFFERPOOL_FILEERR;
+  }
+  if (rc == RC::SUCCESS && !is_valid_page_size(page_size)) {
+    LOG_ERROR("Invalid page size %d in file header of %s", page_size, file_name);
+    rc = RC::BUFFERPOOL_PAGE_CORRUPTED;
+  }
+
+  // 文件头损坏时页数不可信，按照文件大小或者页面映射检查所有的页面
+  PageMap page_map;
+  const bool compressed = PageMap::exists(file_name);
+  if (rc == RC::SUCCESS && compressed) {
+    rc = page_map.open(file_name, fd);
+  }
+  struct stat st;
+  if (rc == RC::SUCCESS && fstat(fd, &st) < 0) {
+    rc = RC::IOERR_FSTAT;
+  }
+  PageNum page_count = 0;
+  if (rc == RC::SUCCESS) {
+    page_count = compressed ? std::max(page_map.page_count(), 1) : (PageNum)(st.st_size / page_size);
+  }
+  for (PageNum page_num = 0; page_num < page_count; page_num++) {
+    uint64_t decompress_ns = 0;
+    if (compressed && page_num != 0) {
+      if (page_map.read_page(page_num, buffer.data(), &decompress_ns) != RC::SUCCESS) {
+        corrupted_pages.push_back(page_num);
+        continue;
+      }
+    } else if (pread(fd, buffer.data(), page_size, (off_t)page_num * page_size) != page_size) {
+      rc = RC::IOERR_SHORT_READ;
+      break;
+    }
+    if (!verify_page(page, page_num, page_size)) {
+      corrupted_pages.push_back(page_num);
+    }
+  }
+  page_map.close();
+  close(fd);
+  return rc;
+}
@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #define __OBSERVER_STORAGE_COMMON_PAGE_MANAGER_H_
 
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <sys/types.h>
 
@@ -22,104 +24,502 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>
 #include <time.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "rc.h"
+#include "storage/default/bp_replacer.h"
+#include "storage/default/page_map.h"
+#include "storage/default/page_io.h"
 
 typedef int PageNum;
 
 //
 #define BP_INVALID_PAGE_NUM (-1)
 #define BP_PAGE_SIZE (1 << 12)
-#define BP_PAGE_DATA_SIZE (BP_PAGE_SIZE - sizeof(PageNum))
+#define BP_PAGE_HEADER_SIZE (sizeof(PageNum) + sizeof(uint32_t))
+#define BP_PAGE_DATA_SIZE (BP_PAGE_SIZE - BP_PAGE_HEADER_SIZE)
+// 每个文件的页面大小可以是BP_PAGE_SIZE的1、2、4、8倍，即4K/8K/16K/32K
+#define BP_PAGE_SIZE_CLASS_NUM 4
+#define BP_MAX_PAGE_SIZE (BP_PAGE_SIZE << (BP_PAGE_SIZE_CLASS_NUM - 1))
+// 缓冲池的内存中留给非默认页面大小的比例，由其它几种页面大小平分
+#define BP_OTHER_PAGE_SIZE_PERCENT 25
+#define BP_MIN_FRAME_NUM 8
+#define BP_PAGE_DATA_SIZE_OF(page_size) ((int)((page_size) - BP_PAGE_HEADER_SIZE))
 #define BP_FILE_SUB_HDR_SIZE (sizeof(BPFileSubHeader))
+/**
+ * 页面按照位图能够管理的数量分组，每组的第一个页面保存这一组的位图：
+ * 第0组的位图在文件头页中紧跟BPFileSubHeader，其它组的位图放在组内第一个页面的数据区开头。
+ * 文件头页的位图长度决定了每组的页面数，4K页面时每组32544个页面
+ */
+#define BP_GROUP_PAGES_OF(page_size) ((int)((BP_PAGE_DATA_SIZE_OF(page_size) - BP_FILE_SUB_HDR_SIZE) * 8))
 #define BP_BUFFER_SIZE 50
 #define MAX_OPEN_FILE 1024
 
+/**
+ * 页面的布局。页面大于BP_PAGE_SIZE时data的实际长度是BP_PAGE_DATA_SIZE_OF(page_size)。
+ * checksum是除checksum之外整个页面的CRC32C，写盘时计算，读盘时校验，用来发现写了一半的页面
+ */
 typedef struct {
   PageNum page_num;
+  uint32_t checksum;
   char data[BP_PAGE_DATA_SIZE];
 } Page;
-// sizeof(Page) should be equal to BP_PAGE_SIZE
-
+// O_DIRECT要求读写的长度和偏移都是块大小的整数倍
+static_assert(sizeof(Page) == BP_PAGE_SIZE, "sizeof(Page) should be equal to BP_PAGE_SIZE");
+
+/**
+ * 文件头页的数据区开头。magic和format_version用来识别文件格式，
+ * 布局不兼容的文件(比如页面没有checksum或者文件头没有page_size)打开时直接报错
+ */
+#define BP_FILE_MAGIC 0x424f494d  // "MIOB"
+#define BP_FILE_FORMAT_VERSION 1
 typedef struct {
+  uint32_t magic;
+  uint32_t format_version;
   PageNum page_count;
   int allocated_pages;
+  int page_size;  // 创建文件时确定，之后不能修改
 } BPFileSubHeader;
 
+/**
+ * 帧只记录页面的元数据，页面内容在BPManager按页对齐分配的一整块内存中。
+ * pin_count、dirty可能被多个线程同时修改，所以是原子变量；
+ * 页面内容由latch保护，读页面时加读锁，修改页面时加写锁
+ */
 typedef struct {
-  bool dirty;
-  unsigned int pin_count;
-  unsigned long acc_time;
+  std::atomic<bool> dirty;
+  std::atomic<unsigned int> pin_count;
+  std::atomic<unsigned long> acc_time;
+  std::atomic<bool> prefetched;  // 预读进来之后还没有被访问过
   int file_desc;
-  Page page;
+  Page *page;
+  pthread_rwlock_t latch;
 } Frame;
 
-typedef struct {
-  bool open;
-  Frame *frame;
-} BPPageHandle;
+/**
+ * 页面句柄。持有句柄即pin住了页面，读写页面内容前需要加对应的latch
+ */
+struct BPPageHandle {
+  bool open = false;
+  Frame *frame = nullptr;
+  bool mapped = false;  // 页面是从文件的只读映射复制出来的，frame只属于这个句柄，不能修改
+
+  void rlatch()
+  {
+    pthread_rwlock_rdlock(&frame->latch);
+  }
+  void runlatch()
+  {
+    pthread_rwlock_unlock(&frame->latch);
+  }
+  void wlatch()
+  {
+    pthread_rwlock_wrlock(&frame->latch);
+  }
+  void wunlatch()
+  {
+    pthread_rwlock_unlock(&frame->latch);
+  }
+};
 
-class BPFileHandle{
+class BPManager;
+
+/**
+ * 只读映射中页面的版本号，用于检测读映射时页面正在被写回文件(seqlock)。
+ * 按页号分成SEQ_NUM组，低16位是正在写这组页面的线程数，高位是写完的次数。
+ * 读映射的线程在复制页面前后看到的版本号相同并且没有正在写的线程，复制的内容才是完整的
+ */
+class MmapPageSeqs {
 public:
-  BPFileHandle() {
-    memset(this, 0, sizeof(*this));
+  static const int SEQ_NUM = 4096;
+  static const uint32_t WRITER_MASK = (1 << 16) - 1;
+
+  void begin_write(PageNum page_num)
+  {
+    seq(page_num).fetch_add(1, std::memory_order_acq_rel);
+  }
+  void end_write(PageNum page_num)
+  {
+    // 正在写的线程数减1，同时版本加1
+    seq(page_num).fetch_add((1 << 16) - 1, std::memory_order_release);
+  }
+
+  /**
+   * 开始读之前的版本号，有线程正在写这组页面时返回false
+   */
+  bool begin_read(PageNum page_num, uint32_t *version) const
+  {
+    *version = seq(page_num).load(std::memory_order_acquire);
+    return (*version & WRITER_MASK) == 0;
+  }
+  /**
+   * 读完之后版本号没有变化，读到的内容才是完整的
+   */
+  bool end_read(PageNum page_num, uint32_t version) const
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq(page_num).load(std::memory_order_relaxed) == version;
   }
 
+  /**
+   * 每组记录最后一个校验通过的页面和版本，版本没变的页面不需要再计算checksum
+   */
+  bool is_verified(PageNum page_num, uint32_t version) const
+  {
+    return verified_[index(page_num)].load(std::memory_order_relaxed) == verified_key(page_num, version);
+  }
+  void set_verified(PageNum page_num, uint32_t version)
+  {
+    verified_[index(page_num)].store(verified_key(page_num, version), std::memory_order_relaxed);
+  }
+
+private:
+  static int index(PageNum page_num)
+  {
+    return (uint32_t)page_num % SEQ_NUM;
+  }
+  static uint64_t verified_key(PageNum page_num, uint32_t version)
+  {
+    return ((uint64_t)(uint32_t)page_num << 32) | version;
+  }
+  std::atomic<uint32_t> &seq(PageNum page_num)
+  {
+    return seqs_[index(page_num)];
+  }
+  const std::atomic<uint32_t> &seq(PageNum page_num) const
+  {
+    return seqs_[index(page_num)];
+  }
+
+private:
+  std::atomic<uint32_t> seqs_[SEQ_NUM] = {};
+  std::atomic<uint64_t> verified_[SEQ_NUM] = {};
+};
+
+class BPFileHandle{
 public:
-  bool bopen;
-  const char *file_name;
-  int file_desc;
-  Frame *hdr_frame;
-  Page *hdr_page;
-  char *bitmap;
-  BPFileSubHeader *file_sub_header;
+  bool bopen = false;
+  const char *file_name = nullptr;
+  int file_desc = -1;
+  bool direct_io = false;  // 文件是否以O_DIRECT打开
+  int page_size = BP_PAGE_SIZE;
+  BPManager *bp_manager = nullptr;  // 缓存这个文件的页面的BPManager，由页面大小决定
+  Frame *hdr_frame = nullptr;
+  Page *hdr_page = nullptr;
+  char *bitmap = nullptr;  // 第0组页面的位图
+  BPFileSubHeader *file_sub_header = nullptr;
+  int group_pages = 0;          // 每个位图管理的页面数
+  PageNum free_page_hint = 0;   // 这个页号之前没有空闲页面，由mutex保护
+  std::mutex mutex;  // 保护文件头和页面位图的修改
+
+  // 顺序读检测和预读窗口，由read_ahead_mutex保护
+  std::mutex read_ahead_mutex;
+  PageNum last_page_num = BP_INVALID_PAGE_NUM;
+  int sequential_count = 0;
+  int read_ahead_window = 0;
+  PageNum read_ahead_end = 0;  // 已经发起预读的页面的上界(不含)
+  int prefetching = 0;         // 在途的预读请求数，由DiskBufferPool::prefetch_mutex_保护
+
+  // 只读映射，打开文件时建立，长度留有余量，文件增长超过映射范围的页面仍然从缓冲区读
+  char *mmap_addr = nullptr;
+  size_t mmap_size = 0;
+  MmapPageSeqs *mmap_seqs = nullptr;
+
+  PageMap *page_map = nullptr;  // 压缩文件的页面映射，不压缩的文件是nullptr
 };
 
+/**
+ * 缓冲区帧管理器。除了管理所有的帧之外，还维护一个页表：
+ * 以(file_desc, page_num)为键的哈希表，用于快速定位已经加载到缓冲区的页面。
+ * 淘汰哪个页面由BPReplacer决定。
+ *
+ * 并发控制：
+ * - 页表按照页面的键分成多个分区，每个分区一把锁，命中时只需要对应分区的锁；
+ * - mutex_保护空闲链表和allocated，replacer_mutex_保护淘汰策略；
+ * - 帧在页表中可见时就可能被其它线程pin住，只有在分区锁内确认pin_count为0才能淘汰。
+ * 加锁顺序为 mutex_ -> 分区锁 -> replacer_mutex_
+ */
 class BPManager {
 public:
-  BPManager(int size = BP_BUFFER_SIZE) {
-    this->size = size;
-    frame = new Frame[size];
-    allocated = new bool[size];
-    for (int i = 0; i < size; i++) {
-      allocated[i] = false;
-      frame[i].pin_count = 0;
-    }
-  }
+  /**
+   * 初始化一个帧，比如从磁盘读取页面。帧在初始化完成之前对其它线程不可见
+   */
+  typedef std::function<RC(Frame *)> FrameInitializer;
+  /**
+   * 把脏页写回磁盘
+   */
+  typedef std::function<RC(Frame *)> FrameFlusher;
 
-  ~BPManager() {
-    delete[] frame;
-    delete[] allocated;
-    size = 0;
-    frame = nullptr;
-    allocated = nullptr;
-  }
+  BPManager(int size = BP_BUFFER_SIZE, BPReplacePolicy policy = BPReplacePolicy::LRU, int page_size = BP_PAGE_SIZE);
+  ~BPManager();
 
-  Frame *alloc() {
-    return nullptr; // TODO for test
+  /**
+   * 设置刷脏页的方法。设置之后，需要淘汰脏页时会先把它刷到磁盘
+   */
+  void set_flusher(const FrameFlusher &flusher)
+  {
+    flusher_ = flusher;
   }
 
-  Frame *get(int file_desc, PageNum page_num) {
-    return nullptr; // TODO for test
+  /**
+   * 为指定的页面分配一个帧，并登记到页表中。
+   * 如果没有空闲帧，会按照淘汰策略淘汰一个没有被pin住的干净页面；
+   * 如果这样的页面是脏页并且没有设置flusher，就返回nullptr
+   */
+  Frame *alloc(int file_desc, PageNum page_num);
+
+  /**
+   * 分配一个帧，用init初始化之后登记到页表中，并pin住返回。
+   * 如果其它线程同时加载了同一个页面，就丢弃自己加载的帧，返回已经存在的帧
+   */
+  RC alloc(int file_desc, PageNum page_num, const FrameInitializer &init, Frame **frame);
+
+  /**
+   * 为预读分配一个帧，帧不登记到页表中，其它线程看不到。
+   * 只使用空闲帧或者干净页面，不会为了预读去刷脏页；页面已经在预读中时返回失败
+   */
+  RC alloc_prefetch(int file_desc, PageNum page_num, Frame **frame);
+
+  /**
+   * 预读结束。读成功并且页面还没有被其它线程加载时登记到页表，否则丢弃这个帧
+   */
+  void complete_prefetch(Frame *frame, PageNum page_num, bool success);
+
+  /**
+   * 页面正在预读时等待预读结束，避免重复读。返回是否等待过
+   */
+  bool wait_prefetch(int file_desc, PageNum page_num);
+
+  /**
+   * 访问指定的页面，找不到返回nullptr。会更新淘汰策略和命中统计
+   */
+  Frame *get(int file_desc, PageNum page_num);
+
+  /**
+   * 与get相同，但是在分区锁内pin住页面，保证返回的帧不会被淘汰。
+   * access为false时不更新淘汰策略和命中统计，后台刷脏页时使用
+   */
+  Frame *pin(int file_desc, PageNum page_num, bool access = true);
+
+  /**
+   * 标记脏页。页面由干净变脏时会加入脏页列表，调用者需要pin住页面
+   */
+  void mark_dirty(Frame *frame);
+
+  /**
+   * 清除脏标记，返回之前是否为脏页
+   */
+  bool clear_dirty(Frame *frame);
+
+  /**
+   * 取走当前的脏页列表，返回页面的键。列表中可能有重复或者已经不脏的页面
+   */
+  std::vector<uint64_t> take_dirty_list();
+
+  /**
+   * 把页面重新放回脏页列表，比如刷盘时页面正在被修改
+   */
+  void requeue_dirty(uint64_t key);
+
+  int dirty_count() const { return dirty_count_.load(); }
+
+  static uint64_t page_key(int file_desc, PageNum page_num)
+  {
+    return ((uint64_t)(uint32_t)file_desc << 32) | (uint32_t)page_num;
   }
+  static int key_file_desc(uint64_t key)
+  {
+    return (int)(key >> 32);
+  }
+  static PageNum key_page_num(uint64_t key)
+  {
+    return (PageNum)(uint32_t)key;
+  }
+
+  /**
+   * 在页表中查找指定的页面，不算作一次访问
+   */
+  Frame *find(int file_desc, PageNum page_num);
+
+  /**
+   * 挑选一个可以淘汰的帧(没有被pin住)，不修改页表
+   */
+  Frame *find_victim();
+
+  /**
+   * 释放一个帧，将其从页表中删除
+   */
+  void free(Frame *frame);
+
+  /**
+   * 页面在缓冲区中并且没有被pin住时释放它的帧。检查pin_count和从页表中删除在同一个分区锁内完成，
+   * 其它线程不会在两者之间pin住这个帧。
+   * 页面被pin住，或者discard_dirty为false并且页面是脏页时返回BUFFERPOOL_PAGE_PINNED；页面不在缓冲区中时返回成功
+   */
+  RC free_if_unpinned(int file_desc, PageNum page_num, bool discard_dirty);
+
+  /**
+   * 列出指定文件在缓冲区中的所有帧
+   */
+  std::vector<Frame *> find_list(int file_desc);
+
+  /**
+   * 列出缓冲区中所有页面的键
+   */
+  std::vector<uint64_t> resident_list();
 
   Frame *getFrame() { return frame; }
 
   bool *getAllocated() { return allocated; }
 
+  int page_size() const { return page_size_; }
+  bool owns(const Frame *buf) const { return buf >= frame && buf < frame + size; }
+
+  BPReplacePolicy policy() const { return policy_; }
+  uint64_t hit_count() const { return hit_count_.load(); }
+  uint64_t miss_count() const { return miss_count_.load(); }
+  uint64_t evict_count() const { return evict_count_.load(); }
+  uint64_t prefetch_count() const { return prefetch_count_.load(); }
+  uint64_t prefetch_hit_count() const { return prefetch_hit_count_.load(); }
+  uint64_t prefetch_wasted_count() const { return prefetch_wasted_count_.load(); }
+
 public:
   int size;
   Frame * frame = nullptr;
   bool *allocated = nullptr;
+
+private:
+  static const int PAGE_TABLE_PARTITION_NUM = 16;
+
+  struct PageTablePartition {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Frame *> table;
+  };
+
+  void recycle(Frame *buf);
+
+  PageTablePartition &partition(uint64_t key)
+  {
+    return partitions_[(key ^ (key >> 32)) % PAGE_TABLE_PARTITION_NUM];
+  }
+
+  Frame *lookup(uint64_t key, bool pin, bool access);
+  RC take_frame(Frame **frame, bool flush_dirty = true);
+  void publish(Frame *buf, uint64_t key);
+  void release_frame(Frame *buf);
+
+private:
+  int page_size_;
+  char *pages_ = nullptr;  // 所有帧的页面内容，按BP_PAGE_SIZE对齐
+  PageTablePartition partitions_[PAGE_TABLE_PARTITION_NUM];
+  std::mutex mutex_;
+  std::vector<Frame *> free_list_;
+  BPReplacePolicy policy_;
+  std::mutex replacer_mutex_;
+  BPReplacer *replacer_ = nullptr;
+  FrameFlusher flusher_;
+
+  std::mutex dirty_mutex_;
+  std::vector<uint64_t> dirty_list_;
+  std::atomic<int> dirty_count_{0};
+
+  std::atomic<uint64_t> hit_count_{0};
+  std::atomic<uint64_t> miss_count_{0};
+  std::atomic<uint64_t> evict_count_{0};
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cond_;
+  std::unordered_set<uint64_t> prefetching_;  // 正在预读的页面
+  std::atomic<int> prefetching_count_{0};
+
+  std::atomic<uint64_t> prefetch_count_{0};
+  std::atomic<uint64_t> prefetch_hit_count_{0};     // 预读的页面在淘汰之前被访问到
+  std::atomic<uint64_t> prefetch_wasted_count_{0};  // 预读的页面没有被访问就被淘汰或丢弃
 };
 
 class DiskBufferPool {
 public:
+  /**
+   * io_threads大于0时页面读写交给异步IO后端，刷脏页线程可以让多批写同时在途。
+   * frame_num按BP_PAGE_SIZE计算缓冲池的总内存，default_page_size的页面使用其中的大部分，
+   * 其它页面大小平分剩下的BP_OTHER_PAGE_SIZE_PERCENT
+   */
+  DiskBufferPool(int frame_num = BP_BUFFER_SIZE, BPReplacePolicy policy = BPReplacePolicy::LRU, int io_threads = 0,
+      int default_page_size = BP_PAGE_SIZE);
+  ~DiskBufferPool();
+
+  /**
+   * 启动后台刷脏页线程。线程每隔interval_ms按照页号顺序把脏页合并写回磁盘，
+   * 干净帧(包括空闲帧)的比例低于clean_percent时会被提前唤醒
+   */
+  RC start_flusher(int interval_ms, int clean_percent);
+  void stop_flusher();
+
+  /**
+   * 把缓冲区中页面的页号和文件名按顺序写到path，重启之后用warm_up重新加载
+   */
+  RC dump_page_list(const char *path);
+
+  /**
+   * 把dump_page_list保存的页面按照文件和页号的顺序异步读入缓冲区，全部读完之后返回。
+   * 只加载已经打开的文件中的页面，path不存在时什么也不做
+   */
+  RC warm_up(const char *path);
+
+  /**
+   * 每隔interval_s秒保存一次页面列表，停止时再保存一次。interval_s为0时只在停止时保存
+   */
+  RC start_page_list_dumper(const char *path, int interval_s);
+  void stop_page_list_dumper();
+
+  /**
+   * 检测到对同一个文件顺序读页面时，异步预读后面的页面。
+   * 预读窗口从一个较小的值开始，每次翻倍，最大max_pages页，0表示关闭预读
+   */
+  void set_read_ahead(int max_pages);
+
+  /**
+   * 提示即将访问某个页面，页面不在缓冲区中时异步读入。
+   * 用于页号不连续的顺序访问，比如B+树沿着兄弟指针扫描叶子节点
+   */
+  RC prefetch_page(int file_id, PageNum page_num);
+
+  /**
+   * 之后打开的文件使用O_DIRECT，绕过内核的页缓存，页面只在缓冲池中缓存一份。
+   * 帧的内存按BP_PAGE_SIZE对齐，读写都以整页为单位，满足O_DIRECT的要求。
+   * 文件系统不支持O_DIRECT时退回到普通的读写
+   */
+  void set_direct_io(bool direct_io);
+
+  /**
+   * 之后打开的文件建立只读的内存映射，get_readonly_page不在缓冲区中的页面从映射中复制，
+   * 不占用缓冲区的帧也不需要系统调用。需要修改的页面仍然通过get_this_page加载到缓冲区
+   */
+  void set_mmap_read(bool mmap_read);
+
   /**
   * 创建一个名称为指定文件名的分页文件
+  * @param page_size 文件的页面大小，0表示使用默认的页面大小
+  * @param compression 页面写盘时使用的压缩算法，压缩的文件不使用O_DIRECT、内存映射和预读
   */
-  RC create_file(const char *file_name);
+  RC create_file(const char *file_name, int page_size = 0, PageCompression compression = PageCompression::NONE);
+  /**
+   * 删除一个没有打开的分页文件，包括压缩文件的页面映射
+   */
+  static RC remove_file(const char *file_name);
+
+  /**
+   * 新建文件默认的页面大小，只能是4K/8K/16K/32K。不改变构造时按页面大小划分的内存
+   */
+  RC set_default_page_size(int page_size);
+  static bool is_valid_page_size(int page_size);
 
   /**
    * 根据文件名打开一个分页文件，返回文件ID
@@ -138,6 +538,13 @@ public:
    */
   RC get_this_page(int file_id, PageNum page_num, BPPageHandle *page_handle);
 
+  /**
+   * 获取一个只读的页面。页面已经在缓冲区中时返回缓冲区中的页面(可能有未刷盘的修改)，
+   * 否则在开启了mmap_read时把映射中的页面复制到句柄私有的帧中返回，通过这个句柄不能mark_dirty。
+   * 复制时如果页面正在被写回文件(版本号变化)，就退回到get_this_page从缓冲区读
+   */
+  RC get_readonly_page(int file_id, PageNum page_num, BPPageHandle *page_handle);
+
   /**
    * 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
    * 分配页面时，如果文件中有空闲页，就直接分配一个空闲页；
@@ -186,10 +593,91 @@ public:
    */
   RC get_page_count(int file_id, int *page_count);
 
+  /**
+   * 获取文件中每个页面数据区的大小
+   */
+  RC get_page_data_size(int file_id, int *data_size);
+
   RC flush_all_pages(int file_id);
 
+  /**
+   * 把所有打开的文件的脏页写回磁盘
+   */
+  RC flush_all_files();
+
+  /**
+   * 计算并设置页面的校验和
+   */
+  static void set_page_checksum(Page *page, int page_size);
+  /**
+   * 校验从文件中读到的页面，页号也要和读取的位置一致。没有写过的全0页面也是有效的
+   */
+  static bool verify_page(const Page *page, PageNum page_num, int page_size);
+  /**
+   * 离线校验一个没有被打开的文件，返回校验失败的页号
+   */
+  static RC verify_file(const char *file_name, std::vector<PageNum> &corrupted_pages);
+
+  /**
+   * 从磁盘读到的页面校验失败的次数
+   */
+  uint64_t checksum_failure_count() const
+  {
+    return checksum_failure_count_;
+  }
+
+  /**
+   * 压缩文件写盘的页面压缩前后的总字节数，以及读盘时解压的页数和时间
+   */
+  uint64_t compress_raw_bytes() const
+  {
+    return compress_raw_bytes_;
+  }
+  uint64_t compress_stored_bytes() const
+  {
+    return compress_stored_bytes_;
+  }
+  uint64_t decompress_count() const
+  {
+    return decompress_count_;
+  }
+  uint64_t decompress_ns() const
+  {
+    return decompress_ns_;
+  }
+
+  /**
+   * 直接从文件映射中读取的页面数
+   */
+  uint64_t mmap_read_count() const
+  {
+    return mmap_read_count_;
+  }
+
+  /**
+   * 读映射时页面正在被写回文件，退回到缓冲区读的次数
+   */
+  uint64_t mmap_read_conflict_count() const
+  {
+    return mmap_read_conflict_count_;
+  }
+
+  /**
+   * 缓冲区的命中、未命中和淘汰次数
+   */
+  const BPManager &bp_manager() const
+  {
+    return bp_manager_;
+  }
+
+  /**
+   * 已经创建的每种页面大小的BPManager，统计整个缓冲池时需要把它们加起来
+   */
+  std::vector<const BPManager *> bp_managers() const;
+
 protected:
-  RC allocate_block(Frame **buf);
+  RC allocate_block(BPManager &bp_manager, int file_desc, PageNum page_num, const BPManager::FrameInitializer &init,
+      Frame **buf);
   RC dispose_block(Frame *buf);
 
   /**
@@ -203,12 +691,121 @@ protected:
   RC check_page_num(PageNum page_num, BPFileHandle *file_handle);
   RC load_page(PageNum page_num, BPFileHandle *file_handle, Frame *frame);
   RC flush_block(Frame *frame);
+  RC read_file_header(int fd, const char *file_name, int *page_size);
+  void map_file(BPFileHandle *file_handle);
+  void unmap_file(BPFileHandle *file_handle);
+
+  /**
+   * 页面分配位图。第0组的位图在常驻的文件头页中，其它组的位图页用到时才pin住
+   */
+  bool is_bitmap_page(BPFileHandle *file_handle, PageNum page_num) const;
+  RC get_bitmap_frame(BPFileHandle *file_handle, int group, Frame **frame);
+  bool is_page_allocated(BPFileHandle *file_handle, PageNum page_num);
+  RC set_page_allocated(BPFileHandle *file_handle, PageNum page_num, bool allocated);
+  RC find_free_page(BPFileHandle *file_handle, PageNum *page_num);
+  RC append_bitmap_page(BPFileHandle *file_handle, PageNum page_num);
+
+  BPManager *get_bp_manager(int page_size);
+  PageMap *page_map_of(int file_desc);
+  MmapPageSeqs *mmap_seqs_of(int file_desc);
+  Frame *take_copy_frame();
+  void return_copy_frame(Frame *frame);
+  BPManager &manager_of(Frame *frame);
+
+  void flusher_loop();
+  void dumper_loop();
+  RC flush_dirty_pages(BPManager &bp_manager);
+  RC flush_batches(BPManager &bp_manager, std::vector<std::vector<Frame *>> &batches);
+
+  void read_ahead(BPFileHandle *file_handle, PageNum page_num);
+  void prefetch_pages(BPFileHandle *file_handle, PageNum start, int count);
+  void wait_prefetch(BPFileHandle *file_handle);
+  void wakeup_flusher_if_needed(const BPManager &bp_manager);
 
 private:
-  BPManager bp_manager_;
+  BPManager bp_manager_;  // 默认页面大小的BPManager
+  PageIO *page_io_ = nullptr;
+  int frame_num_;
+  BPReplacePolicy policy_;
+  int default_page_size_ = BP_PAGE_SIZE;
+  std::mutex managers_mutex_;
+  std::atomic<BPManager *> bp_managers_[BP_PAGE_SIZE_CLASS_NUM];  // 下标i对应BP_PAGE_SIZE << i
   BPFileHandle *open_list_[MAX_OPEN_FILE] = {nullptr};
+  std::mutex open_list_mutex_;  // 保护open_list_的打开和关闭
+
+  std::thread flusher_;
+  std::mutex flusher_mutex_;
+  std::condition_variable flusher_cond_;
+  bool flusher_running_ = false;
+  bool flusher_wakeup_ = false;
+  int flush_interval_ms_ = 0;
+  int clean_percent_ = 0;
+
+  std::thread dumper_;
+  std::mutex dumper_mutex_;
+  std::condition_variable dumper_cond_;
+  bool dumper_running_ = false;
+  std::string dump_path_;
+  int dump_interval_s_ = 0;
+
+  bool direct_io_ = false;
+  bool mmap_read_ = false;
+  std::atomic<uint64_t> mmap_read_count_{0};
+  std::atomic<uint64_t> mmap_read_conflict_count_{0};
+  std::mutex mmap_seqs_mutex_;
+  std::unordered_map<int, MmapPageSeqs *> mmap_seqs_;  // 按照文件描述符查找映射的页面版本号
+  std::mutex copy_frames_mutex_;
+  std::vector<Frame *> copy_frames_;  // 复制映射中的页面用的空闲帧，页面缓冲的大小是BP_MAX_PAGE_SIZE
+  std::atomic<uint64_t> checksum_failure_count_{0};
+
+  std::mutex page_maps_mutex_;
+  std::unordered_map<int, PageMap *> page_maps_;  // 按照文件描述符查找压缩文件的页面映射
+  std::atomic<uint64_t> compress_raw_bytes_{0};
+  std::atomic<uint64_t> compress_stored_bytes_{0};
+  std::atomic<uint64_t> decompress_count_{0};
+  std::atomic<uint64_t> decompress_ns_{0};
+  int read_ahead_max_ = 0;
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cond_;
 };
 
+/**
+ * 按照指定的帧数创建全局的缓冲池，需要在第一次使用theGlobalDiskBufferPool之前调用
+ */
+RC init_global_disk_buffer_pool(int frame_num, BPReplacePolicy policy, int io_threads, int page_size = BP_PAGE_SIZE);
 DiskBufferPool *theGlobalDiskBufferPool();
 
+#define DEFAULT_BUFFER_POOL_NAME "default"
+
+/**
+ * 创建一个命名的缓冲池，比如给索引单独一个缓冲池，避免大表扫描把热点索引页淘汰出去
+ */
+RC init_named_disk_buffer_pool(
+    const char *name, int frame_num, BPReplacePolicy policy, int io_threads, int page_size = BP_PAGE_SIZE);
+
+/**
+ * 按名称查找缓冲池，DEFAULT_BUFFER_POOL_NAME是全局缓冲池，不存在时返回nullptr
+ */
+DiskBufferPool *theNamedDiskBufferPool(const char *name);
+
+/**
+ * 所有的缓冲池和它们的名称，第一个是全局缓冲池
+ */
+std::vector<std::pair<std::string, DiskBufferPool *>> all_disk_buffer_pools();
+
+/**
+ * 指定表的数据文件和索引文件使用的缓冲池，table_name为nullptr时设置没有单独指定的表的缓冲池
+ */
+RC assign_table_buffer_pool(const char *table_name, const char *data_pool, const char *index_pool);
+
+/**
+ * 表的数据文件(index为false)或者索引文件使用的缓冲池，没有配置时是全局缓冲池
+ */
+DiskBufferPool *theTableBufferPool(const char *table_name, bool index);
+
+/**
+ * 进程退出前停止所有缓冲池的后台线程，保存页面列表并把脏页写回磁盘
+ */
+void cleanup_global_disk_buffer_pool();
+
 #endif //__OBSERVER_STORAGE_COMMON_PAGE_MANAGER_H_
@@ -0,0 +1,340 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/default/page_io.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "common/log/log.h"
+
+static ssize_t request_size(const PageIORequest &request)
+{
+  ssize_t size = 0;
+  for (int i = 0; i < request.iovcnt; i++) {
+    size += request.iov[i].iov_len;
+  }
+  return size;
+}
+
+static void complete_request(PageIORequest &request, ssize_t ret)
+{
+  if (ret == request_size(request)) {
+    request.rc = RC::SUCCESS;
+    return;
+  }
+
+  bool is_read = request.type == PageIORequest::READ;
+  LOG_ERROR("Failed to %s %d bytes at %lld of %d. ret=%lld, error=%s",
+      is_read ? "read" : "write", (int)request_size(request), (long long)request.offset, request.fd,
+      (long long)ret, ret < 0 ? strerror(-ret) : "short io");
+  request.rc = is_read ? RC::IOERR_READ : RC::IOERR_WRITE;
+}
+
+void PageIO::execute(PageIORequest &request)
+{
+  ssize_t ret = 0;
+  if (request.type == PageIORequest::READ) {
+    ret = preadv(request.fd, request.iov, request.iovcnt, request.offset);
+  } else {
+    ret = pwritev(request.fd, request.iov, request.iovcnt, request.offset);
+  }
+  complete_request(request, ret < 0 ? -errno : ret);
+}
+
+RC PageIO::submit_and_wait(PageIORequest *requests, int count)
+{
+  if (count == 1) {
+    execute(requests[0]);
+  } else if (count > 1) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool finished = false;
+    submit(requests, count, [&]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+      cond.notify_one();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&finished]() { return finished; });
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (requests[i].rc != RC::SUCCESS) {
+      return requests[i].rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC PageIO::read(int fd, off_t offset, void *buf, size_t size)
+{
+  struct iovec iov = {buf, size};
+  PageIORequest request;
+  request.type = PageIORequest::READ;
+  request.fd = fd;
+  request.offset = offset;
+  request.iov = &iov;
+  request.iovcnt = 1;
+  return submit_and_wait(&request, 1);
+}
+
+RC PageIO::write(int fd, off_t offset, void *buf, size_t size)
+{
+  struct iovec iov = {buf, size};
+  PageIORequest request;
+  request.type = PageIORequest::WRITE;
+  request.fd = fd;
+  request.offset = offset;
+  request.iov = &iov;
+  request.iovcnt = 1;
+  return submit_and_wait(&request, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SyncPageIO::submit(PageIORequest *requests, int count, const Callback &done)
+{
+  for (int i = 0; i < count; i++) {
+    execute(requests[i]);
+  }
+  done();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+struct ThreadPoolPageIO::Batch {
+  std::atomic<int> pending;
+  Callback done;
+};
+
+ThreadPoolPageIO::ThreadPoolPageIO(int thread_num)
+{
+  for (int i = 0; i < thread_num; i++) {
+    workers_.emplace_back(&ThreadPoolPageIO::worker_loop, this);
+  }
+}
+
+ThreadPoolPageIO::~ThreadPoolPageIO()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolPageIO::submit(PageIORequest *requests, int count, const Callback &done)
+{
+  if (count <= 0) {
+    done();
+    return;
+  }
+
+  Batch *batch = new Batch;
+  batch->pending = count;
+  batch->done = done;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 0; i < count; i++) {
+      tasks_.push_back(Task{&requests[i], batch});
+    }
+  }
+  cond_.notify_all();
+}
+
+void ThreadPoolPageIO::worker_loop()
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        break;  // 退出之前把已经提交的请求做完
+      }
+      task = tasks_.front();
+      tasks_.pop_front();
+    }
+
+    execute(*task.request);
+    if (--task.batch->pending == 0) {
+      task.batch->done();
+      delete task.batch;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#ifdef HAVE_LIBURING
+/**
+ * 提交线程只负责填写SQE，由单独的线程收割CQE，
+ * 这样多个线程可以同时有请求在途，互相之间不会拿走对方的完成事件
+ */
+class UringPageIO : public PageIO {
+public:
+  explicit UringPageIO(unsigned queue_depth) : queue_depth_(queue_depth)
+  {}
+  ~UringPageIO() override;
+
+  RC init();
+
+  const char *name() const override
+  {
+    return "io_uring";
+  }
+  void submit(PageIORequest *requests, int count, const Callback &done) override;
+
+private:
+  struct Batch {
+    std::atomic<int> pending;
+    Callback done;
+  };
+
+  void reaper_loop();
+
+private:
+  struct io_uring ring_;
+  unsigned queue_depth_;
+  bool inited_ = false;
+  std::thread reaper_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  unsigned inflight_ = 0;  // 限制在途请求数，保证完成队列不会溢出
+};
+
+RC UringPageIO::init()
+{
+  int ret = io_uring_queue_init(queue_depth_, &ring_, 0);
+  if (ret < 0) {
+    LOG_WARN("Failed to init io_uring. error=%s", strerror(-ret));
+    return RC::IOERR;
+  }
+  inited_ = true;
+  reaper_ = std::thread(&UringPageIO::reaper_loop, this);
+  return RC::SUCCESS;
+}
+
+UringPageIO::~UringPageIO()
+{
+  if (!inited_) {
+    return;
+  }
+
+  // 等在途的请求都完成之后，用一个不带数据的NOP通知收割线程退出
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return inflight_ == 0; });
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(&ring_);
+  }
+  reaper_.join();
+  io_uring_queue_exit(&ring_);
+}
+
+void UringPageIO::submit(PageIORequest *requests, int count, const Callback &done)
+{
+  if (count <= 0) {
+    done();
+    return;
+  }
+
+  Batch *batch = new Batch;
+  batch->pending = count;
+  batch->done = done;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int i = 0; i < count; i++) {
+    // 队列满了就先把已经填好的提交出去，等收割线程腾出位置
+    if (inflight_ >= queue_depth_ - 1) {
+      io_uring_submit(&ring_);
+      cond_.wait(lock, [this]() { return inflight_ < queue_depth_ - 1; });
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+
+    PageIORequest &request = requests[i];
+    if (request.type == PageIORequest::READ) {
+      io_uring_prep_readv(sqe, request.fd, request.iov, request.iovcnt, request.offset);
+    } else {
+      io_uring_prep_writev(sqe, request.fd, request.iov, request.iovcnt, request.offset);
+    }
+    // 收割时通过user data找到请求和所属的批次
+    io_uring_sqe_set_data(sqe, new std::pair<PageIORequest *, Batch *>(&request, batch));
+    inflight_++;
+  }
+  io_uring_submit(&ring_);
+}
+
+void UringPageIO::reaper_loop()
+{
+  while (true) {
+    struct io_uring_cqe *cqe = nullptr;
+    int ret = io_uring_wait_cqe(&ring_, &cqe);
+    if (ret < 0) {
+      if (ret == -EINTR) {
+        continue;
+      }
+      LOG_ERROR("Failed to wait io_uring completion. error=%s", strerror(-ret));
+      break;
+    }
+
+    auto *task = static_cast<std::pair<PageIORequest *, Batch *> *>(io_uring_cqe_get_data(cqe));
+    int res = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+    if (task == nullptr) {
+      break;
+    }
+
+    complete_request(*task->first, res);
+    Batch *batch = task->second;
+    delete task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      inflight_--;
+    }
+    cond_.notify_all();
+    if (--batch->pending == 0) {
+      batch->done();
+      delete batch;
+    }
+  }
+}
+#endif  // HAVE_LIBURING
+
+////////////////////////////////////////////////////////////////////////////////
+PageIO *PageIO::create(int io_threads)
+{
+  if (io_threads <= 0) {
+    return new SyncPageIO();
+  }
+
+#ifdef HAVE_LIBURING
+  UringPageIO *uring = new UringPageIO(256);
+  if (uring->init() == RC::SUCCESS) {
+    return uring;
+  }
+  delete uring;
+  LOG_WARN("io_uring is not supported, fall back to %d io threads", io_threads);
+#endif
+
+  return new ThreadPoolPageIO(io_threads);
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifndef __OBSERVER_STORAGE_DEFAULT_PAGE_IO_H_
+#define __OBSERVER_STORAGE_DEFAULT_PAGE_IO_H_
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rc.h"
+
+/**
+ * 一次页面读写，iov中的多个缓冲区对应文件中从offset开始的连续区域
+ */
+struct PageIORequest {
+  enum Type { READ, WRITE };
+
+  Type type = READ;
+  int fd = -1;
+  off_t offset = 0;
+  struct iovec *iov = nullptr;
+  int iovcnt = 0;
+  RC rc = RC::SUCCESS;  // 完成后的结果，读写的字节数不足也算失败
+};
+
+/**
+ * 缓冲池的页面读写接口。一批请求之间互不依赖，可以同时在途，
+ * 全部完成之后调用一次回调。回调可能在IO线程中执行，不能阻塞
+ */
+class PageIO {
+public:
+  typedef std::function<void()> Callback;
+
+  virtual ~PageIO() = default;
+
+  virtual const char *name() const = 0;
+
+  /**
+   * 提交一批请求，不等待完成。requests在回调执行之前必须保持有效
+   */
+  virtual void submit(PageIORequest *requests, int count, const Callback &done) = 0;
+
+  /**
+   * 提交一批请求并等待全部完成，返回第一个失败请求的错误码。
+   * 只有一个请求时直接在当前线程读写，省掉线程切换
+   */
+  RC submit_and_wait(PageIORequest *requests, int count);
+
+  RC read(int fd, off_t offset, void *buf, size_t size);
+  RC write(int fd, off_t offset, void *buf, size_t size);
+
+  /**
+   * io_threads不大于0时在调用线程上同步读写；
+   * 否则优先使用io_uring(编译时找到liburing并且内核支持)，不支持时使用io_threads个线程的线程池
+   */
+  static PageIO *create(int io_threads);
+
+protected:
+  static void execute(PageIORequest &request);
+};
+
+/**
+ * 在提交线程上依次读写
+ */
+class SyncPageIO : public PageIO {
+public:
+  const char *name() const override
+  {
+    return "sync";
+  }
+  void submit(PageIORequest *requests, int count, const Callback &done) override;
+};
+
+/**
+ * 由固定数量的IO线程执行preadv/pwritev，一批请求可以被多个线程同时执行
+ */
+class ThreadPoolPageIO : public PageIO {
+public:
+  explicit ThreadPoolPageIO(int thread_num);
+  ~ThreadPoolPageIO() override;
+
+  const char *name() const override
+  {
+    return "thread pool";
+  }
+  void submit(PageIORequest *requests, int count, const Callback &done) override;
+
+private:
+  struct Batch;
+  struct Task {
+    PageIORequest *request;
+    Batch *batch;
+  };
+
+  void worker_loop();
+
+private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Task> tasks_;
+  bool stopped_ = false;
+};
+
+#endif  // __OBSERVER_STORAGE_DEFAULT_PAGE_IO_H_
@@ -0,0 +1,427 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/default/page_map.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "common/log/log.h"
+
+static const char *PAGE_MAP_SUFFIX = ".pmap";
+static const uint32_t PAGE_MAP_MAGIC = 0x50414d50;  // "PMAP"
+
+namespace {
+struct PageMapHeader {
+  uint32_t magic;
+  int32_t compression;
+  int32_t page_size;
+  int32_t reserved;
+};
+
+struct PageCompressionRegistry {
+  std::mutex mutex;
+  PageCompression default_compression = PageCompression::NONE;
+  std::map<std::string, PageCompression> table_compressions;
+};
+
+PageCompressionRegistry &page_compression_registry()
+{
+  static PageCompressionRegistry registry;
+  return registry;
+}
+}  // namespace
+
+const char *page_compression_name(PageCompression compression)
+{
+  switch (compression) {
+    case PageCompression::ZLIB:
+      return "zlib";
+    case PageCompression::LZ4:
+      return "lz4";
+    case PageCompression::ZSTD:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+bool page_compression_from_name(const char *name, PageCompression &compression)
+{
+  if (0 == strcasecmp(name, "none")) {
+    compression = PageCompression::NONE;
+  } else if (0 == strcasecmp(name, "zlib")) {
+    compression = PageCompression::ZLIB;
+  } else if (0 == strcasecmp(name, "lz4")) {
+    compression = PageCompression::LZ4;
+  } else if (0 == strcasecmp(name, "zstd")) {
+    compression = PageCompression::ZSTD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool page_compression_supported(PageCompression compression)
+{
+  switch (compression) {
+    case PageCompression::NONE:
+      return true;
+#ifdef HAVE_ZLIB
+    case PageCompression::ZLIB:
+      return true;
+#endif
+#ifdef HAVE_LZ4
+    case PageCompression::LZ4:
+      return true;
+#endif
+#ifdef HAVE_ZSTD
+    case PageCompression::ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+void assign_table_page_compression(const char *table_name, PageCompression compression)
+{
+  PageCompressionRegistry &registry = page_compression_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (table_name == nullptr) {
+    registry.default_compression = compression;
+  } else {
+    registry.table_compressions[table_name] = compression;
+  }
+}
+
+PageCompression theTablePageCompression(const char *table_name)
+{
+  PageCompressionRegistry &registry = page_compression_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto iter = registry.table_compressions.find(table_name);
+  if (iter != registry.table_compressions.end()) {
+    return iter->second;
+  }
+  return registry.default_compression;
+}
+
+/**
+ * 压缩失败或者压缩之后放不进dst时返回0
+ */
+static int compress_data(PageCompression compression, const char *src, int len, char *dst, int dst_len)
+{
+  switch (compression) {
+#ifdef HAVE_ZLIB
+    case PageCompression::ZLIB: {
+      uLongf out_len = dst_len;
+      if (compress2((Bytef *)dst, &out_len, (const Bytef *)src, len, Z_BEST_SPEED) != Z_OK) {
+        return 0;
+      }
+      return (int)out_len;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case PageCompression::LZ4:
+      return LZ4_compress_default(src, dst, len, dst_len);
+#endif
+#ifdef HAVE_ZSTD
+    case PageCompression::ZSTD: {
+      size_t out_len = ZSTD_compress(dst, dst_len, src, len, 1);
+      return ZSTD_isError(out_len) ? 0 : (int)out_len;
+    }
+#endif
+    default:
+      return 0;
+  }
+}
+
+static bool decompress_data(PageCompression compression, const char *src, int len, char *dst, int dst_len)
+{
+  switch (compression) {
+#ifdef HAVE_ZLIB
+    case PageCompression::ZLIB: {
+      uLongf out_len = dst_len;
+      return uncompress((Bytef *)dst, &out_len, (const Bytef *)src, len) == Z_OK && (int)out_len == dst_len;
+    }
+#endif
+#ifdef HAVE_LZ4
+    case PageCompression::LZ4:
+      return LZ4_decompress_safe(src, dst, len, dst_len) == dst_len;
+#endif
+#ifdef HAVE_ZSTD
+    case PageCompression::ZSTD:
+      return ZSTD_decompress(dst, dst_len, src, len) == (size_t)dst_len;
+#endif
+    default:
+      return false;
+  }
+}
+
+static uint32_t round_up_sector(uint32_t len)
+{
+  return (len + PageMap::PAGE_MAP_SECTOR - 1) / PageMap::PAGE_MAP_SECTOR * PageMap::PAGE_MAP_SECTOR;
+}
+
+PageMap::~PageMap()
+{
+  close();
+}
+
+std::string PageMap::map_file_name(const char *file_name)
+{
+  return std::string(file_name) + PAGE_MAP_SUFFIX;
+}
+
+bool PageMap::exists(const char *file_name)
+{
+  return access(map_file_name(file_name).c_str(), F_OK) == 0;
+}
+
+RC PageMap::create(const char *file_name, PageCompression compression, int page_size)
+{
+  std::string map_file = map_file_name(file_name);
+  int fd = ::open(map_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IREAD | S_IWRITE);
+  if (fd < 0) {
+    LOG_ERROR("Failed to create page map %s, due to %s.", map_file.c_str(), strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  PageMapHeader header;
+  header.magic = PAGE_MAP_MAGIC;
+  header.compression = (int32_t)compression;
+  header.page_size = page_size;
+  header.reserved = 0;
+  RC rc = RC::SUCCESS;
+  if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+    LOG_ERROR("Failed to write page map header %s, due to %s.", map_file.c_str(), strerror(errno));
+    rc = RC::IOERR_WRITE;
+  }
+  ::close(fd);
+  return rc;
+}
+
+RC PageMap::open(const char *file_name, int data_fd)
+{
+  std::string map_file = map_file_name(file_name);
+  int fd = ::open(map_file.c_str(), O_RDWR);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open page map %s, due to %s.", map_file.c_str(), strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  PageMapHeader header;
+  if (pread(fd, &header, sizeof(header), 0) != sizeof(header) || header.magic != PAGE_MAP_MAGIC) {
+    LOG_ERROR("Invalid page map header of %s", map_file.c_str());
+    ::close(fd);
+    return RC::IOERR_SHORT_READ;
+  }
+  compression_ = (PageCompression)header.compression;
+  if (!page_compression_supported(compression_)) {
+    LOG_ERROR("Compression %s of %s is not supported by this build", page_compression_name(compression_), file_name);
+    ::close(fd);
+    return RC::NOLFS;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    ::close(fd);
+    return RC::IOERR_FSTAT;
+  }
+  size_t entry_num = (st.st_size - sizeof(header)) / sizeof(Entry);
+  entries_.resize(entry_num);
+  ssize_t entries_size = entry_num * sizeof(Entry);
+  if (entry_num > 0 && pread(fd, entries_.data(), entries_size, sizeof(header)) != entries_size) {
+    LOG_ERROR("Failed to read page map %s", map_file.c_str());
+    ::close(fd);
+    return RC::IOERR_SHORT_READ;
+  }
+
+  file_name_ = file_name;
+  map_fd_ = fd;
+  data_fd_ = data_fd;
+  page_size_ = header.page_size;
+
+  // 映射中没有用到的空间都是空闲空间，文件头页之后才是压缩的页面
+  std::vector<std::pair<uint64_t, uint32_t>> used;
+  for (const Entry &entry : entries_) {
+    if (entry.capacity > 0) {
+      used.emplace_back(entry.offset, entry.capacity);
+    }
+  }
+  std::sort(used.begin(), used.end());
+  uint64_t offset = page_size_;
+  for (const auto &space : used) {
+    if (space.first > offset) {
+      free_space(offset, space.first - offset);
+    }
+    offset = std::max(offset, space.first + space.second);
+  }
+  file_end_ = offset;
+  LOG_INFO("Open page map of %s. compression=%s, pages=%d, free spaces=%d",
+      file_name, page_compression_name(compression_), (int)entries_.size(), (int)free_spaces_.size());
+  return RC::SUCCESS;
+}
+
+void PageMap::close()
+{
+  if (map_fd_ >= 0) {
+    ::close(map_fd_);
+    map_fd_ = -1;
+  }
+  data_fd_ = -1;
+  entries_.clear();
+  free_spaces_.clear();
+}
+
+PageNum PageMap::page_count()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (PageNum)entries_.size();
+}
+
+uint64_t PageMap::allocate_space(uint32_t capacity)
+{
+  auto iter = free_spaces_.lower_bound(capacity);
+  if (iter == free_spaces_.end()) {
+    uint64_t offset = file_end_;
+    file_end_ += capacity;
+    return offset;
+  }
+
+  uint64_t offset = iter->second;
+  uint32_t remain = iter->first - capacity;
+  free_spaces_.erase(iter);
+  if (remain > 0) {
+    free_space(offset + capacity, remain);
+  }
+  return offset;
+}
+
+void PageMap::free_space(uint64_t offset, uint32_t capacity)
+{
+  free_spaces_.emplace(capacity, offset);
+}
+
+RC PageMap::read_page(PageNum page_num, char *page, uint64_t *decompress_ns)
+{
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (page_num < (PageNum)entries_.size()) {
+      entry = entries_[page_num];
+    }
+  }
+  *decompress_ns = 0;
+  if (entry.length == 0) {
+    memset(page, 0, page_size_);
+    return RC::SUCCESS;
+  }
+
+  if (entry.length == (uint32_t)page_size_) {
+    if (pread(data_fd_, page, page_size_, entry.offset) != page_size_) {
+      LOG_ERROR("Failed to read page %s:%d, due to %s.", file_name_.c_str(), page_num, strerror(errno));
+      return RC::IOERR_READ;
+    }
+    return RC::SUCCESS;
+  }
+
+  std::vector<char> buffer(entry.length);
+  if (pread(data_fd_, buffer.data(), entry.length, entry.offset) != (ssize_t)entry.length) {
+    LOG_ERROR("Failed to read page %s:%d, due to %s.", file_name_.c_str(), page_num, strerror(errno));
+    return RC::IOERR_READ;
+  }
+  auto begin = std::chrono::steady_clock::now();
+  bool success = decompress_data(compression_, buffer.data(), entry.length, page, page_size_);
+  // 返回0表示没有解压
+  *decompress_ns = std::max<uint64_t>(1,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+  if (!success) {
+    LOG_ERROR("Failed to decompress page %s:%d", file_name_.c_str(), page_num);
+    return RC::BUFFERPOOL_PAGE_CORRUPTED;
+  }
+  return RC::SUCCESS;
+}
+
+RC PageMap::write_page(PageNum page_num, const char *page, int *stored_size)
+{
+  // 压缩之后节省不了空间的页面不压缩
+  std::vector<char> buffer(page_size_);
+  int length = compress_data(compression_, page, page_size_, buffer.data(), page_size_);
+  const char *data = buffer.data();
+  if (length <= 0 || round_up_sector(length) >= (uint32_t)page_size_) {
+    length = page_size_;
+    data = page;
+  }
+  const uint32_t capacity = round_up_sector(length);
+
+  Entry old_entry;
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (page_num >= (PageNum)entries_.size()) {
+      entries_.resize(page_num + 1);
+    }
+    old_entry = entries_[page_num];
+    entry.length = length;
+    if (old_entry.capacity >= capacity) {
+      entry.offset = old_entry.offset;
+      entry.capacity = old_entry.capacity;
+    } else {
+      entry.offset = allocate_space(capacity);
+      entry.capacity = capacity;
+    }
+  }
+
+  if (pwrite(data_fd_, data, length, entry.offset) != length) {
+    LOG_ERROR("Failed to write page %s:%d, due to %s.", file_name_.c_str(), page_num, strerror(errno));
+    if (entry.offset != old_entry.offset) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_space(entry.offset, entry.capacity);
+    }
+    return RC::IOERR_WRITE;
+  }
+
+  // 换了位置时先写页面再写映射，映射不会指向没有写完的位置
+  std::lock_guard<std::mutex> lock(mutex_);
+  const off_t entry_offset = sizeof(PageMapHeader) + (off_t)page_num * sizeof(Entry);
+  if (pwrite(map_fd_, &entry, sizeof(entry), entry_offset) != sizeof(entry)) {
+    LOG_ERROR("Failed to write page map of %s:%d, due to %s.", file_name_.c_str(), page_num, strerror(errno));
+    if (entry.offset != old_entry.offset) {
+      free_space(entry.offset, entry.capacity);
+    }
+    return RC::IOERR_WRITE;
+  }
+  // 同一个页面可能同时在刷盘，释放的是映射中当前的位置
+  const Entry current = entries_[page_num];
+  entries_[page_num] = entry;
+  if (current.offset != entry.offset && current.capacity > 0) {
+    free_space(current.offset, current.capacity);
+  }
+  *stored_size = entry.capacity;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,109 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#ifndef __OBSERVER_STORAGE_DEFAULT_PAGE_MAP_H_
+#define __OBSERVER_STORAGE_DEFAULT_PAGE_MAP_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rc.h"
+
+typedef int PageNum;
+
+/**
+ * 页面的压缩算法。LZ4和ZSTD在编译时找到对应的库才可以使用
+ */
+enum class PageCompression { NONE, ZLIB, LZ4, ZSTD };
+
+const char *page_compression_name(PageCompression compression);
+bool page_compression_from_name(const char *name, PageCompression &compression);
+bool page_compression_supported(PageCompression compression);
+
+/**
+ * 设置新建的表的数据文件使用的压缩算法，table_name为空时设置默认值。索引文件不压缩
+ */
+void assign_table_page_compression(const char *table_name, PageCompression compression);
+PageCompression theTablePageCompression(const char *table_name);
+
+/**
+ * 压缩文件的页面映射。
+ * 文件头页不压缩，仍然在文件开头；其它页面压缩之后按照PAGE_MAP_SECTOR对齐保存在文件中的任意位置，
+ * 页号到位置的映射保存在"文件名.pmap"中：文件头之后每个页面一项，页面位置变化时只写对应的一项。
+ * 页面重写之后放得下时原地覆盖，否则换一个更大的空间，原来的空间留给其它页面使用
+ */
+class PageMap {
+public:
+  static const int PAGE_MAP_SECTOR = 512;
+
+  ~PageMap();
+
+  static std::string map_file_name(const char *file_name);
+  static bool exists(const char *file_name);
+  static RC create(const char *file_name, PageCompression compression, int page_size);
+
+  /**
+   * @param data_fd 数据文件，不能使用O_DIRECT打开
+   */
+  RC open(const char *file_name, int data_fd);
+  void close();
+
+  PageCompression compression() const
+  {
+    return compression_;
+  }
+  int page_size() const
+  {
+    return page_size_;
+  }
+  /**
+   * 映射中记录过的最大页号加1
+   */
+  PageNum page_count();
+
+  /**
+   * 读取并解压一个页面，没有写过的页面返回全0
+   * @param decompress_ns 返回解压用的时间，没有压缩的页面返回0
+   */
+  RC read_page(PageNum page_num, char *page, uint64_t *decompress_ns);
+  /**
+   * 压缩并写入一个页面
+   * @param stored_size 返回页面在文件中占用的大小
+   */
+  RC write_page(PageNum page_num, const char *page, int *stored_size);
+
+private:
+  struct Entry {
+    uint64_t offset = 0;
+    uint32_t length = 0;    // 压缩后的长度，等于页面大小时没有压缩，0表示还没有写过
+    uint32_t capacity = 0;  // 占用的空间，PAGE_MAP_SECTOR的整数倍
+  };
+
+  uint64_t allocate_space(uint32_t capacity);
+  void free_space(uint64_t offset, uint32_t capacity);
+
+private:
+  std::string file_name_;
+  int data_fd_ = -1;
+  int map_fd_ = -1;
+  int page_size_ = 0;
+  PageCompression compression_ = PageCompression::NONE;
+
+  std::mutex mutex_;  // 保护下面的成员
+  std::vector<Entry> entries_;
+  std::multimap<uint32_t, uint64_t> free_spaces_;  // 空闲空间的大小 -> 位置
+  uint64_t file_end_ = 0;
+};
+
+#endif  // __OBSERVER_STORAGE_DEFAULT_PAGE_MAP_H_
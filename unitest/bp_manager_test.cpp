@@ -15,35 +15,28 @@ See the Mulan PSL v2 for more details. */
 #include "storage/default/disk_buffer_pool.h"
 #include "gtest/gtest.h"
 
+#include <thread>
+
 TEST(test_bp_manager, test_bp_manager_simple_lru) {
   BPManager bp_manager(2);
 
-  Frame * frame1 = bp_manager.alloc();
+  Frame * frame1 = bp_manager.alloc(0, 1);
   ASSERT_NE(frame1, nullptr);
 
-  frame1->file_desc = 0;
-  frame1->page.page_num = 1;
-
   ASSERT_EQ(frame1, bp_manager.get(0, 1));
 
-  Frame *frame2 = bp_manager.alloc();
+  Frame *frame2 = bp_manager.alloc(0, 2);
   ASSERT_NE(frame2, nullptr);
-  frame2->file_desc = 0;
-  frame2->page.page_num = 2;
 
   ASSERT_EQ(frame1, bp_manager.get(0, 1));
 
-  Frame *frame3 = bp_manager.alloc();
+  Frame *frame3 = bp_manager.alloc(0, 3);
   ASSERT_NE(frame3, nullptr);
-  frame3->file_desc = 0;
-  frame3->page.page_num = 3;
 
   frame2 = bp_manager.get(0, 2);
   ASSERT_EQ(frame2, nullptr);
 
-  Frame *frame4 = bp_manager.alloc();
-  frame4->file_desc = 0;
-  frame4->page.page_num = 4;
+  Frame *frame4 = bp_manager.alloc(0, 4);
 
   frame1 = bp_manager.get(0, 1);
   ASSERT_EQ(frame1, nullptr);
@@ -55,6 +48,151 @@ TEST(test_bp_manager, test_bp_manager_simple_lru) {
   ASSERT_NE(frame4, nullptr);
 }
 
+TEST(test_bp_manager, test_bp_manager_page_table) {
+  BPManager bp_manager(2);
+
+  Frame *frame1 = bp_manager.alloc(0, 1);
+  Frame *frame2 = bp_manager.alloc(1, 1);
+  ASSERT_NE(frame1, frame2);
+  ASSERT_EQ(frame1, bp_manager.get(0, 1));
+  ASSERT_EQ(frame2, bp_manager.get(1, 1));
+
+  // 脏页或者被固定的页不会被淘汰
+  frame1->dirty = true;
+  frame2->pin_count = 1;
+  ASSERT_EQ(nullptr, bp_manager.alloc(0, 2));
+  ASSERT_EQ(frame1, bp_manager.find_victim());
+
+  frame1->dirty = false;
+  bp_manager.free(frame1);
+  ASSERT_EQ(nullptr, bp_manager.get(0, 1));
+  ASSERT_EQ(1, (int)bp_manager.find_list(1).size());
+
+  Frame *frame3 = bp_manager.alloc(0, 2);
+  ASSERT_EQ(frame1, frame3);
+  ASSERT_EQ(frame3, bp_manager.get(0, 2));
+}
+
+TEST(test_bp_manager, test_bp_manager_page_arena) {
+  BPManager bp_manager(8);
+  ASSERT_EQ(8, bp_manager.size);
+
+  for (int i = 0; i < bp_manager.size; i++) {
+    Frame *frame = bp_manager.alloc(0, i);
+    ASSERT_NE(frame, nullptr);
+    ASSERT_EQ(0, (int)((uintptr_t)frame->page % BP_PAGE_SIZE));
+    ASSERT_EQ(i, frame->page->page_num);
+  }
+}
+
+TEST(test_bp_manager, test_bp_manager_clock) {
+  BPManager bp_manager(3, BPReplacePolicy::CLOCK);
+
+  Frame *frame1 = bp_manager.alloc(0, 1);
+  Frame *frame2 = bp_manager.alloc(0, 2);
+  Frame *frame3 = bp_manager.alloc(0, 3);
+  ASSERT_NE(frame3, nullptr);
+
+  // 第一圈清除所有的访问位，淘汰第一个页面
+  Frame *frame4 = bp_manager.alloc(0, 4);
+  ASSERT_EQ(frame1, frame4);
+  ASSERT_EQ(nullptr, bp_manager.get(0, 1));
+
+  // 页面2被访问过，跳过它淘汰页面3
+  ASSERT_EQ(frame2, bp_manager.get(0, 2));
+  Frame *frame5 = bp_manager.alloc(0, 5);
+  ASSERT_EQ(frame3, frame5);
+  ASSERT_EQ(nullptr, bp_manager.get(0, 3));
+  ASSERT_EQ(frame2, bp_manager.get(0, 2));
+}
+
+TEST(test_bp_manager, test_bp_manager_2q_scan_resistant) {
+  const int pool_size = 8;
+  BPManager bp_manager(pool_size, BPReplacePolicy::TWO_Q);
+
+  // 热点页面第一次加载后很快被淘汰，再次加载时进入Am
+  ASSERT_NE(nullptr, bp_manager.alloc(0, 100));
+  for (int i = 0; i < pool_size; i++) {
+    ASSERT_NE(nullptr, bp_manager.alloc(1, i));
+  }
+  ASSERT_EQ(nullptr, bp_manager.get(0, 100));
+  ASSERT_NE(nullptr, bp_manager.alloc(0, 100));
+
+  // 一次大的扫描不会把热点页面冲掉
+  for (int i = 0; i < 100 * pool_size; i++) {
+    ASSERT_NE(nullptr, bp_manager.alloc(2, i));
+  }
+  ASSERT_NE(nullptr, bp_manager.get(0, 100));
+
+  // 同样的访问序列，LRU会淘汰热点页面
+  BPManager lru_manager(pool_size, BPReplacePolicy::LRU);
+  ASSERT_NE(nullptr, lru_manager.alloc(0, 100));
+  for (int i = 0; i < 100 * pool_size; i++) {
+    ASSERT_NE(nullptr, lru_manager.alloc(2, i));
+  }
+  ASSERT_EQ(nullptr, lru_manager.get(0, 100));
+}
+
+TEST(test_bp_manager, test_bp_manager_statistics) {
+  BPManager bp_manager(2);
+
+  bp_manager.alloc(0, 1);
+  bp_manager.alloc(0, 2);
+  bp_manager.alloc(0, 3);
+  ASSERT_EQ(1, (int)bp_manager.evict_count());
+
+  bp_manager.get(0, 2);
+  bp_manager.get(0, 3);
+  bp_manager.get(0, 1);
+  bp_manager.find(0, 1);
+  ASSERT_EQ(2, (int)bp_manager.hit_count());
+  ASSERT_EQ(1, (int)bp_manager.miss_count());
+}
+
+TEST(test_bp_manager, test_bp_manager_concurrent_pin) {
+  const int pool_size = 16;
+  const int page_num = 64;
+  const int thread_num = 4;
+  BPManager bp_manager(pool_size, BPReplacePolicy::CLOCK);
+  std::atomic<int> errors(0);
+
+  auto worker = [&](int seed) {
+    for (int i = 0; i < 5000; i++) {
+      PageNum page = (seed * 7 + i * 13) % page_num;
+      Frame *frame = bp_manager.pin(0, page);
+      if (frame == nullptr) {
+        RC rc = bp_manager.alloc(0, page, [page](Frame *f) {
+          f->page->data[0] = (char)page;
+          return RC::SUCCESS;
+        }, &frame);
+        if (rc != RC::SUCCESS) {
+          continue;  // 所有的帧都被pin住了
+        }
+      }
+
+      pthread_rwlock_rdlock(&frame->latch);
+      if (frame->page->page_num != page || frame->page->data[0] != (char)page) {
+        errors++;
+      }
+      pthread_rwlock_unlock(&frame->latch);
+      frame->pin_count--;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, errors.load());
+
+  for (int i = 0; i < pool_size; i++) {
+    ASSERT_EQ(0, (int)bp_manager.frame[i].pin_count);
+  }
+}
+
 int main(int argc, char **argv) {
 
 
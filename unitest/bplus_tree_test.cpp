@@ -0,0 +1,329 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/common/bplus_tree.h"
+#include "storage/default/disk_buffer_pool.h"
+
+static const char *TEST_FILE = "bplus_tree_test.index";
+
+static RID make_rid(int value)
+{
+  RID rid;
+  rid.page_num = value / 100 + 1;
+  rid.slot_num = value % 100;
+  return rid;
+}
+
+// 返回扫描到的大于等于from的项数，扫描结果必须有序
+static int scan_from(BplusTreeHandler &handler, int from)
+{
+  BplusTreeScanner scanner(handler);
+  if (scanner.open(GREAT_EQUAL, (const char *)&from) != RC::SUCCESS) {
+    return -1;
+  }
+  int count = 0;
+  RID rid;
+  RID last_rid = make_rid(from);
+  RC rc;
+  while ((rc = scanner.next_entry(&rid)) == RC::SUCCESS) {
+    if (count > 0 && (rid.page_num < last_rid.page_num ||
+                      (rid.page_num == last_rid.page_num && rid.slot_num <= last_rid.slot_num))) {
+      count = -1;
+      break;
+    }
+    last_rid = rid;
+    count++;
+  }
+  scanner.close();
+  return rc == RC::RECORD_EOF ? count : -1;
+}
+
+TEST(test_bplus_tree, test_insert_delete_scan) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  const int count = 20000;
+  {
+    BplusTreeHandler handler(false);
+    ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, INTS, sizeof(int), &buffer_pool));
+    for (int i = 0; i < count; i++) {
+      RID rid = make_rid(i);
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&i, &rid));
+    }
+    ASSERT_EQ(count, scan_from(handler, 0));
+    ASSERT_EQ(count - 1000, scan_from(handler, 1000));
+
+    for (int i = 0; i < count; i += 2) {
+      RID rid = make_rid(i);
+      ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&i, &rid));
+    }
+    RID rid = make_rid(2);
+    int value = 2;
+    ASSERT_EQ(RC::RECORD_INVALID_KEY, handler.delete_entry((const char *)&value, &rid));
+    ASSERT_EQ(count / 2, scan_from(handler, 0));
+    for (int i = 0; i < 100; i++) {
+      RID rid = make_rid(i);
+      ASSERT_EQ(i % 2 == 0 ? RC::RECORD_INVALID_KEY : RC::SUCCESS, handler.get_entry((const char *)&i, &rid));
+    }
+    ASSERT_EQ(RC::SUCCESS, handler.close());
+  }
+  unlink(TEST_FILE);
+}
+
+TEST(test_bplus_tree, test_composite_key) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  BplusTreeHandler handler(false);
+  const AttrType attr_types[] = {INTS, CHARS};
+  const int attr_lengths[] = {sizeof(int), 8};
+  ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, 2, attr_types, attr_lengths, &buffer_pool));
+
+  // key = (i % 10, "v%03d" i / 10)
+  const int count = 2000;
+  for (int i = 0; i < count; i++) {
+    char key[sizeof(int) + 8] = {0};
+    *(int *)key = i % 10;
+    snprintf(key + sizeof(int), 8, "v%03d", i / 10);
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(key, &rid));
+  }
+
+  char value[sizeof(int) + 8] = {0};
+  *(int *)value = 3;
+  snprintf(value + sizeof(int), 8, "v%03d", 150);
+
+  // 第一列相等
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(EQUAL_TO, value, 1));
+  int num = 0;
+  RID rid;
+  while (scanner.next_entry(&rid) == RC::SUCCESS) {
+    ASSERT_EQ(3, ((rid.page_num - 1) * 100 + rid.slot_num) % 10);
+    num++;
+  }
+  scanner.close();
+  ASSERT_EQ(count / 10, num);
+
+  // 第一列相等，第二列范围
+  const CompOp ops[] = {GREAT_EQUAL, GREAT_THAN, LESS_THAN, LESS_EQUAL, EQUAL_TO};
+  const int expects[] = {50, 49, 150, 151, 1};
+  for (int i = 0; i < 5; i++) {
+    BplusTreeScanner range_scanner(handler);
+    ASSERT_EQ(RC::SUCCESS, range_scanner.open(ops[i], value, 2));
+    num = 0;
+    while (range_scanner.next_entry(&rid) == RC::SUCCESS) {
+      int v = (rid.page_num - 1) * 100 + rid.slot_num;
+      ASSERT_EQ(3, v % 10);
+      num++;
+    }
+    range_scanner.close();
+    ASSERT_EQ(expects[i], num);
+  }
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  unlink(TEST_FILE);
+}
+
+TEST(test_bplus_tree, test_unique_chars_key) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  BplusTreeHandler handler(true);
+  ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, CHARS, 8, &buffer_pool));
+
+  // 乱序插入，节点内二分查找插入的位置
+  const int count = 5000;
+  for (int i = 0; i < count; i++) {
+    int v = (i * 7919) % count;
+    char key[8] = {0};
+    snprintf(key, sizeof(key), "k%05d", v);
+    RID rid = make_rid(v);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(key, &rid));
+  }
+  char key[8] = {0};
+  snprintf(key, sizeof(key), "k%05d", 1234);
+  RID rid = make_rid(count);
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry(key, &rid));
+
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(GREAT_THAN, key));
+  int expect = 1235;
+  while (scanner.next_entry(&rid) == RC::SUCCESS) {
+    ASSERT_EQ(expect, (rid.page_num - 1) * 100 + rid.slot_num);
+    expect++;
+  }
+  scanner.close();
+  ASSERT_EQ(count, expect);
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  unlink(TEST_FILE);
+}
+
+TEST(test_bplus_tree, test_range_scan) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  BplusTreeHandler handler(false);
+  ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, INTS, sizeof(int), &buffer_pool));
+  const int count = 10000;
+  for (int i = 0; i < count; i++) {
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&i, &rid));
+  }
+
+  // 1000 <= key < 2000, 1000 < key <= 2000 ...
+  const int left = 1000;
+  const int right = 2000;
+  for (int i = 0; i < 4; i++) {
+    const bool left_inclusive = i & 1;
+    const bool right_inclusive = i & 2;
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open((const char *)&left, 1, left_inclusive, (const char *)&right, 1,
+                                        right_inclusive));
+    int expect = left_inclusive ? left : left + 1;
+    RID rid;
+    RC rc;
+    while ((rc = scanner.next_entry(&rid)) == RC::SUCCESS) {
+      ASSERT_EQ(expect, (rid.page_num - 1) * 100 + rid.slot_num);
+      expect++;
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(right_inclusive ? right + 1 : right, expect);
+    scanner.close();
+  }
+
+  // 只有上界
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, (const char *)&left, 1, false));
+  int num = 0;
+  RID rid;
+  while (scanner.next_entry(&rid) == RC::SUCCESS) {
+    num++;
+  }
+  scanner.close();
+  ASSERT_EQ(left, num);
+
+  // 空范围
+  ASSERT_EQ(RC::SUCCESS, scanner.open((const char *)&right, 1, true, (const char *)&left, 1, true));
+  ASSERT_EQ(RC::RECORD_EOF, scanner.next_entry(&rid));
+  scanner.close();
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  unlink(TEST_FILE);
+}
+
+TEST(test_bplus_tree, test_scan_with_delete) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  BplusTreeHandler handler(false);
+  ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, INTS, sizeof(int), &buffer_pool));
+  const int count = 10000;
+  for (int i = 0; i < count; i++) {
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&i, &rid));
+  }
+
+  // 两次next_entry之间不固定页面，扫描中的叶子节点可以被合并释放
+  BplusTreeScanner scanner(handler);
+  int zero = 0;
+  ASSERT_EQ(RC::SUCCESS, scanner.open(GREAT_EQUAL, (const char *)&zero));
+  RID rid;
+  int expect = 0;
+  for (; expect < 100; expect++) {
+    ASSERT_EQ(RC::SUCCESS, scanner.next_entry(&rid));
+    ASSERT_EQ(expect, (rid.page_num - 1) * 100 + rid.slot_num);
+  }
+
+  // 只留下10的倍数
+  for (int i = 0; i < count; i++) {
+    if (i % 10 != 0) {
+      RID rid = make_rid(i);
+      ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&i, &rid));
+    }
+  }
+  RC rc;
+  for (expect = 100; (rc = scanner.next_entry(&rid)) == RC::SUCCESS; expect += 10) {
+    ASSERT_EQ(expect, (rid.page_num - 1) * 100 + rid.slot_num);
+    // 删除刚返回的项，扫描要从下一项继续
+    int value = expect;
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry((const char *)&value, &rid));
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(count, expect);
+  scanner.close();
+  ASSERT_EQ(10, scan_from(handler, 0));
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  unlink(TEST_FILE);
+}
+
+TEST(test_bplus_tree, test_concurrent_access) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(256);
+  BplusTreeHandler handler(false);
+  ASSERT_EQ(RC::SUCCESS, handler.create(TEST_FILE, INTS, sizeof(int), &buffer_pool));
+
+  const int thread_count = 4;
+  const int count_per_thread = 10000;
+  std::atomic<bool> failed(false);
+  std::atomic<bool> stop(false);
+
+  // 插入的同时扫描，扫描结果必须有序
+  std::thread reader([&]() {
+    while (!stop) {
+      if (scan_from(handler, 0) < 0) {
+        failed = true;
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (int t = 0; t < thread_count; t++) {
+    writers.emplace_back([&, t]() {
+      for (int i = t; i < thread_count * count_per_thread; i += thread_count) {
+        RID rid = make_rid(i);
+        if (handler.insert_entry((const char *)&i, &rid) != RC::SUCCESS) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+  stop = true;
+  reader.join();
+  ASSERT_FALSE(failed);
+  ASSERT_EQ(thread_count * count_per_thread, scan_from(handler, 0));
+
+  // 删除一半，剩下的都能找到
+  writers.clear();
+  for (int t = 0; t < thread_count; t++) {
+    writers.emplace_back([&, t]() {
+      for (int i = t * 2; i < thread_count * count_per_thread; i += thread_count * 2) {
+        RID rid = make_rid(i);
+        if (handler.delete_entry((const char *)&i, &rid) != RC::SUCCESS) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+  ASSERT_FALSE(failed);
+  ASSERT_EQ(thread_count * count_per_thread / 2, scan_from(handler, 0));
+  for (int i = 1; i < thread_count * count_per_thread; i += 2) {
+    RID rid = make_rid(i);
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry((const char *)&i, &rid));
+  }
+  ASSERT_EQ(RC::SUCCESS, handler.close());
+  unlink(TEST_FILE);
+}
@@ -0,0 +1,734 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "storage/default/disk_buffer_pool.h"
+
+static const char *TEST_FILE = "disk_buffer_pool_test.data";
+
+static bool read_page(const char *file_name, PageNum page_num, Page *page)
+{
+  int fd = open(file_name, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  ssize_t ret = pread(fd, page, sizeof(Page), (off_t)page_num * sizeof(Page));
+  close(fd);
+  return ret == sizeof(Page);
+}
+
+TEST(test_disk_buffer_pool, test_dirty_list) {
+  BPManager bp_manager(4);
+
+  Frame *frame1 = bp_manager.alloc(0, 1);
+  Frame *frame2 = bp_manager.alloc(0, 2);
+  bp_manager.mark_dirty(frame2);
+  bp_manager.mark_dirty(frame1);
+  bp_manager.mark_dirty(frame1);
+  ASSERT_EQ(2, bp_manager.dirty_count());
+
+  std::vector<uint64_t> dirty_list = bp_manager.take_dirty_list();
+  ASSERT_EQ(2, (int)dirty_list.size());
+  ASSERT_EQ(BPManager::page_key(0, 2), dirty_list[0]);
+  ASSERT_EQ(BPManager::page_key(0, 1), dirty_list[1]);
+  ASSERT_TRUE(bp_manager.take_dirty_list().empty());
+
+  ASSERT_TRUE(bp_manager.clear_dirty(frame1));
+  ASSERT_FALSE(bp_manager.clear_dirty(frame1));
+  bp_manager.free(frame2);
+  ASSERT_EQ(0, bp_manager.dirty_count());
+}
+
+TEST(test_disk_buffer_pool, test_free_if_unpinned) {
+  BPManager bp_manager(4);
+
+  Frame *frame = bp_manager.alloc(0, 1);
+  ASSERT_EQ(frame, bp_manager.pin(0, 1, false));
+  ASSERT_EQ(RC::BUFFERPOOL_PAGE_PINNED, bp_manager.free_if_unpinned(0, 1, true));
+  ASSERT_EQ(frame, bp_manager.find(0, 1));
+
+  // 脏页只有discard_dirty为true时才释放
+  frame->pin_count--;
+  bp_manager.mark_dirty(frame);
+  ASSERT_EQ(RC::BUFFERPOOL_PAGE_PINNED, bp_manager.free_if_unpinned(0, 1, false));
+  ASSERT_EQ(RC::SUCCESS, bp_manager.free_if_unpinned(0, 1, true));
+  ASSERT_EQ(nullptr, bp_manager.find(0, 1));
+  ASSERT_EQ(0, bp_manager.dirty_count());
+  ASSERT_EQ(RC::SUCCESS, bp_manager.free_if_unpinned(0, 1, true));
+}
+
+TEST(test_disk_buffer_pool, test_background_flusher) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(16, BPReplacePolicy::LRU, 2);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  const int page_count = 8;
+  PageNum page_nums[page_count];
+  for (int i = 0; i < page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    buffer_pool.get_page_num(&page_handle, &page_nums[i]);
+    char *data = nullptr;
+    buffer_pool.get_data(&page_handle, &data);
+    page_handle.wlatch();
+    snprintf(data, 32, "page %d", page_nums[i]);
+    buffer_pool.mark_dirty(&page_handle);
+    page_handle.wunlatch();
+    buffer_pool.unpin_page(&page_handle);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.start_flusher(10, 0));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  buffer_pool.stop_flusher();
+
+  ASSERT_EQ(0, buffer_pool.bp_manager().dirty_count());
+  for (int i = 0; i < page_count; i++) {
+    Page page;
+    ASSERT_TRUE(read_page(TEST_FILE, page_nums[i], &page));
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", page_nums[i]);
+    ASSERT_STREQ(expected, page.data);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_read_ahead) {
+  unlink(TEST_FILE);
+  const int page_count = 64;
+  {
+    DiskBufferPool buffer_pool(16);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    for (int i = 0; i < page_count; i++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.unpin_page(&page_handle));
+    }
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  DiskBufferPool buffer_pool(32, BPReplacePolicy::LRU, 2);
+  buffer_pool.set_read_ahead(8);
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  for (int i = 1; i <= page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, i, &page_handle));
+    PageNum page_num = -1;
+    buffer_pool.get_page_num(&page_handle, &page_num);
+    ASSERT_EQ(i, page_num);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.unpin_page(&page_handle));
+  }
+
+  // 预读是异步的，前台可能先读到了页面，但是大部分页面应该被预读命中
+  const BPManager &bp_manager = buffer_pool.bp_manager();
+  ASSERT_GT(bp_manager.prefetch_count(), 0u);
+  ASSERT_GT(bp_manager.prefetch_hit_count(), 0u);
+  ASSERT_LT(bp_manager.miss_count(), (uint64_t)page_count / 2);
+
+  // 随机访问不触发预读
+  uint64_t prefetch_count = bp_manager.prefetch_count();
+  PageNum random_pages[] = {10, 3, 40, 7, 22};
+  for (PageNum page_num : random_pages) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, page_num, &page_handle));
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.unpin_page(&page_handle));
+  }
+  ASSERT_EQ(prefetch_count, bp_manager.prefetch_count());
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_direct_io) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(8);
+  buffer_pool.set_direct_io(true);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  // 页面比帧多，会发生淘汰，读写都经过O_DIRECT
+  const int page_count = 32;
+  for (int i = 0; i < page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    ASSERT_EQ(0, (uintptr_t)page_handle.frame->page % BP_PAGE_SIZE);
+    PageNum page_num = -1;
+    buffer_pool.get_page_num(&page_handle, &page_num);
+    char *data = nullptr;
+    buffer_pool.get_data(&page_handle, &data);
+    snprintf(data, 32, "page %d", page_num);
+    buffer_pool.mark_dirty(&page_handle);
+    buffer_pool.unpin_page(&page_handle);
+  }
+  for (int i = 1; i <= page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, i, &page_handle));
+    char *data = nullptr;
+    buffer_pool.get_data(&page_handle, &data);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    ASSERT_STREQ(expected, data);
+    buffer_pool.unpin_page(&page_handle);
+  }
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+
+  Page page;
+  ASSERT_TRUE(read_page(TEST_FILE, page_count, &page));
+  char expected[32];
+  snprintf(expected, sizeof(expected), "page %d", page_count);
+  ASSERT_STREQ(expected, page.data);
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_page_size) {
+  const char *small_file = "disk_buffer_pool_test_4k.data";
+  unlink(TEST_FILE);
+  unlink(small_file);
+
+  // 16K是默认页面大小，分到大部分内存
+  DiskBufferPool buffer_pool(64, BPReplacePolicy::LRU, 0, 16384);
+  ASSERT_NE(RC::SUCCESS, buffer_pool.create_file(TEST_FILE, 12345));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE, 16384));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(small_file, BP_PAGE_SIZE));
+
+  int file_id = -1;
+  int small_file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(small_file, &small_file_id));
+  int data_size = 0;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_page_data_size(file_id, &data_size));
+  ASSERT_EQ(BP_PAGE_DATA_SIZE_OF(16384), data_size);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_page_data_size(small_file_id, &data_size));
+  ASSERT_EQ((int)BP_PAGE_DATA_SIZE, data_size);
+
+  // 两种页面大小的帧加起来不超过64个BP_PAGE_SIZE
+  std::vector<const BPManager *> bp_managers = buffer_pool.bp_managers();
+  ASSERT_EQ(2UL, bp_managers.size());
+  int64_t total_bytes = 0;
+  for (const BPManager *bp_manager : bp_managers) {
+    total_bytes += (int64_t)bp_manager->size * bp_manager->page_size();
+  }
+  ASSERT_LE(total_bytes, 64 * BP_PAGE_SIZE);
+  ASSERT_GT((int64_t)bp_managers[1]->size * 16384, (int64_t)bp_managers[0]->size * BP_PAGE_SIZE);
+
+  // 在页面的末尾写数据，页面比帧多，会发生淘汰
+  const int page_count = 40;
+  int tail = BP_PAGE_DATA_SIZE_OF(16384) - 32;
+  for (int i = 0; i < page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    PageNum page_num = -1;
+    buffer_pool.get_page_num(&page_handle, &page_num);
+    char *data = nullptr;
+    buffer_pool.get_data(&page_handle, &data);
+    snprintf(data + tail, 32, "page %d", page_num);
+    buffer_pool.mark_dirty(&page_handle);
+    buffer_pool.unpin_page(&page_handle);
+
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(small_file_id, &page_handle));
+    buffer_pool.unpin_page(&page_handle);
+  }
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  for (int i = 1; i <= page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, i, &page_handle));
+    char *data = nullptr;
+    buffer_pool.get_data(&page_handle, &data);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    ASSERT_STREQ(expected, data + tail);
+    buffer_pool.unpin_page(&page_handle);
+  }
+  struct stat st;
+  ASSERT_EQ(0, stat(TEST_FILE, &st));
+  ASSERT_EQ(16384 * (page_count + 1), st.st_size);
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(small_file_id));
+  unlink(TEST_FILE);
+  unlink(small_file);
+}
+
+TEST(test_disk_buffer_pool, test_free_page_groups) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  // 分配的页面超过文件头位图的范围，第二组的第一个页面留给位图
+  const int group_pages = BP_GROUP_PAGES_OF(BP_PAGE_SIZE);
+  const int page_count = group_pages + 16;
+  BPPageHandle page_handle;
+  PageNum page_num = -1;
+  for (int i = 1; i < page_count; i++) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    buffer_pool.get_page_num(&page_handle, &page_num);
+    ASSERT_EQ(i < group_pages ? i : i + 1, page_num);
+    buffer_pool.unpin_page(&page_handle);
+  }
+  ASSERT_NE(RC::SUCCESS, buffer_pool.get_this_page(file_id, group_pages, &page_handle));
+  ASSERT_NE(RC::SUCCESS, buffer_pool.dispose_page(file_id, group_pages));
+
+  // 释放的页面按页号从小到大重新分配，之后再扩展文件
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.dispose_page(file_id, group_pages + 5));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.dispose_page(file_id, 3));
+  ASSERT_NE(RC::SUCCESS, buffer_pool.get_this_page(file_id, group_pages + 5, &page_handle));
+  const PageNum expected[] = {3, group_pages + 5, page_count + 1};
+  for (PageNum expected_page_num : expected) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+    buffer_pool.get_page_num(&page_handle, &page_num);
+    ASSERT_EQ(expected_page_num, page_num);
+    buffer_pool.unpin_page(&page_handle);
+  }
+
+  // 第二组的位图重新打开之后仍然有效
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.dispose_page(file_id, group_pages + 7));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  int file_page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_page_count(file_id, &file_page_count));
+  ASSERT_EQ(page_count + 2, file_page_count);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, group_pages + 5, &page_handle));
+  buffer_pool.unpin_page(&page_handle);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+  buffer_pool.get_page_num(&page_handle, &page_num);
+  ASSERT_EQ(group_pages + 7, page_num);
+  buffer_pool.unpin_page(&page_handle);
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_mmap_read) {
+  unlink(TEST_FILE);
+  const int page_count = 8;
+  {
+    DiskBufferPool buffer_pool(16);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    for (int i = 0; i < page_count; i++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+      snprintf(page_handle.frame->page->data, 32, "page %d", page_handle.frame->page->page_num);
+      buffer_pool.mark_dirty(&page_handle);
+      buffer_pool.unpin_page(&page_handle);
+    }
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  DiskBufferPool buffer_pool(16);
+  buffer_pool.set_mmap_read(true);
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  // 不在缓冲区中的页面直接读映射，不占用帧
+  for (int i = 1; i <= page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, i, &page_handle));
+    ASSERT_TRUE(page_handle.mapped);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    ASSERT_STREQ(expected, page_handle.frame->page->data);
+    ASSERT_EQ(RC::READONLY, buffer_pool.mark_dirty(&page_handle));
+    buffer_pool.unpin_page(&page_handle);
+  }
+  ASSERT_EQ((uint64_t)page_count, buffer_pool.mmap_read_count());
+  ASSERT_EQ(0UL, buffer_pool.bp_manager().miss_count());
+
+  // 缓冲区中还没有刷盘的修改优先
+  BPPageHandle page_handle;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, 3, &page_handle));
+  snprintf(page_handle.frame->page->data, 32, "modified");
+  buffer_pool.mark_dirty(&page_handle);
+  buffer_pool.unpin_page(&page_handle);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, 3, &page_handle));
+  ASSERT_FALSE(page_handle.mapped);
+  ASSERT_STREQ("modified", page_handle.frame->page->data);
+  buffer_pool.unpin_page(&page_handle);
+
+  // 刷盘之后的修改和新分配的页面在映射中可见
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.flush_all_pages(file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+  PageNum new_page_num = page_handle.frame->page->page_num;
+  buffer_pool.unpin_page(&page_handle);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, 3, &page_handle));
+  ASSERT_TRUE(page_handle.mapped);
+  ASSERT_STREQ("modified", page_handle.frame->page->data);
+  buffer_pool.unpin_page(&page_handle);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, new_page_num, &page_handle));
+  ASSERT_TRUE(page_handle.mapped);
+  buffer_pool.unpin_page(&page_handle);
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_mmap_read_concurrent_flush) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(16);
+  buffer_pool.set_mmap_read(true);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  BPPageHandle page_handle;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+  const PageNum page_num = page_handle.frame->page->page_num;
+  memset(page_handle.frame->page->data, 0, BP_PAGE_DATA_SIZE);
+  buffer_pool.mark_dirty(&page_handle);
+  buffer_pool.unpin_page(&page_handle);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.force_page(file_id, page_num));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, page_num, &page_handle));
+  ASSERT_TRUE(page_handle.mapped);
+  buffer_pool.unpin_page(&page_handle);
+
+  // 写线程不断修改整个页面并刷盘，读线程读到的页面必须是完整的某一个版本
+  std::atomic<bool> stop(false);
+  std::thread writer([&]() {
+    for (int i = 1; i <= 2000; i++) {
+      BPPageHandle handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, page_num, &handle));
+      handle.wlatch();
+      memset(handle.frame->page->data, i & 0xff, BP_PAGE_DATA_SIZE);
+      handle.wunlatch();
+      buffer_pool.mark_dirty(&handle);
+      buffer_pool.unpin_page(&handle);
+      buffer_pool.force_page(file_id, page_num);
+    }
+    stop = true;
+  });
+
+  while (!stop) {
+    BPPageHandle handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, page_num, &handle));
+    handle.rlatch();
+    const char *data = handle.frame->page->data;
+    for (int i = 1; i < (int)BP_PAGE_DATA_SIZE; i++) {
+      ASSERT_EQ(data[0], data[i]);
+    }
+    handle.runlatch();
+    buffer_pool.unpin_page(&handle);
+  }
+  writer.join();
+  ASSERT_EQ(0UL, buffer_pool.checksum_failure_count());
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_page_checksum) {
+  unlink(TEST_FILE);
+  const int page_count = 4;
+  {
+    DiskBufferPool buffer_pool(16);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    for (int i = 0; i < page_count; i++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+      snprintf(page_handle.frame->page->data, 32, "page %d", page_handle.frame->page->page_num);
+      buffer_pool.mark_dirty(&page_handle);
+      buffer_pool.unpin_page(&page_handle);
+    }
+
+    // checksum只写在刷盘的副本中，不修改缓冲区中的页面
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, 1, &page_handle));
+    page_handle.frame->page->checksum = 0;
+    buffer_pool.mark_dirty(&page_handle);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.flush_all_pages(file_id));
+    ASSERT_EQ(0U, page_handle.frame->page->checksum);
+    buffer_pool.unpin_page(&page_handle);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  std::vector<PageNum> corrupted_pages;
+  ASSERT_EQ(RC::SUCCESS, DiskBufferPool::verify_file(TEST_FILE, corrupted_pages));
+  ASSERT_TRUE(corrupted_pages.empty());
+
+  // 模拟写了一半的页面
+  Page page;
+  ASSERT_TRUE(read_page(TEST_FILE, 2, &page));
+  memset(page.data + sizeof(page.data) / 2, 0x5a, sizeof(page.data) / 2);
+  int fd = open(TEST_FILE, O_WRONLY);
+  ASSERT_EQ((ssize_t)sizeof(Page), pwrite(fd, &page, sizeof(Page), 2 * sizeof(Page)));
+  close(fd);
+  ASSERT_EQ(RC::SUCCESS, DiskBufferPool::verify_file(TEST_FILE, corrupted_pages));
+  ASSERT_EQ(std::vector<PageNum>{2}, corrupted_pages);
+
+  for (bool mmap_read : {false, true}) {
+    DiskBufferPool buffer_pool(16);
+    buffer_pool.set_mmap_read(mmap_read);
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, 1, &page_handle));
+    ASSERT_STREQ("page 1", page_handle.frame->page->data);
+    buffer_pool.unpin_page(&page_handle);
+    ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, buffer_pool.get_readonly_page(file_id, 2, &page_handle));
+    ASSERT_EQ(1UL, buffer_pool.checksum_failure_count());
+
+    // 要修改的页面通过缓冲区读取，同样要校验
+    if (!mmap_read) {
+      ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, buffer_pool.get_this_page(file_id, 2, &page_handle));
+      ASSERT_EQ(2UL, buffer_pool.checksum_failure_count());
+    }
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_file_format) {
+  unlink(TEST_FILE);
+  {
+    DiskBufferPool buffer_pool(16);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  }
+
+  // 模拟布局不兼容的旧文件，打开和检查时都要报告文件格式错误
+  Page page;
+  ASSERT_TRUE(read_page(TEST_FILE, 0, &page));
+  ((BPFileSubHeader *)page.data)->format_version = 0;
+  int fd = open(TEST_FILE, O_WRONLY);
+  ASSERT_EQ((ssize_t)sizeof(Page), pwrite(fd, &page, sizeof(Page), 0));
+  close(fd);
+
+  DiskBufferPool buffer_pool(16);
+  int file_id = -1;
+  ASSERT_EQ(RC::BUFFERPOOL_FILEERR, buffer_pool.open_file(TEST_FILE, &file_id));
+  std::vector<PageNum> corrupted_pages;
+  ASSERT_EQ(RC::BUFFERPOOL_FILEERR, DiskBufferPool::verify_file(TEST_FILE, corrupted_pages));
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_page_compression) {
+  if (!page_compression_supported(PageCompression::ZLIB)) {
+    return;
+  }
+  unlink(TEST_FILE);
+  unlink(PageMap::map_file_name(TEST_FILE).c_str());
+  const int page_count = 8;
+  {
+    DiskBufferPool buffer_pool(16);
+    buffer_pool.set_direct_io(true);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE, 0, PageCompression::ZLIB));
+    ASSERT_TRUE(PageMap::exists(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    for (int i = 0; i < page_count; i++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+      snprintf(page_handle.frame->page->data, 32, "page %d", page_handle.frame->page->page_num);
+      buffer_pool.mark_dirty(&page_handle);
+      buffer_pool.unpin_page(&page_handle);
+    }
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.flush_all_pages(file_id));
+    ASSERT_LE((uint64_t)page_count * buffer_pool.bp_manager().page_size(), buffer_pool.compress_raw_bytes());
+    ASSERT_LT(buffer_pool.compress_stored_bytes() * 4, buffer_pool.compress_raw_bytes());
+
+    // 压缩不了的页面原样保存，原来的位置放不下时换一个位置
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, 3, &page_handle));
+    unsigned int seed = 3;
+    for (size_t i = 32; i < sizeof(page_handle.frame->page->data); i++) {
+      page_handle.frame->page->data[i] = (char)rand_r(&seed);
+    }
+    buffer_pool.mark_dirty(&page_handle);
+    buffer_pool.unpin_page(&page_handle);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  std::vector<PageNum> corrupted_pages;
+  ASSERT_EQ(RC::SUCCESS, DiskBufferPool::verify_file(TEST_FILE, corrupted_pages));
+  ASSERT_TRUE(corrupted_pages.empty());
+
+  {
+    DiskBufferPool buffer_pool(16);
+    buffer_pool.set_mmap_read(true);
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    int count = 0;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_page_count(file_id, &count));
+    ASSERT_EQ(page_count + 1, count);
+    for (PageNum page_num = 1; page_num <= page_count; page_num++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.get_readonly_page(file_id, page_num, &page_handle));
+      char expected[32];
+      snprintf(expected, sizeof(expected), "page %d", page_num);
+      ASSERT_STREQ(expected, page_handle.frame->page->data);
+      buffer_pool.unpin_page(&page_handle);
+    }
+    ASSERT_EQ((uint64_t)page_count - 1, buffer_pool.decompress_count());
+    ASSERT_EQ(0UL, buffer_pool.checksum_failure_count());
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  ASSERT_EQ(RC::SUCCESS, DiskBufferPool::remove_file(TEST_FILE));
+  ASSERT_FALSE(PageMap::exists(TEST_FILE));
+  ASSERT_NE(0, access(TEST_FILE, F_OK));
+}
+
+TEST(test_disk_buffer_pool, test_warm_up) {
+  const char *page_list = "disk_buffer_pool_test.pages";
+  unlink(TEST_FILE);
+  unlink(page_list);
+  const int page_count = 20;
+  {
+    DiskBufferPool buffer_pool(32);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+    for (int i = 0; i < page_count; i++) {
+      BPPageHandle page_handle;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool.allocate_page(file_id, &page_handle));
+      buffer_pool.unpin_page(&page_handle);
+    }
+    // 停止时保存页面列表
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.start_page_list_dumper(page_list, 0));
+    buffer_pool.stop_page_list_dumper();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  }
+
+  DiskBufferPool buffer_pool(32, BPReplacePolicy::LRU, 2);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.warm_up("disk_buffer_pool_test.no_such_file"));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.warm_up(page_list));
+  ASSERT_EQ((uint64_t)page_count, buffer_pool.bp_manager().prefetch_count());
+  for (int i = 1; i <= page_count; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.get_this_page(file_id, i, &page_handle));
+    buffer_pool.unpin_page(&page_handle);
+  }
+  ASSERT_EQ(0UL, buffer_pool.bp_manager().miss_count());
+  ASSERT_EQ((uint64_t)page_count, buffer_pool.bp_manager().prefetch_hit_count());
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.close_file(file_id));
+  unlink(TEST_FILE);
+  unlink(page_list);
+}
+
+TEST(test_disk_buffer_pool, test_named_pools) {
+  ASSERT_EQ(RC::SUCCESS, init_named_disk_buffer_pool("index", 16, BPReplacePolicy::LRU, 0));
+  ASSERT_EQ(RC::SUCCESS, init_named_disk_buffer_pool("hot", 8, BPReplacePolicy::LRU, 0));
+  ASSERT_NE(RC::SUCCESS, init_named_disk_buffer_pool("index", 8, BPReplacePolicy::LRU, 0));
+  ASSERT_NE(RC::SUCCESS, init_named_disk_buffer_pool(DEFAULT_BUFFER_POOL_NAME, 8, BPReplacePolicy::LRU, 0));
+  DiskBufferPool *index_pool = theNamedDiskBufferPool("index");
+  DiskBufferPool *hot_pool = theNamedDiskBufferPool("hot");
+  ASSERT_NE(nullptr, index_pool);
+  ASSERT_NE(nullptr, hot_pool);
+  ASSERT_EQ(nullptr, theNamedDiskBufferPool("no_such_pool"));
+  ASSERT_EQ(3, (int)all_disk_buffer_pools().size());
+  ASSERT_EQ(theGlobalDiskBufferPool(), all_disk_buffer_pools()[0].second);
+
+  // 没有单独指定的表使用默认的映射
+  ASSERT_NE(RC::SUCCESS, assign_table_buffer_pool(nullptr, DEFAULT_BUFFER_POOL_NAME, "no_such_pool"));
+  ASSERT_EQ(RC::SUCCESS, assign_table_buffer_pool(nullptr, DEFAULT_BUFFER_POOL_NAME, "index"));
+  ASSERT_EQ(RC::SUCCESS, assign_table_buffer_pool("t_hot", "hot", "hot"));
+  ASSERT_EQ(theGlobalDiskBufferPool(), theTableBufferPool("t", false));
+  ASSERT_EQ(index_pool, theTableBufferPool("t", true));
+  ASSERT_EQ(hot_pool, theTableBufferPool("t_hot", false));
+  ASSERT_EQ(hot_pool, theTableBufferPool("t_hot", true));
+
+  // 各个缓冲池的帧互不影响
+  unlink(TEST_FILE);
+  ASSERT_EQ(RC::SUCCESS, hot_pool->create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, hot_pool->open_file(TEST_FILE, &file_id));
+  for (int i = 0; i < 4; i++) {
+    BPPageHandle page_handle;
+    ASSERT_EQ(RC::SUCCESS, hot_pool->allocate_page(file_id, &page_handle));
+    hot_pool->unpin_page(&page_handle);
+  }
+  ASSERT_GT(hot_pool->bp_manager().dirty_count(), 0);
+  ASSERT_EQ(0, index_pool->bp_manager().dirty_count());
+  ASSERT_EQ(0, theGlobalDiskBufferPool()->bp_manager().dirty_count());
+  ASSERT_EQ(RC::SUCCESS, hot_pool->close_file(file_id));
+  unlink(TEST_FILE);
+}
+
+static void check_page_io(PageIO *page_io)
+{
+  unlink(TEST_FILE);
+  int fd = open(TEST_FILE, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  ASSERT_GE(fd, 0);
+
+  // 每个请求写两个连续的页面
+  const int request_count = 8;
+  Page pages[request_count * 2];
+  struct iovec iov[request_count * 2];
+  PageIORequest requests[request_count];
+  for (int i = 0; i < request_count * 2; i++) {
+    pages[i].page_num = i;
+    snprintf(pages[i].data, 32, "page %d", i);
+    iov[i].iov_base = &pages[i];
+    iov[i].iov_len = sizeof(Page);
+  }
+  for (int i = 0; i < request_count; i++) {
+    requests[i].type = PageIORequest::WRITE;
+    requests[i].fd = fd;
+    requests[i].offset = (off_t)i * 2 * sizeof(Page);
+    requests[i].iov = &iov[i * 2];
+    requests[i].iovcnt = 2;
+  }
+  ASSERT_EQ(RC::SUCCESS, page_io->submit_and_wait(requests, request_count));
+
+  for (int i = request_count * 2 - 1; i >= 0; i--) {
+    Page page;
+    ASSERT_EQ(RC::SUCCESS, page_io->read(fd, (off_t)i * sizeof(Page), &page, sizeof(Page)));
+    ASSERT_EQ(i, page.page_num);
+    ASSERT_STREQ(pages[i].data, page.data);
+  }
+
+  // 读文件末尾之后的页面不完整，算作失败
+  Page page;
+  ASSERT_NE(RC::SUCCESS, page_io->read(fd, (off_t)request_count * 2 * sizeof(Page), &page, sizeof(Page)));
+
+  close(fd);
+  unlink(TEST_FILE);
+}
+
+TEST(test_disk_buffer_pool, test_page_io) {
+  SyncPageIO sync_page_io;
+  check_page_io(&sync_page_io);
+
+  ThreadPoolPageIO thread_pool_page_io(4);
+  check_page_io(&thread_pool_page_io);
+
+  PageIO *page_io = PageIO::create(2);
+  check_page_io(page_io);
+  delete page_io;
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,461 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/common/condition_filter.h"
+#include "storage/common/field_meta.h"
+#include "storage/common/record_manager.h"
+#include "storage/default/disk_buffer_pool.h"
+
+static const char *TEST_FILE = "record_manager_test.data";
+
+// 记录的格式: int id + char name[NAME_LEN]
+static const int NAME_LEN = 2000;
+static const int RECORD_SIZE = sizeof(int) + NAME_LEN;
+
+static std::vector<char> make_record(int id, const std::string &name)
+{
+  std::vector<char> record(RECORD_SIZE, 0);
+  memcpy(record.data(), &id, sizeof(id));
+  memcpy(record.data() + sizeof(id), name.data(), name.size());
+  return record;
+}
+
+static int scan_count(DiskBufferPool &buffer_pool, int file_id, const RecordLayout *layout)
+{
+  RecordFileScanner scanner;
+  scanner.open_scan(buffer_pool, file_id, nullptr, layout);
+  int count = 0;
+  Record record;
+  RC rc = scanner.get_first_record(&record);
+  while (rc == RC::SUCCESS) {
+    count++;
+    rc = scanner.get_next_record(&record);
+  }
+  scanner.close_scan();
+  return count;
+}
+
+TEST(test_record_manager, test_record_layout) {
+  RecordLayout layout(RecordFormat::SLOTTED, RECORD_SIZE);
+  layout.add_var_field(sizeof(int), NAME_LEN);
+
+  std::vector<char> record = make_record(7, "hello");
+  ASSERT_EQ((int)(sizeof(int) + sizeof(uint16_t) + 5), layout.encoded_size(record.data()));
+
+  std::vector<char> encoded(layout.encoded_size(record.data()));
+  ASSERT_EQ((int)encoded.size(), layout.encode(record.data(), encoded.data()));
+
+  std::vector<char> decoded(RECORD_SIZE, 'x');
+  ASSERT_EQ(RC::SUCCESS, layout.decode(encoded.data(), encoded.size(), decoded.data()));
+  ASSERT_EQ(record, decoded);
+  ASSERT_NE(RC::SUCCESS, layout.decode(encoded.data(), encoded.size() - 1, decoded.data()));
+
+  RecordFormat format = RecordFormat::FIXED;
+  ASSERT_TRUE(record_format_from_name("SLOTTED", format));
+  ASSERT_EQ(RecordFormat::SLOTTED, format);
+  ASSERT_FALSE(record_format_from_name("compressed", format));
+}
+
+TEST(test_record_manager, test_slotted_page) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  RecordLayout layout(RecordFormat::SLOTTED, RECORD_SIZE);
+  layout.add_var_field(sizeof(int), NAME_LEN);
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(buffer_pool, file_id, layout));
+
+  // 短记录按照实际长度保存，一页能放下的记录远多于定长格式的一条
+  const int short_count = 200;
+  std::vector<RID> rids;
+  for (int i = 0; i < short_count; i++) {
+    std::vector<char> record = make_record(i, "name" + std::to_string(i));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), RECORD_SIZE, &rid));
+    rids.push_back(rid);
+  }
+  int page_count = 0;
+  buffer_pool.get_page_count(file_id, &page_count);
+  ASSERT_LE(page_count, 3);
+
+  // 长记录保存到溢出页
+  std::string long_name(NAME_LEN, 'a');
+  std::vector<char> long_record = make_record(short_count, long_name);
+  RID long_rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(long_record.data(), RECORD_SIZE, &long_rid));
+
+  Record record;
+  std::vector<char> record_buf;
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&long_rid, &record, record_buf));
+  ASSERT_EQ(0, memcmp(long_record.data(), record.data, RECORD_SIZE));
+  // 记录在各自的buffer中，后获取的记录不会覆盖先获取的
+  Record other;
+  std::vector<char> other_buf;
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[10], &other, other_buf));
+  ASSERT_EQ(0, memcmp(long_record.data(), record.data, RECORD_SIZE));
+  ASSERT_EQ(make_record(10, "name10"), std::vector<char>(other.data, other.data + RECORD_SIZE));
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[10], &record, record_buf));
+  ASSERT_EQ(make_record(10, "name10"), std::vector<char>(record.data, record.data + RECORD_SIZE));
+  ASSERT_EQ(short_count + 1, scan_count(buffer_pool, file_id, &layout));
+
+  // 变长之后RID不变
+  std::vector<char> updated = make_record(10, std::string(500, 'b'));
+  record.rid = rids[10];
+  record.data = updated.data();
+  ASSERT_EQ(RC::SUCCESS, file_handler.update_record(&record));
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[10], &record, record_buf));
+  ASSERT_EQ(updated, std::vector<char>(record.data, record.data + RECORD_SIZE));
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&long_rid));
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[0]));
+  ASSERT_NE(RC::SUCCESS, file_handler.get_record(&rids[0], &record, record_buf));
+  ASSERT_EQ(short_count - 1, scan_count(buffer_pool, file_id, &layout));
+
+  file_handler.close();
+  buffer_pool.close_file(file_id);
+  unlink(TEST_FILE);
+}
+
+TEST(test_record_manager, test_free_space_map) {
+  RecordFreeSpaceMap free_space_map;
+  ASSERT_EQ(-1, free_space_map.find(1));
+
+  free_space_map.update(1, 0, 100);
+  free_space_map.update(2, 10, 100);
+  free_space_map.update(3, 100, 100);
+  ASSERT_EQ(2, free_space_map.find(1));
+  ASSERT_EQ(3, free_space_map.find(20));
+  ASSERT_EQ(-1, free_space_map.find(101));
+
+  free_space_map.update(1, 50, 100);
+  ASSERT_EQ(1, free_space_map.find(20));
+  free_space_map.remove(1);
+  ASSERT_EQ(3, free_space_map.find(20));
+  ASSERT_EQ(2, free_space_map.page_count());
+
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  // 删除之后的空间要被后面的插入重新使用，文件不再增长
+  const int record_size = 200;
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(buffer_pool, file_id));
+  std::vector<char> record(record_size, 'r');
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+  int page_count = 0;
+  buffer_pool.get_page_count(file_id, &page_count);
+
+  // FIXED格式的记录也复制到调用者的buffer中，不指向可能被换出的页面
+  Record rec;
+  std::vector<char> rec_buf;
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[1], &rec, rec_buf));
+  ASSERT_EQ(rec_buf.data(), rec.data);
+  ASSERT_EQ(record, std::vector<char>(rec.data, rec.data + record_size));
+
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+  for (int i = 0; i < 100; i += 3) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), record_size, &rid));
+  }
+  int new_page_count = 0;
+  buffer_pool.get_page_count(file_id, &new_page_count);
+  ASSERT_EQ(page_count, new_page_count);
+  ASSERT_EQ(100, scan_count(buffer_pool, file_id, nullptr));
+
+  file_handler.close();
+  buffer_pool.close_file(file_id);
+  unlink(TEST_FILE);
+}
+
+TEST(test_record_manager, test_delete_pinned_page) {
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  const int record_size = 200;
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(buffer_pool, file_id));
+  std::vector<char> record(record_size, 'r');
+  std::vector<RID> rids;
+  for (int i = 0; i < 3; i++) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+
+  // 扫描还固定着页面，删空之后不能释放，页面要留在空闲空间表中
+  RecordFileScanner scanner;
+  scanner.open_scan(buffer_pool, file_id, nullptr, nullptr);
+  RecordBatch batch;
+  ASSERT_EQ(RC::SUCCESS, scanner.next_batch(batch));
+  for (RID &rid : rids) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rid));
+  }
+  ASSERT_EQ(1, file_handler.free_space_map().page_count());
+  scanner.close_scan();
+
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), record_size, &rid));
+  ASSERT_EQ(rids[0].page_num, rid.page_num);
+
+  // 没有被固定的页面删空之后释放
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rid));
+  ASSERT_EQ(0, file_handler.free_space_map().page_count());
+
+  file_handler.close();
+  buffer_pool.close_file(file_id);
+  unlink(TEST_FILE);
+}
+
+TEST(test_record_manager, test_relocate) {
+  RecordFreeSpaceMap free_space_map;
+  free_space_map.update(1, 60, 100);
+  free_space_map.update(2, 10, 100);
+  free_space_map.update(3, 80, 100);
+  ASSERT_EQ(1, free_space_map.find(50, 3));
+  ASSERT_EQ(-1, free_space_map.find(50, 1));
+  std::vector<PageNum> pages;
+  free_space_map.sparse_pages(50, pages);
+  ASSERT_EQ((std::vector<PageNum>{3, 1}), pages);
+
+  unlink(TEST_FILE);
+  DiskBufferPool buffer_pool(64);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+  int file_id = -1;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+  const int record_size = 200;
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(buffer_pool, file_id));
+  std::vector<char> record(record_size, 'r');
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+  for (int i = 0; i < 100; i++) {
+    if (i % 4 != 0) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    }
+  }
+  const int page_count = file_handler.free_space_map().page_count();
+
+  // 把后面页面的记录搬到前面的页面上，搬空的页面被释放
+  ASSERT_EQ(RC::SUCCESS, file_handler.sparse_pages(50, pages));
+  ASSERT_FALSE(pages.empty());
+  RecordBatch batch;
+  int moved = 0;
+  for (PageNum page_num : pages) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_page_records(page_num, batch));
+    for (Record &rec : batch.records) {
+      RID rid;
+      RC rc = file_handler.relocate_record(rec.data, page_num, &rid);
+      if (rc == RC::RECORD_NOMEM) {
+        break;
+      }
+      ASSERT_EQ(RC::SUCCESS, rc);
+      ASSERT_LT(rid.page_num, page_num);
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rec.rid));
+      moved++;
+    }
+  }
+  ASSERT_GT(moved, 0);
+  ASSERT_LT(file_handler.free_space_map().page_count(), page_count);
+  ASSERT_EQ(25, scan_count(buffer_pool, file_id, nullptr));
+
+  file_handler.close();
+  buffer_pool.close_file(file_id);
+  unlink(TEST_FILE);
+}
+
+static int batch_count(DiskBufferPool &buffer_pool, int file_id, const RecordLayout *layout)
+{
+  RecordFileScanner scanner;
+  scanner.open_scan(buffer_pool, file_id, nullptr, layout);
+  int count = 0;
+  RecordBatch batch;
+  while (scanner.next_batch(batch) == RC::SUCCESS) {
+    EXPECT_GT(batch.size(), 0);
+    for (const Record &record : batch.records) {
+      EXPECT_EQ(record.rid.slot_num, *(const int *)(record.data + sizeof(int)) % 1000);
+      count++;
+    }
+  }
+  scanner.close_scan();
+  return count;
+}
+
+TEST(test_record_manager, test_next_batch) {
+  // 记录的格式: int id + int slot_num + char name[NAME_LEN]
+  const int record_size = sizeof(int) * 2 + NAME_LEN;
+  RecordLayout layouts[] = {RecordLayout(),
+                            RecordLayout(RecordFormat::SLOTTED, record_size)};
+  layouts[1].add_var_field(sizeof(int) * 2, NAME_LEN);
+  for (RecordLayout &layout : layouts) {
+    unlink(TEST_FILE);
+    DiskBufferPool buffer_pool(64);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.create_file(TEST_FILE));
+    int file_id = -1;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool.open_file(TEST_FILE, &file_id));
+
+    const int fixed_size = layout.format() == RecordFormat::FIXED ? 60 : record_size;
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(buffer_pool, file_id, layout));
+    std::vector<char> record(record_size, 0);
+    std::vector<RID> rids;
+    for (int i = 0; i < 500; i++) {
+      RID rid;
+      memcpy(record.data(), &i, sizeof(i));
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record.data(), fixed_size, &rid));
+      // 把槽位号写进记录，扫描时检查记录和RID对应
+      int slot_num = rid.slot_num;
+      memcpy(record.data() + sizeof(int), &slot_num, sizeof(slot_num));
+      Record rec;
+      rec.rid = rid;
+      rec.data = record.data();
+      ASSERT_EQ(RC::SUCCESS, file_handler.update_record(&rec));
+      rids.push_back(rid);
+    }
+    for (int i = 0; i < 500; i += 7) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    }
+
+    const RecordLayout *scan_layout = layout.format() == RecordFormat::FIXED ? nullptr : &layout;
+    ASSERT_EQ(scan_count(buffer_pool, file_id, scan_layout), batch_count(buffer_pool, file_id, scan_layout));
+    ASSERT_EQ(500 - 72, batch_count(buffer_pool, file_id, scan_layout));
+
+    file_handler.close();
+    buffer_pool.close_file(file_id);
+  }
+  unlink(TEST_FILE);
+}
+
+template <typename T>
+static bool expect_compare(T left, T right, CompOp comp_op)
+{
+  switch (comp_op) {
+    case EQUAL_TO: return left == right;
+    case LESS_EQUAL: return left <= right;
+    case NOT_EQUAL: return left != right;
+    case LESS_THAN: return left < right;
+    case GREAT_EQUAL: return left >= right;
+    case GREAT_THAN: return left > right;
+    default: return false;
+  }
+}
+
+TEST(test_record_manager, test_compiled_filter) {
+  // 记录的格式: int i + float f + nullable int n + char s[8]
+  FieldMeta int_field, float_field, null_field, str_field;
+  int_field.init("i", INTS, 0, 4, true, false);
+  float_field.init("f", FLOATS, 4, 4, true, false);
+  null_field.init("n", INTS, 8, 5, true, true);
+  str_field.init("s", CHARS, 13, 8, true, false);
+  const int record_size = 21;
+
+  const int num = 150;
+  std::vector<char> data(num * record_size, 0);
+  std::vector<Record> records(num);
+  for (int i = 0; i < num; i++) {
+    char *rec = data.data() + i * record_size;
+    int v = i % 37 - 18;
+    float f = v * 0.5f;
+    memcpy(rec, &v, sizeof(v));
+    memcpy(rec + 4, &f, sizeof(f));
+    rec[8] = (i % 5 == 0);  // 空值
+    memcpy(rec + 9, &v, sizeof(v));
+    snprintf(rec + 13, 8, "s%02d", i % 20);
+    records[i].rid.page_num = 1;
+    records[i].rid.slot_num = i;
+    records[i].data = rec;
+  }
+
+  int int_value = 3;
+  float float_value = 2.5f;
+  char str_value[] = "s10";
+  Value int_const = {INTS, &int_value};
+  Value float_const = {FLOATS, &float_value};
+  Value str_const = {CHARS, str_value};
+
+  struct Case {
+    const FieldMeta *field;
+    const Value *value;
+  } cases[] = {{&int_field, &int_const}, {&int_field, &float_const}, {&float_field, &int_const},
+               {&float_field, &float_const}, {&null_field, &int_const}, {&str_field, &str_const}};
+  CompOp ops[] = {EQUAL_TO, LESS_EQUAL, NOT_EQUAL, LESS_THAN, GREAT_EQUAL, GREAT_THAN};
+
+  for (const Case &c : cases) {
+    for (CompOp op : ops) {
+      for (bool attr_left : {true, false}) {
+        ConDesc attr, value;
+        attr.is_attr = true;
+        attr.data.field_meta = c.field;
+        value.is_attr = false;
+        value.data.value = c.value;
+        DefaultConditionFilter filter;
+        if (attr_left) {
+          ASSERT_EQ(RC::SUCCESS, filter.init(attr, value, c.field->type(), c.value->type, op));
+        } else {
+          ASSERT_EQ(RC::SUCCESS, filter.init(value, attr, c.value->type, c.field->type(), op));
+        }
+        ASSERT_TRUE(filter.compiled());
+
+        std::vector<char> select((num + 7) / 8, (char)0xFF);
+        filter.filter_batch(records.data(), num, select.data());
+        for (int i = 0; i < num; i++) {
+          const char *rec = records[i].data;
+          bool expected = false;
+          if (c.field == &str_field) {
+            int cmp = strcmp(rec + 13, str_value);
+            expected = attr_left ? expect_compare(cmp, 0, op) : expect_compare(0, cmp, op);
+          } else if (c.field == &null_field && rec[8]) {
+            expected = false;
+          } else {
+            float field_value = c.field == &float_field ? *(const float *)(rec + 4) : *(const int *)(rec + 0);
+            float const_value = c.value->type == INTS ? int_value : float_value;
+            expected = attr_left ? expect_compare(field_value, const_value, op)
+                                 : expect_compare(const_value, field_value, op);
+          }
+          bool selected = (select[i / 8] >> (i % 8)) & 1;
+          ASSERT_EQ(expected, selected) << "field " << c.field->name() << " op " << op << " record " << i;
+          ASSERT_EQ(expected, filter.filter(records[i]));
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}